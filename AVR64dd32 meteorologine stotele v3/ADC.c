@@ -23,25 +23,25 @@ void ADC0_init() {
 }
 
 /**
- * @brief Sets up ADC0 to read WS (PF1) input.
+ * @brief Sets up ADC0 to read WS (PC2) input.
  *
  * Configures the ADC0 reference voltage to VDD and sets the positive input
- * channel to AIN30 (PF1).
+ * channel to AIN30 (PC2).
  */
 void ADC0_SetupWS() {
     VREF.ADC0REF = VREF_REFSEL_VDD_gc;
-    ADC0.MUXPOS = ADC_MUXPOS_AIN30_gc; // PF1 as input for WS
+    ADC0.MUXPOS = ADC_MUXPOS_AIN30_gc; // PC2 as input for WS
 }
 
 /**
- * @brief Sets up ADC0 to read WD (PF0) input.
+ * @brief Sets up ADC0 to read WD (PC3) input.
  *
  * Configures the ADC0 reference voltage to VDD and sets the positive input
- * channel to AIN31 (PF0).
+ * channel to AIN31 (PC3).
  */
 void ADC0_SetupWD() {
     VREF.ADC0REF = VREF_REFSEL_VDD_gc;
-    ADC0.MUXPOS = ADC_MUXPOS_AIN31_gc; // PF0 as input for WD
+    ADC0.MUXPOS = ADC_MUXPOS_AIN31_gc; // PC3 as input for WD
 }
 
 /**
@@ -55,6 +55,17 @@ void ADC0_SetupSLS() {
     ADC0.MUXPOS = ADC_MUXPOS_AIN26_gc; // PA6 as input for SLS
 }
 
+/**
+ * @brief Sets the number of accumulated samples per ADC0 conversion.
+ *
+ * Used by the adaptive sampling engine to trade conversion time for noise on a per-channel basis.
+ *
+ * @param sampnum Accumulation setting (ADC_SAMPNUM_ACC1_gc to ADC_SAMPNUM_ACC128_gc).
+ */
+void ADC0_SetAccumulation(uint8_t sampnum) {
+    ADC0.CTRLB = sampnum & ADC_SAMPNUM_gm;
+}
+
 /**
  * @brief Reads a value from ADC0.
  *
@@ -65,8 +76,11 @@ void ADC0_SetupSLS() {
  * @return The ADC conversion result as a 12-bit value.
  */
 uint16_t ADC0_read() {
+    uint8_t shift = ADC0.CTRLB & ADC_SAMPNUM_gm; // log2 of accumulated samples
+    if (shift > 4)
+        shift = 4; // Accumulation over 16 is already truncated to 16 bits by the ADC
     ADC0.COMMAND = ADC_STCONV_bm; // Start conversion
     while (!(ADC0.INTFLAGS & ADC_RESRDY_bm)); // Wait until result is ready
     ADC0.INTFLAGS = ADC_RESRDY_bm; // Clear result ready flag
-    return ADC0.RES >> 4; // Shift result if accumulation is over 16
+    return ADC0.RES >> shift; // Scale accumulated result back to 12 bits
 }
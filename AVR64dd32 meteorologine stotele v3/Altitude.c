@@ -8,25 +8,54 @@
 #include "Settings.h"
 #include "AltitudeVar.h"
 
+/**
+ * @brief Calculates the vapor pressure from the SHT21 temperature and humidity.
+ *
+ * @return The vapor pressure in hPa (Magnus formula).
+ */
+double vapor_pressure() {
+    double es = A * exp((B * SHT21.T) / (SHT21.T + C)); // Saturation vapor pressure (hPa)
+    return es * (SHT21.RH / 100.0); // Vapor pressure (hPa)
+}
+
+/**
+ * @brief Calculates the dew point from the SHT21 temperature and humidity.
+ *
+ * @return The dew point in degrees Celsius (Magnus formula, humidity limited to 0.1 % or more).
+ */
+double dew_point() {
+    double rh = (SHT21.RH < 0.1) ? 0.1 : SHT21.RH;
+    double gamma = log(rh / 100.0) + (B * SHT21.T) / (SHT21.T + C);
+    return C * gamma / (B - gamma);
+}
+
+/**
+ * @brief Calculates the elevation from pressure alone (standard atmosphere).
+ *
+ * @return The uncompensated elevation in meters.
+ */
+double calculate_uncompensated_elevation() {
+    // -0.1902632: Precomputed value of (-R*L/g*M). 44330.7692307 is T0/L.
+    return 44330.7692307 * (pow(BMP280.Pressure / SEA_LEVEL_PRESSURE, -0.1902632) - 1);
+}
+
 /**
  * @brief Calculates the adjusted elevation based on atmospheric pressure, temperature, and humidity.
  *
  * The function performs the following steps:
  * 1. Converts the temperature to Kelvin.
- * 2. Calculates the saturation vapor pressure and the vapor pressure.
- * 3. Adjusts the atmospheric pressure by subtracting the vapor pressure.
- * 4. Computes the elevation using the barometric formula.
+ * 2. Adjusts the atmospheric pressure by subtracting the vapor pressure (`SHT21.e`, kept up to
+ *    date by the derived value graph).
+ * 3. Computes the elevation using the barometric formula.
  *
  * @return The calculated elevation in meters.
  */
 double calculate_adjusted_elevation() {
     // 1. Adjust relative humidity
     double temp_k = SHT21.T + T0; // Convert temperature to Kelvin
-    double es = A * exp((B * SHT21.T) / (SHT21.T + C)); // Saturation vapor pressure (hPa)
-    double e = es * (SHT21.RH / 100.0); // Vapor pressure (hPa)
     
     // 2. Adjust atmospheric pressure
-    double adjusted_pressure = BMP280.Pressure - e; // Adjusted atmospheric pressure (hPa)
+    double adjusted_pressure = BMP280.Pressure - SHT21.e; // Adjusted atmospheric pressure (hPa)
 
     // 3. Calculate elevation
     double elevation = (temp_k / GRAVITY) * log(SEA_LEVEL_PRESSURE / adjusted_pressure) * 
@@ -34,20 +63,3 @@ double calculate_adjusted_elevation() {
 
     return elevation;
 }
-
-/**
- * @brief Calculates the average altitude using uncompensated and compensated elevation values.
- *
- * The function computes:
- * - Uncompensated altitude based on the barometric formula.
- * - Compensated altitude using `calculate_adjusted_elevation()`.
- * - Average altitude as the mean of uncompensated and compensated values.
- */
-void AltitudeAverage() {
-    Altitude.UNCOMP = 44330.7692307 * (pow(BMP280.Pressure / SEA_LEVEL_PRESSURE, -0.1902632) - 1); 
-    // -0.1902632: Precomputed value of (-R*L/g*M). 44330.7692307 is T0/L.
-
-    Altitude.COMP = calculate_adjusted_elevation();
-
-    Altitude.AVRG = (Altitude.UNCOMP + Altitude.COMP) / 2;
-}
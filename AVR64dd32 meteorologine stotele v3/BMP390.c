@@ -14,7 +14,7 @@
  * @brief Reads the BMP280 sensor ID from its EEPROM.
  */
 void ReadBMP280ID() {
-    BMP280.ID = ReadReg(BMP280Add, id);
+    BMP280.ID = ReadReg(BMP280.Address, id);
 }
 
 /**
@@ -31,7 +31,7 @@ void ReadBMP280Calibration() {
             startAdd = calib16;
             part = 2;        
         }    
-        uint64_t data = ReadMulti(BMP280Add, startAdd, 8);
+        uint64_t data = ReadMulti(BMP280.Address, startAdd, 8);
 
         if (part == 0) {
             BMP280.CalibrationValues.dig_T1 = ((data >> 48) & 0xFF) << 8 | ((data >> 48) & 0xFF00) >> 8;
@@ -56,7 +56,7 @@ void ReadBMP280Calibration() {
  * @brief Reads the configuration data from the BMP280 sensor.
  */
 void ReadBMP280Config() {
-    uint64_t data = ReadMulti(BMP280Add, ctrl_meas, 2);
+    uint64_t data = ReadMulti(BMP280.Address, ctrl_meas, 2);
     BMP280.Config.osrs_t = (data >> 13) & 0xfff;
     BMP280.Config.osrs_p = (data >> 10) & 0xfff;
     BMP280.Config.Mode = (data >> 8) & 0xff;
@@ -69,35 +69,59 @@ void ReadBMP280Config() {
  * @brief Writes the configuration data to the BMP280 sensor.
  */
 void WriteBMP280Config() {
-    WriteToReg(BMP280Add, ctrl_meas, (BMP280.Config.osrs_p << 5) + (BMP280.Config.osrs_t << 2) + BMP280.Config.Mode);
-    WriteToReg(BMP280Add, config, (BMP280.Config.t_sb << 5) + (BMP280.Config.filter << 2) + BMP280.Config.spi3w_en);
+    WriteToReg(BMP280.Address, ctrl_meas, (BMP280.Config.osrs_p << 5) + (BMP280.Config.osrs_t << 2) + BMP280.Config.Mode);
+    WriteToReg(BMP280.Address, config, (BMP280.Config.t_sb << 5) + (BMP280.Config.filter << 2) + BMP280.Config.spi3w_en);
 }
 
 /**
  * @brief Reads the status register of the BMP280 sensor.
  */
 void ReadBMP280Status() {
-    uint8_t data = ReadReg(BMP280Add, status);
+    uint8_t data = ReadReg(BMP280.Address, status);
     BMP280.Status.measuring = (data >> 3) & 0xf;
     BMP280.Status.im_update = data & 0xf;
 }
 
+/**
+ * @brief Forced mode conversion time (us, datasheet maximum) at the current oversampling.
+ * @details t = 1.25 + 2.3 * osrs_t + 2.3 * osrs_p + 0.575 ms, with the oversampling codes
+ * 1-5 meaning x1 to x16 and 0 meaning skipped.
+ */
+uint32_t BMP280_ConversionTime() {
+    uint8_t ot = BMP280.Config.osrs_t ? 1 << (BMP280.Config.osrs_t > 5 ? 4 : BMP280.Config.osrs_t - 1) : 0;
+    uint8_t op = BMP280.Config.osrs_p ? 1 << (BMP280.Config.osrs_p > 5 ? 4 : BMP280.Config.osrs_p - 1) : 0;
+    return 1250 + 2300UL * ot + (op ? 2300UL * op + 575 : 0);
+}
+
 /**
  * @brief Reads both temperature and pressure from the BMP280 sensor.
+ * @details Does not wait for a running conversion: every call reads the status register at most
+ * once (every BMP280_POLL_US, at most one conversion time from the first call) and returns
+ * I2C_POLL_WAIT while the sensor is measuring, so the caller returns to the main loop and calls
+ * again on the next pass. The start of the conversion is unknown here, so nothing is learned.
+ * @return I2C_POLL_WAIT, or I2C_POLL_READY / I2C_POLL_TIMEOUT once the results are read.
  */
-void ReadBMP280TP() {
-    while (BMP280.Status.measuring && BMP280.Status.im_update) {
-        ReadBMP280Status();
+uint8_t ReadBMP280TP() {
+    static I2C_Poll poll = { .reg = status, .busy = BMP280_MEASURING, .interval = BMP280_POLL_US };
+
+    if (!poll.limit) { // First call of this read
+        poll.address = BMP280.Address;
+        I2C_PollStart(&poll, BMP280_ConversionTime());
     }
-    BMP280.CalibrationValues.UP = (ReadMulti(BMP280Add, press_msb, 3)) >> 4;
-    BMP280.CalibrationValues.UT = (ReadMulti(BMP280Add, temp_msb, 3)) >> 4;
+    uint8_t ready = I2C_PollReady(&poll);
+    if (ready == I2C_POLL_WAIT)
+        return I2C_POLL_WAIT;
+    poll.limit = 0;
+    BMP280.CalibrationValues.UP = (ReadMulti(BMP280.Address, press_msb, 3)) >> 4;
+    BMP280.CalibrationValues.UT = (ReadMulti(BMP280.Address, temp_msb, 3)) >> 4;
+    return ready;
 }
 
 /**
  * @brief Resets the BMP280 sensor.
  */
 void ResetBMP280() {
-    WriteToReg(BMP280Add, reset, BMP280_Reset);
+    WriteToReg(BMP280.Address, reset, BMP280_Reset);
 }
 
 /**
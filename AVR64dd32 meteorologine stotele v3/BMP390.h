@@ -73,6 +73,12 @@
 #define BMP280_SPI_Mode_3w         1 /**< SPI 3-wire mode */
 ///@}
 
+/** @name BMP280 Conversion Ready Poll */
+///@{
+#define BMP280_MEASURING           0x08 /**< Status register bit set while a conversion runs */
+#define BMP280_POLL_US             250  /**< Ready probe interval (us), one status read takes about 30 us of bus time */
+///@}
+
 /** @name BMP280 Reset */
 ///@{
 #define BMP280_Reset               0xb6 /**< Reset register value */
@@ -179,12 +185,14 @@ typedef struct {
  * temperature, pressure, calibration values, and status.
  */
 typedef struct {
+    uint8_t Address; /**< I2C address of the sensor being accessed */
     uint8_t ID; /**< Sensor ID */
     float Temperature; /**< Temperature reading in Celsius */
     double Pressure; /**< Pressure reading in hPa */
     BMP280Values CalibrationValues; /**< Calibration coefficients */
     BMP280Config Config; /**< Configuration settings */
     BMP280Status Status; /**< Sensor status */
+    I2C_Poll Poll; /**< Forced mode conversion ready poll (status register) and measured conversion times */
 } BMP280Result;
 
 /** @brief Global variable for the BMP280 sensor result */
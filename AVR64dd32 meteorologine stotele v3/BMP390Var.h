@@ -16,14 +16,17 @@
  * @brief Global instance of BMP280Result for holding sensor data.
  * 
  * This instance initializes the BMP280 structure with default values:
+ * - `Address`: The sensor address (0x76).
  * - `ID`: The default sensor ID (0x58).
  * - `CalibrationValues.UP`: Placeholder for uncompensated pressure (default: 0x800000).
  * - `CalibrationValues.UT`: Placeholder for uncompensated temperature (default: 0x800000).
  */
 BMP280Result BMP280 = {
+    .Address = BMP280Add, /**< SDO connected to GND. */
     .ID = 0x58, /**< Sensor ID, expected default for BMP280. */
     .CalibrationValues.UP = 0x800000, /**< Default uncompensated pressure value. */
-    .CalibrationValues.UT = 0x800000 /**< Default uncompensated temperature value. */
+    .CalibrationValues.UT = 0x800000, /**< Default uncompensated temperature value. */
+    .Poll = { .address = BMP280Add, .reg = status, .busy = BMP280_MEASURING, .interval = BMP280_POLL_US, .ratio = 192 } /**< Typical time 3/4 of the worst case until measured. */
 };
 
 #endif /* BMP390VAR_H_ */
@@ -0,0 +1,51 @@
+/**
+ * @file CRC.h
+ * @brief Header file for the CRC library.
+ *
+ * This file selects the CRC implementation and defines the initial values of the
+ * supported CRCs:
+ *  - CRC-8/Sensirion: polynomial 0x31, MSB first, no final XOR (SHT2x uses init 0x00,
+ *    SHT3x/SHT4x init 0xFF),
+ *  - CRC-16/CCITT: polynomial 0x1021, MSB first, init 0xFFFF (CCITT-FALSE),
+ *  - CRC-16/Modbus: polynomial 0x8005 reflected (0xA001), init 0xFFFF; with init 0x0000
+ *    the same function gives the SDI-12 CRC (CRC-16/ARC).
+ *
+ * All CRCs are computed incrementally: start from the initial value and pass the
+ * returned CRC to the next call together with the next part of the stream.
+ *
+ * @author Saulius
+ * @date 2025-01-14
+ */
+
+#ifndef CRC_H_
+#define CRC_H_
+
+/**
+ * @brief CRC implementations, selected at compile time with `CRC_IMPLEMENTATION`.
+ *
+ * Flash and speed per implementation (tools/crc_benchmark.py measures them):
+ *  - CRC_TABLE256: one lookup per byte, 256-entry tables (256 B for CRC-8, 512 B per CRC-16),
+ *  - CRC_TABLE16:  two lookups per byte, 16-entry nibble tables (16 B / 32 B),
+ *  - CRC_BITWISE:  eight shift/XOR steps per byte, no tables.
+ *
+ * The tables are PROGMEM and read with pgm_read_byte/pgm_read_word, so none of them costs RAM.
+ */
+#define CRC_TABLE256 0
+#define CRC_TABLE16  1
+#define CRC_BITWISE  2
+
+#ifndef CRC_IMPLEMENTATION
+#define CRC_IMPLEMENTATION CRC_TABLE256 /**< 1280 B of flash out of 64 KB, speed matters on the SHT21 path */
+#endif
+
+#define CRC8_POLYNOMIAL        0x31   /**< x^8 + x^5 + x^4 + 1 */
+#define CRC16_CCITT_POLYNOMIAL 0x1021 /**< x^16 + x^12 + x^5 + 1 */
+#define CRC16_MODBUS_POLYNOMIAL 0xA001 /**< x^16 + x^15 + x^2 + 1, reflected */
+
+#define CRC8_SHT21_INIT        0x00   /**< SHT2x (Separator() data words) */
+#define CRC8_SENSIRION_INIT    0xFF   /**< SHT3x/SHT4x, SGP, SCD */
+#define CRC16_CCITT_INIT       0xFFFF
+#define CRC16_MODBUS_INIT      0xFFFF
+#define CRC16_SDI12_INIT       0x0000 /**< SDI-12 (CRC-16/ARC): Modbus polynomial, init 0 */
+
+#endif /* CRC_H_ */
@@ -0,0 +1,122 @@
+/**
+ * @file ClearSky.c
+ * @brief Fixed-point Haurwitz clear-sky model, clear-sky index and its rolling window statistics.
+ *
+ * @author Saulius
+ * @date 2025-01-18
+ */
+
+#include "Settings.h"
+#include "ClearSkyVar.h"
+
+/**
+ * @brief 2^-y.
+ *
+ * @param y Exponent, Q12 (0 ... 15.99).
+ * @return 2^-y, Q15 (0 for y >= 15).
+ */
+static uint16_t ClearSky_Pow2(uint32_t y) {
+    uint32_t n = y >> 12;
+    uint16_t f = y & 0xFFF;
+
+    if (n >= 15)
+        return 0;
+    uint16_t a = pgm_read_word(&clearSkyPow2[f >> 7]); // 32 table steps per octave
+    uint16_t b = pgm_read_word(&clearSkyPow2[(f >> 7) + 1]);
+    return (a - (uint16_t)(((uint32_t)(a - b) * (f & 0x7F)) >> 7)) >> n;
+}
+
+/**
+ * @brief Haurwitz clear-sky irradiance for the current solar elevation and station altitude.
+ *
+ * @param e Solar elevation, CLEARSKY_MIN_ELEVATION ... 9000 (0.01 deg).
+ * @return Clear-sky global horizontal irradiance (0.1 W/m2).
+ */
+static uint16_t ClearSky_Model(uint16_t e) {
+    if (Date_Clock.altitude != ClearSky.altitude) { // Relative air pressure, only when the altitude changes
+        ClearSky.altitude = Date_Clock.altitude;
+        uint16_t a = (ClearSky.altitude > 0) ? ClearSky.altitude : 0; // Below sea level: as at sea level
+        ClearSky.pressure = ClearSky_Pow2(((uint32_t)a * CLEARSKY_ALT_Q16) >> 16);
+    }
+    uint16_t s = FixedMath_Sin(e);
+    uint32_t x = ((uint32_t)CLEARSKY_B_Q16 * ClearSky.pressure / s) >> 4;  // 0.057 p/p0 / sin(h), Q12
+    uint16_t t = ClearSky_Pow2((x * CLEARSKY_LOG2E_Q12) >> 12);           // exp(-x) = 2^(-x log2 e), Q15
+    return ((uint32_t)CLEARSKY_G0_DW * (((uint32_t)s * t) >> 15)) >> 15;
+}
+
+/**
+ * @brief Adds one index sample to the rolling window and updates the statistics in O(1).
+ *
+ * @param k Clear-sky index (0.001).
+ */
+static void ClearSky_Add(uint16_t k) {
+    uint8_t last = (ClearSky.head + CLEARSKY_WINDOW - 1) % CLEARSKY_WINDOW;
+
+    if (ClearSky.count == CLEARSKY_WINDOW) { // Oldest sample and its step to the next one leave
+        uint16_t oldest = ClearSky.window[ClearSky.head];
+        uint16_t next = ClearSky.window[(ClearSky.head + 1) % CLEARSKY_WINDOW];
+        ClearSky.sum -= oldest;
+        ClearSky.sumSquares -= (uint32_t)oldest * oldest;
+        ClearSky.sumSteps -= (next > oldest) ? next - oldest : oldest - next;
+    } else {
+        ClearSky.count++;
+    }
+    if (ClearSky.count > 1) {
+        uint16_t previous = ClearSky.window[last];
+        ClearSky.sumSteps += (k > previous) ? k - previous : previous - k;
+    }
+    ClearSky.sum += k;
+    ClearSky.sumSquares += (uint32_t)k * k;
+    ClearSky.window[ClearSky.head] = k;
+    ClearSky.head = (ClearSky.head + 1) % CLEARSKY_WINDOW;
+
+    uint8_t n = ClearSky.count;
+    uint16_t mean = (ClearSky.sum + n / 2) / n;
+    // n^2 variance = n sum(k^2) - sum(k)^2, exact; too wide for 32 bits with a full window
+    uint64_t spread = (uint64_t)n * ClearSky.sumSquares - (uint64_t)ClearSky.sum * ClearSky.sum;
+    ClearSky.mean = mean;
+    ClearSky.deviation = (FixedMath_Sqrt(spread * 4 / ((uint16_t)n * n)) + 1) / 2; // Rounded: sqrt(4 var) / 2
+    ClearSky.variability = (n > 1) ? (ClearSky.sumSteps + (n - 1) / 2) / (n - 1) : 0;
+
+    if (ClearSky.deviation > CLEARSKY_VARIABLE_SD)
+        ClearSky.sky = CLEARSKY_VARIABLE;
+    else if (mean >= CLEARSKY_CLEAR_MEAN && ClearSky.deviation < CLEARSKY_CLEAR_SD)
+        ClearSky.sky = CLEARSKY_CLEAR;
+    else if (mean < CLEARSKY_OVERCAST_MEAN)
+        ClearSky.sky = CLEARSKY_OVERCAST;
+    else
+        ClearSky.sky = CLEARSKY_PARTLY;
+}
+
+/**
+ * @brief Takes one clear-sky index sample when due, call from the main loop.
+ *
+ * Below CLEARSKY_MIN_ELEVATION the window is emptied: the index of a low sun says more about
+ * the horizon and the sensor's cosine response than about cloud.
+ */
+void ClearSky_Task() {
+    uint32_t now = Timer_ms();
+
+    if ((int32_t)(now - ClearSky.nextSample) < 0)
+        return;
+    ClearSky.nextSample = now + CLEARSKY_SAMPLE_MS;
+
+    Derived_Refresh(DERIVED_BIT(DERIVED_ADJ_ANGLES));
+    int16_t e = lround(SUN.adjelevation * 100);
+    uint32_t g = ((uint32_t)SUN.sunlevel * CLEARSKY_CAL_Q8 * 10) >> 8;
+    ClearSky.irradiance = (g > UINT16_MAX) ? UINT16_MAX : g;
+    if (e < CLEARSKY_MIN_ELEVATION) {
+        ClearSky.clearSky = 0;
+        ClearSky.index = 0;
+        ClearSky.count = 0;
+        ClearSky.head = 0;
+        ClearSky.sum = ClearSky.sumSquares = ClearSky.sumSteps = 0;
+        ClearSky.mean = ClearSky.deviation = ClearSky.variability = 0;
+        ClearSky.sky = CLEARSKY_LOW_SUN;
+        return;
+    }
+    ClearSky.clearSky = ClearSky_Model(e > 9000 ? 9000 : e);
+    uint32_t k = (uint32_t)ClearSky.irradiance * 1000 / ClearSky.clearSky;
+    ClearSky.index = (k > CLEARSKY_MAX_INDEX) ? CLEARSKY_MAX_INDEX : k;
+    ClearSky_Add(ClearSky.index);
+}
@@ -0,0 +1,97 @@
+/**
+ * @file ClearSky.h
+ * @brief Header file for the clear-sky model, clear-sky index and sky variability.
+ *
+ * The Haurwitz model gives the global horizontal irradiance under a cloudless sky from the
+ * solar elevation h alone:
+ *
+ *   G_cs = 1098 W/m2 * sin(h) * exp(-0.057 * (p/p0) / sin(h))
+ *
+ * with the optical path scaled by the standard relative air pressure of the station altitude,
+ * p/p0 = exp(-altitude / 8434.5 m). Everything is fixed point: sin() (FixedMath.c) and 2^-x
+ * come from small PROGMEM tables with linear interpolation, so one evaluation is a few multiplies.
+ *
+ * The light sensor reading, converted with CLEARSKY_CAL_Q8, divided by G_cs gives the
+ * clear-sky index k (1 = clear, lower = cloud, above 1 = cloud edge enhancement). Every
+ * CLEARSKY_SAMPLE_MS one k sample enters a rolling window of CLEARSKY_WINDOW samples whose sums
+ * of k, k^2 and |k step| are updated incrementally (one sample in, one out), so mean, standard
+ * deviation and mean step cost O(1) per sample. tools/clearsky_accuracy.py checks the model and
+ * the window statistics against double precision on the host.
+ *
+ * @author Saulius
+ * @date 2025-01-18
+ */
+
+#ifndef CLEARSKY_H_
+#define CLEARSKY_H_
+
+/**
+ * @brief Light sensor calibration: W/m2 per SUN.sunlevel unit, Q8 (1100 W/m2 at 2048 mV).
+ *
+ * Replace with the factor found against a reference pyranometer on a clear day.
+ */
+#define CLEARSKY_CAL_Q8 138
+
+#define CLEARSKY_SAMPLE_MS 10000     /**< Period of the clear-sky index samples */
+#define CLEARSKY_WINDOW 60           /**< Samples in the rolling window: 10 minutes */
+#define CLEARSKY_MIN_ELEVATION 500   /**< Lowest solar elevation with a meaningful index (0.01 deg) */
+#define CLEARSKY_MAX_INDEX 2000      /**< Largest index kept (0.001), beyond is a sensor fault */
+
+/** @name Model constants (fixed point) */
+///@{
+#define CLEARSKY_G0_DW 10980         /**< Haurwitz 1098 W/m2, in 0.1 W/m2 */
+#define CLEARSKY_B_Q16 3736          /**< Haurwitz 0.057, Q16 */
+#define CLEARSKY_LOG2E_Q12 5909      /**< log2(e), Q12 */
+#define CLEARSKY_ALT_Q16 45915       /**< log2(e) / 8434.5 m per metre, Q12 scaled by 2^16 */
+///@}
+
+/** @name Sky classification of the window (clear-sky index, 0.001) */
+///@{
+#define CLEARSKY_CLEAR_MEAN 850      /**< Clear: mean index above this ... */
+#define CLEARSKY_CLEAR_SD 50         /**< ... and standard deviation below this */
+#define CLEARSKY_OVERCAST_MEAN 450   /**< Overcast: mean index below this, steady */
+#define CLEARSKY_VARIABLE_SD 150     /**< Variable (broken cloud): standard deviation above this */
+///@}
+
+/**
+ * @brief Sky state of the window.
+ */
+typedef enum {
+    CLEARSKY_LOW_SUN,  /**< Sun below CLEARSKY_MIN_ELEVATION, no index */
+    CLEARSKY_CLEAR,    /**< Cloudless */
+    CLEARSKY_PARTLY,   /**< Thin or scattered cloud */
+    CLEARSKY_VARIABLE, /**< Broken cloud, fast changes */
+    CLEARSKY_OVERCAST  /**< Thick steady cloud */
+} clearsky_sky_t;
+
+/**
+ * @brief Model results, rolling window and its statistics.
+ */
+typedef struct {
+    uint32_t nextSample;  /**< Time of the next sample (Timer_ms()) */
+    int16_t altitude;     /**< Altitude the pressure factor was computed for (m) */
+    uint16_t pressure;    /**< Relative air pressure p/p0 of that altitude, Q15 */
+
+    uint16_t clearSky;    /**< Clear-sky irradiance (0.1 W/m2) */
+    uint16_t irradiance;  /**< Measured irradiance (0.1 W/m2) */
+    uint16_t index;       /**< Clear-sky index of the last sample (0.001) */
+
+    uint16_t window[CLEARSKY_WINDOW]; /**< Index samples (0.001), oldest at head when full */
+    uint8_t head;         /**< Next slot to write */
+    uint8_t count;        /**< Samples in the window */
+    uint32_t sum;         /**< Sum of the indices in the window */
+    uint32_t sumSquares;  /**< Sum of their squares */
+    uint32_t sumSteps;    /**< Sum of |difference| of consecutive indices in the window */
+
+    uint16_t mean;        /**< Mean index of the window (0.001) */
+    uint16_t deviation;   /**< Standard deviation of the index (0.001) */
+    uint16_t variability; /**< Mean |step| between samples (0.001), the fast part of the variation */
+    uint8_t sky;          /**< clearsky_sky_t */
+} ClearSkyState;
+
+/**
+ * @brief Global clear-sky state.
+ */
+extern ClearSkyState ClearSky;
+
+#endif /* CLEARSKY_H_ */
@@ -0,0 +1,30 @@
+/**
+ * @file ClearSkyVar.h
+ * @brief Variable definitions and PROGMEM tables of the clear-sky model.
+ *
+ * @author Saulius
+ * @date 2025-01-18
+ */
+
+#ifndef CLEARSKYVAR_H_
+#define CLEARSKYVAR_H_
+
+/**
+ * @brief Clear-sky state, empty window; the pressure factor is computed on the first sample.
+ */
+ClearSkyState ClearSky = {
+    .altitude = INT16_MIN,
+    .count = 0,
+    .sky = CLEARSKY_LOW_SUN
+};
+
+/**
+ * @brief 2^(-i/32) for i = 0 ... 32, Q15.
+ */
+const uint16_t clearSkyPow2[33] PROGMEM = {
+    32767, 32066, 31379, 30706, 30048, 29405, 28774, 28158, 27554, 26964, 26386, 25821, 25268,
+    24726, 24196, 23678, 23170, 22674, 22188, 21713, 21247, 20792, 20347, 19911, 19484, 19066,
+    18658, 18258, 17867, 17484, 17109, 16743, 16384
+};
+
+#endif /* CLEARSKYVAR_H_ */
@@ -17,72 +17,100 @@
  * 
  * The command string is expected to contain data separated by '|', such as date, time,
  * solar angles, latitude, longitude, and timezone. The function extracts and assigns
- * these values to the respective variables.
+ * these values to the respective variables. A frame with a missing field or a value out
+ * of range (a byte lost or changed on the line) is rejected as a whole.
  * 
  * @param[in] command Pointer to the command string to be processed.
+ * @return 0 if the frame was applied, 1 if it was rejected.
  */
-void executeCommand(char *command) {
+uint8_t executeCommand(char *command) {
+    Calendar clock = Date_Clock;
+    double values[5];
     // Extract tokens from the command string
     char *token = strtok(command, "|");
 
-    if (token != NULL) {
-        // Parse the first token for date and time
-        sscanf(token, "%4u%2u%2u%2u%2u%2u%1u", 
-            &Date_Clock.year, &Date_Clock.month, &Date_Clock.day,
-            &Date_Clock.hour, &Date_Clock.minute, &Date_Clock.second, 
-            &Date_Clock.hunderts);
+    // Parse the first token for date and time
+    if (token == NULL || sscanf_P(token, PSTR("%4u%2u%2u%2u%2u%2u%1u"),
+            &clock.year, &clock.month, &clock.day,
+            &clock.hour, &clock.minute, &clock.second,
+            &clock.hunderts) != 7) {
+        return 1;
     }
-
     // Parse additional tokens for solar angles, latitude, longitude, and timezone
-    if ((token = strtok(NULL, "|")) != NULL) {
-        SUN.azimuth = atof(token);
-    }
-    if ((token = strtok(NULL, "|")) != NULL) {
-        SUN.elevation = atof(token);
+    for (uint8_t i = 0; i < 5; i++) {
+        if ((token = strtok(NULL, "|")) == NULL)
+            return 1;
+        values[i] = atof(token);
     }
-    if ((token = strtok(NULL, "|")) != NULL) {
-        Date_Clock.latitude = atof(token);
-    }
-    if ((token = strtok(NULL, "|")) != NULL) {
-        Date_Clock.longitude = atof(token);
-    }
-    if ((token = strtok(NULL, "|")) != NULL) {
-        Date_Clock.timezone = atoi(token);
+    clock.latitude = values[2];
+    clock.longitude = values[3];
+    clock.timezone = (int)values[4];
+    if (isValidDateTime(clock.year, clock.month, clock.day, clock.hour, clock.minute, clock.second)
+        || isValidTimeZone(clock.timezone) || isValidLatitude(clock.latitude) || isValidLongitude(clock.longitude)
+        || values[0] < 0.0 || values[0] > 360.0 || values[1] < -90.0 || values[1] > 90.0) {
+        return 1;
     }
+    SUN.azimuth = values[0];
+    SUN.elevation = values[1];
+    Date_Clock.year = clock.year;
+    Date_Clock.month = clock.month;
+    Date_Clock.day = clock.day;
+    Date_Clock.hour = clock.hour;
+    Date_Clock.minute = clock.minute;
+    Date_Clock.second = clock.second;
+    Date_Clock.hunderts = clock.hunderts;
+    Date_Clock.latitude = clock.latitude;
+    Date_Clock.longitude = clock.longitude;
+    Date_Clock.timezone = clock.timezone;
+    return 0;
 }
 
 /**
  * @brief Reads and processes clock and data commands.
  * 
  * The function listens for data input, processes commands between `<` and `>` delimiters,
- * and handles error conditions related to data validity.
+ * and handles error conditions related to data validity. Only a valid frame clears the error;
+ * ClockFrameBytes bytes without one (line noise, or the GNSS receiver at its own rate) count
+ * like a timeout.
+ *
+ * @return 1 if a valid frame was read, 0 otherwise.
  */
-void ClockAndDataReader() {
+uint8_t ClockAndDataReader() {
     uint8_t index = 0;
-    char command[60] = {0};
+    uint8_t block = Pool_Take(POOL_CLOCK_RX);
     uint8_t start = 0;
+    uint8_t valid = 0;
+    uint16_t received = 0;
+
+    if (block == POOL_NONE)
+        return 0;
+    char *command = Pool.data[block]; // The frame is received and parsed in place
 
     while (1) {
         char c = USART1_readChar();
 
+        if (!Date_Clock.warning && ++received > ClockFrameBytes)
+            Date_Clock.warning = 3; // Bytes, but no frame
         if (!Date_Clock.warning) {
             if (start == 1) {
                 if (c == '>') {
                     start = 0;
-                    executeCommand(command);
+                    command[index] = '\0';
+                    valid = !executeCommand(command);
                     index = 0;
+                    if (valid && Date_Clock.error == 1) {
+                        screen_clear();
+                        Date_Clock.errorCounter = 0;
+                        Date_Clock.error = 0;
+                    }
                     break;
-                } else {
+                } else if (index < POOL_BLOCK_SIZE - 1) { // A lost '>' must not run past the block
                     command[index++] = c;
                 }
             }
             if (c == '<') {
                 start = 1;
-            }
-            if (Date_Clock.error == 1) {
-                screen_clear();
-                Date_Clock.errorCounter = 0;
-                Date_Clock.error = 0;
+                index = 0; // A frame whose '>' was lost is dropped
             }
         } else {
             Date_Clock.warning = 0;
@@ -97,6 +125,8 @@ void ClockAndDataReader() {
             break;
         }
     }
+    Pool_Free(block);
+    return valid;
 }
 
 /**
@@ -177,11 +207,19 @@ uint8_t isValidLongitude(double longitude) {
 
 /**
  * @brief Reads clock data, processes solar angles, and retransmits formatted output.
+ *
+ * While the GNSS receiver is the time source, USART1 belongs to its receive interrupt and
+ * Gnss_Task() provides the time and the solar angles. The derived values are marked dirty
+ * right after the new angles arrive, so this and every later consumer of the pass reads
+ * values computed from them.
  */
 void Retransmitt() {
-    ClockAndDataReader();
-    correct_solar_angles();
-    printf("%4d-%02d-%02d %02d:%02d:%02d: Az.: % 3.2f El.: % 3.2f T: %2.2fC P: %4.2fhPa RH: %2.2f%%\r\n",
+    if (Gnss.source == GNSS_SOURCE_CLOCK)
+        ClockAndDataReader();
+    Gnss_Task();
+    Derived_Update(); // The sensors were read by Redundant_Task() earlier in the pass
+    Derived_Refresh(DERIVED_BIT(DERIVED_ADJ_ANGLES));
+    printf_P(PSTR("%4d-%02d-%02d %02d:%02d:%02d: Az.: % 3.2f El.: % 3.2f T: %2.2fC P: %4.2fhPa RH: %2.2f%%\r\n"),
         Date_Clock.year,
         Date_Clock.month,
         Date_Clock.day,
@@ -17,6 +17,11 @@
  */
 #define CountForError 10
 
+/** 
+ * @brief Bytes read without a complete frame before a read counts as failed (about three frames).
+ */
+#define ClockFrameBytes (3 * POOL_BLOCK_SIZE)
+
 /** 
  * @brief Calendar structure to store date, time, and geographical information.
  *
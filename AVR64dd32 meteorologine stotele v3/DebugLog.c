@@ -0,0 +1,110 @@
+/**
+ * @file DebugLog.c
+ * @brief Deferred binary debug log: recording into the RAM ring and draining over USART0.
+ *
+ * Wire format of a record (all multi-byte fields little endian):
+ *
+ *     0xA6 | size | id (2) | time ms (2) | arguments (size bytes) | XOR of size ... arguments
+ *
+ * @author Saulius
+ * @date 2025-01-11
+ */
+
+#include "Settings.h"
+
+#if DEBUG_LOG_ENABLE
+
+#include "DebugLogVar.h"
+
+/**
+ * @brief Stores one record in the ring buffer.
+ *
+ * Runs with interrupts disabled for the few byte copies, so it may be called from interrupts.
+ * When the record does not fit it is dropped and counted.
+ *
+ * @param message Message id (offset of the format string in `.logstr`).
+ * @param args Raw argument bytes.
+ * @param size Number of argument bytes.
+ */
+void DebugLog_Write(uint16_t message, const void *args, uint8_t size) {
+    const uint8_t *p = args;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t head = DebugLog.head;
+        uint8_t used = (head - DebugLog.tail) & DEBUG_LOG_BUFFER_MASK;
+        uint16_t time = (uint16_t)Timer.ms; // Interrupts are off, the tick cannot change under us
+
+        if (size > DEBUG_LOG_MAX_ARGS || used + DEBUG_LOG_HEADER + size >= DEBUG_LOG_BUFFER_SIZE) {
+            DebugLog.dropped++;
+        } else {
+            DebugLog.data[head] = size;
+            DebugLog.data[(head + 1) & DEBUG_LOG_BUFFER_MASK] = message;
+            DebugLog.data[(head + 2) & DEBUG_LOG_BUFFER_MASK] = message >> 8;
+            DebugLog.data[(head + 3) & DEBUG_LOG_BUFFER_MASK] = time;
+            DebugLog.data[(head + 4) & DEBUG_LOG_BUFFER_MASK] = time >> 8;
+            head += DEBUG_LOG_HEADER;
+            while (size--)
+                DebugLog.data[head++ & DEBUG_LOG_BUFFER_MASK] = *p++;
+            DebugLog.head = head & DEBUG_LOG_BUFFER_MASK; // Publish the record
+        }
+    }
+}
+
+/**
+ * @brief Sends the DEBUG_LOG_DROPPED_ID record with the drop count straight to USART0.
+ *
+ * It does not go through the ring: records are dropped when the ring is full, so the count
+ * would mostly be dropped too. The caller checks the transmit queue space.
+ */
+static void DebugLog_SendDropped() {
+    uint16_t dropped, time;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        dropped = DebugLog.dropped;
+        DebugLog.dropped = 0;
+        time = (uint16_t)Timer.ms;
+    }
+    uint8_t record[DEBUG_LOG_HEADER + sizeof(dropped)] = {
+        sizeof(dropped), (uint8_t)DEBUG_LOG_DROPPED_ID, DEBUG_LOG_DROPPED_ID >> 8,
+        time, time >> 8, dropped, dropped >> 8
+    };
+    uint8_t checksum = 0;
+
+    USART0_sendChar(DEBUG_LOG_SYNC);
+    for (uint8_t i = 0; i < sizeof(record); i++) {
+        checksum ^= record[i];
+        USART0_sendChar(record[i]);
+    }
+    USART0_sendChar(checksum);
+}
+
+/**
+ * @brief Sends the buffered records over USART0, call from the main loop.
+ *
+ * Only whole records are queued, and only while the USART0 transmit queue has room for them,
+ * so the drain never waits and never splits a telemetry line. A pending drop count follows
+ * the records that were buffered before it, as a DEBUG_LOG_DROPPED_ID record.
+ */
+void DebugLog_Drain() {
+    while (DebugLog.tail != DebugLog.head) {
+        uint8_t tail = DebugLog.tail;
+        uint8_t length = DEBUG_LOG_HEADER + DebugLog.data[tail];
+        uint8_t checksum = 0;
+
+        if (USART0_TxSpace() < length + 2)
+            return; // Try again on the next pass
+        USART0_sendChar(DEBUG_LOG_SYNC);
+        while (length--) {
+            uint8_t c = DebugLog.data[tail];
+            checksum ^= c;
+            USART0_sendChar(c);
+            tail = (tail + 1) & DEBUG_LOG_BUFFER_MASK;
+        }
+        USART0_sendChar(checksum);
+        DebugLog.tail = tail;
+    }
+
+    if (DebugLog.dropped && USART0_TxSpace() >= DEBUG_LOG_HEADER + sizeof(uint16_t) + 2)
+        DebugLog_SendDropped();
+}
+
+#endif /* DEBUG_LOG_ENABLE */
@@ -0,0 +1,134 @@
+/**
+ * @file DebugLog.h
+ * @brief Header file for the deferred binary debug log.
+ *
+ * A log call stores only a message id and the raw bytes of its arguments in a RAM ring buffer;
+ * no formatting is done on the station. The format strings are placed in the `.logstr` section,
+ * which is kept in the ELF file but not loaded into flash, and the id of a message is the
+ * offset of its format string in that section. `DebugLog_Drain()` sends complete records over
+ * USART0 when the transmit queue has room, and tools/debuglog.py formats them on the host
+ * with the strings read from the ELF file.
+ *
+ * Arguments are stored with their own size, so the format must match the argument types the
+ * way the AVR ABI sizes them: `%hhu`/`%hhd`/`%c` 1 byte, `%u`/`%d`/`%x` 2 bytes,
+ * `%lu`/`%ld`/`%lx` 4 bytes, `%f` 4 bytes (float). `%s` is not supported. The argument blocks
+ * are packed, so a host build lays them out like the AVR one.
+ *
+ * @author Saulius
+ * @date 2025-01-11
+ */
+
+#ifndef DEBUGLOG_H_
+#define DEBUGLOG_H_
+
+/**
+ * @brief Set to 1 (here or with -DDEBUG_LOG_ENABLE=1) to compile the log calls in; with 0 they
+ * generate no code.
+ */
+#ifndef DEBUG_LOG_ENABLE
+#define DEBUG_LOG_ENABLE 0
+#endif
+
+/**
+ * @brief Size of the RAM ring buffer (must be a power of two, at most 256).
+ */
+#define DEBUG_LOG_BUFFER_SIZE 128
+
+/**
+ * @brief Index mask of the ring buffer.
+ */
+#define DEBUG_LOG_BUFFER_MASK (DEBUG_LOG_BUFFER_SIZE - 1)
+
+/**
+ * @brief Largest argument block of one record (four 4-byte arguments).
+ */
+#define DEBUG_LOG_MAX_ARGS 16
+
+/**
+ * @brief Record header in the ring: argument size, message id (2), time (2).
+ */
+#define DEBUG_LOG_HEADER 5
+
+/**
+ * @brief First byte of every record on the wire (never part of the ASCII telemetry).
+ *
+ * Differs from LINK_SYNC0 and MICROBARO_SYNC, the other binary frames sent on USART0.
+ */
+#define DEBUG_LOG_SYNC 0xA6
+
+/**
+ * @brief Message id of the "records dropped" record (2-byte count).
+ */
+#define DEBUG_LOG_DROPPED_ID 0xFFFF
+
+/**
+ * @brief Debug log ring buffer.
+ *
+ * `head` is written by the log calls (main loop and interrupts, with interrupts disabled),
+ * `tail` by `DebugLog_Drain()` only.
+ */
+typedef struct {
+    uint8_t data[DEBUG_LOG_BUFFER_SIZE]; /**< Records: size, id, time, argument bytes */
+    volatile uint8_t head;               /**< Next free byte */
+    volatile uint8_t tail;               /**< First byte of the oldest record */
+    uint16_t dropped;                    /**< Records lost because the buffer was full */
+} DebugLogBuffer;
+
+/**
+ * @brief Global debug log buffer.
+ */
+extern DebugLogBuffer DebugLog;
+
+#if DEBUG_LOG_ENABLE
+
+/**
+ * @brief Section of the format strings, with the flags overridden to non-allocated.
+ *
+ * The trailing comment character hides the flags GCC appends: ';' for the AVR assembler,
+ * '#' for the x86 one of the host build (tools/loop_benchmark.py), where ';' separates
+ * statements.
+ */
+#ifdef __AVR__
+#define DEBUG_LOG_SECTION ".logstr,\"\",@progbits;"
+#else
+#define DEBUG_LOG_SECTION ".logstr,\"\",@progbits#"
+#endif
+
+/**
+ * @brief Places a format string in the `.logstr` section and yields its id (section offset).
+ *
+ * The section is not allocated, so the strings cost no flash.
+ */
+#define DEBUG_LOG_ID(fmt) ({ \
+    static const char _logFormat[] __attribute__((section(DEBUG_LOG_SECTION), used)) = fmt; \
+    (uint16_t)(uintptr_t)_logFormat; })
+
+#define DEBUG_LOG0(fmt) DebugLog_Write(DEBUG_LOG_ID(fmt), 0, 0)
+
+#define DEBUG_LOG1(fmt, a) do { \
+    __typeof__(a) _logArgs = (a); \
+    DebugLog_Write(DEBUG_LOG_ID(fmt), &_logArgs, sizeof(_logArgs)); } while (0)
+
+#define DEBUG_LOG2(fmt, a, b) do { \
+    struct __attribute__((packed)) { __typeof__(a) _0; __typeof__(b) _1; } _logArgs = { (a), (b) }; \
+    DebugLog_Write(DEBUG_LOG_ID(fmt), &_logArgs, sizeof(_logArgs)); } while (0)
+
+#define DEBUG_LOG3(fmt, a, b, c) do { \
+    struct __attribute__((packed)) { __typeof__(a) _0; __typeof__(b) _1; __typeof__(c) _2; } _logArgs = { (a), (b), (c) }; \
+    DebugLog_Write(DEBUG_LOG_ID(fmt), &_logArgs, sizeof(_logArgs)); } while (0)
+
+#define DEBUG_LOG4(fmt, a, b, c, d) do { \
+    struct __attribute__((packed)) { __typeof__(a) _0; __typeof__(b) _1; __typeof__(c) _2; __typeof__(d) _3; } _logArgs = { (a), (b), (c), (d) }; \
+    DebugLog_Write(DEBUG_LOG_ID(fmt), &_logArgs, sizeof(_logArgs)); } while (0)
+
+#else
+
+#define DEBUG_LOG0(fmt) do { } while (0)
+#define DEBUG_LOG1(fmt, a) do { } while (0)
+#define DEBUG_LOG2(fmt, a, b) do { } while (0)
+#define DEBUG_LOG3(fmt, a, b, c) do { } while (0)
+#define DEBUG_LOG4(fmt, a, b, c, d) do { } while (0)
+
+#endif
+
+#endif /* DEBUGLOG_H_ */
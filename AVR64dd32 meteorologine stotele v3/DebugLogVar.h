@@ -0,0 +1,21 @@
+/**
+ * @file DebugLogVar.h
+ * @brief Variable definition of the debug log buffer (only allocated when DEBUG_LOG_ENABLE is 1).
+ *
+ * @author Saulius
+ * @date 2025-01-11
+ */
+
+#ifndef DEBUGLOGVAR_H_
+#define DEBUGLOGVAR_H_
+
+/**
+ * @brief Global debug log buffer, empty at start-up.
+ */
+DebugLogBuffer DebugLog = {
+    .head = 0,
+    .tail = 0,
+    .dropped = 0
+};
+
+#endif /* DEBUGLOGVAR_H_ */
@@ -0,0 +1,123 @@
+/**
+ * @file Derived.c
+ * @brief Dirty tracking and lazy recomputation of derived values.
+ *
+ * @author Saulius
+ * @date 2025-01-12
+ */
+
+#include "Settings.h"
+#include "DerivedVar.h"
+
+#define IN(node) DERIVED_BIT(DERIVED_IN_##node)
+
+/**
+ * @brief Direct dependencies of every node (inputs have none).
+ */
+static const uint16_t derivedDeps[DERIVED_NODES] = {
+    [DERIVED_VAPOR]      = IN(TEMPERATURE) | IN(HUMIDITY),
+    [DERIVED_DEW_POINT]  = IN(TEMPERATURE) | IN(HUMIDITY),
+    [DERIVED_ALT_UNCOMP] = IN(PRESSURE),
+    [DERIVED_ALT_COMP]   = IN(PRESSURE) | IN(TEMPERATURE) | DERIVED_BIT(DERIVED_VAPOR),
+    [DERIVED_ALT_AVRG]   = DERIVED_BIT(DERIVED_ALT_UNCOMP) | DERIVED_BIT(DERIVED_ALT_COMP),
+    [DERIVED_REFRACTION] = IN(ELEVATION) | IN(PRESSURE) | IN(TEMPERATURE) | IN(SITE_ALTITUDE),
+    [DERIVED_ADJ_ANGLES] = IN(ELEVATION) | IN(AZIMUTH) | DERIVED_BIT(DERIVED_REFRACTION),
+    [DERIVED_TRACKER]    = DERIVED_BIT(DERIVED_ADJ_ANGLES),
+};
+
+/**
+ * @brief Returns an input in units of its resolution.
+ *
+ * @param node Input node.
+ */
+static int32_t Derived_Input(uint8_t node) {
+    switch (node) {
+        case DERIVED_IN_PRESSURE:    return UNIT_RAW(UNIT_CONVERT(PASCAL_Q8, HPA_100, UNIT(PASCAL_Q8, BMP280.CalibrationValues.p)));
+        case DERIVED_IN_TEMPERATURE: return UNIT_RAW(UNIT_FROM_FLOAT(CELSIUS_100, SHT21.T));
+        case DERIVED_IN_HUMIDITY:    return UNIT_RAW(UNIT_FROM_FLOAT(RH_10, SHT21.RH));
+        case DERIVED_IN_ELEVATION:   return UNIT_RAW(UNIT_FROM_FLOAT(DEGREE_1000, SUN.elevation));
+        case DERIVED_IN_AZIMUTH:     return UNIT_RAW(UNIT_FROM_FLOAT(DEGREE_1000, SUN.azimuth));
+        default:                     return UNIT_RAW(UNIT(METRE, Date_Clock.altitude));
+    }
+}
+
+/**
+ * @brief Recomputes one derived value.
+ *
+ * @param node Derived node, its dependencies are already up to date.
+ */
+static void Derived_Compute(uint8_t node) {
+    switch (node) {
+        case DERIVED_VAPOR:
+            SHT21.e = vapor_pressure();
+            break;
+        case DERIVED_DEW_POINT:
+            SHT21.Td = dew_point();
+            break;
+        case DERIVED_ALT_UNCOMP:
+            Altitude.UNCOMP = calculate_uncompensated_elevation();
+            break;
+        case DERIVED_ALT_COMP:
+            Altitude.COMP = calculate_adjusted_elevation();
+            break;
+        case DERIVED_ALT_AVRG:
+            Altitude.AVRG = (Altitude.UNCOMP + Altitude.COMP) / 2;
+            break;
+        case DERIVED_REFRACTION:
+            SUN.refraction = calculate_refraction();
+            break;
+        case DERIVED_ADJ_ANGLES:
+            correct_solar_angles();
+            break;
+        default:
+            Tracker_Compute();
+            break;
+    }
+    Derived.computed[node]++;
+}
+
+/**
+ * @brief Marks the values depending on changed inputs as dirty, call once per main loop pass.
+ *
+ * An input counts as changed when it moved by at least its resolution. Nodes are in
+ * topological order, so one forward pass propagates the change through the whole graph.
+ */
+void Derived_Update() {
+    uint16_t changed = 0;
+
+    for (uint8_t i = 0; i < DERIVED_INPUTS; i++) {
+        int32_t value = Derived_Input(i);
+        if (value != Derived.input[i]) {
+            Derived.input[i] = value;
+            changed |= DERIVED_BIT(i);
+        }
+    }
+    for (uint8_t i = DERIVED_INPUTS; i < DERIVED_NODES; i++) {
+        if (derivedDeps[i] & changed)
+            changed |= DERIVED_BIT(i);
+    }
+    Derived.dirty |= changed & (DERIVED_BIT(DERIVED_NODES) - DERIVED_BIT(DERIVED_INPUTS));
+    Derived.passes++;
+}
+
+/**
+ * @brief Brings the requested derived values up to date.
+ *
+ * The request is first widened to everything the requested values depend on (backward pass),
+ * then the dirty ones are recomputed in dependency order (forward pass).
+ *
+ * @param nodes Mask of DERIVED_BIT() values the caller is about to read.
+ */
+void Derived_Refresh(uint16_t nodes) {
+    for (int8_t i = DERIVED_NODES - 1; i >= DERIVED_INPUTS; i--) {
+        if (nodes & DERIVED_BIT(i))
+            nodes |= derivedDeps[i];
+    }
+    nodes &= Derived.dirty;
+    for (uint8_t i = DERIVED_INPUTS; i < DERIVED_NODES; i++) {
+        if (nodes & DERIVED_BIT(i)) {
+            Derived_Compute(i);
+            Derived.dirty &= ~DERIVED_BIT(i);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/**
+ * @file Derived.h
+ * @brief Header file for the dependency graph of derived values.
+ *
+ * Derived values (vapour pressure, dew point, the altitude variants, refraction, the
+ * adjusted solar angles and the tracker rotation) declare the inputs and other derived values they depend on. Once per
+ * main loop pass `Derived_Update()` compares the measured inputs with their last values at
+ * the input resolution and marks every value that depends on a changed input as dirty.
+ * Nothing is computed until a consumer calls `Derived_Refresh()` for the values it is about to
+ * read; only the dirty ones (and their dirty dependencies) are recomputed then.
+ *
+ * @author Saulius
+ * @date 2025-01-12
+ */
+
+#ifndef DERIVED_H_
+#define DERIVED_H_
+
+/**
+ * @brief Graph nodes in topological order: measured inputs first, then derived values.
+ */
+typedef enum {
+    DERIVED_IN_PRESSURE,      /**< BMP280.Pressure, resolution 0.01 hPa */
+    DERIVED_IN_TEMPERATURE,   /**< SHT21.T, resolution 0.01 C */
+    DERIVED_IN_HUMIDITY,      /**< SHT21.RH, resolution 0.1 % */
+    DERIVED_IN_ELEVATION,     /**< SUN.elevation, resolution 0.001 deg */
+    DERIVED_IN_AZIMUTH,       /**< SUN.azimuth, resolution 0.001 deg */
+    DERIVED_IN_SITE_ALTITUDE, /**< Date_Clock.altitude, resolution 1 m */
+    DERIVED_INPUTS,           /**< Number of inputs */
+    DERIVED_VAPOR = DERIVED_INPUTS, /**< SHT21.e: vapour pressure (T, RH) */
+    DERIVED_DEW_POINT,        /**< SHT21.Td: dew point (T, RH) */
+    DERIVED_ALT_UNCOMP,       /**< Altitude.UNCOMP (p) */
+    DERIVED_ALT_COMP,         /**< Altitude.COMP (p, T, vapour pressure) */
+    DERIVED_ALT_AVRG,         /**< Altitude.AVRG (both altitudes) */
+    DERIVED_REFRACTION,       /**< SUN.refraction (elevation, p, T, site altitude) */
+    DERIVED_ADJ_ANGLES,       /**< SUN.adjelevation and SUN.adjazimuth (elevation, azimuth, refraction) */
+    DERIVED_TRACKER,          /**< Tracker.ideal and Tracker.angle (adjusted angles) */
+    DERIVED_NODES             /**< Number of nodes */
+} derived_node_t;
+
+/**
+ * @brief Bit of a node in the dirty and request masks.
+ */
+#define DERIVED_BIT(node) (1U << (node))
+
+/**
+ * @brief Request mask of the three altitude values.
+ */
+#define DERIVED_ALTITUDES (DERIVED_BIT(DERIVED_ALT_UNCOMP) | DERIVED_BIT(DERIVED_ALT_COMP) | DERIVED_BIT(DERIVED_ALT_AVRG))
+
+/**
+ * @brief Dependency graph state and recomputation counters.
+ */
+typedef struct {
+    uint16_t dirty;                      /**< Derived values whose inputs changed since they were computed */
+    int32_t input[DERIVED_INPUTS];       /**< Last inputs, in units of their resolution */
+    uint32_t passes;                     /**< Derived_Update() calls: recomputations per value of the old every-pass scheme */
+    uint32_t computed[DERIVED_NODES];    /**< Recomputations per derived value */
+} DerivedGraph;
+
+/**
+ * @brief Global dependency graph instance.
+ */
+extern DerivedGraph Derived;
+
+#endif /* DERIVED_H_ */
@@ -0,0 +1,20 @@
+/**
+ * @file DerivedVar.h
+ * @brief Variable definition of the derived value dependency graph.
+ *
+ * @author Saulius
+ * @date 2025-01-12
+ */
+
+#ifndef DERIVEDVAR_H_
+#define DERIVEDVAR_H_
+
+/**
+ * @brief Global dependency graph instance, every derived value starts dirty.
+ */
+DerivedGraph Derived = {
+    .dirty = DERIVED_BIT(DERIVED_NODES) - DERIVED_BIT(DERIVED_INPUTS),
+    .passes = 0
+};
+
+#endif /* DERIVEDVAR_H_ */
@@ -5,7 +5,8 @@
  * Author: Saulius
  *
  * This file contains functions for calculating the refraction angle for solar elevation,
- * correcting solar angles, and reading the sun level from an ADC.
+ * correcting solar angles, computing the solar position when no clock device sends it, and
+ * reading the sun level from an ADC.
  */
 
 #include "Settings.h"
@@ -27,13 +28,14 @@ double calculate_refraction() {
         return 0.0;  // No refraction needed if the sun is below the horizon
 
     double elevation_rad = SUN.elevation * M_PI / 180.0;  // Convert elevation to radians
+    double pressure = BMP280.Pressure;  // Local copy: the measured pressure is only refreshed when the sampling engine reads the BMP280
     // Adjust pressure for altitude (Date_Clock.altitude is in meters)
     if (Date_Clock.altitude > 0) 
-        BMP280.Pressure *= pow(1 - (0.0065 * Date_Clock.altitude / 288.15), 5.255); // Temperature lapse rate with altitude
+        pressure *= pow(1 - (0.0065 * Date_Clock.altitude / 288.15), 5.255); // Temperature lapse rate with altitude
 
     // Calculate refraction based on solar elevation and environmental factors
     double refraction = 0.0167 / tan(elevation_rad + (10.3 / (SUN.elevation + 5.11)));
-    refraction *= (BMP280.Pressure / 1010.0) * (283.0 / (273.0 + SHT21.T));  // Adjust for pressure and temperature
+    refraction *= (pressure / 1010.0) * (283.0 / (273.0 + SHT21.T));  // Adjust for pressure and temperature
     return refraction;  // Return refraction in minutes
 }
 
@@ -48,12 +50,78 @@ double calculate_refraction() {
 void correct_solar_angles() {
     if(SUN.elevation > 0){
         // Adjust the elevation by the refraction and keep the azimuth unchanged
-        SUN.adjelevation = SUN.elevation + calculate_refraction() / 60.0;  
+        SUN.adjelevation = SUN.elevation + SUN.refraction / 60.0;  // Refraction is kept up to date by the derived value graph
         SUN.adjazimuth = SUN.azimuth;
     }
     // If the elevation is below the horizon, retain the last azimuth and elevation values
 }
 
+/**
+ * @brief Angle that turns at a constant rate, at a given time.
+ *
+ * @param start Angle at 2000-01-01 0h UTC (0.01 deg).
+ * @param whole, fraction Rate: whole + fraction / 100000 (0.01 deg per day).
+ * @param days, seconds Time since 2000-01-01 0h UTC.
+ * @return Angle, 0 ... 35999 (0.01 deg).
+ */
+static uint16_t solar_turn(uint16_t start, uint16_t whole, uint32_t fraction, uint16_t days, uint32_t seconds) {
+    uint32_t angle = start + (uint32_t)(whole % 36000) * days + (fraction * days + 50000) / 100000
+                   + ((uint32_t)whole * seconds + fraction / 10 * seconds / 10000 + 43200) / 86400;
+    return angle % 36000;
+}
+
+/**
+ * @brief Product of two Q15 values.
+ */
+static int16_t solar_mul(int16_t a, int16_t b) {
+    return ((int32_t)a * b) >> 15;
+}
+
+/**
+ * @brief Calculates the solar azimuth and elevation from the time and the station position.
+ *
+ * The clock device sends the sun angles with the time; the GNSS receiver only sends the time and
+ * position, so the angles are computed here with the low precision formulas of the Astronomical
+ * Almanac (mean longitude and anomaly, equation of centre, obliquity, sidereal time; about 0.01
+ * degree from 2000 to 2099) in FixedMath units. The sun direction stays a Q15 unit vector from
+ * ecliptic to equatorial to horizontal coordinates, so only two arc tangents and no float
+ * functions are needed. The elevation is geometric, the refraction is added by correct_solar_angles().
+ *
+ * @param days UTC date, days since 2000-01-01.
+ * @param seconds UTC seconds of the day.
+ * @param latitude Station latitude, north positive.
+ * @param longitude Station longitude, east positive.
+ */
+void calculate_solar_position(uint16_t days, uint32_t seconds, UNIT_T(DEGREE_10000) latitude,
+                              UNIT_T(DEGREE_10000) longitude) {
+    uint16_t meanLongitude = solar_turn(27997, 98, 56474, days, seconds);  // 280.460 + 0.9856474 n
+    uint16_t anomaly = solar_turn(35704, 98, 56003, days, seconds);        // 357.528 + 0.9856003 n
+    uint16_t sidereal = solar_turn(9997, 36098, 56474, days, seconds);     // 280.46062 + 360.98564736 n
+    int32_t lambda = meanLongitude + ((FixedMath_Sin(anomaly) * 383L + 32768) >> 16)    // + 1.915 sin g
+                   + ((FixedMath_Sin(2L * anomaly) + 8192) >> 14);                      // + 0.020 sin 2g
+    int32_t obliquity = (23439 - days / 2500 + 5) / 10;                                // 23.439 - 0.0000004 n
+
+    // Equatorial direction: x to the equinox, z to the celestial pole
+    int16_t sinLambda = FixedMath_Sin(lambda);
+    int16_t x = FixedMath_Cos(lambda);
+    int16_t y = solar_mul(FixedMath_Cos(obliquity), sinLambda);
+    int16_t sinDec = solar_mul(FixedMath_Sin(obliquity), sinLambda);
+    int16_t cosDec = FixedMath_Sqrt((uint32_t)((int32_t)x * x + (int32_t)y * y));
+    int32_t hourAngle = sidereal + UNIT_RAW(UNIT_CONVERT(DEGREE_10000, DEGREE_100, longitude)) - FixedMath_Atan2(y, x);
+
+    // Horizontal direction: east, north, up
+    int32_t phi = UNIT_RAW(UNIT_CONVERT(DEGREE_10000, DEGREE_100, latitude));
+    int16_t sinPhi = FixedMath_Sin(phi), cosPhi = FixedMath_Cos(phi);
+    int16_t cosDecCosH = solar_mul(cosDec, FixedMath_Cos(hourAngle));
+    int32_t east = -solar_mul(cosDec, FixedMath_Sin(hourAngle));
+    int32_t north = solar_mul(sinDec, cosPhi) - solar_mul(cosDecCosH, sinPhi);
+    int32_t up = solar_mul(sinDec, sinPhi) + solar_mul(cosDecCosH, cosPhi);
+    int16_t azimuth = FixedMath_Atan2(east, north);
+
+    SUN.azimuth = (azimuth < 0 ? azimuth + 36000 : azimuth) / 100.0;
+    SUN.elevation = FixedMath_Atan2(up, FixedMath_Sqrt((uint32_t)(east * east + north * north))) / 100.0;
+}
+
 /**
  * @brief Reads and calculates the sun level from an ADC sensor.
  *
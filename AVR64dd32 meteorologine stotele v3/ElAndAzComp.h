@@ -22,6 +22,7 @@ typedef struct {
     float azimuth;         ///< The solar azimuth angle in degrees.
     float adjelevation;    ///< The adjusted solar elevation considering refraction (in degrees).
     float adjazimuth;      ///< The adjusted solar azimuth (in degrees).
+    float refraction;      ///< The refraction correction of the elevation (in minutes of arc).
     uint16_t sunlevel;     ///< The measured sun level, typically obtained from an ADC (scaled value).
 } SunAngles;
 
@@ -0,0 +1,194 @@
+/**
+ * @file EventLog.c
+ * @brief Event and fault log: EEPROM ring of 8-byte records, written one byte per main loop pass.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#include "Settings.h"
+#include "EventLogVar.h"
+
+_Static_assert(sizeof(EventRecord) == 8, "records are 8 bytes in EEPROM");
+_Static_assert(EVENT_LOG_RECORDS * sizeof(EventRecord) <= EEPROM_SIZE, "the ring must fit the EEPROM");
+_Static_assert(EVENT_LOG_RECORDS < 256, "the sequence numbers must tell the newest record");
+_Static_assert(EVENT_CODES <= EVENT_LOG_UPTIME, "the codes are 7 bits");
+
+/**
+ * @brief Events whose repeats within EVENT_LOG_REPEAT_MS are counted instead of logged.
+ */
+#define EVENT_LOG_REPEATING ((1 << EVENT_I2C) | (1 << EVENT_CLOCK_LOST) | (1 << EVENT_SOURCE))
+
+/**
+ * @brief EEPROM address of a byte of a ring slot.
+ */
+static inline uint8_t *EventLog_Address(uint8_t slot, uint8_t offset) {
+    return (uint8_t *)(uintptr_t)(EVENT_LOG_ADDRESS + slot * sizeof(EventRecord) + offset);
+}
+
+/**
+ * @brief Reads a ring slot.
+ *
+ * @return 1 if it holds a record, 0 if it is erased or was cut by a reset.
+ */
+static uint8_t EventLog_Slot(uint8_t slot, EventRecord *record) {
+    eeprom_read_block(record, EventLog_Address(slot, 0), sizeof(EventRecord));
+    uint8_t code = record->code & ~EVENT_LOG_UPTIME;
+    return code != EVENT_NONE && code < EVENT_CODES;
+}
+
+/**
+ * @brief Whether Date_Clock holds a time that fits a record.
+ */
+static uint8_t EventLog_TimeValid() {
+    return !Date_Clock.error && Date_Clock.year >= 2000 && Date_Clock.year < 2064;
+}
+
+/**
+ * @brief Date_Clock as a record time.
+ */
+static uint32_t EventLog_Now() {
+    return EVENT_LOG_TIME(Date_Clock.year, Date_Clock.month, Date_Clock.day,
+                          Date_Clock.hour, Date_Clock.minute, Date_Clock.second);
+}
+
+void EventLog_init() {
+    uint8_t valid[EVENT_LOG_RECORDS], sequence[EVENT_LOG_RECORDS];
+    EventRecord record;
+
+    for (uint8_t slot = 0; slot < EVENT_LOG_RECORDS; slot++) {
+        valid[slot] = EventLog_Slot(slot, &record);
+        sequence[slot] = record.sequence;
+    }
+    // The newest record is the one not followed by the next sequence number
+    for (uint8_t slot = 0; slot < EVENT_LOG_RECORDS; slot++) {
+        uint8_t next = (slot + 1) % EVENT_LOG_RECORDS;
+        if (!valid[slot] || (valid[next] && sequence[next] == (uint8_t)(sequence[slot] + 1)))
+            continue;
+        EventLog.slot = next;
+        EventLog.sequence = sequence[slot] + 1;
+        EventLog.count = 1;
+        while (EventLog.count < EVENT_LOG_RECORDS) { // Back to the oldest record of the chain
+            uint8_t previous = slot ? slot - 1 : EVENT_LOG_RECORDS - 1;
+            if (!valid[previous] || (uint8_t)(sequence[previous] + 1) != sequence[slot])
+                break;
+            slot = previous;
+            EventLog.count++;
+        }
+        break;
+    }
+
+    uint8_t flags = RSTCTRL.RSTFR;
+    RSTCTRL.RSTFR = flags; // Cleared, so the next start shows only its own cause
+    EventLog_Add(EVENT_RESET, flags);
+}
+
+uint8_t EventLog_Add(uint8_t code, uint16_t argument) {
+    uint32_t now = Timer_ms();
+
+    if ((EVENT_LOG_REPEATING & (1 << code)) && EventLog.lastMs[code] &&
+        EventLog.lastArgument[code] == argument && now - EventLog.lastMs[code] < EVENT_LOG_REPEAT_MS) {
+        EventLog.repeats++;
+        return 0;
+    }
+    if (((EventLog.head + 1) & EVENT_LOG_QUEUE_MASK) == EventLog.tail) {
+        EventLog.dropped++;
+        return 0;
+    }
+    EventLog.lastMs[code] = now ? now : 1; // 0 means never
+    EventLog.lastArgument[code] = argument;
+
+    EventRecord *record = &EventLog.queue[EventLog.head];
+    record->argument = argument;
+    if (EventLog_TimeValid()) {
+        record->code = code;
+        record->time = EventLog_Now();
+    } else {
+        record->code = code | EVENT_LOG_UPTIME;
+        record->time = now / 1000;
+    }
+    EventLog.head = (EventLog.head + 1) & EVENT_LOG_QUEUE_MASK;
+    return 1;
+}
+
+/**
+ * @brief Logs the changes of the clock link and of the time source.
+ */
+static void EventLog_Watch() {
+    static uint8_t lostLogged;
+
+    if (Date_Clock.error != EventLog.clockError) {
+        EventLog.clockError = Date_Clock.error;
+        if (Date_Clock.error) {
+            EventLog.lostMs = Timer_ms();
+            lostLogged = EventLog_Add(EVENT_CLOCK_LOST, EventLog.source); // The source seen before a failover
+        } else if (lostLogged) { // A return is logged with its loss only
+            uint32_t seconds = (Timer_ms() - EventLog.lostMs) / 1000;
+            EventLog_Add(EVENT_CLOCK_BACK, seconds > 0xFFFF ? 0xFFFF : seconds);
+        }
+    }
+    if (Gnss.source != EventLog.source) {
+        EventLog.source = Gnss.source;
+        EventLog_Add(EVENT_SOURCE, Gnss.source);
+    }
+}
+
+void EventLog_Task() {
+    EventLog_Watch();
+    if (EventLog.head == EventLog.tail || !eeprom_is_ready())
+        return;
+
+    EventRecord *record = &EventLog.queue[EventLog.tail];
+    if (!EventLog.byte) {
+        if (EventLog_TimeValid()) {
+            if ((record->code & EVENT_LOG_UPTIME) && record->time < EVENT_LOG_START_MS / 1000) {
+                record->code &= ~EVENT_LOG_UPTIME; // Queued at start-up: the first valid time
+                record->time = EventLog_Now();
+            }
+        } else if (Timer_ms() < EVENT_LOG_START_MS) {
+            return; // The clock device's first frame may still come
+        }
+        record->sequence = EventLog.sequence;
+        if (EventLog.count == EVENT_LOG_RECORDS)
+            EventLog.count--; // The oldest record is overwritten
+    }
+
+    // Code byte first as EVENT_NONE, then the rest, the real code last
+    uint8_t offset = EventLog.byte == sizeof(EventRecord) ? 0 : EventLog.byte;
+    uint8_t value = EventLog.byte ? ((const uint8_t *)record)[offset] : EVENT_NONE;
+    eeprom_update_byte(EventLog_Address(EventLog.slot, offset), value);
+    if (++EventLog.byte <= sizeof(EventRecord))
+        return;
+
+    EventLog.byte = 0;
+    EventLog.slot = (EventLog.slot + 1) % EVENT_LOG_RECORDS;
+    EventLog.sequence++;
+    EventLog.count++;
+    EventLog.written++;
+    EventLog.tail = (EventLog.tail + 1) & EVENT_LOG_QUEUE_MASK;
+}
+
+uint8_t EventLog_Read(uint8_t index, EventRecord *record) {
+    if (index >= EventLog.count)
+        return 0;
+    uint8_t slot = (EventLog.slot + EVENT_LOG_RECORDS - EventLog.count + index) % EVENT_LOG_RECORDS;
+    return EventLog_Slot(slot, record);
+}
+
+void EventLog_Text(char *text, const EventRecord *record, uint8_t full) {
+    char name[sizeof(eventLogNames[0])];
+    uint32_t t = record->time;
+    uint8_t month = (t >> 22) & 0x0F, day = (t >> 17) & 0x1F, hour = (t >> 12) & 0x1F, minute = (t >> 6) & 0x3F;
+
+    strcpy_P(name, eventLogNames[record->code & ~EVENT_LOG_UPTIME]);
+    if (full)
+        text += sprintf_P(text, PSTR("%3u "), record->sequence);
+    if (record->code & EVENT_LOG_UPTIME)
+        text += sprintf_P(text, full ? PSTR("up %15lus") : PSTR("up %7lus"), (unsigned long)t);
+    else if (full)
+        text += sprintf_P(text, PSTR("%04u-%02u-%02u %02u:%02u:%02u"), (unsigned)(t >> 26) + 2000, month, day,
+                          hour, minute, (unsigned)(t & 0x3F));
+    else
+        text += sprintf_P(text, PSTR("%02u-%02u %02u:%02u"), month, day, hour, minute);
+    sprintf_P(text, PSTR(" %-4s %04X"), name, record->argument);
+}
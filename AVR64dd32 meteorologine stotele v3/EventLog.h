@@ -0,0 +1,107 @@
+/**
+ * @file EventLog.h
+ * @brief Header file for the event and fault log kept in EEPROM for post-mortem analysis.
+ *
+ * Resets, I2C bus failures, clock link losses and returns, time source switches and settings
+ * changes are appended as fixed 8-byte records to a ring that fills the EEPROM. Every record
+ * carries an 8-bit sequence number, one more than the record before it, so the newest record is
+ * the one whose successor in the ring does not continue the sequence; no index is stored.
+ *
+ * EventLog_Add() only queues the record in RAM. An EEPROM byte takes milliseconds to erase and
+ * write, so EventLog_Task() writes one byte per main loop pass, when the EEPROM is not busy, and
+ * the main tasks never wait for it. A record is written code byte first, as EVENT_NONE, so a
+ * record cut by a reset is not taken for a valid one; its real code goes in last.
+ *
+ * The time is the local date and time from Date_Clock, packed as in EVENT_LOG_TIME(). Without a
+ * valid time it is the uptime in seconds and the code has EVENT_LOG_UPTIME set. Records are
+ * not written during the first EVENT_LOG_START_MS, while the clock device's first frame is
+ * awaited, and those queued then get the first valid time instead of their uptime.
+ *
+ * The log is read with the console command "log", the binary command LINK_CMD_EVENTS and in the
+ * event log window (long press 5).
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef EVENTLOG_H_
+#define EVENTLOG_H_
+
+#define EVENT_LOG_ADDRESS 0              /**< First EEPROM byte of the ring */
+#define EVENT_LOG_RECORDS 32             /**< Records in the ring: 256 bytes, the whole EEPROM */
+#define EVENT_LOG_QUEUE 4                /**< Records waiting in RAM (power of two) */
+#define EVENT_LOG_QUEUE_MASK (EVENT_LOG_QUEUE - 1)
+#define EVENT_LOG_START_MS 10000         /**< Nothing is written before this uptime without a valid time */
+#define EVENT_LOG_REPEAT_MS 3600000UL    /**< The same event with the same argument is logged once per hour */
+#define EVENT_LOG_UPTIME 0x80            /**< Set in the code: the time is the uptime in seconds */
+
+/**
+ * @brief Packs a local date and time into a record time: year - 2000 (6 bits), month (4),
+ *        day (5), hour (5), minute (6), second (6).
+ */
+#define EVENT_LOG_TIME(year, month, day, hour, minute, second) \
+    (((uint32_t)((year) - 2000) << 26) | ((uint32_t)(month) << 22) | ((uint32_t)(day) << 17) | \
+     ((uint32_t)(hour) << 12) | ((uint16_t)(minute) << 6) | (second))
+
+/**
+ * @brief Event codes (7 bits). EVENT_NONE and erased EEPROM (0xFF) mark an empty record.
+ */
+typedef enum {
+    EVENT_NONE,       /**< Empty record */
+    EVENT_RESET,      /**< Station started; argument: RSTCTRL.RSTFR reset flags */
+    EVENT_I2C,        /**< I2C bus error or timeout; argument: address << 8 | error code */
+    EVENT_CLOCK_LOST, /**< Date_Clock.error set; argument: the gnss_source_t that stopped giving the time */
+    EVENT_CLOCK_BACK, /**< Date_Clock.error cleared; argument: seconds without time, at most 65535 */
+    EVENT_SOURCE,     /**< Time source switched; argument: the new gnss_source_t */
+    EVENT_SETTINGS,   /**< Settings saved in ValidateNewData(); argument: EVENT_SETTINGS_x of those changed */
+    EVENT_CODES       /**< Number of event codes */
+} event_code_t;
+
+/** @name EVENT_SETTINGS argument bits */
+///@{
+#define EVENT_SETTINGS_TIME      0x01 /**< Date and time sent to the clock device */
+#define EVENT_SETTINGS_TIMEZONE  0x02
+#define EVENT_SETTINGS_ALTITUDE  0x04
+#define EVENT_SETTINGS_LATITUDE  0x08
+#define EVENT_SETTINGS_LONGITUDE 0x10
+///@}
+
+/**
+ * @brief One log record, as stored in EEPROM (8 bytes, little-endian).
+ */
+typedef struct {
+    uint8_t code;      /**< event_code_t, EVENT_LOG_UPTIME if `time` is the uptime */
+    uint8_t sequence;  /**< One more than the previous record's */
+    uint16_t argument; /**< Event argument */
+    uint32_t time;     /**< EVENT_LOG_TIME() local time, or uptime in seconds */
+} EventRecord;
+
+/**
+ * @brief Log state: RAM queue, ring position and the conditions watched for changes.
+ *
+ * Only the main loop uses it.
+ */
+typedef struct {
+    EventRecord queue[EVENT_LOG_QUEUE];   /**< Records waiting for the EEPROM */
+    uint8_t head;                         /**< Next free queue entry */
+    uint8_t tail;                         /**< Queue entry being written */
+    uint8_t byte;                         /**< Next byte of the record being written, 0 ... 8 */
+    uint8_t slot;                         /**< Ring slot of the record being written */
+    uint8_t sequence;                     /**< Sequence number of the next record */
+    uint8_t count;                        /**< Valid records in the ring */
+    uint16_t written;                     /**< Records written since start-up */
+    uint16_t dropped;                     /**< Records lost because the queue was full */
+    uint16_t repeats;                     /**< Events not logged: repeated within EVENT_LOG_REPEAT_MS */
+    uint16_t lastArgument[EVENT_CODES];   /**< Argument of the last record of each code */
+    uint32_t lastMs[EVENT_CODES];         /**< Timer_ms() of the last record of each code, 0 if none */
+    uint8_t clockError;                   /**< Date_Clock.error seen last */
+    uint8_t source;                       /**< Gnss.source seen last */
+    uint32_t lostMs;                      /**< Timer_ms() when Date_Clock.error was set */
+} EventLogState;
+
+/**
+ * @brief Global event log.
+ */
+extern EventLogState EventLog;
+
+#endif /* EVENTLOG_H_ */
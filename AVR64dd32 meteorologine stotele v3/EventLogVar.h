@@ -0,0 +1,26 @@
+/**
+ * @file EventLogVar.h
+ * @brief Variable definition and PROGMEM tables of the event log.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef EVENTLOGVAR_H_
+#define EVENTLOGVAR_H_
+
+/**
+ * @brief Global event log, empty queue at start-up; EventLog_init() finds the ring position.
+ */
+EventLogState EventLog = {
+    .head = 0,
+    .tail = 0,
+    .source = GNSS_SOURCE_CLOCK
+};
+
+/**
+ * @brief Short names of the event codes, for the console and the log window.
+ */
+const char eventLogNames[EVENT_CODES][5] PROGMEM = { "none", "rst", "i2c", "lost", "back", "src", "set" };
+
+#endif /* EVENTLOGVAR_H_ */
@@ -0,0 +1,108 @@
+/**
+ * @file FixedMath.c
+ * @brief Fixed-point sine, cosine, arc tangent, arc cosine and square root.
+ *
+ * @author Saulius
+ * @date 2025-01-19
+ */
+
+#include "Settings.h"
+#include "FixedMathVar.h"
+
+/**
+ * @brief Sine of an angle.
+ *
+ * @param angle Angle (0.01 deg).
+ * @return sin(angle), Q15.
+ */
+int16_t FixedMath_Sin(int32_t angle) {
+    int32_t a = angle % 36000;
+    int8_t sign = 1;
+
+    if (a < 0)
+        a += 36000;
+    if (a >= 18000) { // sin(a) = -sin(a - 180)
+        a -= 18000;
+        sign = -1;
+    }
+    if (a > 9000)     // sin(a) = sin(180 - a)
+        a = 18000 - a;
+
+    uint8_t d = a / 100;
+    uint8_t f = a % 100;
+    int16_t s = pgm_read_word(&fixedMathSin[d]);
+    if (d < 90)
+        s += (int16_t)(((int32_t)((int16_t)pgm_read_word(&fixedMathSin[d + 1]) - s) * f) / 100);
+    return sign * s;
+}
+
+/**
+ * @brief Cosine of an angle.
+ *
+ * @param angle Angle (0.01 deg).
+ * @return cos(angle), Q15.
+ */
+int16_t FixedMath_Cos(int32_t angle) {
+    return FixedMath_Sin(angle + 9000);
+}
+
+/**
+ * @brief Four quadrant arc tangent.
+ *
+ * @param y, x Any common scale.
+ * @return atan2(y, x), -18000 ... 18000 (0.01 deg); 0 for (0, 0).
+ */
+int16_t FixedMath_Atan2(int32_t y, int32_t x) {
+    uint32_t ay = (y < 0) ? -(uint32_t)y : (uint32_t)y;
+    uint32_t ax = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+    uint8_t swap = ay > ax;
+    uint32_t small = swap ? ax : ay;
+    uint32_t large = swap ? ay : ax;
+
+    if (large == 0)
+        return 0;
+    while (large > 0xFFFF) { // Ratio below in 32 bits
+        large >>= 1;
+        small >>= 1;
+    }
+    uint16_t r = ((small << 16) / large) >> 3; // small / large, 0 ... 8192 (Q13)
+    uint8_t i = r >> 8;                          // Table step (1/32)
+    int16_t a = pgm_read_word(&fixedMathAtan[i]);
+    if (i < FIXEDMATH_ATAN_STEPS)
+        a += (int16_t)(((int32_t)((int16_t)pgm_read_word(&fixedMathAtan[i + 1]) - a) * (r & 0xFF)) >> 8);
+
+    if (swap)
+        a = 9000 - a;  // Octant above 45 degrees
+    if (x < 0)
+        a = 18000 - a; // Left half plane
+    return (y < 0) ? -a : a;
+}
+
+/**
+ * @brief Integer square root.
+ *
+ * @param x Radicand.
+ * @return floor(sqrt(x)).
+ */
+uint16_t FixedMath_Sqrt(uint32_t x) {
+    uint16_t r = 0;
+
+    for (uint16_t bit = 0x8000; bit; bit >>= 1) {
+        uint16_t t = r | bit;
+        if ((uint32_t)t * t <= x)
+            r = t;
+    }
+    return r;
+}
+
+/**
+ * @brief Arc cosine.
+ *
+ * @param x Cosine, -32768 ... 32767 (Q15).
+ * @return acos(x), 0 ... 18000 (0.01 deg).
+ */
+int16_t FixedMath_Acos(int16_t x) {
+    uint32_t xx = (int32_t)x * x;
+    uint16_t s = FixedMath_Sqrt(xx < (1UL << 30) ? (1UL << 30) - xx : 0); // sin = sqrt(1 - x^2), Q15
+    return FixedMath_Atan2(s, x);
+}
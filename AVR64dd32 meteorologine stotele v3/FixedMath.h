@@ -0,0 +1,20 @@
+/**
+ * @file FixedMath.h
+ * @brief Header file for the fixed-point trigonometry shared by the solar models.
+ *
+ * Angles are in 0.01 degree (int32_t, any value for sin/cos), sines, cosines and unit vector
+ * components are Q15. The functions use short PROGMEM tables with linear interpolation: sin()
+ * in 1 degree steps (error below 2 LSB), atan() of 0 ... 1 in 1/32 steps (error below 0.01
+ * degree), so they cost a few 16 x 16 bit multiplies instead of the float library.
+ *
+ * @author Saulius
+ * @date 2025-01-19
+ */
+
+#ifndef FIXEDMATH_H_
+#define FIXEDMATH_H_
+
+#define FIXEDMATH_ONE 32767        /**< 1.0 in Q15 (saturated) */
+#define FIXEDMATH_ATAN_STEPS 32    /**< atan table steps between 0 and 45 degrees */
+
+#endif /* FIXEDMATH_H_ */
@@ -0,0 +1,33 @@
+/**
+ * @file FixedMathVar.h
+ * @brief PROGMEM tables of the fixed-point trigonometry.
+ *
+ * @author Saulius
+ * @date 2025-01-19
+ */
+
+#ifndef FIXEDMATHVAR_H_
+#define FIXEDMATHVAR_H_
+
+/**
+ * @brief sin(d) for d = 0 ... 90 degrees, Q15.
+ */
+const int16_t fixedMathSin[91] PROGMEM = {
+    0, 572, 1144, 1715, 2286, 2856, 3425, 3993, 4560, 5126, 5690, 6252, 6813, 7371, 7927, 8481,
+    9032, 9580, 10126, 10668, 11207, 11743, 12275, 12803, 13328, 13848, 14365, 14876, 15384, 15886,
+    16384, 16877, 17364, 17847, 18324, 18795, 19261, 19720, 20174, 20622, 21063, 21498, 21926,
+    22348, 22763, 23170, 23571, 23965, 24351, 24730, 25102, 25466, 25822, 26170, 26510, 26842,
+    27166, 27482, 27789, 28088, 28378, 28660, 28932, 29197, 29452, 29698, 29935, 30163, 30382,
+    30592, 30792, 30983, 31164, 31336, 31499, 31651, 31795, 31928, 32052, 32166, 32270, 32365,
+    32449, 32524, 32588, 32643, 32688, 32723, 32748, 32763, 32767
+};
+
+/**
+ * @brief atan(i / 32) for i = 0 ... 32, 0.01 degree.
+ */
+const int16_t fixedMathAtan[FIXEDMATH_ATAN_STEPS + 1] PROGMEM = {
+    0, 179, 358, 536, 713, 888, 1062, 1234, 1404, 1571, 1735, 1897, 2056, 2211, 2363, 2511, 2657,
+    2798, 2936, 3070, 3201, 3327, 3451, 3571, 3687, 3800, 3909, 4016, 4119, 4218, 4315, 4409, 4500
+};
+
+#endif /* FIXEDMATHVAR_H_ */
@@ -0,0 +1,123 @@
+/**
+ * @file GPIO.h
+ * @brief Compile-time pin map and single-bit pin operations.
+ *
+ * Every pin the firmware uses is named once here as a "port, bit" pair (PIN_<name>) and
+ * listed in GPIO_PINS() with the state GPIO_init() gives it. Code refers to pins only by name:
+ *
+ *     GPIO_LOW(KEYPAD_ROW1);            // CBI VPORTD.OUT, 7
+ *     if (GPIO_IS_LOW(KEYPAD_COL2))     // SBIC VPORTF.IN, 4
+ *
+ * The operations go through the VPORT registers with a constant bit, so avr-gcc emits one SBI, CBI,
+ * SBIS or SBIC: one word, one cycle, no pointer and no branch on the port, and atomic against the
+ * ISRs that touch other pins of the same port. A name that is not in the map does not compile
+ * (PIN_<name> is undefined), and GPIO.c turns GPIO_PINS() into one enumerator per port bit, so two
+ * names on the same pin fail the build with "redeclaration of enumerator 'GPIO_TAKEN_PD_7'".
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef GPIO_H_
+#define GPIO_H_
+
+/** @name Pin map: port (PA, PC, PD, PF), bit */
+///@{
+#define PIN_XTAL1        PA, 0 /**< XOSCHF crystal (CLK.c) */
+#define PIN_XTAL2        PA, 1 /**< XOSCHF crystal (CLK.c) */
+#define PIN_TWI_SDA      PA, 2 /**< TWI0 default route */
+#define PIN_TWI_SCL      PA, 3 /**< TWI0 default route */
+#define PIN_USART0_TX    PA, 4 /**< USART0 ALT1 route, RS485 */
+#define PIN_USART0_RX    PA, 5 /**< USART0 ALT1 route, RS485 */
+#define PIN_SUN          PA, 6 /**< AIN26, light level */
+#define PIN_USART0_XDIR  PA, 7 /**< USART0 ALT1 route, RS485 driver enable */
+#define PIN_USART1_TX    PC, 0 /**< USART1 default route, clock device */
+#define PIN_USART1_RX    PC, 1 /**< USART1 default route, clock device */
+#define PIN_WIND_SPEED   PC, 2 /**< AIN30, wind speed */
+#define PIN_WIND_DIR     PC, 3 /**< AIN31, wind direction */
+#define PIN_KEYPAD_COL1  PD, 1 /**< Keypad column 1, pull-up */
+#define PIN_KEYPAD_ROW4  PD, 2 /**< Keypad row 4, driven low while scanned */
+#define PIN_KEYPAD_ROW3  PD, 3 /**< Keypad row 3 */
+#define PIN_SDI12        PD, 4 /**< SDI-12 data line, inverted; SDI12_EVSYS_GENERATOR must match */
+#define PIN_KEYPAD_ROW2  PD, 6 /**< Keypad row 2 */
+#define PIN_KEYPAD_ROW1  PD, 7 /**< Keypad row 1 */
+#define PIN_GNSS_SELECT  PF, 1 /**< USART1 RX multiplexer select: low the clock device, high the GNSS receiver */
+#define PIN_CLOCK_SET    PF, 2 /**< Clock device command, low while time and place are sent */
+#define PIN_KEYPAD_COL3  PF, 3 /**< Keypad column 3, pull-up */
+#define PIN_KEYPAD_COL2  PF, 4 /**< Keypad column 2, pull-up */
+///@}
+
+/**
+ * @brief Every pin with its GPIO_init() state, X(name, mode) with mode one of GPIO_MODE_*.
+ */
+#define GPIO_PINS(X) \
+    X(XTAL1,        NONE) \
+    X(XTAL2,        NONE) \
+    X(TWI_SDA,      OUTPUT) \
+    X(TWI_SCL,      OUTPUT) \
+    X(USART0_TX,    OUTPUT_PULLUP) \
+    X(USART0_RX,    INPUT_PULLUP) \
+    X(SUN,          ANALOG) \
+    X(USART0_XDIR,  OUTPUT) \
+    X(USART1_TX,    OUTPUT_PULLUP) \
+    X(USART1_RX,    INPUT_PULLUP) \
+    X(WIND_SPEED,   ANALOG) \
+    X(WIND_DIR,     ANALOG) \
+    X(KEYPAD_COL1,  INPUT_PULLUP) \
+    X(KEYPAD_ROW4,  OUTPUT_HIGH) \
+    X(KEYPAD_ROW3,  OUTPUT_HIGH) \
+    X(SDI12,        NONE) \
+    X(KEYPAD_ROW2,  OUTPUT_HIGH) \
+    X(KEYPAD_ROW1,  OUTPUT_HIGH) \
+    X(GNSS_SELECT,  OUTPUT) \
+    X(CLOCK_SET,    OUTPUT_HIGH) \
+    X(KEYPAD_COL3,  INPUT_PULLUP) \
+    X(KEYPAD_COL2,  INPUT_PULLUP)
+
+/** @name Expansion helpers: apply a (port, bit) macro to a pin map entry */
+///@{
+#define GPIO_APPLY(macro, ...) macro(__VA_ARGS__)
+#define GPIO_PORT_(port, bit) GPIO_PORT_##port
+#define GPIO_VPORT_(port, bit) GPIO_VPORT_##port
+#define GPIO_BM_(port, bit) (1 << (bit))
+#define GPIO_CTRL_(port, bit) GPIO_PORT_##port.PIN##bit##CTRL
+#define GPIO_PORT_PA PORTA
+#define GPIO_PORT_PC PORTC
+#define GPIO_PORT_PD PORTD
+#define GPIO_PORT_PF PORTF
+#define GPIO_VPORT_PA VPORTA
+#define GPIO_VPORT_PC VPORTC
+#define GPIO_VPORT_PD VPORTD
+#define GPIO_VPORT_PF VPORTF
+///@}
+
+/** @name Pin registers and mask */
+///@{
+#define GPIO_PORT(name) GPIO_APPLY(GPIO_PORT_, PIN_##name)   /**< PORTx of the pin */
+#define GPIO_VPORT(name) GPIO_APPLY(GPIO_VPORT_, PIN_##name) /**< VPORTx of the pin */
+#define GPIO_BM(name) GPIO_APPLY(GPIO_BM_, PIN_##name)       /**< Bit mask of the pin */
+#define GPIO_CTRL(name) GPIO_APPLY(GPIO_CTRL_, PIN_##name)   /**< PINnCTRL of the pin */
+///@}
+
+/** @name Single-bit operations (SBI, CBI, SBIS, SBIC) */
+///@{
+#define GPIO_HIGH(name) (GPIO_VPORT(name).OUT |= GPIO_BM(name))
+#define GPIO_LOW(name) (GPIO_VPORT(name).OUT &= ~GPIO_BM(name))
+#define GPIO_OUTPUT(name) (GPIO_VPORT(name).DIR |= GPIO_BM(name))
+#define GPIO_INPUT(name) (GPIO_VPORT(name).DIR &= ~GPIO_BM(name))
+#define GPIO_IS_HIGH(name) ((GPIO_VPORT(name).IN & GPIO_BM(name)) != 0)
+#define GPIO_IS_LOW(name) ((GPIO_VPORT(name).IN & GPIO_BM(name)) == 0)
+#define GPIO_CLEAR_FLAG(name) (GPIO_VPORT(name).INTFLAGS = GPIO_BM(name)) /**< Pin change flag */
+///@}
+
+/** @name Start-up states for GPIO_PINS(); inputs and low outputs are the reset state */
+///@{
+#define GPIO_MODE_NONE(name)                   /**< Owned by a peripheral or set up by its driver */
+#define GPIO_MODE_OUTPUT(name) GPIO_OUTPUT(name);
+#define GPIO_MODE_OUTPUT_HIGH(name) GPIO_HIGH(name); GPIO_OUTPUT(name); /**< High before driven: no low glitch */
+#define GPIO_MODE_OUTPUT_PULLUP(name) GPIO_OUTPUT(name); GPIO_CTRL(name) = PORT_PULLUPEN_bm;
+#define GPIO_MODE_INPUT_PULLUP(name) GPIO_CTRL(name) = PORT_PULLUPEN_bm;
+#define GPIO_MODE_ANALOG(name) GPIO_CTRL(name) = PORT_ISC_INPUT_DISABLE_gc; /**< Digital input off, no pull-up */
+///@}
+
+#endif /* GPIO_H_ */
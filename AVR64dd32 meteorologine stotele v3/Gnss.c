@@ -0,0 +1,400 @@
+/**
+ * @file Gnss.c
+ * @brief GNSS receiver: incremental NMEA 0183 parser in the USART1 receive interrupt, failover
+ *        between the clock device and the receiver in the main loop.
+ *
+ * Sentence (the checksum is the XOR of the characters between '$' and '*', two hex digits):
+ *
+ *     $GNRMC,hhmmss.ss,A,ddmm.mmmmm,N,dddmm.mmmmm,E,speed,course,ddmmyy,,,A*hh<CR><LF>
+ *     $GNGGA,hhmmss.ss,ddmm.mmmmm,N,dddmm.mmmmm,E,quality,satellites,hdop,altitude,M,...*hh
+ *     $GNZDA,hhmmss.ss,dd,mm,yyyy,zone hours,zone minutes*hh
+ *
+ * The talker (GP, GL, GA, GN, ...) is ignored, sentences of other types are skipped.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#include "Settings.h"
+#include "GnssVar.h"
+
+#define GNSS_RX_ERRORS (USART_BUFOVF_bm | USART_FERR_bm | USART_PERR_bm) /**< RXDATAH error flags */
+#define GNSS_ADDRESS(a, b, c) (((uint32_t)(a) << 16) | ((uint16_t)(b) << 8) | (c)) /**< Sentence type */
+#define GNSS_AT(type, field) (((uint16_t)(type) << 8) | (field)) /**< Field of a sentence type */
+
+/**
+ * @brief Starts the next field.
+ */
+static inline void Gnss_Clear() {
+    Gnss.whole = 0;
+    Gnss.fraction = 0;
+    Gnss.cents = 0;
+    Gnss.point = 0;
+    Gnss.letter = 0;
+    Gnss.negative = 0;
+}
+
+/**
+ * @brief Value of a hex checksum digit.
+ *
+ * @return 0 ... 15, 0xFF if c is not a hex digit.
+ */
+static inline uint8_t Gnss_Hex(uint8_t c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20; // Either case
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return 0xFF;
+}
+
+/**
+ * @brief Stores the field just ended into the sentence being received.
+ *
+ * @param field Field that ended, 0 for the address.
+ * @return Next field, GNSS_IDLE after the address of a sentence that is not decoded.
+ */
+static inline uint8_t Gnss_Field(uint8_t field) {
+    GnssSentence *s = &Gnss.work;
+    uint32_t whole = Gnss.whole;
+
+    if (!field) {
+        uint32_t address = Gnss.address & 0xFFFFFF;
+        uint8_t type = address == GNSS_ADDRESS('R', 'M', 'C') ? GNSS_RMC
+                     : address == GNSS_ADDRESS('G', 'G', 'A') ? GNSS_GGA
+                     : address == GNSS_ADDRESS('Z', 'D', 'A') ? GNSS_ZDA : GNSS_SENTENCES;
+        Gnss.type = type;
+        return type == GNSS_SENTENCES ? GNSS_IDLE : 1;
+    }
+    switch (GNSS_AT(Gnss.type, field)) {
+        case GNSS_AT(GNSS_RMC, 1):
+        case GNSS_AT(GNSS_GGA, 1):
+        case GNSS_AT(GNSS_ZDA, 1):
+            s->time = whole;
+            s->hundredths = Gnss.cents;
+            break;
+        case GNSS_AT(GNSS_RMC, 2):
+            if (Gnss.letter == 'A')
+                s->flags |= GNSS_VALID;
+            break;
+        case GNSS_AT(GNSS_RMC, 3):
+        case GNSS_AT(GNSS_GGA, 2):
+            s->latitude = whole;
+            s->latitudeFraction = Gnss.fraction;
+            break;
+        case GNSS_AT(GNSS_RMC, 4):
+        case GNSS_AT(GNSS_GGA, 3):
+            if (Gnss.letter == 'S')
+                s->flags |= GNSS_SOUTH;
+            break;
+        case GNSS_AT(GNSS_RMC, 5):
+        case GNSS_AT(GNSS_GGA, 4):
+            s->longitude = whole;
+            s->longitudeFraction = Gnss.fraction;
+            break;
+        case GNSS_AT(GNSS_RMC, 6):
+        case GNSS_AT(GNSS_GGA, 5):
+            if (Gnss.letter == 'W')
+                s->flags |= GNSS_WEST;
+            break;
+        case GNSS_AT(GNSS_RMC, 9):
+            s->date = whole;
+            break;
+        case GNSS_AT(GNSS_GGA, 6):
+            if (whole) // Fix quality: 0 invalid, 1 GNSS, 2 differential, ...
+                s->flags |= GNSS_VALID;
+            break;
+        case GNSS_AT(GNSS_GGA, 9):
+            whole += Gnss.cents >= 50; // Rounded to the metre
+            s->altitude = Gnss.negative ? -(int16_t)whole : (int16_t)whole;
+            break;
+        case GNSS_AT(GNSS_ZDA, 2):
+            s->date = whole * 10000;
+            break;
+        case GNSS_AT(GNSS_ZDA, 3):
+            s->date += whole * 100;
+            break;
+        case GNSS_AT(GNSS_ZDA, 4):
+            if (whole >= 2000 && whole < 2100) { // Empty or a receiver default before its first fix
+                s->date += whole - 2000;
+                s->flags |= GNSS_VALID;
+            }
+            break;
+        default:
+            break;
+    }
+    return field + 1;
+}
+
+/**
+ * @brief USART1 receive interrupt: one NMEA character.
+ *
+ * '$' starts a sentence wherever it comes. The checksum is accumulated and every field is turned
+ * into numbers while the characters arrive, so a sentence is never buffered: at its checksum the
+ * decoded fields are copied to `sentences` or dropped. Calls no functions; the longest path, that
+ * copy, takes about a hundred cycles against a character every 25000 cycles at GNSS_BAUD, so the
+ * USART0 receive interrupt is never held up for long.
+ */
+ISR(USART1_RXC_vect) {
+    uint8_t flags = USART1.RXDATAH; // Error flags belong to the byte in RXDATAL, read them first
+    uint8_t c = USART1.RXDATAL;
+    uint8_t field = Gnss.field;
+
+    if (c == '$') {
+        if (field != GNSS_IDLE)
+            Gnss.errors++; // Cut short
+        Gnss.work = (GnssSentence){ 0 };
+        Gnss.address = 0;
+        Gnss.sum = 0;
+        Gnss.check = 0;
+        Gnss.length = 0;
+        Gnss.field = 0;
+        Gnss_Clear();
+        return;
+    }
+    if (field == GNSS_IDLE)
+        return;
+    if ((flags & GNSS_RX_ERRORS) || ++Gnss.length > GNSS_SENTENCE_LENGTH) {
+        Gnss.errors++;
+        Gnss.field = GNSS_IDLE;
+        return;
+    }
+
+    uint8_t check = Gnss.check;
+    if (check) { // Checksum digits
+        uint8_t digit = Gnss_Hex(c);
+        if (digit == 0xFF) {
+            Gnss.errors++;
+            Gnss.field = GNSS_IDLE;
+        } else if (check == 1) {
+            Gnss.received = digit << 4;
+            Gnss.check = 2;
+        } else {
+            if ((Gnss.received | digit) == Gnss.sum) {
+                uint8_t type = Gnss.type;
+                Gnss.sentences[type] = Gnss.work;
+                Gnss.fresh |= 1 << type;
+                Gnss.good++;
+            } else {
+                Gnss.errors++;
+            }
+            Gnss.field = GNSS_IDLE;
+        }
+        return;
+    }
+    if (c == ',' || c == '*') {
+        if (c == ',')
+            Gnss.sum ^= c;
+        else
+            Gnss.check = 1;
+        Gnss.field = Gnss_Field(field);
+        Gnss_Clear();
+        return;
+    }
+    Gnss.sum ^= c;
+
+    if (!field) {
+        Gnss.address = (Gnss.address << 8) | c;
+    } else if (c >= '0' && c <= '9') {
+        uint8_t digit = c - '0';
+        uint8_t point = Gnss.point;
+        if (!point) {
+            Gnss.whole = Gnss.whole * 10 + digit;
+        } else if (point <= GNSS_FRACTION_DIGITS) { // Further digits are below the resolution
+            Gnss.fraction += (uint32_t)digit * pgm_read_word(&gnssFraction[point - 1]);
+            if (point <= 2)
+                Gnss.cents += (point == 1) ? digit * 10 : digit;
+            Gnss.point = point + 1;
+        }
+    } else if (c == '.') {
+        Gnss.point = 1;
+    } else if (c == '-') {
+        Gnss.negative = 1;
+    } else {
+        Gnss.letter = c;
+    }
+}
+
+/**
+ * @brief Switches USART1 and the receive line multiplexer between the clock device and the GNSS receiver.
+ *
+ * @param on 1: the receiver at GNSS_BAUD and the receive interrupt, 0: the clock device at
+ *           GNSS_CLOCK_BAUD, polled by ClockAndDataReader().
+ */
+static void Gnss_Listen(uint8_t on) {
+    USART1.CTRLA = 0;
+    if (on)
+        GPIO_HIGH(GNSS_SELECT);
+    else
+        GPIO_LOW(GNSS_SELECT);
+    USART1.BAUD = on ? (uint16_t)USART1_BAUD_RATE(GNSS_BAUD) : (uint16_t)USART1_BAUD_RATE(GNSS_CLOCK_BAUD);
+    Gnss.field = GNSS_IDLE; // Whatever was received at the other rate is not a sentence
+    if (on)
+        USART1.CTRLA = USART_RXCIE_bm;
+}
+
+/**
+ * @brief Days of a month.
+ */
+static uint8_t Gnss_MonthDays(uint16_t year, uint8_t month) {
+    return pgm_read_byte(&gnssMonthDays[month - 1]) + (month == 2 && isLeapYear(year));
+}
+
+/**
+ * @brief Days from 2000-01-01 to a date of 2000 ... 2099.
+ */
+static uint16_t Gnss_Days(uint8_t year, uint8_t month, uint8_t day) {
+    uint16_t days = year * 365 + (year + 3) / 4; // Every fourth year from 2000 on is a leap year
+    for (uint8_t m = 1; m < month; m++)
+        days += Gnss_MonthDays(2000 + year, m);
+    return days + day - 1;
+}
+
+/**
+ * @brief Coordinate from NMEA degrees and minutes.
+ *
+ * @param minutes Degrees and whole minutes, ddmm or dddmm.
+ * @param fraction Minutes after the decimal point, 0.00001 minute.
+ * @param negative 1 for S or W.
+ */
+static UNIT_T(DEGREE_10000) Gnss_Degrees(uint16_t minutes, uint32_t fraction, uint8_t negative) {
+    int32_t degrees = (minutes / 100) * 10000L + ((minutes % 100) * 100000UL + fraction + 300) / 600;
+    return UNIT(DEGREE_10000, negative ? -degrees : degrees);
+}
+
+/**
+ * @brief Takes the position of an RMC or GGA sentence with a fix.
+ */
+static void Gnss_Position(const GnssSentence *s) {
+    UNIT_T(DEGREE_10000) latitude = Gnss_Degrees(s->latitude, s->latitudeFraction, s->flags & GNSS_SOUTH);
+    UNIT_T(DEGREE_10000) longitude = Gnss_Degrees(s->longitude, s->longitudeFraction, s->flags & GNSS_WEST);
+
+    if (UNIT_RAW(latitude) < -900000 || UNIT_RAW(latitude) > 900000
+        || UNIT_RAW(longitude) < -1800000 || UNIT_RAW(longitude) > 1800000)
+        return;
+    Gnss.latitude = latitude;
+    Gnss.longitude = longitude;
+    Gnss.located = 1;
+    Date_Clock.latitude = UNIT_RAW(latitude) / 10000.0;
+    Date_Clock.longitude = UNIT_RAW(longitude) / 10000.0;
+}
+
+/**
+ * @brief Sets Date_Clock to the local time of a UTC time.
+ *
+ * @param days UTC date, days since 2000-01-01.
+ * @param seconds UTC seconds of the day.
+ */
+static void Gnss_Local(uint16_t days, uint32_t seconds) {
+    int32_t local = (int32_t)seconds + (int32_t)Date_Clock.timezone * 3600;
+    if (local < 0) {
+        local += 86400;
+        days--;
+    } else if (local >= 86400) {
+        local -= 86400;
+        days++;
+    }
+    uint16_t year = 2000;
+    while (days >= 365 + isLeapYear(year)) {
+        days -= 365 + isLeapYear(year);
+        year++;
+    }
+    uint8_t month = 1;
+    while (days >= Gnss_MonthDays(year, month)) {
+        days -= Gnss_MonthDays(year, month);
+        month++;
+    }
+    Date_Clock.year = year;
+    Date_Clock.month = month;
+    Date_Clock.day = days + 1;
+    Date_Clock.hour = local / 3600;
+    Date_Clock.minute = local / 60 % 60;
+    Date_Clock.second = local % 60;
+}
+
+/**
+ * @brief Takes the time and date of an RMC or ZDA sentence: Date_Clock and the sun angles.
+ *
+ * @return 1 if the time was valid and taken.
+ */
+static uint8_t Gnss_Time(const GnssSentence *s) {
+    uint8_t day = s->date / 10000, month = s->date / 100 % 100, year = s->date % 100;
+    uint8_t hour = s->time / 10000, minute = s->time / 100 % 100, second = s->time % 100;
+
+    if (isValidDateTime(2000 + year, month, day, hour, minute, second))
+        return 0;
+    uint16_t days = Gnss_Days(year, month, day);
+    uint32_t seconds = hour * 3600UL + minute * 60 + second;
+    Gnss_Local(days, seconds);
+    Date_Clock.hunderts = s->hundredths / 10;
+    if (Gnss.located)
+        calculate_solar_position(days, seconds, Gnss.latitude, Gnss.longitude);
+    if (Date_Clock.error == 1) { // Time again: the windows show it instead of the clock error
+        screen_clear();
+        Date_Clock.error = 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Gives the clock device up to GNSS_PROBE_FRAMES frames at its own rate; back to it if one is valid.
+ */
+static void Gnss_Probe() {
+    uint8_t error = Date_Clock.error, count = Date_Clock.errorCounter;
+
+    Gnss_Listen(0);
+    Date_Clock.error = 1; // A silent clock device does not clear the screen
+    for (uint8_t frame = 0; frame < GNSS_PROBE_FRAMES; frame++) {
+        Date_Clock.errorCounter = CountForError - 1; // A timeout counts it up to CountForError
+        if (ClockAndDataReader()) {
+            Gnss.source = GNSS_SOURCE_CLOCK;
+            Date_Clock.errorCounter = 0;
+            return;
+        }
+        if (Date_Clock.errorCounter == CountForError)
+            break; // Silent: no other frame will come
+    }
+    Date_Clock.error = error;
+    Date_Clock.errorCounter = count;
+    Gnss_Listen(1);
+}
+
+void Gnss_Task() {
+    uint32_t now = Timer_ms();
+
+    if (Gnss.source == GNSS_SOURCE_CLOCK) {
+        if (Date_Clock.error == 1) { // The clock device link is lost: listen to the GNSS receiver
+            Gnss_Listen(1);
+            Gnss.source = GNSS_SOURCE_GNSS;
+            Gnss.failovers++;
+            Gnss.timeMs = Gnss.probeMs = now;
+        }
+        return;
+    }
+
+    for (uint8_t type = 0; type < GNSS_SENTENCES; type++) {
+        GnssSentence s;
+        uint8_t fresh;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            fresh = Gnss.fresh & (1 << type);
+            Gnss.fresh &= ~(1 << type);
+            s = Gnss.sentences[type];
+        }
+        if (!fresh || !(s.flags & GNSS_VALID))
+            continue;
+        if (type != GNSS_ZDA)
+            Gnss_Position(&s);
+        if (type == GNSS_GGA && !isValidAltitude(s.altitude))
+            Date_Clock.altitude = s.altitude;
+        if (type != GNSS_GGA && Gnss_Time(&s)) // GGA has no date: at midnight its time may not match the last one
+            Gnss.timeMs = now; // The pass's own time: a later Timer_ms() would make now - timeMs wrap
+    }
+    if (now - Gnss.timeMs > GNSS_TIMEOUT_MS && Date_Clock.error != 1) { // Neither source has the time
+        screen_clear();
+        Date_Clock.error = 1;
+    }
+    if (now - Gnss.probeMs >= GNSS_PROBE_MS) {
+        Gnss.probeMs = now;
+        Gnss_Probe();
+    }
+}
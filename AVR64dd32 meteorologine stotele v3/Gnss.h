@@ -0,0 +1,115 @@
+/**
+ * @file Gnss.h
+ * @brief Header file for the GNSS receiver, the fallback time and location source of the station.
+ *
+ * The clock device and a GNSS receiver share the USART1 receive pin, each talking at its own rate:
+ * the clock device at GNSS_CLOCK_BAUD, the receiver's NMEA 0183 sentences at GNSS_BAUD. Both
+ * transmitters drive their line all the time, so they must not be wired together: a 2:1
+ * multiplexer (74LVC1G157 or similar) connects one of them to PIN_USART1_RX, its select input
+ * driven by PIN_GNSS_SELECT (low: the clock device, the reset and GPIO_init() state). While the
+ * clock device works, USART1 runs at its rate and ClockAndDataReader() polls its frames. When
+ * Date_Clock.error latches, Gnss_Task() selects the receiver, switches USART1 to GNSS_BAUD and the
+ * receive interrupt parses RMC, GGA and ZDA sentences byte by byte: the checksum is computed while
+ * the sentence arrives, the fields are accumulated as integers (coordinates ddmm.mmmmm as whole minutes and
+ * 0.00001 minute) and nothing but the decoded numbers is stored. Gnss_Task() turns a sentence with
+ * a good checksum into Date_Clock (local time from the UTC time and Date_Clock.timezone), the
+ * position and altitude, and computes the sun angles the clock device would have sent. Every
+ * GNSS_PROBE_MS it selects the clock device, listens for its frames at its own rate and goes back
+ * to it when it answers.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef GNSS_H_
+#define GNSS_H_
+
+#define GNSS_BAUD 9600              /**< NMEA 0183 rate of the GNSS receiver */
+#define GNSS_CLOCK_BAUD 2500000     /**< Rate of the clock device, as set by USART1_init() */
+#define GNSS_PROBE_MS 60000         /**< On the GNSS receiver, the clock device is tried this often */
+#define GNSS_PROBE_FRAMES 2         /**< Frames a probe waits for: the first one may be cut by the switch */
+#define GNSS_TIMEOUT_MS 5000        /**< No valid time for this long: Date_Clock.error is set */
+#define GNSS_SENTENCE_LENGTH 82     /**< Longest NMEA 0183 sentence, '$' to LF */
+#define GNSS_FRACTION_DIGITS 5      /**< Digits kept after a decimal point (0.00001) */
+#define GNSS_IDLE 0xFF              /**< `field` between sentences: waiting for '$' */
+
+/** @name GnssSentence flags */
+///@{
+#define GNSS_VALID 0x01 /**< RMC status A, GGA fix quality above 0, ZDA with a year */
+#define GNSS_SOUTH 0x02 /**< Latitude hemisphere S */
+#define GNSS_WEST  0x04 /**< Longitude hemisphere W */
+///@}
+
+/**
+ * @brief Source of the station's time, position and sun angles.
+ */
+typedef enum {
+    GNSS_SOURCE_CLOCK, /**< Clock device frames, USART1 at GNSS_CLOCK_BAUD */
+    GNSS_SOURCE_GNSS   /**< GNSS receiver sentences, USART1 at GNSS_BAUD */
+} gnss_source_t;
+
+/**
+ * @brief Sentences decoded; the others are skipped.
+ */
+typedef enum {
+    GNSS_RMC,      /**< Recommended minimum: UTC time and date, status, position */
+    GNSS_GGA,      /**< Fix data: UTC time, position, fix quality, altitude */
+    GNSS_ZDA,      /**< UTC time and date */
+    GNSS_SENTENCES /**< Number of decoded sentences; also any other sentence */
+} gnss_sentence_t;
+
+/**
+ * @brief Fields of one sentence, as integers.
+ */
+typedef struct {
+    uint32_t time;              /**< UTC hhmmss */
+    uint32_t date;              /**< UTC ddmmyy (RMC, ZDA) */
+    uint32_t latitudeFraction;  /**< Latitude minutes after the decimal point, 0.00001 minute */
+    uint32_t longitudeFraction; /**< Longitude minutes after the decimal point, 0.00001 minute */
+    uint16_t latitude;          /**< Latitude ddmm */
+    uint16_t longitude;         /**< Longitude dddmm */
+    int16_t altitude;           /**< Antenna altitude above mean sea level, m (GGA) */
+    uint8_t hundredths;         /**< UTC hundredths of a second */
+    uint8_t flags;              /**< GNSS_VALID, GNSS_SOUTH, GNSS_WEST */
+} GnssSentence;
+
+/**
+ * @brief Sentence parser, last sentences and source selection.
+ *
+ * `work` and the field accumulators belong to the receive interrupt; a sentence in `sentences`
+ * is replaced by the interrupt and read by Gnss_Task() with interrupts disabled.
+ */
+typedef struct {
+    GnssSentence work;                      /**< Sentence being received */
+    GnssSentence sentences[GNSS_SENTENCES]; /**< Last sentence of each type with a good checksum */
+    volatile uint8_t fresh;                 /**< Bit per gnss_sentence_t received since Gnss_Task() took it */
+    uint32_t address;                       /**< Last three characters of the address field ("RMC") */
+    uint32_t whole;                         /**< Digits of the field before the decimal point */
+    uint32_t fraction;                      /**< Digits after it, 0.00001 */
+    uint8_t cents;                          /**< First two digits after it, 0.01 */
+    uint8_t point;                          /**< 0 before the decimal point, then 1 + digits after it */
+    uint8_t letter;                         /**< Last character of the field that is not part of a number */
+    uint8_t negative;                       /**< 1 after a minus sign */
+    uint8_t type;                           /**< gnss_sentence_t being received */
+    uint8_t field;                          /**< Field being received (0: address), GNSS_IDLE between sentences */
+    uint8_t sum;                            /**< XOR of the characters between '$' and '*' */
+    uint8_t check;                          /**< Checksum digits after '*' + 1, 0 before '*' */
+    uint8_t received;                       /**< Checksum of the sentence */
+    uint8_t length;                         /**< Characters since '$' */
+    uint16_t good;                          /**< Decoded sentences with a good checksum */
+    uint16_t errors;                        /**< Sentences with a bad checksum, a receive error or too long */
+    uint8_t source;                         /**< gnss_source_t in use */
+    uint8_t failovers;                      /**< Switches from the clock device to the GNSS receiver */
+    uint8_t located;                        /**< 1 once a position has been received */
+    UNIT_T(DEGREE_10000) latitude;          /**< Last position, north positive */
+    UNIT_T(DEGREE_10000) longitude;         /**< Last position, east positive */
+    uint32_t timeMs;                        /**< Timer_ms() of the last valid time, or of the switch */
+    uint32_t probeMs;                       /**< Timer_ms() of the last clock device probe */
+} GnssReceiver;
+
+/**
+ * @brief Global GNSS receiver.
+ */
+extern GnssReceiver Gnss;
+
+#endif /* GNSS_H_ */
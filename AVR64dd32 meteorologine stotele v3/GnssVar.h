@@ -0,0 +1,30 @@
+/**
+ * @file GnssVar.h
+ * @brief Variable definition and PROGMEM tables of the GNSS receiver.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef GNSSVAR_H_
+#define GNSSVAR_H_
+
+/**
+ * @brief Global GNSS receiver: not listening, the clock device is the source at start-up.
+ */
+GnssReceiver Gnss = {
+    .field = GNSS_IDLE,
+    .source = GNSS_SOURCE_CLOCK
+};
+
+/**
+ * @brief Value of the i-th digit after the decimal point, 0.00001.
+ */
+const uint16_t gnssFraction[GNSS_FRACTION_DIGITS] PROGMEM = { 10000, 1000, 100, 10, 1 };
+
+/**
+ * @brief Days of the months of a common year.
+ */
+const uint8_t gnssMonthDays[12] PROGMEM = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+#endif /* GNSSVAR_H_ */
@@ -0,0 +1,390 @@
+/**
+ * @file History.c
+ * @brief Compressed 1-minute history: minute reduction, block packing, circular pool and decoders.
+ *
+ * @author Saulius
+ * @date 2025-01-21
+ */
+
+#include "Settings.h"
+#include "HistoryVar.h"
+
+#define HISTORY_POOL_BITS ((uint16_t)HISTORY_POOL_SIZE * 8)
+
+/**
+ * @brief Current input of a channel, before quantisation.
+ *
+ * Pressure, temperature and humidity come from the dependency graph inputs, which
+ * Derived_Update() refreshes every pass at the sensor resolution.
+ *
+ * @param ch history_channel_t.
+ * @return Input in the units listed in historyChannels[].
+ */
+static int32_t History_Input(uint8_t ch) {
+    switch (ch) {
+        case HISTORY_PRESSURE:    return Derived.input[DERIVED_IN_PRESSURE];
+        case HISTORY_TEMPERATURE: return Derived.input[DERIVED_IN_TEMPERATURE];
+        case HISTORY_HUMIDITY:    return Derived.input[DERIVED_IN_HUMIDITY];
+        case HISTORY_WIND_SPEED:
+        case HISTORY_WIND_GUST:   return ((uint32_t)Wind.raw * 3000) >> 12; // 30 m/s full scale
+        case HISTORY_WIND_DIR:    return Wind.direction;
+        default:                  return SUN.sunlevel;
+    }
+}
+
+/**
+ * @brief Writes bits to the pool, MSB first.
+ *
+ * @param bit Pool bit to write at, advanced past the written bits (circular).
+ * @param value Bits to write, right aligned.
+ * @param n Number of bits (0 ... 16).
+ */
+static void History_Put(uint16_t *bit, uint16_t value, uint8_t n) {
+    while (n--) {
+        uint8_t mask = 0x80 >> (*bit & 7);
+        if ((value >> n) & 1)
+            History.pool[*bit >> 3] |= mask;
+        else
+            History.pool[*bit >> 3] &= ~mask;
+        if (++*bit == HISTORY_POOL_BITS)
+            *bit = 0;
+    }
+}
+
+/**
+ * @brief Reads bits from the pool, MSB first.
+ *
+ * @param bit Pool bit to read at, advanced past the read bits (circular).
+ * @param n Number of bits (0 ... 16).
+ * @return The bits, right aligned.
+ */
+static uint16_t History_Get(uint16_t *bit, uint8_t n) {
+    uint16_t value = 0;
+
+    while (n--) {
+        value = (value << 1) | ((History.pool[*bit >> 3] >> (7 - (*bit & 7))) & 1);
+        if (++*bit == HISTORY_POOL_BITS)
+            *bit = 0;
+    }
+    return value;
+}
+
+/**
+ * @brief Open block bit of a value: rows of HISTORY_ROW_BITS, channels in order within a row.
+ *
+ * @param ch history_channel_t.
+ * @param i Minute within the block.
+ */
+static uint16_t History_OpenBit(uint8_t ch, uint8_t i) {
+    uint16_t bit = (uint16_t)i * HISTORY_ROW_BITS;
+
+    for (uint8_t c = 0; c < ch; c++)
+        bit += pgm_read_byte(&historyChannels[c].bits);
+    return bit;
+}
+
+/**
+ * @brief Reads one value of the open block.
+ *
+ * @param ch history_channel_t.
+ * @param i Minute within the block.
+ */
+static uint16_t History_OpenGet(uint8_t ch, uint8_t i) {
+    uint16_t bit = History_OpenBit(ch, i);
+    uint16_t value = 0;
+
+    for (uint8_t n = pgm_read_byte(&historyChannels[ch].bits); n; n--, bit++)
+        value = (value << 1) | ((History.open[bit >> 3] >> (7 - (bit & 7))) & 1);
+    return value;
+}
+
+/**
+ * @brief Reads the values of one channel of the full open block.
+ *
+ * @param ch history_channel_t.
+ * @param v Receives HISTORY_BLOCK values.
+ */
+static void History_OpenChannel(uint8_t ch, uint16_t *v) {
+    for (uint8_t i = 0; i < HISTORY_BLOCK; i++)
+        v[i] = History_OpenGet(ch, i);
+}
+
+/**
+ * @brief Zigzag code of the difference of two stored values (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...).
+ *
+ * The difference is taken modulo the channel width, so a wind direction step from 7 to 0 is +1
+ * and every code stays below 2^bits.
+ *
+ * @param previous Previous stored value.
+ * @param value Stored value.
+ * @param bits Width of the channel values.
+ */
+static uint16_t History_Zigzag(uint16_t previous, uint16_t value, uint8_t bits) {
+    int16_t d = (int16_t)((value - previous) << (16 - bits)) >> (16 - bits);
+    return ((uint16_t)d << 1) ^ (d >> 15);
+}
+
+/**
+ * @brief Reads a channel block header.
+ *
+ * @param bit Pool bit of the header, advanced to the first code.
+ * @param ch Channel of the block.
+ * @param r Receives the Rice parameter and the first value.
+ */
+static void History_Header(uint16_t *bit, uint8_t ch, HistoryReader *r) {
+    r->bits = pgm_read_byte(&historyChannels[ch].bits);
+    r->width = History_Get(bit, HISTORY_WIDTH_BITS);
+    r->value = History_Get(bit, r->bits);
+}
+
+/**
+ * @brief Decodes the next code of the reader's block into r->value.
+ */
+static void History_Code(HistoryReader *r) {
+    uint16_t code = 0;
+
+    if (r->width != HISTORY_CONSTANT) {
+        while (History_Get(&r->bit, 1)) // Unary high part ...
+            code++;
+        code = (code << r->width) | History_Get(&r->bit, r->width); // ... and width low bits
+    }
+    r->value = (r->value + (int16_t)((code >> 1) ^ -(code & 1))) & ((1U << r->bits) - 1);
+    r->left--;
+}
+
+/**
+ * @brief Drops the oldest group from the pool.
+ */
+static void History_Drop() {
+    uint8_t next = (History.head + 1) % HISTORY_GROUPS;
+
+    if (History.groups > 1)
+        History.used -= (History.index[next] + HISTORY_POOL_SIZE - History.index[History.head]) % HISTORY_POOL_SIZE;
+    else
+        History.used = 0;
+    History.head = next;
+    History.groups--;
+    History.dropped++;
+}
+
+/**
+ * @brief Packs the full open block into a new group, dropping the oldest groups to make room.
+ *
+ * Per channel the Rice parameter is the one with the fewest bits over the block: at most 14
+ * candidates over HISTORY_BLOCK - 1 codes, once every HISTORY_BLOCK minutes. The channel is
+ * unpacked from the open block rows once per pass over it.
+ */
+static void History_Close() {
+    uint8_t width[HISTORY_CHANNELS];
+    uint16_t v[HISTORY_BLOCK];
+    uint16_t bits = 0;
+
+    for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+        uint8_t n = pgm_read_byte(&historyChannels[ch].bits);
+        uint32_t best = 0;
+        uint16_t widest = 0;
+
+        History_OpenChannel(ch, v);
+        for (uint8_t i = 1; i < HISTORY_BLOCK; i++)
+            widest |= History_Zigzag(v[i - 1], v[i], n);
+        width[ch] = HISTORY_CONSTANT;
+        for (uint8_t k = 0; widest && k < n; k++) {
+            uint32_t cost = (uint16_t)(k + 1) * (HISTORY_BLOCK - 1);
+            for (uint8_t i = 1; i < HISTORY_BLOCK; i++)
+                cost += History_Zigzag(v[i - 1], v[i], n) >> k;
+            if (k == 0 || cost < best) {
+                best = cost;
+                width[ch] = k;
+            }
+        }
+        bits += HISTORY_WIDTH_BITS + n + best;
+    }
+
+    uint16_t size = (bits + 7) / 8;
+    while (History.groups && (History.groups == HISTORY_GROUPS || History.used + size > HISTORY_POOL_SIZE))
+        History_Drop();
+    uint16_t start = History.groups ? (History.index[History.head] + History.used) % HISTORY_POOL_SIZE : 0;
+    History.index[(History.head + History.groups) % HISTORY_GROUPS] = start;
+    History.groups++;
+    History.used += size;
+
+    uint16_t bit = start * 8;
+    for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+        uint8_t n = pgm_read_byte(&historyChannels[ch].bits);
+        uint8_t k = width[ch];
+
+        History_OpenChannel(ch, v);
+        History_Put(&bit, k, HISTORY_WIDTH_BITS);
+        History_Put(&bit, v[0], n);
+        if (k == HISTORY_CONSTANT)
+            continue;
+        for (uint8_t i = 1; i < HISTORY_BLOCK; i++) {
+            uint16_t code = History_Zigzag(v[i - 1], v[i], n);
+            for (uint16_t q = code >> k; q; q--)
+                History_Put(&bit, 1, 1);
+            History_Put(&bit, 0, 1);
+            History_Put(&bit, code, k);
+        }
+    }
+    History.count = 0;
+}
+
+/**
+ * @brief Appends one minute; O(1), the open block is packed every HISTORY_BLOCK minutes.
+ *
+ * @param value Stored value of every channel, within the channel bits.
+ */
+void History_Append(const uint16_t *value) {
+    uint16_t bit = History_OpenBit(0, History.count);
+
+    for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+        for (uint8_t n = pgm_read_byte(&historyChannels[ch].bits); n--; bit++) {
+            uint8_t mask = 0x80 >> (bit & 7);
+            if ((value[ch] >> n) & 1)
+                History.open[bit >> 3] |= mask;
+            else
+                History.open[bit >> 3] &= ~mask;
+        }
+    }
+    History.count++;
+    History.minutes++;
+    if (History.count == HISTORY_BLOCK)
+        History_Close();
+}
+
+/**
+ * @brief Reduces the inputs of the passes of the minute to stored values and appends them.
+ */
+static void History_Minute() {
+    uint16_t value[HISTORY_CHANNELS];
+
+    for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+        uint32_t v = History.sum[ch];
+        uint8_t divisor = pgm_read_byte(&historyChannels[ch].divisor);
+        uint16_t limit = (1U << pgm_read_byte(&historyChannels[ch].bits)) - 1;
+
+        if (pgm_read_byte(&historyChannels[ch].mode) == HISTORY_MEAN)
+            v = (v + History.samples / 2) / History.samples;
+        v = (v + divisor / 2) / divisor;
+        value[ch] = (v > limit) ? limit : v;
+        History.sum[ch] = 0;
+    }
+    History.samples = 0;
+    History_Append(value);
+}
+
+/**
+ * @brief Accumulates the channel inputs of this pass and appends the minute when it is over.
+ *
+ * Call from the main loop. The first pass after the end of a minute closes it and then starts
+ * the next one. Means take the first pass of the minute and then one pass every
+ * HISTORY_SAMPLE_MS, whatever the pass rate: the mean covers the whole minute with equal weight
+ * in time, and the sums stay within 32 bits. The highest and last values look at every pass.
+ */
+void History_Task() {
+    uint32_t now = Timer_ms();
+
+    if (History.samples == 0 && History.minutes == 0) {
+        History.nextMinute = now + HISTORY_PERIOD_MS;
+        History.nextSample = now;
+    } else if ((int32_t)(now - History.nextMinute) >= 0) {
+        History.nextMinute += HISTORY_PERIOD_MS;
+        if ((int32_t)(now - History.nextMinute) >= 0) // Fell behind by more than a minute: restart the grid
+            History.nextMinute = now + HISTORY_PERIOD_MS;
+        History_Minute();
+        History.nextSample = now;
+    }
+
+    uint8_t sample = (int32_t)(now - History.nextSample) >= 0;
+    if (sample) {
+        History.nextSample += HISTORY_SAMPLE_MS;
+        if ((int32_t)(now - History.nextSample) >= 0) // Slow pass: one sample, then a grid from now
+            History.nextSample = now + HISTORY_SAMPLE_MS;
+    }
+
+    for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+        int32_t x = History_Input(ch) + pgm_read_word(&historyChannels[ch].offset);
+        uint32_t input = (x > 0) ? x : 0;
+        uint8_t mode = pgm_read_byte(&historyChannels[ch].mode);
+
+        if (mode == HISTORY_MEAN) {
+            if (sample)
+                History.sum[ch] += input;
+        } else if (mode == HISTORY_LAST || History.samples == 0 || input > History.sum[ch]) {
+            History.sum[ch] = input;
+        }
+    }
+    History.samples += sample;
+}
+
+/**
+ * @brief Positions a reader at a minute.
+ *
+ * @param r Reader.
+ * @param ch history_channel_t.
+ * @param minute Minute of the first value History_Next() returns.
+ * @return 1 if the minute is in the store.
+ */
+uint8_t History_Seek(HistoryReader *r, uint8_t ch, uint32_t minute) {
+    r->channel = ch;
+    r->minute = minute;
+    r->left = 0;
+    return minute >= HISTORY_OLDEST() && minute < History.minutes;
+}
+
+/**
+ * @brief Returns the value of the reader's minute and moves to the next minute.
+ *
+ * Within a block every value costs one code; the first value of a block, and the first one after
+ * History_Seek(), looks the block up in the index and skips to the minute. Appends between
+ * calls are allowed: once the reader's minute has been dropped it returns 0.
+ *
+ * @param r Reader.
+ * @param value Receives the stored value.
+ * @return 1 if a value was returned, 0 if the minute is not (or no longer) in the store.
+ */
+uint8_t History_Next(HistoryReader *r, uint16_t *value) {
+    uint32_t oldest = HISTORY_OLDEST();
+    uint32_t closed = History.minutes - History.count;
+
+    if (r->minute < oldest || r->minute >= History.minutes)
+        return 0;
+    if (r->minute >= closed) { // Open block: raw values
+        r->value = History_OpenGet(r->channel, r->minute - closed);
+        r->left = 0;
+    } else if (r->left) {
+        History_Code(r);
+    } else {
+        uint32_t offset = r->minute - oldest;
+        uint16_t bit = History.index[(History.head + offset / HISTORY_BLOCK) % HISTORY_GROUPS] * 8;
+
+        for (uint8_t ch = 0; ch <= r->channel; ch++) { // Earlier channel blocks are decoded to skip them
+            History_Header(&bit, ch, r);
+            r->bit = bit;
+            r->left = HISTORY_BLOCK - 1;
+            while (ch < r->channel && r->left)
+                History_Code(r);
+            bit = r->bit;
+        }
+        for (uint8_t i = offset % HISTORY_BLOCK; i; i--)
+            History_Code(r);
+    }
+    *value = r->value;
+    r->minute++;
+    return 1;
+}
+
+/**
+ * @brief Random access to one value.
+ *
+ * @param ch history_channel_t.
+ * @param minute Minute after start-up.
+ * @param value Receives the stored value.
+ * @return 1 if the minute is in the store.
+ */
+uint8_t History_Read(uint8_t ch, uint32_t minute, uint16_t *value) {
+    HistoryReader r;
+
+    History_Seek(&r, ch, minute);
+    return History_Next(&r, value);
+}
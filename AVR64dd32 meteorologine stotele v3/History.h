@@ -0,0 +1,123 @@
+/**
+ * @file History.h
+ * @brief Header file for the compressed 1-minute history of the station channels.
+ *
+ * Every minute one value per channel is appended: the mean of the values sampled every
+ * HISTORY_SAMPLE_MS during that minute (the wind gust is the maximum of every main loop pass, the
+ * wind direction the last value), quantised to the channel resolution in historyChannels[] (HistoryVar.h). A day of raw values
+ * would need 20 KB; the store packs them into HISTORY_POOL_SIZE bytes:
+ *
+ *  - the open block collects HISTORY_BLOCK raw values per channel, one row of HISTORY_ROW_BITS
+ *    per minute with every channel at its own width,
+ *  - when it is full every channel is packed into one group: per channel the first value and the
+ *    zigzag coded differences to the previous value as Rice codes, the high part in unary and the
+ *    low k bits as they are. k is chosen per block for the fewest bits, so the code width follows
+ *    the activity of the channel: a steady block costs about one bit per value, a constant one
+ *    (the light level at night) nothing but its header,
+ *  - groups go into a circular byte pool; the oldest groups are dropped when a new one does not
+ *    fit. The block index holds the start of every group, so any minute is found by decoding at
+ *    most HISTORY_CHANNELS blocks of the group, which takes well under a millisecond.
+ *
+ * Channel block layout (bits, MSB first): k (HISTORY_WIDTH_BITS, HISTORY_CONSTANT = no codes),
+ * first value (channel bits), HISTORY_BLOCK - 1 codes of q ones, a zero and k low bits.
+ *
+ * Minute n is the n-th minute after start-up. tools/history_compression.py checks the round trip
+ * and reports the bytes per sample and the retained hours on recorded or synthetic traces: 0.23 B
+ * per sample and 26 h on a calm day, 0.32 B and 19 h with strong gusty wind and broken cloud,
+ * where the wind speed and gust channels alone take a third of the pool.
+ *
+ * @author Saulius
+ * @date 2025-01-21
+ */
+
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#define HISTORY_PERIOD_MS 60000UL /**< One value per channel per minute */
+#define HISTORY_BLOCK 32          /**< Values per channel block */
+#define HISTORY_POOL_SIZE 2560    /**< Bytes of packed groups (at most 8191); tools/ram_usage.py checks what is left */
+#define HISTORY_GROUPS 64         /**< Block index entries: 34 h of groups */
+#define HISTORY_WIDTH_BITS 4      /**< Rice parameter 0 ... 13 */
+#define HISTORY_CONSTANT 15       /**< Rice parameter of a block whose values are all equal */
+#define HISTORY_SAMPLE_MS 10      /**< Mean sample period: at most 6001 samples a minute, sums within 32 bits for inputs below 715000 */
+#define HISTORY_ROW_BITS 56       /**< Bits of one open block row: the sum of the channel bits (HistoryVar.h) */
+
+/**
+ * @brief History channels.
+ */
+typedef enum {
+    HISTORY_PRESSURE,    /**< Pressure, 0.1 hPa */
+    HISTORY_TEMPERATURE, /**< SHT21 temperature, 0.1 C from -60 C */
+    HISTORY_HUMIDITY,    /**< SHT21 relative humidity, 1 % */
+    HISTORY_WIND_SPEED,  /**< Mean wind speed, 0.5 m/s */
+    HISTORY_WIND_GUST,   /**< Highest wind speed of the minute, 0.5 m/s */
+    HISTORY_WIND_DIR,    /**< Last wind direction index (0 = North ... 7) */
+    HISTORY_SUN,         /**< Light level, 4 mV */
+    HISTORY_CHANNELS     /**< Number of channels */
+} history_channel_t;
+
+/**
+ * @brief How the values of one minute are reduced to the stored value.
+ */
+typedef enum {
+    HISTORY_MEAN, /**< Mean of the passes */
+    HISTORY_MAX,  /**< Highest value */
+    HISTORY_LAST  /**< Value at the end of the minute */
+} history_mode_t;
+
+/**
+ * @brief Quantisation of one channel (PROGMEM).
+ *
+ * Stored value = (input + offset) / divisor, rounded and limited to bits.
+ */
+typedef struct {
+    uint16_t offset; /**< Added to the input so that the stored value is not negative */
+    uint8_t divisor; /**< Input units per stored unit */
+    uint8_t bits;    /**< Width of the stored value (at most 14) */
+    uint8_t mode;    /**< history_mode_t */
+} HistoryChannel;
+
+/**
+ * @brief Sequential decoder of one channel, see History_Seek() and History_Next().
+ */
+typedef struct {
+    uint32_t minute;  /**< Minute of the next value */
+    uint16_t bit;     /**< Pool bit of the next code */
+    uint16_t value;   /**< Last decoded value */
+    uint8_t channel;  /**< history_channel_t */
+    uint8_t bits;     /**< Width of the channel values */
+    uint8_t width;    /**< Rice parameter of the current block */
+    uint8_t left;     /**< Codes left in the current block, 0 = find the block of minute */
+} HistoryReader;
+
+/**
+ * @brief History store: packed groups, block index, open block and the minute accumulators.
+ */
+typedef struct {
+    uint8_t pool[HISTORY_POOL_SIZE];   /**< Packed groups, circular */
+    uint16_t index[HISTORY_GROUPS];    /**< Pool byte of every group, circular from head */
+    uint8_t head;                      /**< Index entry of the oldest group */
+    uint8_t groups;                    /**< Groups in the pool */
+    uint16_t used;                     /**< Pool bytes in use */
+    uint8_t open[HISTORY_BLOCK * HISTORY_ROW_BITS / 8]; /**< Values of the open block, one row per minute */
+    uint8_t count;                     /**< Values in the open block */
+    uint32_t minutes;                  /**< Minutes appended since start-up */
+    uint32_t dropped;                  /**< Groups dropped to make room */
+
+    uint32_t nextMinute;               /**< End of the current minute (Timer_ms()) */
+    uint32_t nextSample;               /**< Next mean sample (Timer_ms()) */
+    uint32_t sum[HISTORY_CHANNELS];    /**< Sum (mean), highest or last input of the minute */
+    uint16_t samples;                  /**< Mean samples in the current minute */
+} HistoryStore;
+
+/**
+ * @brief Global history store.
+ */
+extern HistoryStore History;
+
+/**
+ * @brief Oldest minute in the store.
+ */
+#define HISTORY_OLDEST() (History.minutes - History.count - (uint32_t)History.groups * HISTORY_BLOCK)
+
+#endif /* HISTORY_H_ */
@@ -0,0 +1,41 @@
+/**
+ * @file HistoryVar.h
+ * @brief Variable definitions and channel quantisation of the history store.
+ *
+ * Resolutions follow the synoptic reporting steps (0.1 hPa, 0.1 C, 1 %, 0.5 m/s) rather than the
+ * sensor resolution: every halving of the step costs about one more bit per sample, and the
+ * history is for graphs and statistics, not for calibration.
+ *
+ * @author Saulius
+ * @date 2025-01-21
+ */
+
+#ifndef HISTORYVAR_H_
+#define HISTORYVAR_H_
+
+/**
+ * @brief Global history store, empty; the first minute starts on the first History_Task().
+ */
+HistoryStore History = {
+    .groups = 0,
+    .count = 0,
+    .minutes = 0,
+    .samples = 0
+};
+
+/**
+ * @brief Quantisation of every channel, inputs in the units of History_Input().
+ *
+ * Stored steps: 0.1 hPa, 0.1 C, 1 %, 0.5 m/s, 0.5 m/s, one sector, 4 mV.
+ */
+const HistoryChannel historyChannels[HISTORY_CHANNELS] PROGMEM = { // Bits add up to HISTORY_ROW_BITS
+    [HISTORY_PRESSURE]    = { .offset = 0,    .divisor = 10, .bits = 14, .mode = HISTORY_MEAN }, /**< Input 0.01 hPa */
+    [HISTORY_TEMPERATURE] = { .offset = 6000, .divisor = 10, .bits = 11, .mode = HISTORY_MEAN }, /**< Input 0.01 C */
+    [HISTORY_HUMIDITY]    = { .offset = 0,    .divisor = 10, .bits = 7,  .mode = HISTORY_MEAN }, /**< Input 0.1 % */
+    [HISTORY_WIND_SPEED]  = { .offset = 0,    .divisor = 50, .bits = 6,  .mode = HISTORY_MEAN }, /**< Input 0.01 m/s */
+    [HISTORY_WIND_GUST]   = { .offset = 0,    .divisor = 50, .bits = 6,  .mode = HISTORY_MAX },  /**< Input 0.01 m/s */
+    [HISTORY_WIND_DIR]    = { .offset = 0,    .divisor = 1,  .bits = 3,  .mode = HISTORY_LAST }, /**< Direction index */
+    [HISTORY_SUN]         = { .offset = 0,    .divisor = 4,  .bits = 9,  .mode = HISTORY_MEAN }, /**< Input mV */
+};
+
+#endif /* HISTORYVAR_H_ */
@@ -14,6 +14,23 @@
 #include "Settings.h"
 #include "Keypad3x4Var.h"
 
+/**
+ * @brief Drives one keypad row low and returns the key of the first column reading low.
+ *
+ * Unrolled per row: CBI/SBI on the row, SBIC on each column; the two NOPs cover the input
+ * synchroniser between driving the row and reading the columns.
+ */
+#define KEYPAD_ROW(row, first) \
+    GPIO_LOW(row); \
+    _NOP(); \
+    _NOP(); \
+    key = GPIO_IS_LOW(KEYPAD_COL1) ? (first) \
+        : GPIO_IS_LOW(KEYPAD_COL2) ? (first) + 1 \
+        : GPIO_IS_LOW(KEYPAD_COL3) ? (first) + 2 : 0; \
+    GPIO_HIGH(row); \
+    if (key) \
+        return key
+
 /**
  * @brief Scans the 3x4 keypad for pressed keys.
  * 
@@ -24,25 +41,12 @@
  * @return uint8_t The key number (1-12), or 0 if no key is pressed.
  */
 uint8_t scan_keypad() {
-    uint8_t row_pins[4] = {PIN7_bm, PIN6_bm, PIN3_bm, PIN2_bm}; ///< Row pins
-    uint8_t col_pins[3] = {PIN1_bm, PIN4_bm, PIN3_bm}; ///< Column pins
+    uint8_t key;
 
-    for (uint8_t row = 0; row < 4; row++) {
-        PORTD.OUTCLR = row_pins[row]; // Set the current row pin low
-        uint8_t pin_state = 0;
-        for (uint8_t col = 0; col < 3; col++) {
-            if (col == 0) {
-                pin_state = (!(PORTD.IN & col_pins[col])); // Read from PORTD
-            } else {
-                pin_state = (!(PORTF.IN & col_pins[col])); // Read from PORTF
-            }
-            if (pin_state) {
-                PORTD.OUTSET = row_pins[row]; // Reset the row pin
-                return ((row * 3) + col + 1); // Return the key number
-            }
-        }
-        PORTD.OUTSET = row_pins[row]; // Reset the row pin
-    }
+    KEYPAD_ROW(KEYPAD_ROW1, 1);
+    KEYPAD_ROW(KEYPAD_ROW2, 4);
+    KEYPAD_ROW(KEYPAD_ROW3, 7);
+    KEYPAD_ROW(KEYPAD_ROW4, 10);
     return 0; // No key pressed
 }
 
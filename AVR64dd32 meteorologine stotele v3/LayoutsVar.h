@@ -0,0 +1,135 @@
+/**
+ * @file LayoutsVar.h
+ * @brief PROGMEM bitmaps and span tables of the pre-rendered static screen labels.
+ *
+ * Generated by tools/render_layouts.py from font.h - do not edit by hand.
+ * Included by ST7567S.c only.
+ */
+
+#ifndef LAYOUTSVAR_H_
+#define LAYOUTSVAR_H_
+
+/** @brief Column bitmaps of all labels, one byte per display column (bit 0 = top row). */
+const uint8_t label_bitmap[1248] PROGMEM = {
+    0x01, 0x01, 0x7F, 0x01, 0x01, 0x00, 0x38, 0x54, 0x54, 0x54, 0x18, 0x00, 0x7C, 0x04, 0x18, 0x04,
+    0x78, 0x00, 0x7C, 0x14, 0x14, 0x14, 0x08, 0x00, 0x38, 0x54, 0x54, 0x54, 0x18, 0x00, 0x7C, 0x08,
+    0x04, 0x04, 0x08, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00,
+    0x3C, 0x40, 0x40, 0x20, 0x7C, 0x00, 0x7C, 0x08, 0x04, 0x04, 0x08, 0x00, 0x38, 0x54, 0x54, 0x54,
+    0x18, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x7F, 0x09, 0x09, 0x09, 0x06, 0x00, 0x7C, 0x08,
+    0x04, 0x04, 0x08, 0x00, 0x38, 0x54, 0x54, 0x54, 0x18, 0x00, 0x48, 0x54, 0x54, 0x54, 0x20, 0x00,
+    0x48, 0x54, 0x54, 0x54, 0x20, 0x00, 0x3C, 0x40, 0x40, 0x20, 0x7C, 0x00, 0x7C, 0x08, 0x04, 0x04,
+    0x08, 0x00, 0x38, 0x54, 0x54, 0x54, 0x18, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x7F, 0x08,
+    0x08, 0x08, 0x7F, 0x00, 0x3C, 0x40, 0x40, 0x20, 0x7C, 0x00, 0x7C, 0x04, 0x18, 0x04, 0x78, 0x00,
+    0x00, 0x44, 0x7D, 0x40, 0x00, 0x00, 0x38, 0x44, 0x44, 0x48, 0x7F, 0x00, 0x00, 0x44, 0x7D, 0x40,
+    0x00, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00, 0x0C, 0x50, 0x50, 0x50, 0x3C, 0x00, 0x00, 0x36,
+    0x36, 0x00, 0x00, 0x00, 0x3F, 0x40, 0x38, 0x40, 0x3F, 0x00, 0x00, 0x44, 0x7D, 0x40, 0x00, 0x00,
+    0x7C, 0x08, 0x04, 0x04, 0x78, 0x00, 0x38, 0x44, 0x44, 0x48, 0x7F, 0x00, 0x00, 0x36, 0x36, 0x00,
+    0x00, 0x00, 0x7F, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, 0x44, 0x7D, 0x40, 0x00, 0x00, 0x08, 0x14,
+    0x54, 0x54, 0x3C, 0x00, 0x7F, 0x08, 0x04, 0x04, 0x78, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x41, 0x7F, 0x40, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54,
+    0x18, 0x00, 0x1C, 0x20, 0x40, 0x20, 0x1C, 0x00, 0x38, 0x54, 0x54, 0x54, 0x18, 0x00, 0x00, 0x41,
+    0x7F, 0x40, 0x00, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00,
+    0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08,
+    0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08,
+    0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00,
+    0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08,
+    0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08,
+    0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00,
+    0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08,
+    0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00, 0x00, 0x36,
+    0x36, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x44, 0x64, 0x54, 0x4C, 0x44, 0x00,
+    0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x06, 0x09, 0x09, 0x06, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54,
+    0x18, 0x00, 0x00, 0x41, 0x7F, 0x40, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x06, 0x09,
+    0x09, 0x06, 0x00, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00,
+    0x38, 0x44, 0x44, 0x48, 0x7F, 0x00, 0x20, 0x40, 0x44, 0x3D, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x18, 0x00, 0x00, 0x41,
+    0x7F, 0x40, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x06, 0x09, 0x09, 0x06, 0x00, 0x00,
+    0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00, 0x00, 0x60, 0x60, 0x00,
+    0x00, 0x00, 0x44, 0x64, 0x54, 0x4C, 0x44, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x41,
+    0x7F, 0x40, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00,
+    0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x09, 0x09, 0x06,
+    0x00, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x41, 0x7F, 0x40, 0x00, 0x00, 0x38, 0x44,
+    0x44, 0x44, 0x38, 0x00, 0x7C, 0x08, 0x04, 0x04, 0x78, 0x00, 0x08, 0x14, 0x54, 0x54, 0x3C, 0x00,
+    0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x09, 0x09, 0x06,
+    0x00, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x7F, 0x48, 0x44, 0x44, 0x38, 0x00, 0x7C, 0x04,
+    0x18, 0x04, 0x78, 0x00, 0x7C, 0x14, 0x14, 0x14, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x01, 0x7F, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x41, 0x41, 0x41,
+    0x22, 0x00, 0x06, 0x09, 0x09, 0x06, 0x00, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x48, 0x54,
+    0x54, 0x54, 0x20, 0x00, 0x7F, 0x08, 0x04, 0x04, 0x78, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x7F, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x3E, 0x41, 0x41, 0x41, 0x22, 0x00, 0x06, 0x09, 0x09, 0x06, 0x00, 0x00, 0x00, 0x36,
+    0x36, 0x00, 0x00, 0x00, 0x7C, 0x14, 0x14, 0x14, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x7F, 0x08, 0x04, 0x04, 0x78, 0x00, 0x7F, 0x09, 0x09, 0x09, 0x06, 0x00, 0x20, 0x54, 0x54, 0x54,
+    0x78, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x7C, 0x08, 0x04, 0x04, 0x08, 0x00, 0x7F, 0x08,
+    0x04, 0x04, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x23, 0x13, 0x08, 0x64, 0x62, 0x00,
+    0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x7C, 0x08, 0x04, 0x04, 0x78, 0x00, 0x38, 0x44, 0x44, 0x44,
+    0x38, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x54,
+    0x54, 0x54, 0x78, 0x00, 0x38, 0x44, 0x44, 0x48, 0x7F, 0x00, 0x20, 0x40, 0x44, 0x3D, 0x00, 0x00,
+    0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x00, 0x41, 0x7F, 0x40,
+    0x00, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x18, 0x04, 0x78, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00,
+    0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x38, 0x44, 0x44, 0x48, 0x7F, 0x00, 0x20, 0x40, 0x44, 0x3D,
+    0x00, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x00, 0x41,
+    0x7F, 0x40, 0x00, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x18, 0x04, 0x78, 0x00, 0x00, 0x36, 0x36, 0x00,
+    0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x1C, 0x20, 0x40, 0x20, 0x1C, 0x00, 0x08, 0x14,
+    0x54, 0x54, 0x3C, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00,
+    0x00, 0x41, 0x7F, 0x40, 0x00, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00, 0x00, 0x60, 0x60, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x18, 0x04, 0x78, 0x00, 0x00, 0x36,
+    0x36, 0x00, 0x00, 0x00, 0x7C, 0x08, 0x04, 0x04, 0x08, 0x00, 0x00, 0x41, 0x7F, 0x40, 0x00, 0x00,
+    0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x00, 0x41, 0x7F, 0x40,
+    0x00, 0x00, 0x04, 0x3F, 0x44, 0x40, 0x20, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x18, 0x04, 0x78, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00,
+    0x3C, 0x40, 0x30, 0x40, 0x3C, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x54,
+    0x20, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x04,
+    0x18, 0x04, 0x78, 0x00, 0x20, 0x10, 0x08, 0x04, 0x02, 0x00, 0x48, 0x54, 0x54, 0x54, 0x20, 0x00,
+    0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x30, 0x40, 0x3C, 0x00, 0x00, 0x60, 0x60, 0x00,
+    0x00, 0x00, 0x38, 0x44, 0x44, 0x48, 0x7F, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x7C, 0x08,
+    0x04, 0x04, 0x78, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x7F, 0x40, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x41, 0x7F, 0x40,
+    0x00, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x04,
+    0x18, 0x04, 0x78, 0x00, 0x1F, 0x20, 0x40, 0x20, 0x1F, 0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00,
+};
+
+/** @brief Offset and width of every label inside `label_bitmap`. */
+const LabelBitmap label_index[LABEL_COUNT] PROGMEM = {
+    {    0,  72 }, /**< LABEL_TEMPERATURE */
+    {   72,  54 }, /**< LABEL_PRESSURE */
+    {  126,  54 }, /**< LABEL_HUMIDITY */
+    {  180,  30 }, /**< LABEL_WIND */
+    {  210,  72 }, /**< LABEL_LIGHT */
+    {  282, 126 }, /**< LABEL_SEPARATOR */
+    {  408,  12 }, /**< LABEL_TIME */
+    {  420,  24 }, /**< LABEL_AZIMUTH */
+    {  444,  30 }, /**< LABEL_ELEVATION */
+    {  474,  60 }, /**< LABEL_ADJ_ELEVATION */
+    {  534,  24 }, /**< LABEL_TIMEZONE */
+    {  558,  42 }, /**< LABEL_LATITUDE */
+    {  600,  48 }, /**< LABEL_LONGITUDE */
+    {  648,  54 }, /**< LABEL_BMP_T */
+    {  702,  54 }, /**< LABEL_SHT_T */
+    {  756,  36 }, /**< LABEL_P */
+    {  792,  30 }, /**< LABEL_RH */
+    {  822,  90 }, /**< LABEL_UNCOMP_ALT */
+    {  912,  66 }, /**< LABEL_COMP_ALT */
+    {  978,  66 }, /**< LABEL_AVRG_ALT */
+    { 1044,  60 }, /**< LABEL_REAL_ALT */
+    { 1104,  54 }, /**< LABEL_WIND_SPEED */
+    { 1158,  42 }, /**< LABEL_WIND_DIR */
+    { 1200,  48 }, /**< LABEL_LIGHT_LEVEL */
+};
+
+/** @brief Label placements of all layouts. */
+const LayoutSpan layout_spans[6] PROGMEM = {
+    { LABEL_TEMPERATURE, 0, 0 },
+    { LABEL_PRESSURE, 1, 0 },
+    { LABEL_HUMIDITY, 2, 0 },
+    { LABEL_WIND, 3, 0 },
+    { LABEL_LIGHT, 4, 0 },
+    { LABEL_SEPARATOR, 5, 0 },
+};
+
+/** @brief First span of every layout in `layout_spans` (the last entry closes the list). */
+const uint8_t layout_first[LAYOUT_COUNT + 1] PROGMEM = { 0, 6 };
+
+#endif /* LAYOUTSVAR_H_ */
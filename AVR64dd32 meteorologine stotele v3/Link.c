@@ -0,0 +1,560 @@
+/**
+ * @file Link.c
+ * @brief Protocol multiplexer on USART0: message classification in the receive interrupt,
+ *        console, Modbus RTU, binary command and bootloader handlers in the main loop.
+ *
+ * Binary frame (the reply has the same layout, the CRC-16/CCITT covers command ... payload):
+ *
+ *     LINK_SYNC0 | LINK_SYNC1 | command | length | payload (length bytes) | CRC high | CRC low
+ *
+ * Modbus input and holding registers (functions 3 and 4, the same map): telemetry field n
+ * (telemetry_field_t) is the signed 32-bit fixed-point value of the CSV record, high word in
+ * register 2n, low word in register 2n + 1.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#include "Settings.h"
+#include "LinkVar.h"
+
+_Static_assert(!LINK_IS_TEXT(LINK_MODBUS_ADDRESS) && LINK_MODBUS_ADDRESS != LINK_SYNC0,
+               "the Modbus address must not look like text or a binary frame");
+_Static_assert(!LINK_IS_TEXT(LINK_SYNC0), "the binary sync byte must not look like text");
+_Static_assert(LINK_GAP_TICKS < 2 * (TIMER_TCB0_CCMP + 1), "Link_Silence() measures up to two ticks");
+_Static_assert(5 + 2 * LINK_MODBUS_MAX_REGISTERS <= POOL_BLOCK_SIZE, "a Modbus reply is built in one block");
+_Static_assert(6 + LINK_PROTOCOLS * sizeof(LinkCounters) + 2 <= POOL_BLOCK_SIZE, "the counters reply fits one block");
+_Static_assert(6 + 1 + LINK_EVENTS_MAX * sizeof(EventRecord) <= POOL_BLOCK_SIZE, "the event log reply fits one block");
+
+#define LINK_RX_ERRORS (USART_BUFOVF_bm | USART_FERR_bm | USART_PERR_bm) /**< RXDATAH error flags */
+
+/**
+ * @brief Time of the last byte now, and the TCB0 counts since the previous one.
+ *
+ * Runs with interrupts disabled. Reading TCB0.CNT before the flag tells a wrap that has not
+ * reached Timer.ms yet from one that happened after the read, as in Timer_us().
+ *
+ * @param ms Receives the millisecond tick now (low 16 bits).
+ * @param tick Receives the TCB0 count now.
+ * @return Counts since the last byte, UINT16_MAX after two ticks or more.
+ */
+static inline uint16_t Link_Silence(uint16_t *ms, uint16_t *tick) {
+    uint16_t count = TCB0.CNT;
+    uint16_t now = (uint16_t)Timer.ms;
+    if ((TCB0.INTFLAGS & TCB_CAPT_bm) && count < TIMER_TCB0_CCMP / 2)
+        now++;
+    *ms = now;
+    *tick = count;
+    uint16_t ticks = now - Link.ms;
+    if (ticks > 2)
+        return UINT16_MAX;
+    uint16_t silence = count - Link.tick;
+    if (ticks)
+        silence += TIMER_TCB0_CCMP + 1;
+    if (ticks == 2)
+        silence += TIMER_TCB0_CCMP + 1;
+    return silence;
+}
+
+/**
+ * @brief Ends the message being received, interrupts disabled.
+ *
+ * A clean Modbus frame waits for Link_Task(); skipped noise counts as a message, anything cut
+ * short as an error.
+ */
+static inline void Link_End() {
+    uint8_t protocol = Link.protocol;
+    if (protocol == LINK_MODBUS && !Link.bad)
+        Link.ready = LINK_MODBUS;
+    else if (protocol == LINK_NOISE)
+        Link.counters[LINK_NOISE].messages++;
+    else
+        Link.counters[protocol].errors++;
+    Link.protocol = LINK_IDLE;
+}
+
+/**
+ * @brief Turns the message being received into noise: counts the error, skips to the next silence.
+ *
+ * @return LINK_NOISE.
+ */
+static inline uint8_t Link_Reject(uint8_t protocol) {
+    Link.counters[protocol].errors++;
+    return LINK_NOISE;
+}
+
+/**
+ * @brief Console byte: builds the line, CR or LF completes it, backspace and DEL delete.
+ *
+ * @param silence Counts since the previous byte.
+ * @return Protocol of the next byte.
+ */
+static inline uint8_t Link_ConsoleByte(uint8_t c, uint16_t silence) {
+    uint8_t length = Link.length;
+    if (!LINK_IS_TEXT(c))
+        return Link_Reject(LINK_CONSOLE);
+    if (c == ' ' && length == 1 && Link.frame[0] == '0' && silence < LINK_CHAR_GAP_TICKS) {
+        Link.ready = LINK_BOOT; // STK_GET_SYNC, CRC_EOP: typed by a programmer, not a person
+        return LINK_IDLE;
+    }
+    if (c == '\r' || c == '\n') {
+        if (!length)
+            return LINK_CONSOLE; // Empty line, or the LF of CR LF
+        Link.frame[length] = 0;
+        if (Link.bad)
+            Link.counters[LINK_CONSOLE].errors++;
+        else
+            Link.ready = LINK_CONSOLE;
+        return LINK_IDLE;
+    }
+    if (c == '\b' || c == 0x7F) {
+        if (length)
+            Link.length = length - 1;
+    } else if (length < LINK_FRAME_SIZE - 1) {
+        Link.frame[length] = c;
+        Link.length = length + 1;
+    } else {
+        Link.bad = 1; // Too long, dropped at its end
+    }
+    return LINK_CONSOLE;
+}
+
+/**
+ * @brief Modbus byte: appended until the silence that ends the frame.
+ *
+ * @return Protocol of the next byte.
+ */
+static inline uint8_t Link_ModbusByte(uint8_t c, uint16_t silence) {
+    uint8_t length = Link.length;
+    if (length && silence > LINK_CHAR_GAP_TICKS)
+        Link.bad = 1; // Pause inside the frame
+    if (length < LINK_FRAME_SIZE) {
+        Link.frame[length] = c;
+        Link.length = length + 1;
+    } else {
+        Link.bad = 1;
+    }
+    return LINK_MODBUS;
+}
+
+/**
+ * @brief Binary byte: checks the sync and the length, completes the frame at its length.
+ *
+ * @return Protocol of the next byte.
+ */
+static inline uint8_t Link_BinaryByte(uint8_t c, uint16_t silence) {
+    uint8_t length = Link.length;
+    if (length && silence > LINK_CHAR_GAP_TICKS)
+        Link.bad = 1;
+    Link.frame[length++] = c;
+    Link.length = length;
+    if (length == 2 && c != LINK_SYNC1)
+        return Link_Reject(LINK_BINARY);
+    if (length == 4) {
+        if (c > LINK_FRAME_SIZE - 6)
+            return Link_Reject(LINK_BINARY);
+        Link.need = c + 6;
+    }
+    if (length == Link.need) {
+        if (Link.bad)
+            Link.counters[LINK_BINARY].errors++;
+        else
+            Link.ready = LINK_BINARY;
+        return LINK_IDLE;
+    }
+    return LINK_BINARY;
+}
+
+/**
+ * @brief Initializes the receiver: enables the USART0 receive complete interrupt.
+ *
+ * USART0_init() has set up the port; the transmitter keeps its interrupt driven queue.
+ */
+void Link_init() {
+    Link.protocol = LINK_IDLE;
+    Link.ready = LINK_IDLE;
+    USART0.CTRLA |= USART_RXCIE_bm;
+}
+
+/**
+ * @brief USART0 receive complete interrupt: classifies and collects the message.
+ *
+ * A byte after LINK_GAP_US of silence starts a new message (a console line goes on while text
+ * comes), its first byte selects the protocol. Calls no functions and takes constant time, so it
+ * keeps up with a byte every 96 CPU cycles at 2.5 Mbit/s. While a message waits for Link_Task()
+ * the bytes are dropped and counted.
+ */
+ISR(USART0_RXC_vect) {
+    uint8_t flags = USART0.RXDATAH; // Error flags belong to the byte in RXDATAL, read them first
+    uint8_t c = USART0.RXDATAL;
+    uint16_t ms, tick;
+    uint16_t silence = Link_Silence(&ms, &tick);
+    Link.ms = ms;
+    Link.tick = tick;
+
+    if (Link.ready != LINK_IDLE) {
+        if (c != '\n' && c != '\r') // The LF of a CR LF line end is expected
+            Link.dropped++;
+        return;
+    }
+    uint8_t protocol = Link.protocol;
+    if (protocol != LINK_IDLE && silence >= LINK_GAP_TICKS && !(protocol == LINK_CONSOLE && LINK_IS_TEXT(c))) {
+        Link_End();
+        if (Link.ready != LINK_IDLE) { // The frame before the silence waits, this one is lost
+            Link.dropped++;
+            return;
+        }
+        protocol = LINK_IDLE;
+    }
+    if (protocol == LINK_IDLE) {
+        Link.length = 0;
+        Link.bad = 0;
+        Link.need = 0;
+        if (LINK_IS_TEXT(c))
+            protocol = LINK_CONSOLE;
+        else if (c == LINK_MODBUS_ADDRESS || c == 0)
+            protocol = LINK_MODBUS;
+        else if (c == LINK_SYNC0)
+            protocol = LINK_BINARY;
+        else
+            protocol = LINK_NOISE;
+    }
+    Link.counters[protocol].bytes++;
+    if (flags & LINK_RX_ERRORS)
+        Link.bad = 1;
+
+    switch (protocol) {
+        case LINK_CONSOLE:
+            protocol = Link_ConsoleByte(c, silence);
+            break;
+        case LINK_MODBUS:
+            protocol = Link_ModbusByte(c, silence);
+            break;
+        case LINK_BINARY:
+            protocol = Link_BinaryByte(c, silence);
+            break;
+        default:
+            break; // Noise: skipped up to the next silence
+    }
+    Link.protocol = protocol;
+}
+
+/**
+ * @brief Adds one to a counter shared with the receive interrupt.
+ */
+static void Link_Count(uint16_t *counter) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        (*counter)++;
+    }
+}
+
+/**
+ * @brief Sends a Modbus reply built in a pool block, appending its CRC (low byte first).
+ */
+static void Link_ModbusSend(uint8_t block, uint8_t length) {
+    uint8_t *reply = (uint8_t *)Pool.data[block];
+    uint16_t crc = CRC16_Modbus_Update(CRC16_MODBUS_INIT, reply, length);
+    reply[length++] = crc & 0xFF;
+    reply[length++] = crc >> 8;
+    USART0_SendBlock(block, length);
+}
+
+/**
+ * @brief Handles a Modbus frame: reads of the telemetry registers, exceptions for the rest.
+ *
+ * @return 1 when the frame was valid.
+ */
+static uint8_t Link_Modbus() {
+    const uint8_t *request = Link.frame;
+    uint8_t length = Link.length;
+    if (length < 4 || CRC16_Modbus_Update(CRC16_MODBUS_INIT, request, length) != 0)
+        return 0; // Short frame or CRC error: a slave stays silent
+    if (request[0] == 0)
+        return 1; // Broadcast: no reply
+
+    uint8_t function = request[1];
+    uint8_t exception = 0;
+    uint16_t first = 0, count = 0;
+    if (function != LINK_MODBUS_READ_HOLDING && function != LINK_MODBUS_READ_INPUT) {
+        exception = LINK_MODBUS_BAD_FUNCTION;
+    } else if (length != 8) {
+        exception = LINK_MODBUS_BAD_VALUE;
+    } else {
+        first = ((uint16_t)request[2] << 8) | request[3];
+        count = ((uint16_t)request[4] << 8) | request[5];
+        if (!count || count > LINK_MODBUS_MAX_REGISTERS)
+            exception = LINK_MODBUS_BAD_VALUE;
+        else if (first >= 2 * TELEMETRY_FIELDS || count > 2 * TELEMETRY_FIELDS - first)
+            exception = LINK_MODBUS_BAD_ADDRESS;
+    }
+
+    uint8_t block = Pool_Take(POOL_LINK);
+    if (block == POOL_NONE)
+        return 1; // Counted in Pool.failures, the master retries
+    uint8_t *reply = (uint8_t *)Pool.data[block];
+    reply[0] = request[0];
+    if (exception) {
+        reply[1] = function | 0x80;
+        reply[2] = exception;
+        Link_ModbusSend(block, 3);
+        return 1;
+    }
+    Derived_Refresh(DERIVED_BIT(DERIVED_TRACKER) | DERIVED_BIT(DERIVED_DEW_POINT));
+    reply[1] = function;
+    reply[2] = 2 * count;
+    uint8_t *p = reply + 3;
+    for (uint16_t r = first; r < first + count; r++) {
+        int32_t value = Telemetry_Value(r >> 1);
+        uint16_t word = r & 1 ? (uint16_t)value : (uint16_t)((uint32_t)value >> 16);
+        *p++ = word >> 8;
+        *p++ = word & 0xFF;
+    }
+    Link_ModbusSend(block, 3 + 2 * count);
+    return 1;
+}
+
+/**
+ * @brief Sends a binary reply frame whose payload is in place in a pool block.
+ */
+static void Link_BinarySend(uint8_t block, uint8_t command, uint8_t length) {
+    uint8_t *reply = (uint8_t *)Pool.data[block];
+    reply[0] = LINK_SYNC0;
+    reply[1] = LINK_SYNC1;
+    reply[2] = command;
+    reply[3] = length;
+    uint16_t crc = CRC16_CCITT_Update(CRC16_CCITT_INIT, reply + 2, length + 2);
+    reply[4 + length] = crc >> 8;
+    reply[5 + length] = crc & 0xFF;
+    USART0_SendBlock(block, length + 6);
+}
+
+/**
+ * @brief Handles a binary command frame.
+ *
+ * @return 1 when the frame was valid.
+ */
+static uint8_t Link_Binary() {
+    const uint8_t *frame = Link.frame;
+    uint8_t length = frame[3];
+    uint16_t crc = CRC16_CCITT_Update(CRC16_CCITT_INIT, frame + 2, length + 2);
+    if (crc != (((uint16_t)frame[4 + length] << 8) | frame[5 + length]))
+        return 0;
+
+    uint8_t command = frame[2];
+    if (command == LINK_CMD_RECORD && length == 1 && frame[4] <= TELEMETRY_ROTATION) {
+        Telemetry_SendStation(frame[4]);
+        return 1;
+    }
+    uint8_t block = Pool_Take(POOL_LINK);
+    if (block == POOL_NONE)
+        return 1;
+    uint8_t *payload = (uint8_t *)Pool.data[block] + 4;
+    if (command == LINK_CMD_COUNTERS && !length) {
+        uint8_t size = 0;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            memcpy(payload, Link.counters, sizeof Link.counters); // The AVR is little-endian
+            memcpy(payload + sizeof Link.counters, &Link.dropped, sizeof Link.dropped);
+            size = sizeof Link.counters + sizeof Link.dropped;
+        }
+        Link_BinarySend(block, command, size);
+    } else if (command == LINK_CMD_EVENTS && length == 1) {
+        EventRecord *records = (EventRecord *)(payload + 1);
+        uint8_t size = 0;
+        while (size < LINK_EVENTS_MAX && frame[4] + size < EventLog.count && EventLog_Read(frame[4] + size, &records[size]))
+            size++;
+        payload[0] = EventLog.count;
+        Link_BinarySend(block, command, 1 + size * sizeof(EventRecord));
+    } else {
+        Link_BinarySend(block, command | LINK_CMD_NAK, 0);
+    }
+    return 1;
+}
+
+/**
+ * @brief Sends the next lines of a console history download, if one is running.
+ *
+ * A line holds the stored values of one minute in the HistoryVar.h steps; the line "end" closes
+ * the download. The readers are positioned once per pass, so a pass decodes the channel blocks
+ * of its first minute and then one code per value. Minutes dropped from the store meanwhile are
+ * skipped.
+ */
+static void Link_History() {
+    HistoryReader r[HISTORY_CHANNELS];
+    uint16_t v[HISTORY_CHANNELS];
+    uint32_t oldest = HISTORY_OLDEST();
+
+    if (!Link.historyLeft)
+        return;
+    if (Link.historyMinute < oldest) {
+        uint32_t skip = oldest - Link.historyMinute;
+        Link.historyLeft -= (skip < Link.historyLeft) ? skip : Link.historyLeft - 1;
+        Link.historyMinute = oldest;
+    }
+    for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++)
+        History_Seek(&r[ch], ch, Link.historyMinute);
+    for (uint8_t n = 0; n < LINK_HISTORY_LINES && Link.historyLeft && Pool.used < POOL_BLOCKS - 1; n++) {
+        if (Link.historyLeft-- == 1) {
+            USART_printf(0, "end\r\n");
+            break;
+        }
+        for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++)
+            History_Next(&r[ch], &v[ch]);
+        USART_printf(0, "%lu %u %u %u %u %u %u %u\r\n", (unsigned long)Link.historyMinute, v[HISTORY_PRESSURE],
+                     v[HISTORY_TEMPERATURE], v[HISTORY_HUMIDITY], v[HISTORY_WIND_SPEED], v[HISTORY_WIND_GUST],
+                     v[HISTORY_WIND_DIR], v[HISTORY_SUN]);
+        Link.historyMinute++;
+    }
+}
+
+/**
+ * @brief Starts a console history download: "hist [count [first minute]]".
+ *
+ * Without a count LINK_HISTORY_MINUTES are sent, without a first minute the download ends with
+ * the newest minute. Both are clipped to the minutes in the store. Link_History() sends the
+ * lines over the next main loop passes.
+ */
+static void Link_HistoryStart(const char *arguments) {
+    char *end;
+    uint32_t oldest = HISTORY_OLDEST();
+    uint32_t count = strtoul(arguments, &end, 10);
+    const char *next = end;
+    uint32_t first = strtoul(next, &end, 10);
+
+    if (end == next || first > History.minutes)
+        first = History.minutes - ((next == arguments) ? LINK_HISTORY_MINUTES : count);
+    if ((int32_t)(first - oldest) < 0)
+        first = oldest;
+    if (next == arguments || count > History.minutes - first)
+        count = History.minutes - first;
+    USART_printf(0, "minute p t rh speed gust dir sun: %lu from %lu\r\n", (unsigned long)count, (unsigned long)first);
+    Link.historyMinute = first;
+    Link.historyLeft = count + 1; // The minutes and "end"
+}
+
+/**
+ * @brief Starts or ends a noise trace: "trace [channel level [osrs_t filter]]".
+ *
+ * The channel is a sampling_channel_t, the level 0 ... SAMPLING_OS_LEVELS - 1. For the pressure
+ * the BMP280 temperature oversampling (BMP280_Temperature_Os_x1 ... x16 codes, 1 ... 5) and IIR
+ * filter (BMP280_Filter_Off ... 16 codes, 0 ... 4) may follow; they stay set after the trace.
+ * Anything else ends the trace.
+ */
+static void Link_Trace(const char *arguments) {
+    char *end;
+    uint8_t ch = strtoul(arguments, &end, 10);
+    const char *next = end;
+    uint8_t level = strtoul(next, &end, 10);
+
+    if (end == next || ch >= SAMPLING_CHANNELS || level >= SAMPLING_OS_LEVELS) {
+        Sampling_Trace(SAMPLING_TRACE_OFF, 0);
+        USART_printf(0, "# trace off\r\n");
+        return;
+    }
+    if (ch == SAMPLING_PRESSURE) {
+        next = end;
+        uint8_t osrs = strtoul(next, &end, 10);
+        if (end != next && osrs >= BMP280_Temperature_Os_x1 && osrs <= BMP280_Temperature_Os_x16)
+            BMP280.Config.osrs_t = osrs; // Sent with the next trigger
+        next = end;
+        uint8_t filter = strtoul(next, &end, 10);
+        if (end != next && filter <= BMP280_Filter_16) {
+            BMP280.Config.filter = filter;
+            Redundant_WriteBMP280Config();
+        }
+        USART_printf(0, "# osrs_t %u filter %u\r\n", BMP280.Config.osrs_t, BMP280.Config.filter);
+    }
+    Sampling_Trace(ch, level);
+}
+
+/**
+ * @brief Handles a console line.
+ */
+static void Link_Console() {
+    static const char names[LINK_PROTOCOLS][8] PROGMEM = { "noise", "console", "modbus", "binary", "boot" };
+    const char *line = (const char *)Link.frame;
+
+    if (!strcmp_P(line, PSTR("stat"))) {
+        for (uint8_t i = 0; i < LINK_PROTOCOLS; i++) {
+            LinkCounters counters;
+            char name[sizeof(names[0])];
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                counters = Link.counters[i];
+            }
+            strcpy_P(name, names[i]);
+            USART_printf(0, "%-8s %10lu B %5u msg %5u err\r\n", name, (unsigned long)counters.bytes,
+                         counters.messages, counters.errors);
+        }
+        USART_printf(0, "dropped %u B\r\n", Link.dropped);
+        USART_printf(0, "pool peak %u, %u failed, %u cut\r\n", Pool.peak, Pool.failures, Pool.truncations);
+        uint16_t late = BMP280.Poll.lateMax > SHT21.Poll.lateMax ? BMP280.Poll.lateMax : SHT21.Poll.lateMax;
+        USART_printf(0, "screen bus %u us, %u yields, probe late %u us\r\n", Screen.busMax, Screen.yields, late);
+    } else if (!strcmp_P(line, PSTR("rec"))) {
+        Telemetry_SendStation(TELEMETRY_CSV);
+    } else if (!strcmp_P(line, PSTR("log"))) {
+        char text[40];
+        for (uint8_t i = 0; i < EventLog.count; i++) {
+            EventRecord record;
+            if (EventLog_Read(i, &record)) {
+                EventLog_Text(text, &record, 1);
+                USART_printf(0, "%s\r\n", text);
+            }
+        }
+        USART_printf(0, "%u records, %u dropped, %u repeats\r\n", EventLog.count, EventLog.dropped, EventLog.repeats);
+    } else if (!strncmp_P(line, PSTR("hist"), 4) && (line[4] == 0 || line[4] == ' ')) {
+        Link_HistoryStart(line + 4);
+    } else if (!strncmp_P(line, PSTR("trace"), 5) && (line[5] == 0 || line[5] == ' ')) {
+        Link_Trace(line + 5);
+    } else if (!strcmp_P(line, PSTR("help"))) {
+        USART_printf(0, "stat  traffic, pool and bus figures\r\n"); // One line per message: a message is one pool block
+        USART_printf(0, "rec   CSV record\r\n");
+        USART_printf(0, "log   event log\r\n");
+        USART_printf(0, "hist  [count [first]] minutes of history\r\n");
+        USART_printf(0, "trace [ch level [osrs_t filter]] noise trace\r\n");
+    } else {
+        USART_printf(0, "?\r\n");
+    }
+}
+
+/**
+ * @brief Handles the message waiting from the receive interrupt, if any; called every main loop pass.
+ *
+ * Sends the next lines of a running history download first.
+ * Also ends a Modbus or binary frame once LINK_GAP_US has passed after its last byte, so the
+ * reply does not wait for the next message. The bootloader handshake restarts the station
+ * through a software reset as soon as the transmit queue has drained; the bootloader then
+ * answers the programmer's next GET_SYNC.
+ */
+void Link_Task() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t protocol = Link.protocol;
+        uint16_t ms, tick;
+        if (Link.ready == LINK_IDLE && protocol != LINK_IDLE && protocol != LINK_CONSOLE &&
+            Link_Silence(&ms, &tick) >= LINK_GAP_TICKS)
+            Link_End();
+    }
+
+    Link_History();
+    uint8_t ready = Link.ready;
+    uint8_t valid = 1;
+    switch (ready) {
+        case LINK_IDLE:
+            return;
+        case LINK_CONSOLE:
+            Link_Console();
+            break;
+        case LINK_MODBUS:
+            valid = Link_Modbus();
+            break;
+        case LINK_BINARY:
+            valid = Link_Binary();
+            break;
+        case LINK_BOOT:
+            if (USART0_TX.head != USART0_TX.tail || USART0_TX.blockHead != USART0_TX.blockTail)
+                return; // Let the replies go out first, retried on the next pass
+            Link_Count(&Link.counters[LINK_BOOT].messages);
+            ccp_write_io((uint8_t *)&RSTCTRL.SWRR, RSTCTRL_SWRST_bm);
+            return;
+    }
+    Link_Count(valid ? &Link.counters[ready].messages : &Link.counters[ready].errors);
+    Link.ready = LINK_IDLE;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file Link.h
+ * @brief Header file for the protocol multiplexer on USART0 / RS-485.
+ *
+ * The console, Modbus RTU, the binary telemetry commands and the bootloader handshake share
+ * USART0 without any reconfiguration. The receive interrupt classifies each incoming message by
+ * its first bytes and by the silence before it, then feeds every byte to the receiver of that
+ * protocol:
+ *
+ *  - text (printable characters, CR, LF, backspace): a console line, ended by CR or LF. People
+ *    type slowly, so a pause does not end the line, only a message of another protocol does,
+ *  - LINK_MODBUS_ADDRESS or 0 (broadcast): a Modbus RTU frame, ended by LINK_GAP_US of silence
+ *    (t3.5, fixed at 1.75 ms above 19200 bit/s). A pause longer than LINK_CHAR_GAP_US (t1.5)
+ *    inside the frame spoils it,
+ *  - LINK_SYNC0 LINK_SYNC1: a binary command frame `sync0 sync1 command length payload crc`,
+ *    ended by its length; the CRC-16/CCITT is sent high byte first,
+ *  - '0' ' ' with no pause between them (STK_GET_SYNC, CRC_EOP from a programmer): the
+ *    bootloader handshake,
+ *  - anything else (a Modbus frame for another address, line noise): skipped up to the next
+ *    LINK_GAP_US of silence.
+ *
+ * The classification and every byte take constant time in the interrupt, which calls no
+ * functions: at 2.5 Mbit/s a byte arrives every 96 CPU cycles. A complete message stays in
+ * the frame buffer until Link_Task() has handled it in the main loop. Replies go to the USART0
+ * transmitter. Every protocol counts its bytes, messages and errors.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef LINK_H_
+#define LINK_H_
+
+#define LINK_FRAME_SIZE 64        /**< Longest message: console line, Modbus or binary frame */
+#define LINK_GAP_US 1750          /**< Silence that ends a message (Modbus t3.5) */
+#define LINK_CHAR_GAP_US 750      /**< Longest pause inside a Modbus or binary frame (Modbus t1.5) */
+#define LINK_MODBUS_ADDRESS 0x01  /**< Modbus slave address: not text and not LINK_SYNC0 */
+#define LINK_SYNC0 0xA5           /**< First byte of a binary command frame */
+#define LINK_SYNC1 0x5A           /**< Second byte of a binary command frame */
+#define LINK_IDLE 0xFF            /**< No message being received or waiting */
+
+/** @name Binary commands; the reply to command c is command c, or c | LINK_CMD_NAK with no payload */
+///@{
+#define LINK_CMD_RECORD   0x01 /**< Payload: telemetry_format_t. Sends one station record in that format */
+#define LINK_CMD_COUNTERS 0x02 /**< Reply payload: the LinkCounters of every protocol, then `dropped` (little-endian) */
+#define LINK_CMD_EVENTS   0x03 /**< Payload: index of a record, 0 the oldest. Reply payload: the number of records, then up to LINK_EVENTS_MAX EventRecords from it */
+#define LINK_CMD_NAK      0x80 /**< Unknown command or bad payload */
+///@}
+
+/** @name Modbus functions and exception codes */
+///@{
+#define LINK_MODBUS_READ_HOLDING  0x03
+#define LINK_MODBUS_READ_INPUT    0x04
+#define LINK_MODBUS_BAD_FUNCTION  0x01
+#define LINK_MODBUS_BAD_ADDRESS   0x02
+#define LINK_MODBUS_BAD_VALUE     0x03
+#define LINK_MODBUS_MAX_REGISTERS 29   /**< A reply of 5 + 2 * 29 bytes fits a pool block */
+///@}
+
+#define LINK_EVENTS_MAX 7 /**< Event records per LINK_CMD_EVENTS reply: 6 + 1 + 7 * 8 bytes fit a pool block */
+#define LINK_HISTORY_MINUTES 60 /**< Minutes of a console history download without a count */
+#define LINK_HISTORY_LINES 2    /**< History download lines per main loop pass; one pool block is always left to the other senders */
+
+/** @name Silences in TCB0 counts (TIMER_TCB0_PER_US per microsecond) */
+///@{
+#define LINK_GAP_TICKS (LINK_GAP_US * TIMER_TCB0_PER_US)
+#define LINK_CHAR_GAP_TICKS (LINK_CHAR_GAP_US * TIMER_TCB0_PER_US)
+///@}
+
+/**
+ * @brief Text bytes: they start or continue a console line.
+ */
+#define LINK_IS_TEXT(c) (((c) >= ' ' && (c) <= 0x7F) || (c) == '\r' || (c) == '\n' || (c) == '\b')
+
+/**
+ * @brief Protocols, in the order of their counters.
+ */
+typedef enum {
+    LINK_NOISE,    /**< Messages of no known protocol */
+    LINK_CONSOLE,  /**< Text command lines */
+    LINK_MODBUS,   /**< Modbus RTU slave */
+    LINK_BINARY,   /**< Binary telemetry commands */
+    LINK_BOOT,     /**< Bootloader handshake */
+    LINK_PROTOCOLS /**< Number of protocols */
+} link_protocol_t;
+
+/**
+ * @brief Traffic counters of one protocol.
+ */
+typedef struct {
+    uint32_t bytes;    /**< Bytes received */
+    uint16_t messages; /**< Messages received and handled */
+    uint16_t errors;   /**< Messages spoiled (receive error, pause, CRC, length) or cut short */
+} LinkCounters;
+
+/**
+ * @brief Receiver state and counters.
+ *
+ * `frame` and `length` belong to the receive interrupt while `ready` is LINK_IDLE, and to
+ * Link_Task() while a message waits in them.
+ */
+typedef struct {
+    uint8_t frame[LINK_FRAME_SIZE];        /**< Message being received or waiting */
+    uint8_t length;                        /**< Bytes in `frame` */
+    uint8_t need;                          /**< Length of the binary frame being received */
+    uint8_t bad;                           /**< 1 when the message being received is spoiled */
+    volatile uint8_t protocol;             /**< Protocol of the message being received, LINK_IDLE between messages */
+    volatile uint8_t ready;                /**< Protocol of the message waiting for Link_Task(), LINK_IDLE if none */
+    volatile uint16_t ms;                  /**< Timer.ms when the last byte arrived (low 16 bits) */
+    volatile uint16_t tick;                /**< TCB0 count when the last byte arrived */
+    LinkCounters counters[LINK_PROTOCOLS]; /**< Traffic per protocol */
+    uint16_t dropped;                      /**< Bytes lost while a message was waiting */
+    uint32_t historyMinute;                /**< Next minute of the console history download */
+    uint16_t historyLeft;                  /**< Minutes left to send, 0 = no download */
+} LinkPort;
+
+/**
+ * @brief Global USART0 receiver.
+ */
+extern LinkPort Link;
+
+#endif /* LINK_H_ */
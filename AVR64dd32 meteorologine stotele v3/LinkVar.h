@@ -0,0 +1,20 @@
+/**
+ * @file LinkVar.h
+ * @brief Variable definition of the USART0 protocol multiplexer.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef LINKVAR_H_
+#define LINKVAR_H_
+
+/**
+ * @brief Global USART0 receiver, idle with no message waiting at start-up.
+ */
+LinkPort Link = {
+    .protocol = LINK_IDLE,
+    .ready = LINK_IDLE
+};
+
+#endif /* LINKVAR_H_ */
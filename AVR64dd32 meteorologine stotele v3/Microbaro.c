@@ -0,0 +1,164 @@
+/**
+ * @file Microbaro.c
+ * @brief High-rate microbarometer mode: scheduled BMP280 reads, high-pass filter, binary stream.
+ *
+ * Microbaro_Task() takes over the pressure channel from Redundant_Task() once its running
+ * acquisition has finished, switches the BMP280 to normal mode and from then on reads the newest
+ * conversion every MICROBARO_PERIOD_MS. Microbaro_Stop() puts the sensor back to sleep with the
+ * forced mode settings, and the adaptive sampling engine takes over again.
+ *
+ * @author Saulius
+ * @date 2025-01-16
+ */
+
+#include "Settings.h"
+#include "MicrobaroVar.h"
+
+/**
+ * @brief Closes the frame being filled and queues it if the transmit queue has room for it.
+ */
+static void Microbaro_Send() {
+    uint8_t n = Microbaro.count;
+    uint8_t length = 5 + 2 * n;
+
+    if (n == 0)
+        return;
+    Microbaro.frame[3] = n;
+    Microbaro.frame[length - 1] = CRC8_Update(CRC8_SENSIRION_INIT, &Microbaro.frame[1], length - 2);
+    if (USART0_TxSpace() >= length) {
+        for (uint8_t i = 0; i < length; i++)
+            USART0_sendChar(Microbaro.frame[i]);
+        Microbaro.frames++;
+    } else {
+        Microbaro.dropped++; // Never wait for the line, the next sample is due soon
+    }
+    Microbaro.peak = Microbaro.peakRunning;
+    Microbaro.peakRunning = 0;
+    Microbaro.count = 0;
+}
+
+/**
+ * @brief Adds one sample to the frame being filled, queues the frame when it is full.
+ *
+ * @param x Fluctuation (0.01 Pa) or MICROBARO_MISSING.
+ */
+static void Microbaro_Put(int16_t x) {
+    uint8_t *f = Microbaro.frame;
+    uint8_t k = 4 + 2 * Microbaro.count;
+
+    if (Microbaro.count == 0) {
+        f[0] = MICROBARO_SYNC;
+        f[1] = Microbaro.index & 0xFF;
+        f[2] = Microbaro.index >> 8;
+    }
+    f[k] = x & 0xFF;
+    f[k + 1] = (uint16_t)x >> 8;
+    Microbaro.index++;
+    if (++Microbaro.count == MICROBARO_FRAME_SAMPLES)
+        Microbaro_Send();
+}
+
+/**
+ * @brief Reads the newest conversion, splits it into trend and fluctuation and stores it.
+ */
+static void Microbaro_Sample() {
+    Redundant_LoadBMP280(MICROBARO_INSTANCE);
+    uint64_t raw = ReadMulti(BMP280.Address, press_msb, 6); // Pressure and temperature in one burst
+    if (I2C.error || raw == 0) {
+        Microbaro.errors++;
+        Microbaro_Put(MICROBARO_MISSING);
+        return;
+    }
+    BMP280.CalibrationValues.UP = (raw >> 28) & 0xFFFFF;
+    BMP280.CalibrationValues.UT = (raw >> 4) & 0xFFFFF;
+    CalcTrueTemp();
+    CalcTruePres();
+
+    // First order low-pass of the pressure (relative to the reference, so the state fits in 32
+    // bits), the fluctuation is what the low-pass leaves: a high-pass with the same corner
+    int32_t d = (int32_t)BMP280.CalibrationValues.p - Microbaro.reference; // Q8 Pa
+    Microbaro.trend += ((d << MICROBARO_HP_SHIFT) - Microbaro.trend) >> MICROBARO_HP_SHIFT;
+    int32_t slow = Microbaro.trend >> MICROBARO_HP_SHIFT;
+    int32_t f = ((d - slow) * 25 + 32) >> 6; // Q8 Pa -> 0.01 Pa (100 / 256)
+    if (f > INT16_MAX)
+        f = INT16_MAX;
+    else if (f <= MICROBARO_MISSING)
+        f = MICROBARO_MISSING + 1;
+
+    // The trend stands in for the normal pressure reading while the mode runs
+    BMP280.CalibrationValues.p = Microbaro.reference + slow;
+    BMP280.Pressure = (float)BMP280.CalibrationValues.p / 25600;
+
+    Microbaro.fluctuation = f;
+    uint16_t a = f < 0 ? -f : f;
+    if (a > Microbaro.peakRunning)
+        Microbaro.peakRunning = a;
+    Microbaro_Put(f);
+}
+
+/**
+ * @brief Switches the microbarometer mode on; it starts once the running BMP280 acquisition ends.
+ */
+void Microbaro_Start() {
+    if (Microbaro.mode == MICROBARO_OFF)
+        Microbaro.mode = MICROBARO_STARTING;
+}
+
+/**
+ * @brief Switches the microbarometer mode off and returns the BMP280 to forced mode acquisitions.
+ */
+void Microbaro_Stop() {
+    if (Microbaro.mode == MICROBARO_RUNNING) {
+        Microbaro_Send(); // Partial frame
+        Redundant_LoadBMP280(MICROBARO_INSTANCE);
+        WriteBMP280Config(); // Sleep mode and the forced mode standby/filter settings
+    }
+    Microbaro.mode = MICROBARO_OFF;
+}
+
+/**
+ * @brief Checks whether the next sample is too close for a full main loop pass.
+ *
+ * @return 1 if the main loop should only call Microbaro_Task() until the sample has been taken.
+ */
+uint8_t Microbaro_Busy() {
+    return Microbaro.mode == MICROBARO_RUNNING && (int32_t)(Microbaro.nextSample - Timer_ms()) < MICROBARO_GUARD_MS;
+}
+
+/**
+ * @brief Starts the mode when the sensor is free and takes the sample that is due, call from the main loop.
+ */
+void Microbaro_Task() {
+    uint32_t now = Timer_ms();
+
+    if (Microbaro.mode == MICROBARO_STARTING) {
+        if (Redundant.bmpState != REDUNDANT_IDLE)
+            return; // Forced mode conversion still running
+        Redundant_LoadBMP280(MICROBARO_INSTANCE);
+        WriteToReg(BMP280.Address, ctrl_meas, BMP280_Mode_Sleep); // Config is only taken in sleep mode
+        WriteToReg(BMP280.Address, config, (BMP280_StanBy_0m5 << 5) + (MICROBARO_FILTER << 2) + BMP280.Config.spi3w_en);
+        WriteToReg(BMP280.Address, ctrl_meas, (MICROBARO_OSRS_P << 5) + (MICROBARO_OSRS_T << 2) + BMP280_Mode_Normal);
+        Microbaro.reference = BMP280.CalibrationValues.p; // Last reading of the instance
+        Microbaro.trend = 0;
+        Microbaro.count = 0;
+        Microbaro.peakRunning = 0;
+        Microbaro.nextSample = now + MICROBARO_PERIOD_MS; // First conversion has ended by then
+        Microbaro.mode = MICROBARO_RUNNING;
+        return;
+    }
+    if (Microbaro.mode != MICROBARO_RUNNING)
+        return;
+
+    int32_t late = (int32_t)(now - Microbaro.nextSample);
+    if (late < 0)
+        return;
+    if (late >= MICROBARO_PERIOD_MS) {
+        uint16_t missed = late / MICROBARO_PERIOD_MS;
+        Microbaro_Send(); // The receiver sees the skipped slots from the index of the next frame
+        Microbaro.index += missed;
+        Microbaro.gaps += missed;
+        Microbaro.nextSample += (uint32_t)missed * MICROBARO_PERIOD_MS;
+    }
+    Microbaro.nextSample += MICROBARO_PERIOD_MS;
+    Microbaro_Sample();
+}
@@ -0,0 +1,85 @@
+/**
+ * @file Microbaro.h
+ * @brief Header file for the high-rate microbarometer mode.
+ *
+ * While the mode runs, one BMP280 instance free-runs in normal mode and its newest result is
+ * read every MICROBARO_PERIOD_MS. A first order fixed-point high-pass filter splits every sample
+ * into a slow trend, which keeps feeding the normal pressure value, and the fluctuation around
+ * it (infrasound, door slams, gust pressure), which is streamed on USART0 in compact binary
+ * frames:
+ *
+ *  byte   0      MICROBARO_SYNC
+ *  byte   1-2    index of the first sample (little endian, counts every sample slot, so a
+ *                receiver sees skipped slots as a jump of the index)
+ *  byte   3      n, samples in the frame (1 ... MICROBARO_FRAME_SAMPLES)
+ *  byte   4 ...  n fluctuations, int16 little endian, 0.01 Pa (MICROBARO_MISSING: read failed)
+ *  last byte     CRC-8/Sensirion (CRC8_SENSIRION_INIT) of bytes 1 ... 3 + 2n
+ *
+ * Frames are queued whole, only when the transmit queue has room for them; otherwise the frame
+ * is dropped and counted, the sampling never waits for the line. The frames share USART0 with
+ * the text telemetry, so only enable the mode when every listener skips bytes outside its own
+ * records. tools/microbaro.py decodes a capture of the line.
+ *
+ * The BMP280 has no FIFO: samples are read one by one on a tight schedule and drained to the
+ * line in bursts of MICROBARO_FRAME_SAMPLES. To keep the schedule, the main loop runs its other
+ * tasks only when the next sample is more than MICROBARO_GUARD_MS away (see Microbaro_Busy()),
+ * so they continue at a reduced rate, about once per sample period.
+ *
+ * @author Saulius
+ * @date 2025-01-16
+ */
+
+#ifndef MICROBARO_H_
+#define MICROBARO_H_
+
+#define MICROBARO_PERIOD_MS 40       /**< Sample period: 25 Hz */
+#define MICROBARO_GUARD_MS 15        /**< Longest main loop pass (keypad debounce, display, telemetry) */
+#define MICROBARO_INSTANCE 0         /**< Redundant.bmp[] instance used for the fast samples */
+#define MICROBARO_HP_SHIFT 8         /**< High-pass time constant 2^8 samples (10 s, corner ~0.016 Hz) */
+#define MICROBARO_FRAME_SAMPLES 10   /**< Samples per frame: 0.4 s at 25 Hz */
+#define MICROBARO_FRAME_BYTES (5 + 2 * MICROBARO_FRAME_SAMPLES)
+#define MICROBARO_SYNC 0xA7          /**< First byte of a frame, unlike LINK_SYNC0 and DEBUG_LOG_SYNC */
+#define MICROBARO_MISSING INT16_MIN  /**< Sample value of a failed read */
+
+/** @name BMP280 settings while the mode runs: ~14 ms conversions, newest one read every period */
+///@{
+#define MICROBARO_OSRS_P BMP280_Pressure_SR
+#define MICROBARO_OSRS_T BMP280_Temperature_Os_x1
+#define MICROBARO_FILTER BMP280_Filter_4
+///@}
+
+/**
+ * @brief Mode states.
+ */
+typedef enum {
+    MICROBARO_OFF,      /**< Normal forced mode acquisitions by Redundant_Task() */
+    MICROBARO_STARTING, /**< Waiting for the running BMP280 acquisition to finish */
+    MICROBARO_RUNNING   /**< BMP280 in normal mode, fast sampling */
+} microbaro_mode_t;
+
+/**
+ * @brief Microbarometer state, filter and frame being filled.
+ */
+typedef struct {
+    uint8_t mode;         /**< microbaro_mode_t */
+    uint32_t nextSample;  /**< Time of the next sample (Timer_ms()) */
+    uint16_t index;       /**< Index of the next sample slot */
+    int32_t reference;    /**< Pressure at the start (Q24.8 Pa), filter input is relative to it */
+    int32_t trend;        /**< Low-pass state: pressure - reference, Q8 Pa << MICROBARO_HP_SHIFT */
+    int16_t fluctuation;  /**< Last fluctuation (0.01 Pa) */
+    uint16_t peak;        /**< Largest |fluctuation| of the last full frame (0.01 Pa) */
+    uint16_t peakRunning; /**< Largest |fluctuation| of the frame being filled */
+    uint8_t count;        /**< Samples in the frame being filled */
+    uint8_t frame[MICROBARO_FRAME_BYTES]; /**< Frame being filled */
+    uint16_t frames;      /**< Frames queued */
+    uint16_t dropped;     /**< Frames dropped because the transmit queue was full */
+    uint16_t errors;      /**< Failed reads */
+    uint16_t gaps;        /**< Sample slots skipped because a pass was late by more than one period */
+} MicrobaroState;
+
+/**
+ * @brief Global microbarometer state.
+ */
+extern MicrobaroState Microbaro;
+
+#endif /* MICROBARO_H_ */
@@ -0,0 +1,20 @@
+/**
+ * @file MicrobaroVar.h
+ * @brief Variable definition of the high-rate microbarometer mode.
+ *
+ * @author Saulius
+ * @date 2025-01-16
+ */
+
+#ifndef MICROBAROVAR_H_
+#define MICROBAROVAR_H_
+
+/**
+ * @brief Microbarometer state, the mode starts switched off.
+ */
+MicrobaroState Microbaro = {
+    .mode = MICROBARO_OFF,
+    .count = 0
+};
+
+#endif /* MICROBAROVAR_H_ */
@@ -0,0 +1,29 @@
+/**
+ * @file NoiseProfile.h
+ * @brief Highest oversampling level the adaptive sampling engine may use, per channel,
+ *        and the BMP280 temperature oversampling and IIR filter (main.c).
+ *
+ * Generated by tools/noise_profile.py from recorded noise traces - do not edit by hand.
+ * Each limit is the cheapest level whose single-reading noise (Allan deviation at the
+ * sample interval) meets the channel target.
+ *
+ * channel      level         noise       target   time ms  charge uC
+ * wind_speed   ACC128        not measured
+ * wind_dir     ACC128        not measured
+ * sun          ACC128        not measured
+ * pressure     UHR/T16/F16   not measured
+ * sht          12/14         not measured
+ */
+
+#ifndef NOISEPROFILE_H_
+#define NOISEPROFILE_H_
+
+#define NOISE_PROFILE_OS_WIND_SPEED    3 /**< ACC128 */
+#define NOISE_PROFILE_OS_WIND_DIR      3 /**< ACC128 */
+#define NOISE_PROFILE_OS_SUN           3 /**< ACC128 */
+#define NOISE_PROFILE_OS_PRESSURE      3 /**< UHR */
+#define NOISE_PROFILE_OS_SHT           3 /**< 12/14 */
+#define NOISE_PROFILE_BMP280_OSRS_T    BMP280_Temperature_Os_x16 /**< x16 */
+#define NOISE_PROFILE_BMP280_FILTER    BMP280_Filter_16 /**< coefficient 16 */
+
+#endif /* NOISEPROFILE_H_ */
@@ -0,0 +1,125 @@
+/**
+ * @file PlaneOfArray.c
+ * @brief Fixed-point angle of incidence, Erbs decomposition and isotropic sky transposition.
+ *
+ * @author Saulius
+ * @date 2025-01-20
+ */
+
+#include "Settings.h"
+#include "PlaneOfArrayVar.h"
+
+/**
+ * @brief Sets the plane orientation and precomputes its normal.
+ *
+ * @param mode plane_mode_t.
+ * @param tilt Fixed plane tilt from horizontal (0.01 deg).
+ * @param azimuth Direction the fixed plane faces (0.01 deg from North).
+ */
+void PlaneOfArray_Configure(uint8_t mode, int16_t tilt, uint16_t azimuth) {
+    int16_t st = FixedMath_Sin(tilt);
+
+    PlaneOfArray.mode = mode;
+    PlaneOfArray.tilt = tilt;
+    PlaneOfArray.azimuth = azimuth;
+    PlaneOfArray.normalE = ((int32_t)st * FixedMath_Sin(azimuth)) >> 15;
+    PlaneOfArray.normalN = ((int32_t)st * FixedMath_Cos(azimuth)) >> 15;
+    PlaneOfArray.normalU = FixedMath_Cos(tilt);
+    PlaneOfArray.configured = 1;
+}
+
+/**
+ * @brief Erbs diffuse fraction.
+ *
+ * @param kt Clearness index, Q15.
+ * @return DHI / GHI, Q15.
+ */
+static uint16_t PlaneOfArray_Erbs(uint16_t kt) {
+    if (kt <= 7209) // 0.22
+        return 32767 - (((uint32_t)2949 * kt) >> 15); // 1 - 0.09 kt
+    if (kt > 26214) // 0.8
+        return 5407; // 0.165
+    // 0.9511 - 0.1604 kt + 4.388 kt^2 - 16.638 kt^3 + 12.336 kt^4, Horner in Q12
+    int32_t p = 50528;
+    p = ((p * kt) >> 15) - 68149;
+    p = ((p * kt) >> 15) + 17973;
+    p = ((p * kt) >> 15) - 657;
+    p = ((p * kt) >> 15) + 3896;
+    return p << 3;
+}
+
+/**
+ * @brief Extraterrestrial normal irradiance, recomputed when the day changes.
+ */
+static void PlaneOfArray_Day() {
+    if (Date_Clock.day == PlaneOfArray.day)
+        return;
+    PlaneOfArray.day = Date_Clock.day;
+    // Day of the year, +-1 day is plenty for a 3.3 % yearly cosine
+    int32_t n = (Date_Clock.month - 1) * 3044L / 100 + Date_Clock.day;
+    int16_t c = FixedMath_Cos(n * 36000L / 365);
+    PlaneOfArray.e0 = PLANE_E0_DW + (((int32_t)PLANE_E0_DW * (((int32_t)PLANE_ECCENTRICITY_Q15 * c) >> 15)) >> 15);
+}
+
+/**
+ * @brief Updates the angle of incidence and the plane-of-array irradiance, call after every light sample.
+ */
+void PlaneOfArray_Update() {
+    if (!PlaneOfArray.configured)
+        PlaneOfArray_Configure(PlaneOfArray.mode, PlaneOfArray.tilt, PlaneOfArray.azimuth);
+    PlaneOfArray_Day();
+    Derived_Refresh(PlaneOfArray.mode == PLANE_TRACKER ? DERIVED_BIT(DERIVED_TRACKER) : DERIVED_BIT(DERIVED_ADJ_ANGLES));
+
+    uint32_t g = ((uint32_t)SUN.sunlevel * CLEARSKY_CAL_Q8 * 10) >> 8;
+    uint16_t ghi = (g > UINT16_MAX) ? UINT16_MAX : g;
+    int32_t h = lround(SUN.adjelevation * 100);
+    PlaneOfArray.ghi = ghi;
+
+    if (h <= 0) { // Night or twilight: only diffuse light, no angle of incidence
+        PlaneOfArray.cosAoi = 0;
+        PlaneOfArray.aoi = 9000;
+        PlaneOfArray.clearness = 0;
+        PlaneOfArray.dhi = ghi;
+        PlaneOfArray.beam = 0;
+        PlaneOfArray.poa = 0;
+        return;
+    }
+
+    int32_t az = lround(SUN.adjazimuth * 100);
+    int16_t sh = FixedMath_Sin(h);
+    int16_t cosTilt;
+    int32_t c;
+    if (PlaneOfArray.mode == PLANE_TRACKER) {
+        int16_t r = Tracker.angle;
+        int16_t cr = FixedMath_Cos(r);
+        c = ((int32_t)Tracker.sunX * FixedMath_Sin(r) + (int32_t)Tracker.sunZ * cr) >> 15;
+        cosTilt = ((int32_t)cr * FixedMath_Cos(Tracker.axisTilt)) >> 15;
+    } else {
+        int16_t ch = FixedMath_Cos(h);
+        int32_t se = ((int32_t)ch * FixedMath_Sin(az)) >> 15;
+        int32_t sn = ((int32_t)ch * FixedMath_Cos(az)) >> 15;
+        c = (se * PlaneOfArray.normalE + sn * PlaneOfArray.normalN + (int32_t)sh * PlaneOfArray.normalU) >> 15;
+        cosTilt = PlaneOfArray.normalU;
+    }
+    if (c > FIXEDMATH_ONE)
+        c = FIXEDMATH_ONE;
+    PlaneOfArray.cosAoi = c;
+    PlaneOfArray.aoi = FixedMath_Acos(c);
+
+    // Clearness index and diffuse fraction
+    uint32_t eh = ((uint32_t)PlaneOfArray.e0 * sh) >> 15; // Extraterrestrial horizontal
+    uint32_t kt = ((uint32_t)ghi << 15) / (eh ? eh : 1);
+    if (kt > FIXEDMATH_ONE)
+        kt = FIXEDMATH_ONE;
+    PlaneOfArray.clearness = (kt * 1000 + 16384) >> 15;
+    uint16_t dhi = (h < PLANE_MIN_ELEVATION) ? ghi : ((uint32_t)ghi * PlaneOfArray_Erbs(kt)) >> 15;
+    PlaneOfArray.dhi = dhi;
+
+    // Isotropic sky transposition
+    uint32_t beam = (c > 0) ? (uint32_t)(ghi - dhi) * c / sh : 0;
+    uint32_t sky = ((uint32_t)dhi * (32768 + cosTilt)) >> 16;
+    uint32_t ground = ((((uint32_t)ghi * PLANE_ALBEDO_Q15) >> 15) * (32768 - cosTilt)) >> 16;
+    uint32_t poa = beam + sky + ground;
+    PlaneOfArray.beam = (beam > UINT16_MAX) ? UINT16_MAX : beam;
+    PlaneOfArray.poa = (poa > UINT16_MAX) ? UINT16_MAX : poa;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file PlaneOfArray.h
+ * @brief Header file for the angle of incidence and plane-of-array irradiance.
+ *
+ * The panel plane is either fixed (tilt and azimuth) or follows the single-axis tracker
+ * (Tracker.angle). For a fixed plane the unit normal n = (sin b sin g, sin b cos g, cos b)
+ * (east, north, up) is computed once by PlaneOfArray_Configure(); for a tracked plane the sun
+ * vector in the tracker frame comes from Tracker.c, so the angle of incidence is
+ *
+ *   fixed:   cos(AOI) = n . s
+ *   tracked: cos(AOI) = x' sin(R) + z' cos(R),  cos(tilt) = cos(R) cos(axis tilt)
+ *
+ * The light reading (CLEARSKY_CAL_Q8) is the global horizontal irradiance GHI. The Erbs
+ * correlation of the clearness index kt = GHI / (E0 sin h) splits it into diffuse (DHI) and
+ * beam parts, and the isotropic sky model transposes them to the plane:
+ *
+ *   POA = (GHI - DHI) cos(AOI) / sin(h) + DHI (1 + cos tilt) / 2 + GHI albedo (1 - cos tilt) / 2
+ *
+ * All fixed point (FixedMath.c): one update is four table sines, about twenty 16 x 16 bit
+ * multiplies and two divisions, cheap enough for every light sample. Below PLANE_MIN_ELEVATION
+ * all light is taken as diffuse, which keeps the beam term away from the 1 / sin(h) pole.
+ * tools/poa_accuracy.py compares it with double precision on the host.
+ *
+ * @author Saulius
+ * @date 2025-01-20
+ */
+
+#ifndef PLANEOFARRAY_H_
+#define PLANEOFARRAY_H_
+
+/**
+ * @brief Panel plane orientation source.
+ */
+typedef enum {
+    PLANE_FIXED,   /**< Fixed tilt and azimuth */
+    PLANE_TRACKER  /**< Rows of the single-axis tracker (Tracker.h) */
+} plane_mode_t;
+
+/** @name Plane configuration */
+///@{
+#define PLANE_MODE PLANE_FIXED       /**< Orientation source at start-up */
+#define PLANE_TILT 3500              /**< Fixed plane tilt from horizontal (0.01 deg) */
+#define PLANE_AZIMUTH 18000          /**< Fixed plane azimuth, direction it faces (0.01 deg from North) */
+#define PLANE_ALBEDO_Q15 6554        /**< Ground reflectance 0.2 (grass), Q15 */
+///@}
+
+#define PLANE_MIN_ELEVATION 500      /**< Lowest solar elevation with a beam component (0.01 deg) */
+#define PLANE_E0_DW 13610            /**< Solar constant 1361 W/m2, in 0.1 W/m2 */
+#define PLANE_ECCENTRICITY_Q15 1081  /**< Amplitude of the Earth-Sun distance correction 0.033, Q15 */
+
+/**
+ * @brief Plane configuration, angle of incidence and irradiance components.
+ */
+typedef struct {
+    uint8_t mode;         /**< plane_mode_t */
+    uint8_t configured;   /**< 1 once the normal below matches tilt and azimuth */
+    int16_t tilt;         /**< Fixed plane tilt (0.01 deg) */
+    uint16_t azimuth;     /**< Fixed plane azimuth (0.01 deg) */
+    int16_t normalE;      /**< Fixed plane normal, east component (Q15) */
+    int16_t normalN;      /**< Fixed plane normal, north component (Q15) */
+    int16_t normalU;      /**< Fixed plane normal, up component = cos(tilt) (Q15) */
+    int8_t day;           /**< Day of month the extraterrestrial irradiance was computed for */
+    uint16_t e0;          /**< Extraterrestrial normal irradiance of the day (0.1 W/m2) */
+
+    int16_t cosAoi;       /**< cos(angle of incidence), Q15, negative when the sun is behind the plane */
+    uint16_t aoi;         /**< Angle of incidence (0.01 deg), 9000 at night */
+    uint16_t clearness;   /**< Clearness index kt (0.001) */
+    uint16_t ghi;         /**< Global horizontal irradiance (0.1 W/m2) */
+    uint16_t dhi;         /**< Diffuse horizontal irradiance (0.1 W/m2) */
+    uint16_t beam;        /**< Beam irradiance on the plane (0.1 W/m2) */
+    uint16_t poa;         /**< Total plane-of-array irradiance (0.1 W/m2) */
+} PlaneOfArrayState;
+
+/**
+ * @brief Global plane-of-array state.
+ */
+extern PlaneOfArrayState PlaneOfArray;
+
+#endif /* PLANEOFARRAY_H_ */
@@ -0,0 +1,24 @@
+/**
+ * @file PlaneOfArrayVar.h
+ * @brief Variable definition of the plane-of-array state.
+ *
+ * @author Saulius
+ * @date 2025-01-20
+ */
+
+#ifndef PLANEOFARRAYVAR_H_
+#define PLANEOFARRAYVAR_H_
+
+/**
+ * @brief Plane configuration from PlaneOfArray.h; the normal is computed on the first update.
+ */
+PlaneOfArrayState PlaneOfArray = {
+    .mode = PLANE_MODE,
+    .configured = 0,
+    .tilt = PLANE_TILT,
+    .azimuth = PLANE_AZIMUTH,
+    .day = -1,
+    .aoi = 9000
+};
+
+#endif /* PLANEOFARRAYVAR_H_ */
@@ -0,0 +1,92 @@
+/**
+ * @file Pool.c
+ * @brief Fixed-block buffer pool: allocation, ownership handoff and release.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#include "Settings.h"
+#include "PoolVar.h"
+
+_Static_assert(POOL_BLOCKS <= 8, "the free blocks are one bit each in Pool.available");
+_Static_assert(USART0_TX_BLOCKS > POOL_BLOCKS, "the USART0 block queue must hold every block");
+_Static_assert(MAX_TEXT_LENGTH <= POOL_BLOCK_SIZE, "a display line is formatted into one block");
+
+/**
+ * @brief Takes the lowest free block, interrupts disabled by the caller.
+ *
+ * @return Block number, or POOL_NONE.
+ */
+static uint8_t Pool_Grab(uint8_t owner) {
+    uint8_t free_bits = Pool.available;
+    if (!free_bits)
+        return POOL_NONE;
+    uint8_t block = 0;
+    while (!(free_bits & 1)) {
+        free_bits >>= 1;
+        block++;
+    }
+    Pool.available &= ~(1 << block);
+    Pool.owner[block] = owner;
+    Pool.held[owner]++;
+    Pool.allocations++;
+    if (++Pool.used > Pool.peak)
+        Pool.peak = Pool.used;
+    return block;
+}
+
+/**
+ * @brief Allocates a block, safe in interrupts.
+ */
+uint8_t Pool_Alloc(uint8_t owner) {
+    uint8_t block;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        block = Pool_Grab(owner);
+        if (block == POOL_NONE)
+            Pool.failures++;
+    }
+    return block;
+}
+
+/**
+ * @brief Allocates a block, waiting while blocks are being transmitted (their driver frees them).
+ *
+ * With global interrupts disabled the transmit interrupt cannot free a block, so there is no wait.
+ */
+uint8_t Pool_Take(uint8_t owner) {
+    uint8_t block;
+    while (1) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            block = Pool_Grab(owner);
+        }
+        if (block != POOL_NONE || !Pool.held[POOL_USART0_TX] || !(SREG & CPU_I_bm))
+            break;
+    }
+    if (block == POOL_NONE)
+        Pool.failures++;
+    return block;
+}
+
+/**
+ * @brief Hands a block over to a new owner.
+ */
+void Pool_Give(uint8_t block, uint8_t owner) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        Pool.held[Pool.owner[block]]--;
+        Pool.owner[block] = owner;
+        Pool.held[owner]++;
+    }
+}
+
+/**
+ * @brief Returns a block to the pool, safe in interrupts.
+ */
+void Pool_Free(uint8_t block) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        Pool.held[Pool.owner[block]]--;
+        Pool.owner[block] = POOL_FREE;
+        Pool.available |= 1 << block;
+        Pool.used--;
+    }
+}
@@ -0,0 +1,63 @@
+/**
+ * @file Pool.h
+ * @brief Header file for the fixed-block buffer pool shared by the drivers.
+ *
+ * Messages are built once in a pool block and handed on by block number instead of being
+ * copied between stack buffers: USART_printf() formats into a block and gives it to the USART0
+ * transmitter, whose data register empty interrupt sends it and frees it; a frame from the clock
+ * device is received into a block and parsed in place; a display line is formatted into a block.
+ *
+ * Every block has one owner (pool_owner_t). Pool_Alloc() and Pool_Free() run with interrupts
+ * disabled and may be called from interrupts; Pool_Give() hands a block over. Blocks are static,
+ * and the firmware uses no heap: the allocator functions are poisoned below.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#define POOL_BLOCKS 4       /**< Number of blocks (at most 8) */
+#define POOL_BLOCK_SIZE 64  /**< Bytes per block */
+#define POOL_NONE 0xFF      /**< No block */
+
+/**
+ * @brief Owners of a block.
+ */
+typedef enum {
+    POOL_FREE,      /**< Not allocated */
+    POOL_PRINTF,    /**< USART_printf() formatting a message */
+    POOL_DISPLAY,   /**< screen_write_formatted_text() formatting a line */
+    POOL_CLOCK_RX,  /**< Frame received from the clock device */
+    POOL_USART0_TX, /**< Queued to the USART0 transmitter, freed by its interrupt */
+    POOL_LINK,      /**< Modbus or binary reply built by Link_Task() */
+    POOL_OWNERS     /**< Number of owners */
+} pool_owner_t;
+
+/**
+ * @brief Buffer pool: the blocks, their owners and the occupancy statistics.
+ */
+typedef struct {
+    char data[POOL_BLOCKS][POOL_BLOCK_SIZE]; /**< Blocks */
+    volatile uint8_t available;              /**< Bit n set: block n is free */
+    uint8_t owner[POOL_BLOCKS];              /**< pool_owner_t of every block */
+    volatile uint8_t held[POOL_OWNERS];      /**< Blocks held per owner */
+    uint8_t used;                            /**< Blocks allocated */
+    uint8_t peak;                            /**< Most blocks allocated at once */
+    uint16_t allocations;                    /**< Successful allocations (wraps) */
+    uint16_t failures;                       /**< Allocations that found no free block */
+    uint16_t truncations;                    /**< USART_printf() messages cut to POOL_BLOCK_SIZE - 1 characters */
+} BufferPool;
+
+/**
+ * @brief Global buffer pool.
+ */
+extern BufferPool Pool;
+
+/**
+ * @brief No heap: every buffer is static or a pool block, a call to the allocator does not compile.
+ */
+#pragma GCC poison malloc calloc realloc free
+
+#endif /* POOL_H_ */
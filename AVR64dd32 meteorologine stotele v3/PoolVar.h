@@ -0,0 +1,21 @@
+/**
+ * @file PoolVar.h
+ * @brief Variable definition of the buffer pool.
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef POOLVAR_H_
+#define POOLVAR_H_
+
+/**
+ * @brief Global buffer pool, every block free at start-up.
+ */
+BufferPool Pool = {
+    .available = (1 << POOL_BLOCKS) - 1,
+    .used = 0,
+    .peak = 0
+};
+
+#endif /* POOLVAR_H_ */
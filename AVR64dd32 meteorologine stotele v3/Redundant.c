@@ -0,0 +1,397 @@
+/**
+ * @file Redundant.c
+ * @brief Parallel acquisition, median voting and health scoring of redundant BMP280 and SHT21 sets.
+ *
+ * `Redundant_Task()` runs from the main loop. When the sampling engine says a sensor channel is
+ * due, one command starts the conversion on every instance: BMP280s are put in forced mode
+ * (one write per address, reaching all multiplexer channels with that address), SHT21s get a
+ * no hold master command with all their multiplexer channels selected. The task then returns
+ * and probes one instance at the poll interval from a little before the typical conversion time
+ * (`BMP280.Poll`, `SHT21.Poll`: status register, read header), reads every instance in one bus
+ * window as soon as it is ready, at the latest after the worst case time, and fuses the readings
+ * into the global `BMP280` and `SHT21` results.
+ *
+ * @author Saulius
+ * @date 2025-01-10
+ */
+
+#include "Settings.h"
+#include "RedundantVar.h"
+
+/**
+ * @brief Connects the multiplexer channels of the given instances with the given address.
+ *
+ * @param s Instances.
+ * @param count Number of instances.
+ * @param address Address to match, 0 matches every instance.
+ */
+static void Redundant_Select(RedundantSensor *s, uint8_t count, uint8_t address) {
+#if REDUNDANT_MUX
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if ((address == 0 || s[i].address == address) && s[i].channel != REDUNDANT_DIRECT)
+            mask |= 1 << s[i].channel;
+    }
+    I2C_MuxSelect(mask);
+#else
+    (void)s; (void)count; (void)address;
+#endif
+}
+
+/**
+ * @brief Marks an instance as failed for the current acquisition.
+ */
+static void Redundant_Fail(RedundantSensor *s) {
+    if (s->valid) {
+        s->valid = 0;
+        s->failures++;
+        s->health = (s->health > REDUNDANT_HEALTH_FAIL) ? s->health - REDUNDANT_HEALTH_FAIL : 0;
+        DEBUG_LOG3("sensor 0x%02hhx ch %hhu failed, health %hhu", s->address, s->channel, s->health);
+    }
+}
+
+/**
+ * @brief Median vote over the valid instances for one value.
+ *
+ * Healthy instances vote; if none of them read successfully, every valid instance votes so a
+ * recovering set still produces a value. With two voters the mean is used.
+ *
+ * @param s Instances.
+ * @param count Number of instances.
+ * @param k Index in `value[]`.
+ * @param result Fused value (unchanged when there are no voters).
+ * @return Number of voters.
+ */
+static uint8_t Redundant_Vote(RedundantSensor *s, uint8_t count, uint8_t k, int32_t *result) {
+    int32_t v[3];
+    uint8_t n = 0;
+
+    for (uint8_t pass = 0; pass < 2 && n == 0; pass++) {
+        for (uint8_t i = 0; i < count; i++) {
+            if (s[i].valid && (pass || s[i].health >= REDUNDANT_HEALTH_MIN))
+                v[n++] = s[i].value[k];
+        }
+    }
+    if (n == 0)
+        return 0;
+
+    for (uint8_t i = 1; i < n; i++) { // Insertion sort of at most three values
+        int32_t x = v[i];
+        int8_t j = i - 1;
+        while (j >= 0 && v[j] > x) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = x;
+    }
+    *result = (n == 2) ? (v[0] + v[1]) / 2 : v[n / 2];
+    return n;
+}
+
+/**
+ * @brief Updates the health scores against the fused values.
+ *
+ * @param s Instances.
+ * @param count Number of instances.
+ * @param fused Fused values.
+ * @param tol Agreement tolerance of both values.
+ */
+static void Redundant_Score(RedundantSensor *s, uint8_t count, const int32_t *fused, const int32_t *tol) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (!s[i].valid)
+            continue; // Already penalised when the read failed
+        if (labs(s[i].value[0] - fused[0]) > tol[0] || labs(s[i].value[1] - fused[1]) > tol[1])
+            s[i].health = (s[i].health > REDUNDANT_HEALTH_OUTLIER) ? s[i].health - REDUNDANT_HEALTH_OUTLIER : 0;
+        else
+            s[i].health = (s[i].health + REDUNDANT_HEALTH_GOOD > REDUNDANT_HEALTH_MAX) ? REDUNDANT_HEALTH_MAX : s[i].health + REDUNDANT_HEALTH_GOOD;
+    }
+}
+
+/**
+ * @brief Writes the shared `SHT21` settings to every SHT21 instance.
+ *
+ * One write with all their multiplexer channels selected.
+ */
+void Redundant_WriteSHT21Settings() {
+    Redundant_Select(Redundant.sht, REDUNDANT_SHT21_COUNT, 0);
+    SHT21_Settings_Write();
+}
+
+/**
+ * @brief Writes `BMP280.Config` to every BMP280 instance; the oversampling goes with every trigger anyway.
+ */
+void Redundant_WriteBMP280Config() {
+    for (uint8_t i = 0; i < REDUNDANT_BMP280_COUNT; i++) {
+        Redundant_Select(&Redundant.bmp[i], 1, 0);
+        BMP280.Address = Redundant.bmp[i].address;
+        WriteBMP280Config();
+    }
+}
+
+/**
+ * @brief Configures every instance and reads the BMP280 calibration values.
+ *
+ * Every instance starts fully healthy. The sensor settings must be filled in (`BMP280.Config`,
+ * `SHT21`) before the call. The
+ * BMP280 oversampling is sent again with every forced mode trigger, so later changes of
+ * `BMP280.Config.osrs_p` need no extra write.
+ */
+void Redundant_init() {
+    for (uint8_t i = 0; i < REDUNDANT_SHT21_COUNT; i++)
+        Redundant.sht[i].health = REDUNDANT_HEALTH_MAX;
+    for (uint8_t i = 0; i < REDUNDANT_BMP280_COUNT; i++) {
+        Redundant.bmp[i].health = REDUNDANT_HEALTH_MAX;
+        Redundant_Select(&Redundant.bmp[i], 1, 0);
+        BMP280.Address = Redundant.bmp[i].address;
+        WriteBMP280Config();
+        ReadBMP280Calibration();
+        RedundantCalibration[i] = BMP280.CalibrationValues;
+    }
+    Redundant_WriteSHT21Settings();
+}
+
+/**
+ * @brief Connects one BMP280 instance and loads its address and calibration into `BMP280`.
+ *
+ * @param i Instance (index in `Redundant.bmp[]`).
+ */
+void Redundant_LoadBMP280(uint8_t i) {
+    Redundant_Select(&Redundant.bmp[i], 1, 0);
+    BMP280.Address = Redundant.bmp[i].address;
+    BMP280.CalibrationValues = RedundantCalibration[i];
+}
+
+/**
+ * @brief Starts a forced mode conversion on every BMP280 instance.
+ */
+static void Redundant_TriggerBMP280() {
+    uint8_t ctrl = (BMP280.Config.osrs_p << 5) + (BMP280.Config.osrs_t << 2) + BMP280_Mode_Forced;
+
+    for (uint8_t i = 0; i < REDUNDANT_BMP280_COUNT; i++) {
+        uint8_t first = 1;
+        for (uint8_t j = 0; j < i; j++) {
+            if (Redundant.bmp[j].address == Redundant.bmp[i].address)
+                first = 0; // Already started together with instance j
+        }
+        Redundant.bmp[i].valid = 1;
+        if (first) {
+            Redundant_Select(Redundant.bmp, REDUNDANT_BMP280_COUNT, Redundant.bmp[i].address);
+            WriteToReg(Redundant.bmp[i].address, ctrl_meas, ctrl);
+        }
+    }
+}
+
+/**
+ * @brief Reads and compensates every BMP280 instance, then votes.
+ */
+static void Redundant_ReadBMP280() {
+    for (uint8_t i = 0; i < REDUNDANT_BMP280_COUNT; i++) {
+        RedundantSensor *s = &Redundant.bmp[i];
+
+        Redundant_Select(s, 1, 0);
+        uint64_t raw = ReadMulti(s->address, press_msb, 6); // Pressure and temperature in one burst
+        if (I2C.error || raw == 0) {
+            Redundant_Fail(s);
+            continue;
+        }
+        BMP280.CalibrationValues = RedundantCalibration[i];
+        BMP280.CalibrationValues.UP = (raw >> 28) & 0xFFFFF;
+        BMP280.CalibrationValues.UT = (raw >> 4) & 0xFFFFF;
+        CalcTrueTemp();
+        CalcTruePres();
+        RedundantCalibration[i] = BMP280.CalibrationValues;
+        s->value[0] = BMP280.CalibrationValues.p;
+        s->value[1] = BMP280.CalibrationValues.T;
+        if (s->value[0] < 30000L * 256 || s->value[0] > 110000L * 256 || s->value[1] < -4000 || s->value[1] > 8500)
+            Redundant_Fail(s); // Outside the sensor's operating range
+    }
+
+    int32_t fused[2] = { BMP280.CalibrationValues.p, BMP280.CalibrationValues.T };
+    static const int32_t tol[2] = { REDUNDANT_TOL_PRESSURE, REDUNDANT_TOL_TEMPERATURE };
+    Redundant.bmpVoters = Redundant_Vote(Redundant.bmp, REDUNDANT_BMP280_COUNT, 0, &fused[0]);
+    Redundant_Vote(Redundant.bmp, REDUNDANT_BMP280_COUNT, 1, &fused[1]);
+    Redundant_Score(Redundant.bmp, REDUNDANT_BMP280_COUNT, fused, tol);
+
+    BMP280.CalibrationValues.p = fused[0];
+    BMP280.CalibrationValues.T = fused[1];
+    BMP280.Pressure = (float)fused[0] / 25600;
+    BMP280.Temperature = (float)fused[1] / 100;
+}
+
+/**
+ * @brief Starts an SHT21 conversion on every instance with one command.
+ *
+ * @param mode NO_HOLD_MASTER_T_MES or NO_HOLD_MASTER_RH_MES.
+ */
+static void Redundant_TriggerSHT21(uint8_t mode) {
+    Redundant_Select(Redundant.sht, REDUNDANT_SHT21_COUNT, 0);
+    if (SHT21_Trigger(mode)) {
+        for (uint8_t i = 0; i < REDUNDANT_SHT21_COUNT; i++)
+            Redundant_Fail(&Redundant.sht[i]); // Nobody acknowledged the command
+    }
+    Redundant.shtPolled = REDUNDANT_NONE;
+    for (uint8_t i = REDUNDANT_SHT21_COUNT; i-- > 0;) {
+        if (Redundant.sht[i].valid)
+            Redundant.shtPolled = i; // First instance still in the acquisition
+    }
+    I2C_PollStart(&SHT21.Poll, SHT21_ConversionTime(mode));
+}
+
+/**
+ * @brief Probes the running SHT21 conversion when the next probe is due.
+ *
+ * The first valid instance is probed with its read header; the others were started by the same
+ * command.
+ *
+ * @return I2C_POLL_WAIT, I2C_POLL_READY (the polled instance acknowledged, its data bytes follow)
+ *         or I2C_POLL_TIMEOUT.
+ */
+static uint8_t Redundant_SHT21Ready() {
+    if (Redundant.shtPolled == REDUNDANT_NONE)
+        return I2C_POLL_TIMEOUT; // Every instance failed, nothing to wait for
+    if (!I2C_POLL_DUE(&SHT21.Poll, 0))
+        return I2C_POLL_WAIT;
+
+    RedundantSensor *s = &Redundant.sht[Redundant.shtPolled];
+    Redundant_Select(s, 1, 0);
+    SHT21.Poll.address = s->address;
+    return I2C_PollReady(&SHT21.Poll);
+}
+
+/**
+ * @brief Reads one SHT21 result from every instance.
+ *
+ * @param k 0 for temperature (0.01 C), 1 for humidity (0.01 %).
+ * @param ready Result of the last Redundant_SHT21Ready() call.
+ */
+static void Redundant_ReadSHT21(uint8_t k, uint8_t ready) {
+    for (uint8_t i = 0; i < REDUNDANT_SHT21_COUNT; i++) {
+        RedundantSensor *s = &Redundant.sht[i];
+        if (!s->valid)
+            continue;
+
+        uint32_t raw;
+        if (ready == I2C_POLL_READY && i == Redundant.shtPolled) {
+            raw = CRC8MAXIM(SHT21_Receive()); // Read header acknowledged by the probe
+        } else {
+            Redundant_Select(s, 1, 0);
+            raw = CRC8MAXIM(SHT21_Fetch());
+        }
+        if (raw == 0 || ((raw & 2) != 0) != k) { // Read or CRC failed, or wrong measurement type
+            Redundant_Fail(s);
+            continue;
+        }
+        raw &= ~3UL; // Clear the status bits
+        if (k)
+            s->value[1] = (int32_t)((12500UL * raw) >> 16) - 600; // RH = -6 + 125 * raw / 2^16
+        else
+            s->value[0] = (int32_t)((17572UL * raw) >> 16) - 4685; // T = -46.85 + 175.72 * raw / 2^16
+    }
+}
+
+/**
+ * @brief Votes the SHT21 results into the global `SHT21` values.
+ */
+static void Redundant_FuseSHT21() {
+    int32_t fused[2] = { lround(SHT21.T * 100), lround(SHT21.RH * 100) };
+    static const int32_t tol[2] = { REDUNDANT_TOL_TEMPERATURE, REDUNDANT_TOL_HUMIDITY };
+
+    Redundant.shtVoters = Redundant_Vote(Redundant.sht, REDUNDANT_SHT21_COUNT, 0, &fused[0]);
+    Redundant_Vote(Redundant.sht, REDUNDANT_SHT21_COUNT, 1, &fused[1]);
+    Redundant_Score(Redundant.sht, REDUNDANT_SHT21_COUNT, fused, tol);
+
+    SHT21.Fault = (Redundant.shtVoters == 0);
+    SHT21.T = (float)fused[0] / 100;
+    SHT21.RH = (float)fused[1] / 100;
+}
+
+/**
+ * @brief Probes the running BMP280 conversion when the next probe is due.
+ *
+ * The last instance is probed: it got the last trigger command.
+ *
+ * @return I2C_POLL_WAIT, I2C_POLL_READY or I2C_POLL_TIMEOUT.
+ */
+static uint8_t Redundant_BMP280Ready() {
+    if (!I2C_POLL_DUE(&BMP280.Poll, 0))
+        return I2C_POLL_WAIT;
+
+    RedundantSensor *s = &Redundant.bmp[REDUNDANT_BMP280_COUNT - 1];
+    Redundant_Select(s, 1, 0);
+    BMP280.Poll.address = s->address;
+    return I2C_PollReady(&BMP280.Poll);
+}
+
+/**
+ * @brief Checks whether a sensor transaction is due now or within REDUNDANT_PENDING_US.
+ *
+ * Lower priority bus users (the display flush) call this before each slice and give up the
+ * bus when it returns 1.
+ *
+ * @return 1 if a BMP280 or SHT21 trigger, probe or read is pending.
+ */
+uint8_t Redundant_Pending() {
+    if (Redundant.bmpState == REDUNDANT_IDLE ? Microbaro.mode == MICROBARO_OFF && Sampling_Due(SAMPLING_PRESSURE) : I2C_POLL_DUE(&BMP280.Poll, REDUNDANT_PENDING_US))
+        return 1;
+    if (Redundant.shtState == REDUNDANT_IDLE ? Sampling_Due(SAMPLING_SHT) : I2C_POLL_DUE(&SHT21.Poll, REDUNDANT_PENDING_US))
+        return 1;
+    return 0;
+}
+
+/**
+ * @brief Runs the BMP280 and SHT21 acquisitions, call from the main loop.
+ *
+ * Never waits for a conversion: each call either starts conversions, reads finished ones or
+ * returns immediately.
+ */
+void Redundant_Task() {
+    uint32_t now = Timer_ms();
+    uint8_t ready;
+
+    switch (Redundant.bmpState) {
+        case REDUNDANT_IDLE:
+            if (Microbaro.mode == MICROBARO_OFF && Sampling_Begin(SAMPLING_PRESSURE)) { // Microbaro_Task() owns the sensor otherwise
+                Redundant_TriggerBMP280();
+                Redundant.bmpStart = now;
+                I2C_PollStart(&BMP280.Poll, BMP280_ConversionTime());
+                Redundant.bmpState = REDUNDANT_WAIT_T;
+            }
+            break;
+        default:
+            if (Redundant_BMP280Ready() != I2C_POLL_WAIT) { // After a timeout the reads fail and are scored
+                Redundant_ReadBMP280();
+                Redundant.bmpTime = Timer_ms() - Redundant.bmpStart;
+                Redundant.bmpState = REDUNDANT_IDLE;
+                Sampling_End(SAMPLING_PRESSURE, UNIT_RAW(UNIT_CONVERT(PASCAL_Q8, PASCAL, UNIT(PASCAL_Q8, BMP280.CalibrationValues.p))));
+            }
+            break;
+    }
+
+    switch (Redundant.shtState) {
+        case REDUNDANT_IDLE:
+            if (Sampling_Begin(SAMPLING_SHT)) {
+                for (uint8_t i = 0; i < REDUNDANT_SHT21_COUNT; i++)
+                    Redundant.sht[i].valid = 1;
+                Redundant.shtStart = now;
+                Redundant_TriggerSHT21(NO_HOLD_MASTER_T_MES);
+                Redundant.shtState = REDUNDANT_WAIT_T;
+            }
+            break;
+        case REDUNDANT_WAIT_T:
+            if ((ready = Redundant_SHT21Ready()) != I2C_POLL_WAIT) {
+                Redundant_ReadSHT21(0, ready);
+                Redundant_TriggerSHT21(NO_HOLD_MASTER_RH_MES);
+                Redundant.shtState = REDUNDANT_WAIT_RH;
+            }
+            break;
+        default:
+            if ((ready = Redundant_SHT21Ready()) != I2C_POLL_WAIT) {
+                Redundant_ReadSHT21(1, ready);
+                Redundant_FuseSHT21();
+                Redundant.shtTime = Timer_ms() - Redundant.shtStart;
+                Redundant.shtState = REDUNDANT_IDLE;
+                Sampling_End(SAMPLING_SHT, UNIT_RAW(UNIT_FROM_FLOAT(CELSIUS_100, SHT21.T)));
+            }
+            break;
+    }
+}
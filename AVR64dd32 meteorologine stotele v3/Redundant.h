@@ -0,0 +1,107 @@
+/**
+ * @file Redundant.h
+ * @brief Header file for redundant BMP280 and SHT21 sensor sets.
+ *
+ * Up to three instances of each sensor can be fitted, on the main bus with a different address
+ * (BMP280 0x76 / 0x77) or behind a TCA9548A multiplexer channel (any sensor, same address).
+ * All instances are started with one command, convert in parallel and are read back one after
+ * another as soon as one of them reports the conversion done, so acquiring N sensors takes
+ * about as long as acquiring one. Results are fused by median voting; every instance keeps a
+ * health score and unhealthy instances are left out of the vote until they agree again.
+ *
+ * @author Saulius
+ * @date 2025-01-10
+ */
+
+#ifndef REDUNDANT_H_
+#define REDUNDANT_H_
+
+/**
+ * @brief Number of fitted BMP280 and SHT21 instances (1 to 3), see RedundantVar.h for their slots.
+ */
+#define REDUNDANT_BMP280_COUNT 1
+#define REDUNDANT_SHT21_COUNT  1
+
+/**
+ * @brief Set to 1 when any instance sits behind the TCA9548A multiplexer.
+ */
+#define REDUNDANT_MUX 0
+
+/**
+ * @brief Multiplexer channel value of an instance wired to the main bus.
+ */
+#define REDUNDANT_DIRECT 0xFF
+
+/**
+ * @brief Instance index meaning no instance.
+ */
+#define REDUNDANT_NONE 0xFF
+
+/**
+ * @brief Display traffic yields the bus to sensor transactions due within this time (us).
+ *
+ * A little more than one display flush slice (SCREEN_FLUSH_BUDGET bytes), so a slice started
+ * just before a conversion ends cannot delay the read.
+ */
+#define REDUNDANT_PENDING_US 1000
+
+/** @name Health scoring (0 to REDUNDANT_HEALTH_MAX) */
+///@{
+#define REDUNDANT_HEALTH_MAX     100 /**< Score of a sensor that has always agreed */
+#define REDUNDANT_HEALTH_MIN     40  /**< Lowest score that still takes part in the vote */
+#define REDUNDANT_HEALTH_FAIL    25  /**< Penalty for a failed read (NACK, CRC, out of range) */
+#define REDUNDANT_HEALTH_OUTLIER 10  /**< Penalty for disagreeing with the fused value */
+#define REDUNDANT_HEALTH_GOOD    5   /**< Reward for a good read that agrees */
+///@}
+
+/** @name Agreement tolerances */
+///@{
+#define REDUNDANT_TOL_PRESSURE    (50L * 256) /**< 50 Pa, in BMP280 Q24.8 Pa */
+#define REDUNDANT_TOL_TEMPERATURE 50          /**< 0.5 C, in 0.01 C */
+#define REDUNDANT_TOL_HUMIDITY    300         /**< 3 %, in 0.01 % */
+///@}
+
+/**
+ * @brief Acquisition states.
+ */
+typedef enum {
+    REDUNDANT_IDLE,    /**< Waiting for the sampling engine */
+    REDUNDANT_WAIT_T,  /**< Temperature (BMP280: temperature and pressure) conversion running */
+    REDUNDANT_WAIT_RH  /**< SHT21 humidity conversion running */
+} redundant_state_t;
+
+/**
+ * @brief One sensor instance.
+ */
+typedef struct {
+    uint8_t address;   /**< I2C address */
+    uint8_t channel;   /**< TCA9548A channel (0-7) or REDUNDANT_DIRECT */
+    uint8_t health;    /**< Health score */
+    uint8_t valid;     /**< 1 when every read of the current acquisition succeeded */
+    uint16_t failures; /**< Failed acquisitions since start-up */
+    int32_t value[2];  /**< BMP280: pressure (Q24.8 Pa), temperature (0.01 C); SHT21: temperature (0.01 C), RH (0.01 %) */
+} RedundantSensor;
+
+/**
+ * @brief Redundant sensor sets and their acquisition state.
+ */
+typedef struct {
+    RedundantSensor bmp[REDUNDANT_BMP280_COUNT]; /**< BMP280 instances */
+    RedundantSensor sht[REDUNDANT_SHT21_COUNT];  /**< SHT21 instances */
+    uint8_t bmpState;   /**< BMP280 acquisition state (redundant_state_t) */
+    uint8_t shtState;   /**< SHT21 acquisition state (redundant_state_t) */
+    uint32_t bmpStart;  /**< Start of the running BMP280 acquisition (ms) */
+    uint32_t shtStart;  /**< Start of the running SHT21 acquisition (ms) */
+    uint16_t bmpTime;   /**< Duration of the last BMP280 acquisition, trigger to fused value (ms) */
+    uint16_t shtTime;   /**< Duration of the last SHT21 acquisition (ms) */
+    uint8_t bmpVoters;  /**< Instances in the last BMP280 vote (0 = no valid reading, last value kept) */
+    uint8_t shtVoters;  /**< Instances in the last SHT21 vote */
+    uint8_t shtPolled;  /**< SHT21 instance probed for the end of the conversion, REDUNDANT_NONE if none is valid */
+} RedundantSensors;
+
+/**
+ * @brief Global redundant sensor state.
+ */
+extern RedundantSensors Redundant;
+
+#endif /* REDUNDANT_H_ */
@@ -0,0 +1,38 @@
+/**
+ * @file RedundantVar.h
+ * @brief Sensor slots of the redundant BMP280 and SHT21 sets.
+ *
+ * One entry per fitted instance (REDUNDANT_BMP280_COUNT / REDUNDANT_SHT21_COUNT). Examples:
+ * - two BMP280 on the main bus: `{ BMP280Add, REDUNDANT_DIRECT }`, `{ BMP280Add + 1, REDUNDANT_DIRECT }`
+ * - three SHT21 behind the multiplexer: `{ SHT21_ADD, 0 }`, `{ SHT21_ADD, 1 }`, `{ SHT21_ADD, 2 }`
+ *
+ * Instances with the same address must be on different multiplexer channels, and not on the
+ * main bus at the same time.
+ *
+ * @author Saulius
+ * @date 2025-01-10
+ */
+
+#ifndef REDUNDANTVAR_H_
+#define REDUNDANTVAR_H_
+
+/**
+ * @brief Global redundant sensor state (health scores are set by Redundant_init()).
+ */
+RedundantSensors Redundant = {
+    .bmp = {
+        { .address = BMP280Add, .channel = REDUNDANT_DIRECT },
+    },
+    .sht = {
+        { .address = SHT21_ADD, .channel = REDUNDANT_DIRECT },
+    },
+    .bmpState = REDUNDANT_IDLE,
+    .shtState = REDUNDANT_IDLE
+};
+
+/**
+ * @brief Calibration and compensation state of every BMP280 instance.
+ */
+BMP280Values RedundantCalibration[REDUNDANT_BMP280_COUNT];
+
+#endif /* REDUNDANTVAR_H_ */
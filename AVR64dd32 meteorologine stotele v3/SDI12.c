@@ -0,0 +1,345 @@
+/**
+ * @file SDI12.c
+ * @brief SDI-12 sensor interface: break detection, bit timing and command handling in interrupts.
+ *
+ * TCB1_INT_vect detects breaks, PORTD_PORT_vect catches start bits and TCB2_INT_vect receives
+ * and sends the bits and decodes a command as soon as its '!' arrives. The main loop only
+ * refreshes the measurement snapshot (SDI12_Task()).
+ *
+ * @author Saulius
+ * @date 2025-01-17
+ */
+
+#include "Settings.h"
+#include "SDI12Var.h"
+
+/**
+ * @brief Even parity bit of a 7-bit character.
+ */
+static uint8_t SDI12_Parity(uint8_t c) {
+    c ^= c >> 4;
+    c ^= c >> 2;
+    c ^= c >> 1;
+    return c & 1;
+}
+
+/**
+ * @brief Releases the line and waits for the next start bit.
+ */
+static void SDI12_Listen() {
+    TCB2.CTRLA = 0; // Bit timer off until the next start bit
+    GPIO_INPUT(SDI12);
+    GPIO_CLEAR_FLAG(SDI12);
+    GPIO_CTRL(SDI12) = PORT_INVEN_bm | PORT_ISC_FALLING_gc;
+    SDI12.state = SDI12_LISTEN;
+}
+
+/**
+ * @brief Appends the value text of one page of the latched snapshot to the response.
+ *
+ * @param k Response length so far.
+ * @param page Page number.
+ * @return New response length.
+ */
+static uint8_t SDI12_Page(uint8_t k, uint8_t page) {
+    const SDI12Snapshot *s = &SDI12.snapshot[SDI12.latched];
+
+    if (page < SDI12_PAGES) {
+        for (uint8_t i = s->page[page]; i < s->page[page + 1]; i++)
+            SDI12.response[k++] = s->text[i];
+    }
+    if (SDI12.crc) { // CRC-16/ARC of the response so far as three printable characters
+        uint16_t crc = CRC16_Modbus_Update(CRC16_SDI12_INIT, SDI12.response, k);
+        SDI12.response[k++] = 0x40 | (crc >> 12);
+        SDI12.response[k++] = 0x40 | ((crc >> 6) & 0x3F);
+        SDI12.response[k++] = 0x40 | (crc & 0x3F);
+    }
+    return k;
+}
+
+/**
+ * @brief Appends a string to the response.
+ */
+static uint8_t SDI12_Append(uint8_t k, const char *s) {
+    while (*s)
+        SDI12.response[k++] = *s++;
+    return k;
+}
+
+/**
+ * @brief Decodes the received command and prepares the response.
+ *
+ * @return 1 if there is a response to send, 0 if the command is ignored (another sensor's
+ *         address, unsupported or damaged command).
+ */
+static uint8_t SDI12_Decode() {
+    const char *c = SDI12.command;
+    uint8_t n = SDI12.commandLength;
+    uint8_t k = 1;
+
+    if (n == 0 || n >= SDI12_COMMAND_SIZE)
+        return 0;
+    if (n == 1 && c[0] == '?') { // Address query
+        SDI12.response[0] = SDI12.address;
+    } else if (c[0] != SDI12.address) {
+        return 0;
+    } else {
+        SDI12.commands++;
+        SDI12.response[0] = SDI12.address;
+        char x = (n > 2) ? c[2] : 0;
+        switch (n == 1 ? '!' : c[1]) {
+            case '!': // Acknowledge active
+                break;
+            case 'I':
+                k = SDI12_Append(k, SDI12_IDENTIFICATION);
+                break;
+            case 'A': // Change address (kept until reset)
+                if (n != 3 || !((x >= '0' && x <= '9') || (x >= 'a' && x <= 'z') || (x >= 'A' && x <= 'Z')))
+                    return 0;
+                SDI12.address = x;
+                SDI12.response[0] = x;
+                break;
+            case 'V': // Verification: no values
+                k = SDI12_Append(k, "0000");
+                break;
+            case 'M':
+            case 'C':
+                if (n == 2 || (n == 3 && x == 'C')) { // Latch the newest snapshot, ready now
+                    SDI12.latched = SDI12.front;
+                    SDI12.crc = (n == 3);
+                    k = SDI12_Append(k, c[1] == 'M' ? "000" : "0000");
+                    SDI12.response[k++] = '0' + SDI12_VALUES;
+                } else if (x >= '1' && x <= '9') { // Additional measurements: none
+                    k = SDI12_Append(k, c[1] == 'M' ? "0000" : "00000");
+                } else {
+                    return 0;
+                }
+                break;
+            case 'D':
+                if (n != 3 || x < '0' || x > '9')
+                    return 0;
+                k = SDI12_Page(k, x - '0');
+                break;
+            default:
+                return 0;
+        }
+    }
+    SDI12.response[k++] = '\r';
+    SDI12.response[k++] = '\n';
+    SDI12.responseLength = k;
+    SDI12.responseNext = 0;
+    return 1;
+}
+
+/**
+ * @brief Samples one bit of the character being received, handles the character after its stop bit.
+ */
+static void SDI12_ReceiveBit() {
+    uint8_t level = GPIO_IS_HIGH(SDI12);
+
+    if (SDI12.bit < 8) { // 7 data bits LSB first, then parity
+        if (level)
+            SDI12.shift |= 1 << SDI12.bit;
+        SDI12.bit++;
+        return;
+    }
+
+    uint8_t c = SDI12.shift;
+    if (!level || SDI12_Parity(c)) { // Framing or parity error (all zero: a break is starting)
+        if (c || level)
+            SDI12.errors++;
+        SDI12.commandLength = 0;
+        SDI12_Listen();
+        return;
+    }
+    c &= 0x7F;
+    SDI12.lastActivity = Timer_ms();
+    if (c != '!') {
+        if (SDI12.commandLength < SDI12_COMMAND_SIZE)
+            SDI12.command[SDI12.commandLength++] = c;
+        SDI12_Listen();
+        return;
+    }
+
+    SDI12.commandEnd = Timer_us();
+    uint8_t respond = SDI12_Decode();
+    SDI12.commandLength = 0;
+    if (!respond) {
+        SDI12_Listen();
+        return;
+    }
+    // Take the line: marking now, the response after SDI12_MARK_BITS bit times
+    GPIO_CTRL(SDI12) = PORT_INVEN_bm | PORT_ISC_INTDISABLE_gc;
+    GPIO_HIGH(SDI12);
+    GPIO_OUTPUT(SDI12);
+    SDI12.bit = SDI12_MARK_BITS;
+    SDI12.state = SDI12_MARK;
+}
+
+/**
+ * @brief Drives the next bit of the response, releases the line after the last stop bit.
+ */
+static void SDI12_SendBit() {
+    uint8_t b = SDI12.bit;
+    uint8_t level;
+
+    if (b == 0) { // Start bit of the next character
+        if (SDI12.responseNext == SDI12.responseLength) {
+            SDI12.lastActivity = Timer_ms();
+            SDI12_Listen();
+            return;
+        }
+        if (SDI12.responseNext == 0) {
+            uint32_t t = Timer_us() - SDI12.commandEnd;
+            if (t > SDI12.turnaround)
+                SDI12.turnaround = (t > UINT16_MAX) ? UINT16_MAX : t;
+        }
+        uint8_t c = SDI12.response[SDI12.responseNext++] & 0x7F;
+        SDI12.shift = c | (SDI12_Parity(c) << 7);
+        level = 0;
+    } else if (b <= 8) {
+        level = (SDI12.shift >> (b - 1)) & 1;
+    } else {
+        level = 1; // Stop bit
+    }
+    if (level)
+        GPIO_HIGH(SDI12);
+    else
+        GPIO_LOW(SDI12);
+    SDI12.bit = (b == 9) ? 0 : b + 1;
+}
+
+/**
+ * @brief Configures the pin, the break detector (TCB1) and the bit timer (TCB2).
+ */
+void SDI12_init() {
+    GPIO_INPUT(SDI12);
+    GPIO_HIGH(SDI12); // Marking whenever the pin drives the line
+    GPIO_CTRL(SDI12) = PORT_INVEN_bm | PORT_ISC_FALLING_gc; // Inverted: the event to TCB1 too
+
+    EVSYS.SDI12_EVSYS_CHANNEL = SDI12_EVSYS_GENERATOR;
+    EVSYS.USERTCB1CAPT = SDI12_EVSYS_USER;
+
+    TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV64_gc | TCA_SINGLE_ENABLE_bm; // 375 kHz clock for TCB1: 174 ms range
+    TCB1.CTRLB = TCB_CNTMODE_PW_gc; // Pulse width measurement
+    TCB1.EVCTRL = TCB_CAPTEI_bm | TCB_EDGE_bm; // Cleared at the start of spacing, captured at its end
+    TCB1.INTCTRL = TCB_CAPT_bm;
+    TCB1.CTRLA = TCB_CLKSEL_TCA0_gc | TCB_ENABLE_bm;
+
+    TCB2.CTRLB = TCB_CNTMODE_INT_gc;
+    TCB2.INTCTRL = TCB_CAPT_bm;
+    CPUINT.LVL1VEC = TCB2_INT_vect_num; // Bit timing must not wait behind other interrupts
+}
+
+/**
+ * @brief Refreshes the measurement snapshot when due, call from the main loop.
+ *
+ * Writes the buffer that is neither the newest nor the latched one, then publishes it, so the
+ * interrupt side never sees a half written snapshot.
+ */
+void SDI12_Task() {
+    static const char formats[SDI12_VALUES][6] PROGMEM = { "%+.2f", "%+.2f", "%+.2f", "%+.0f", "%+.0f", "%+.0f", "%+.2f", "%+.1f", "%+.2f" };
+    uint32_t now = Timer_ms();
+
+    if ((int32_t)(now - SDI12.nextSnapshot) < 0)
+        return;
+    SDI12.nextSnapshot = now + SDI12_SNAPSHOT_MS;
+
+    uint8_t w = 0;
+    while (w == SDI12.front || w == SDI12.latched)
+        w++;
+
+    Derived_Refresh(DERIVED_BIT(DERIVED_DEW_POINT));
+    float v[SDI12_VALUES] = {
+        SHT21.T,                     // Air temperature, C
+        SHT21.RH,                    // Relative humidity, %
+        BMP280.Pressure,             // Pressure, hPa
+        Wind.speed,                  // Wind speed, m/s
+        Wind.direction * 45,         // Wind direction, degrees
+        SUN.sunlevel,                // Light level, mV
+        SHT21.Td,                    // Dew point, C
+        Turbulence.intensity / 10.0, // Turbulence intensity, %
+        Turbulence.gustFactor / 100.0 // Gust factor
+    };
+
+    SDI12Snapshot *s = &SDI12.snapshot[w];
+    uint8_t length = 0, page = 0;
+    s->page[0] = 0;
+    for (uint8_t i = 0; i < SDI12_VALUES; i++) {
+        char value[16];
+        uint8_t n = snprintf_P(value, sizeof(value), formats[i], v[i]);
+        if (length + n > SDI12_SNAPSHOT_SIZE)
+            break;
+        if (length + n - s->page[page] > SDI12_PAGE_SIZE && page < SDI12_PAGES - 1)
+            s->page[++page] = length; // Values never straddle two pages
+        memcpy(&s->text[length], value, n);
+        length += n;
+    }
+    while (page < SDI12_PAGES)
+        s->page[++page] = length;
+    SDI12.front = w;
+}
+
+/**
+ * @brief Start bit detector: starts receiving a character; any falling edge restarts the break measurement.
+ */
+ISR(PORTD_PORT_vect) {
+    GPIO_CLEAR_FLAG(SDI12);
+    TCB1.INTFLAGS = TCB_OVF_bm; // TCB1 has just been cleared by the same edge
+    if (SDI12.state != SDI12_LISTEN)
+        return;
+    if (Timer_ms() - SDI12.lastActivity > SDI12_SLEEP_MS) {
+        SDI12.state = SDI12_SLEEP; // Too long idle, only a break wakes the sensor
+        return;
+    }
+    GPIO_CTRL(SDI12) = PORT_INVEN_bm | PORT_ISC_INTDISABLE_gc;
+    SDI12.bit = 0;
+    SDI12.shift = 0;
+    SDI12.state = SDI12_RX;
+    TCB2.CNT = 0;
+    TCB2.CCMP = SDI12_BIT_COUNTS * 3 / 2 - 1; // First sample in the middle of data bit 0
+    TCB2.INTFLAGS = TCB_CAPT_bm;
+    TCB2.CTRLA = TCB_CLKSEL_DIV2_gc | TCB_ENABLE_bm;
+}
+
+/**
+ * @brief Break detector: end of a spacing pulse, a long one is a break.
+ */
+ISR(TCB1_INT_vect) {
+    uint16_t width = TCB1.CCMP;
+    uint8_t overflow = TCB1.INTFLAGS & TCB_OVF_bm; // Longer than the counter range
+    TCB1.INTFLAGS = TCB_CAPT_bm | TCB_OVF_bm;
+
+    if (SDI12.state >= SDI12_MARK)
+        return; // Our own response
+    if (overflow || width >= SDI12_BREAK_COUNTS) {
+        SDI12.breaks++;
+        SDI12.commandLength = 0;
+        SDI12.lastActivity = Timer_ms();
+        SDI12_Listen();
+    }
+}
+
+/**
+ * @brief Bit timer: receives, marks and sends one bit per call.
+ */
+ISR(TCB2_INT_vect) {
+    TCB2.INTFLAGS = TCB_CAPT_bm;
+    TCB2.CCMP = SDI12_BIT_COUNTS - 1; // Whole bits after the first half bit
+
+    switch (SDI12.state) {
+        case SDI12_RX:
+            SDI12_ReceiveBit();
+            break;
+        case SDI12_MARK:
+            if (--SDI12.bit == 0)
+                SDI12.state = SDI12_TX;
+            break;
+        case SDI12_TX:
+            SDI12_SendBit();
+            break;
+        default:
+            TCB2.CTRLA = 0;
+            break;
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * @file SDI12.h
+ * @brief Header file for the SDI-12 sensor interface.
+ *
+ * The station answers an SDI-12 data recorder as one sensor (1200 baud, 7E1, half duplex on
+ * one wire). The AVR64DD32 has no USART left (USART0 is the RS-485 line, USART1 the clock
+ * device), so the line is driven by interrupts on a spare pin:
+ *
+ *  - the pin is inverted (PORT INVEN), so software sees TTL polarity: marking (line low) is 1,
+ *    spacing and break (line high) are 0;
+ *  - TCB1 measures every spacing pulse by input capture (pin event, pulse width mode, clocked
+ *    by TCA0 at CLK_PER / 64), a pulse of SDI12_BREAK_US or more is a break and wakes the sensor;
+ *  - a falling pin edge starts a character, TCB2 (level 1 interrupt priority) then samples the
+ *    bits in their middle and later shifts out the response, so the response starts 8.33 ms
+ *    after the last command character whatever the main loop is doing (SDI-12: within 15 ms).
+ *
+ * Commands are decoded and answered entirely from interrupt context. Measurement values come
+ * from a snapshot that SDI12_Task() formats in the main loop every SDI12_SNAPSHOT_MS; aM! and
+ * aC! latch the newest snapshot and report it as ready at once (ttt = 000), aD0! ... return its
+ * pages. Supported: a!, ?!, aI!, aAb!, aM!, aMC!, aC!, aCC!, aV!, aDn! (aM1! ... report no
+ * values). The line needs the usual SDI-12 front end (5 V data line, series resistor); the
+ * address is kept in RAM.
+ *
+ * @author Saulius
+ * @date 2025-01-17
+ */
+
+#ifndef SDI12_H_
+#define SDI12_H_
+
+/** @name Event generator of the pin (PIN_SDI12 in GPIO.h, PD4) and the channel carrying it to TCB1 */
+///@{
+#define SDI12_EVSYS_CHANNEL CHANNEL2
+#define SDI12_EVSYS_GENERATOR EVSYS_CHANNEL2_PORTD_PIN4_gc
+#define SDI12_EVSYS_USER EVSYS_USER_CHANNEL2_gc
+///@}
+
+#define SDI12_ADDRESS '0'         /**< Address at start-up */
+#define SDI12_IDENTIFICATION "14SAULIUS METEO3300" /**< aI! response after the address: version 1.4, vendor (8), model (6), version (3) */
+#define SDI12_BIT_COUNTS (F_CPU / 2 / 1200) /**< TCB2 counts per bit (CLK_PER / 2) */
+#define SDI12_MARK_BITS 10        /**< Marking before a response: 8.33 ms */
+#define SDI12_BREAK_US 9000       /**< Shortest break; a character has at most 9 spacing bits (7.5 ms) */
+#define SDI12_BREAK_COUNTS ((uint16_t)(SDI12_BREAK_US * (F_CPU / 64 / 1000) / 1000)) /**< In TCB1 (TCA0) counts */
+#define SDI12_SLEEP_MS 100        /**< Marking after which a new break is needed */
+#define SDI12_SNAPSHOT_MS 1000    /**< Snapshot refresh period */
+#define SDI12_VALUES 9            /**< Values per snapshot */
+#define SDI12_PAGE_SIZE 35        /**< Longest value text per aDn! response (aM! limit) */
+#define SDI12_PAGES 4             /**< Pages per snapshot */
+#define SDI12_SNAPSHOT_SIZE 80    /**< Value text of one snapshot */
+#define SDI12_COMMAND_SIZE 8      /**< Longest command, '!' included */
+#define SDI12_RESPONSE_SIZE 48    /**< Longest response, CR LF included */
+
+/**
+ * @brief Line states.
+ */
+typedef enum {
+    SDI12_SLEEP,  /**< Waiting for a break */
+    SDI12_LISTEN, /**< Awake, waiting for a start bit */
+    SDI12_RX,     /**< Receiving a character */
+    SDI12_MARK,   /**< Driving the marking before a response */
+    SDI12_TX      /**< Sending the response */
+} sdi12_state_t;
+
+/**
+ * @brief Measurement values, formatted for aDn! responses.
+ */
+typedef struct {
+    char text[SDI12_SNAPSHOT_SIZE];  /**< Values, each with its sign, no terminator */
+    uint8_t page[SDI12_PAGES + 1];   /**< Start of each page in text[], page[SDI12_PAGES] is the end */
+} SDI12Snapshot;
+
+/**
+ * @brief Line, command and snapshot state.
+ */
+typedef struct {
+    volatile uint8_t state;   /**< sdi12_state_t */
+    char address;             /**< Sensor address */
+    uint8_t bit;              /**< Bit of the character being received or sent */
+    uint8_t shift;            /**< Character being received or sent */
+    char command[SDI12_COMMAND_SIZE]; /**< Command being received */
+    uint8_t commandLength;
+    char response[SDI12_RESPONSE_SIZE]; /**< Response being sent */
+    uint8_t responseLength;
+    uint8_t responseNext;     /**< Next character of the response */
+    uint32_t lastActivity;    /**< End of the last character on the line (ms) */
+    uint32_t commandEnd;      /**< End of the last command (Timer_us()) */
+
+    SDI12Snapshot snapshot[3]; /**< Triple buffer: newest, latched, being written */
+    volatile uint8_t front;   /**< Newest complete snapshot */
+    volatile uint8_t latched; /**< Snapshot latched by the last aM!/aC! */
+    uint8_t crc;              /**< 1 if the latched measurement was requested with CRC */
+    uint32_t nextSnapshot;    /**< Time of the next snapshot refresh (Timer_ms()) */
+
+    volatile uint16_t breaks;    /**< Breaks detected */
+    volatile uint16_t commands;  /**< Commands addressed to this sensor */
+    volatile uint16_t errors;    /**< Characters with a parity or framing error */
+    volatile uint16_t turnaround; /**< Longest time from a command to its response start bit (us) */
+} SDI12State;
+
+/**
+ * @brief Global SDI-12 interface state.
+ */
+extern SDI12State SDI12;
+
+#endif /* SDI12_H_ */
@@ -0,0 +1,22 @@
+/**
+ * @file SDI12Var.h
+ * @brief Variable definition of the SDI-12 sensor interface.
+ *
+ * @author Saulius
+ * @date 2025-01-17
+ */
+
+#ifndef SDI12VAR_H_
+#define SDI12VAR_H_
+
+/**
+ * @brief SDI-12 state: asleep until the first break, no measurement latched yet.
+ */
+SDI12State SDI12 = {
+    .state = SDI12_SLEEP,
+    .address = SDI12_ADDRESS,
+    .front = 0,
+    .latched = 0
+};
+
+#endif /* SDI12VAR_H_ */
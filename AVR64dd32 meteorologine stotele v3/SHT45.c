@@ -40,6 +40,23 @@ void SHT21_Settings_Write(){
 	WriteToReg(SHT21_ADD, W_USER_REG, SHT21.Resolution + (SHT21.Heater << HEATER_ADD) + (SHT21.OTP_DISABLE << OTP_ADD) + (SHT21.Battery << BATTERY_ADD));
 }
 
+/**
+ * @brief No hold master conversion time (us, datasheet maximum + 1 ms) at the current resolution.
+ *
+ * @param mode NO_HOLD_MASTER_T_MES or NO_HOLD_MASTER_RH_MES.
+ */
+uint32_t SHT21_ConversionTime(uint8_t mode){
+	uint8_t t = (mode == NO_HOLD_MASTER_T_MES);
+	uint8_t ms;
+	switch(SHT21.Resolution){
+		case RH_11b_T_11b: ms = t ? 12 : 16; break;
+		case RH_10b_T_13b: ms = t ? 44 : 10; break;
+		case RH_8b_T_12b:  ms = t ? 23 : 5; break;
+		default:           ms = t ? 86 : 30; break;
+	}
+	return ms * 1000UL;
+}
+
 /**
  * @brief Reads data from the SHT21 sensor.
  *
@@ -47,10 +64,14 @@ void SHT21_Settings_Write(){
  * depending on the provided mode. It handles both "hold" and "no hold" master 
  * reading modes. In hold mode, the sensor waits for the measurement to complete, 
  * while in no hold mode, the measurement is performed while the master device 
- * communicates with the sensor.
+ * communicates with the sensor; the result is then read as soon as the sensor
+ * acknowledges its read header (SHT21.Poll), not after the worst case time.
+ * A no hold read does not wait: the first call triggers the measurement, every call
+ * probes it at most once and returns SHT21_PENDING until the result is read, so the
+ * caller returns to the main loop and calls again with the same mode on the next pass.
  *
  * @param mode The mode of measurement: temperature or humidity.
- * @return The raw sensor data (32-bit).
+ * @return The raw sensor data (32-bit), SHT21_PENDING while a no hold measurement runs.
  */
 uint32_t SHT21_Read(uint8_t mode){
 	// Faster read for hold modes (temperature or humidity measurement)
@@ -59,57 +80,76 @@ uint32_t SHT21_Read(uint8_t mode){
 	}
 	// Slower read for no hold modes (temperature or humidity measurement)
 	else if((mode == NO_HOLD_MASTER_T_MES) || (mode == NO_HOLD_MASTER_RH_MES)){
-		if(!TransmitAdd(SHT21_ADD, WRITE)){
-			if(!TransmitByte(mode)){
-				_delay_us(20); // Wait for the measurement to complete
-				TWI0.MCTRLB = TWI_MCMD_STOP_gc; // Stop condition to finish the transmission
-				// Handle different resolutions for different measurement delays
-				switch(SHT21.Resolution){
-					case RH_11b_T_11b:
-						if(mode == NO_HOLD_MASTER_T_MES)
-							_delay_ms(11);
-						else
-							_delay_ms(15);
-						break;
-					case RH_10b_T_13b:
-						if(mode == NO_HOLD_MASTER_T_MES)
-							_delay_ms(43);
-						else
-							_delay_ms(9);
-						break;
-					case RH_8b_T_12b:
-						if(mode == NO_HOLD_MASTER_T_MES)
-							_delay_ms(22);
-						else
-							_delay_ms(4);
-						break;
-					default:
-						if(mode == NO_HOLD_MASTER_T_MES)
-							_delay_ms(85);
-						else
-							_delay_ms(29);
-						break;
-				}
-				uint32_t data = 0;
-				if(!TransmitAdd(SHT21_ADD, READ)){
-					// Read the data byte by byte and reconstruct the 32-bit result
-					for (int i = 0; i < 3; i++) {
-						uint8_t byte = 0;
-						ReadByteInf(i < 2 ? 1 : 0, &byte); // ACK for first two bytes, NACK for last byte
-						if(I2C.error)
-							break;
-						else
-							data |= ((uint32_t)byte << (8 * (2 - i))); // Insert byte into the correct position
-					}
-					TWI0.MCTRLB |= TWI_MCMD_STOP_gc; // Send stop condition
-					return data;
-				}
-			}
+		if(SHT21.Pending != mode){ // No measurement of this mode running yet: start one
+			if(SHT21_Trigger(mode))
+				return 0;
+			I2C_PollStart(&SHT21.Poll, SHT21_ConversionTime(mode));
+			SHT21.Pending = mode;
 		}
+		// Probe with the read header when due, at most the worst case time
+		uint8_t ready = I2C_PollReady(&SHT21.Poll);
+		if(ready == I2C_POLL_WAIT)
+			return SHT21_PENDING;
+		SHT21.Pending = 0;
+		if(ready == I2C_POLL_READY)
+			return SHT21_Receive();
 	}
 	return 0; // Return 0 if read failed
 }
 
+/**
+ * @brief Starts a no hold master measurement.
+ *
+ * The command is sent and the bus released; the result is read later with SHT21_Fetch().
+ * With several multiplexer channels selected the command starts all sensors at once.
+ *
+ * @param mode NO_HOLD_MASTER_T_MES or NO_HOLD_MASTER_RH_MES.
+ * @return 0 on success, I2C error code otherwise.
+ */
+uint8_t SHT21_Trigger(uint8_t mode){
+	if(!TransmitAdd(SHT21_ADD, WRITE)){
+		if(!TransmitByte(mode)){
+			_delay_us(20); // Let the sensor latch the command
+			TWI0.MCTRLB = TWI_MCMD_STOP_gc; // Stop condition to finish the transmission
+			return 0;
+		}
+	}
+	return I2C.error;
+}
+
+/**
+ * @brief Reads the result of a no hold master measurement.
+ *
+ * The sensor does not acknowledge its address while the conversion is still running.
+ *
+ * @return The raw sensor data (two data bytes and CRC), 0 if the read failed.
+ */
+uint32_t SHT21_Fetch(){
+	if(!TransmitAdd(SHT21_ADD, READ))
+		return SHT21_Receive();
+	return 0;
+}
+
+/**
+ * @brief Reads the result bytes after an acknowledged read header and ends the transfer.
+ *
+ * @return The raw sensor data (two data bytes and CRC), 0 if the read failed.
+ */
+uint32_t SHT21_Receive(){
+	uint32_t data = 0;
+	// Read the data byte by byte and reconstruct the 32-bit result
+	for (int i = 0; i < 3; i++) {
+		uint8_t byte = 0;
+		ReadByteInf(i < 2 ? 1 : 0, &byte); // ACK for first two bytes, NACK for last byte
+		if(I2C.error)
+			break;
+		else
+			data |= ((uint32_t)byte << (8 * (2 - i))); // Insert byte into the correct position
+	}
+	TWI0.MCTRLB |= TWI_MCMD_STOP_gc; // Send stop condition
+	return I2C.error ? 0 : data;
+}
+
 /**
  * @brief Separates the sensor data into temperature or humidity.
  *
@@ -80,6 +80,20 @@
 #define RH_10b_T_13b 128 // 10-bit RH, 13-bit temperature resolution
 #define RH_11b_T_11b 129 // 11-bit RH, 11-bit temperature resolution
 
+/**
+ * @brief Ready probe interval in no hold master mode (us).
+ * 
+ * One probe (read header) takes about 10 us of bus time.
+ */
+#define SHT21_POLL_US 500
+
+/**
+ * @brief SHT21_Read() result while a no hold measurement is still converting.
+ * 
+ * Not a possible raw value: those have 24 bits (two data bytes and CRC).
+ */
+#define SHT21_PENDING 0xFFFFFFFFUL
+
 /**
  * @brief ON/OFF constants for enabling/disabling features in the SHT21 sensor.
  * 
@@ -106,6 +120,9 @@ typedef struct {
 	float RH; // Calculated relative humidity in percentage
 	uint8_t Fault; // Flag for CRC correctness (0: valid CRC, 1: invalid CRC)
 	float e; // Vapor pressure calculation (optional, for advanced applications)
+	float Td; // Dew point in Celsius
+	I2C_Poll Poll; // No hold master conversion ready poll (read header) and measured conversion times
+	uint8_t Pending; // No hold mode SHT21_Read() waits for, 0 if none
 } SHT;
 
 /**
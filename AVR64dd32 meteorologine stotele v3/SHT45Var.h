@@ -30,6 +30,7 @@ SHT SHT21 = {
     .Battery = 0,       ///< Battery detection disabled (2.25V detection off)
     .Heater = 0,        ///< Heater turned off
     .Resolution = 0,    ///< Default resolution setting for temperature and humidity
+    .Poll = { .address = SHT21_ADD, .reg = I2C_POLL_ACK, .interval = SHT21_POLL_US, .ratio = 192 }, ///< Typical time 3/4 of the worst case until measured
 };
 
 #endif /* SHT45VAR_H_ */
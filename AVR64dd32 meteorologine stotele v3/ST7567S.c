@@ -13,28 +13,123 @@
 #include "Settings.h"
 #include "ST7567Var.h"
 #include "font.h"
+#include "LayoutsVar.h"
 
 /**
  * @brief Sends a command byte to the ST7567S display.
  * 
- * This function writes a single command byte to the display, using the appropriate 
- * command register.
+ * Page and column address commands only move the frame buffer cursor; screen_flush() 
+ * addresses the glass itself. Every other command (and its argument) is sent at once.
  * 
  * @param cmd The command byte to send to the display.
  */
 void screen_command(uint8_t cmd) {
+    if (Screen.commandArg) {
+        Screen.commandArg = 0;  ///< Argument of the previous command
+    } else if ((cmd & 0xF0) == 0xB0) {
+        Screen.page = cmd & 0x07;  ///< Set page address
+        return;
+    } else if ((cmd & 0xF0) == 0x10) {
+        Screen.column = (Screen.column & 0x0F) | (cmd << 4);  ///< Set column address, high nibble
+        return;
+    } else if ((cmd & 0xF0) == 0x00) {
+        Screen.column = (Screen.column & 0xF0) | cmd;  ///< Set column address, low nibble
+        return;
+    } else if (cmd == 0x81) {
+        Screen.commandArg = 1;  ///< Contrast value follows
+    }
     WriteToReg(ST7567S_ADD, 0x00, cmd);  ///< Send command to ST7567S display
 }
 
 /**
- * @brief Sends data byte to the ST7567S display.
+ * @brief Writes a data byte to the frame buffer at the cursor.
  * 
- * This function writes a single data byte to the display.
+ * The cursor advances like the display's column address. The byte is marked dirty only 
+ * when it differs from what is already on the glass (or queued for it).
  * 
  * @param data The data byte to send to the display.
  */
 void screen_data(uint8_t data) {
-    WriteToReg(ST7567S_ADD, 0x40, data);  ///< Send data to ST7567S display
+    uint8_t page = Screen.page, column = Screen.column;
+
+    if (column >= ST7567S_SCREEN_WIDTH)
+        return;  ///< Past the right edge, the display ignores it too
+    Screen.column = column + 1;
+    if (Screen.frame[page][column] == data)
+        return;
+    Screen.frame[page][column] = data;
+    if (column < Screen.dirtyFirst[page]) {
+        if (Screen.dirtyFirst[page] == SCREEN_CLEAN)
+            Screen.dirtyLast[page] = column;
+        Screen.dirtyFirst[page] = column;
+    }
+    if (column > Screen.dirtyLast[page])
+        Screen.dirtyLast[page] = column;
+}
+
+/**
+ * @brief Sends a column range of one frame buffer page to the glass in one burst.
+ * 
+ * @param page Display page.
+ * @param column First column.
+ * @param length Number of columns.
+ */
+static void screen_send(uint8_t page, uint8_t column, uint8_t length) {
+    uint8_t cmd[4] = {0x00, 0xB0 | page, 0x10 | (column >> 4), column & 0x0F};
+    const uint8_t *data = &Screen.frame[page][column];
+
+    if (!TransmitAdd(ST7567S_ADD, WRITE)) {
+        for (uint8_t i = 0; i < 4; i++) {
+            TransmitByte(cmd[i]);  ///< Control byte (commands) + page and column address
+        }
+        if (!TransmitAdd(ST7567S_ADD, WRITE)) {  ///< Repeated start for the data burst
+            TransmitByte(0x40);  ///< Control byte: data follows
+            for (uint8_t i = 0; i < length; i++) {
+                if (TransmitByte(data[i]))
+                    break;  ///< Stop on bus error
+            }
+        }
+    }
+    TWI0.MCTRLB |= TWI_MCMD_STOP_gc;  ///< Release the bus
+}
+
+/**
+ * @brief Sends the next slice of the changed frame buffer bytes to the display.
+ * 
+ * Call once per main loop pass. At most SCREEN_FLUSH_BUDGET bytes are sent per call, and 
+ * the flush stops early while a sensor transaction is pending, so display traffic never 
+ * delays a BMP280 or SHT21 read by more than one slice.
+ */
+void screen_flush() {
+    uint16_t budget = SCREEN_FLUSH_BUDGET ? SCREEN_FLUSH_BUDGET : ST7567S_PAGE_COUNT * ST7567S_SCREEN_WIDTH;
+    uint32_t start = Timer_us();
+
+    for (uint8_t n = 0; n < ST7567S_PAGE_COUNT && budget; n++) {
+        uint8_t page = Screen.flushPage;
+        uint8_t first = Screen.dirtyFirst[page];
+
+        if (first != SCREEN_CLEAN) {
+            if (SCREEN_FLUSH_BUDGET && Redundant_Pending()) {
+                Screen.yields++;  ///< Sensors first, continue on a later pass
+                break;
+            }
+            uint8_t length = Screen.dirtyLast[page] - first + 1;
+            if (length > budget)
+                length = budget;
+            screen_send(page, first, length);
+            budget -= length;
+            if (first + length <= Screen.dirtyLast[page]) {
+                Screen.dirtyFirst[page] = first + length;  ///< Rest of the page on the next pass
+                break;
+            }
+            Screen.dirtyFirst[page] = SCREEN_CLEAN;
+        }
+        Screen.flushPage = (page + 1) % ST7567S_PAGE_COUNT;
+    }
+
+    uint32_t busy = Timer_us() - start;
+    if (busy > Screen.busMax)
+        Screen.busMax = (busy > UINT16_MAX) ? UINT16_MAX : busy;
 }
 
 /**
@@ -53,33 +148,23 @@ void screen_init() {
 /**
  * @brief Draws an image on the ST7567S display.
  * 
- * This function draws an image on the LCD screen by sending image data for each 
- * page and column. It supports both PGM (flash memory) and direct SRAM images.
+ * This function draws an image into the frame buffer, page by page and column by 
+ * column. It supports both PGM (flash memory) and direct SRAM images.
  * 
  * @param mode The mode for reading image data (0 for PGM, 1 for SRAM).
  * @param image_data A pointer to the image data.
  */
 void screen_draw_image(uint8_t mode, const uint8_t *image_data) {
-    uint8_t cmd[4] = {0x00, 0xb0, 0x10, 0x00};
-
     for (uint8_t page = 0; page < ST7567S_PAGE_COUNT; page++) {
-        cmd[1] = 0xb0 + page;
-        TransmitAdd(ST7567S_ADD, WRITE);
-        for (uint8_t i = 0; i < 4; i++) {
-            TransmitByte(cmd[i]);  ///< Send page and column commands
-        }
+        Screen.page = page;  ///< Page and column address
+        Screen.column = 0;
         uint8_t page_offset = 7 - page;
         for (uint8_t col = 0; col < ST7567S_SCREEN_WIDTH; col++) {
             uint16_t index = col * 8 + page_offset;
-            uint8_t dat[2] = {0x40, 0x00};
             if (mode == 0) {
-                dat[1] = pgm_read_byte(&image_data[index]);  ///< Read from program memory
+                screen_data(pgm_read_byte(&image_data[index]));  ///< Read from program memory
             } else {
-                dat[1] = image_data[index];  ///< Read directly from SRAM
-            }
-            TransmitAdd(ST7567S_ADD, WRITE);
-            for (uint8_t i = 0; i < 2; i++) {
-                TransmitByte(dat[i]);  ///< Send image data byte
+                screen_data(image_data[index]);  ///< Read directly from SRAM
             }
         }
     }
@@ -108,7 +193,7 @@ void screen_draw_char(char c) {
 
     // Draw the character using the font data
     for (uint8_t i = 0; i < 5; i++) {
-        uint8_t line = font[c - minus][i];  ///< Get the corresponding font byte
+        uint8_t line = pgm_read_byte(&font[c - minus][i]);  ///< Get the corresponding font byte from flash
         screen_data(line);  ///< Display the character line by line
     }
 
@@ -148,6 +233,67 @@ void screen_clear() {
         }
     }
     screen_contrast(ST7567S_CONTRAST);  ///< Restore contrast
+    Screen.staticTag = SCREEN_STATIC_NONE;  ///< Static labels are gone and must be blitted again
+}
+
+/**
+ * @brief Blits a PROGMEM column bitmap to one display page.
+ * 
+ * @param bitmap Pointer to the column bitmap in program memory.
+ * @param length Number of columns to send.
+ * @param line The line (page) to draw on.
+ * @param start_pixel The starting pixel column.
+ */
+void screen_blit(const uint8_t *bitmap, uint8_t length, uint8_t line, uint8_t start_pixel) {
+    Screen.page = line;  ///< Page and column address
+    Screen.column = start_pixel;
+    for (uint8_t i = 0; i < length; i++) {
+        screen_data(pgm_read_byte(&bitmap[i]));
+    }
+}
+
+/**
+ * @brief Draws a pre-rendered label from program memory.
+ * 
+ * @param label Label id (LABEL_x from Layouts.h).
+ * @param line The line (page) to draw on.
+ * @param start_pixel The starting pixel column.
+ */
+void screen_draw_label(uint8_t label, uint8_t line, uint8_t start_pixel) {
+    uint16_t offset = pgm_read_word(&label_index[label].offset);
+    uint8_t length = pgm_read_byte(&label_index[label].length);
+    screen_blit(&label_bitmap[offset], length, line, start_pixel);
+}
+
+/**
+ * @brief Draws all labels of a pre-rendered layout.
+ * 
+ * @param layout Layout id (LAYOUT_x from Layouts.h).
+ */
+void screen_draw_layout(uint8_t layout) {
+    uint8_t last = pgm_read_byte(&layout_first[layout + 1]);
+    for (uint8_t i = pgm_read_byte(&layout_first[layout]); i < last; i++) {
+        screen_draw_label(pgm_read_byte(&layout_spans[i].label),
+                          pgm_read_byte(&layout_spans[i].page),
+                          pgm_read_byte(&layout_spans[i].column));
+    }
+}
+
+/**
+ * @brief Checks whether a window has to draw its static content.
+ * 
+ * Windows call this every pass with a tag identifying their static content (window and
+ * scroll position). Static labels only need to be drawn when the tag changes or the screen 
+ * was cleared in the meantime.
+ * 
+ * @param tag Tag of the static content the caller is about to show.
+ * @return 1 if the static content must be drawn now, 0 if it is already on screen.
+ */
+uint8_t screen_static_begin(uint8_t tag) {
+    if (Screen.staticTag == tag)
+        return 0;
+    Screen.staticTag = tag;
+    return 1;
 }
 
 /**
@@ -243,17 +389,20 @@ void screen_write_text_aligned(char *text, uint8_t line, alignment_t alignment)
  * This function formats the text using the specified format string and arguments 
  * and then writes the formatted text to the display with the chosen alignment.
  * 
- * @param format The format string for the text.
+ * @param format The format string for the text, in flash.
  * @param line The line (page) where the text will be written.
  * @param alignment The desired text alignment (left, center, right).
  */
-void screen_write_formatted_text(const char *format, uint8_t line, alignment_t alignment, ...) {
-    char textStorage[MAX_TEXT_LENGTH];  ///< Buffer for storing formatted text
+void screen_write_formatted_text_P(PGM_P format, uint8_t line, alignment_t alignment, ...) {
+    uint8_t block = Pool_Take(POOL_DISPLAY);  ///< Pool block for the formatted text
     va_list args;  ///< Variable argument list
 
+    if (block == POOL_NONE)
+        return;
     va_start(args, alignment);  ///< Start reading variable arguments
-    vsnprintf(textStorage, MAX_TEXT_LENGTH, format, args);  ///< Format the text
+    vsnprintf_P(Pool.data[block], MAX_TEXT_LENGTH, format, args);  ///< Format the text
     va_end(args);  ///< End reading variable arguments
 
-    screen_write_text_aligned(textStorage, line, alignment);  ///< Write formatted text to display
+    screen_write_text_aligned(Pool.data[block], line, alignment);  ///< Write formatted text to display
+    Pool_Free(block);
 }
@@ -33,4 +33,14 @@ uint8_t st7567sCommands[11] = {
     0xaf       /**< Display ON: Turns the display on */
 };
 
+/** 
+ * @brief Display state: nothing static is drawn after power-up, and the whole frame buffer
+ *        (blank) is sent to the glass, whose RAM content is undefined after power-up.
+ */
+ScreenState Screen = {
+    .staticTag = SCREEN_STATIC_NONE,
+    .dirtyFirst = { 0, 0, 0, 0, 0, 0, 0, 0 },
+    .dirtyLast = { 127, 127, 127, 127, 127, 127, 127, 127 }
+};
+
 #endif /* ST7567VAR_H_ */
@@ -0,0 +1,201 @@
+/**
+ * @file Sampling.c
+ * @brief Adaptive per-channel sampling engine.
+ *
+ * Every acquisition point in the main loop asks `Sampling_Begin()` whether its channel is due,
+ * and hands the new value to `Sampling_End()` afterwards. The engine keeps an exponentially
+ * weighted mean of the absolute difference between consecutive samples and halves the interval
+ * (one oversampling level up) when it exceeds the channel threshold, or doubles the interval
+ * (one level down) when it falls below threshold / SAMPLING_HYSTERESIS.
+ *
+ * The highest level of every channel is capped by NoiseProfile.h: levels above the cheapest one that
+ * meets the channel noise target only cost conversion time and current.
+ *
+ * Oversampling levels are mapped to ADC accumulation for the wind and light channels, pressure
+ * oversampling for the BMP280 and measurement resolution for the SHT21.
+ *
+ * Sampling_Trace() records the raw traces tools/noise_profile.py needs: it holds one channel at a
+ * fixed level and its shortest interval, whatever its activity and cap, and sends every sample to
+ * the console.
+ *
+ * @author Saulius
+ * @date 2025-01-06
+ */
+
+#include "Settings.h"
+#include "SamplingVar.h"
+
+/**
+ * @brief ADC accumulation per oversampling level (wind speed, wind direction, light level).
+ */
+static const uint8_t adcAccumulation[SAMPLING_OS_LEVELS] = {
+    ADC_SAMPNUM_ACC4_gc, ADC_SAMPNUM_ACC16_gc, ADC_SAMPNUM_ACC64_gc, ADC_SAMPNUM_ACC128_gc
+};
+
+/**
+ * @brief BMP280 pressure oversampling per oversampling level.
+ */
+static const uint8_t bmpOversampling[SAMPLING_OS_LEVELS] = {
+    BMP280_Pressure_ULP, BMP280_Pressure_SR, BMP280_Pressure_HR, BMP280_Pressure_UHR
+};
+
+/**
+ * @brief SHT21 resolution per oversampling level, ordered by T + RH conversion time
+ *        (26 ms, 26 ms, 52 ms, 114 ms).
+ */
+static const uint8_t shtResolution[SAMPLING_OS_LEVELS] = {
+    RH_11b_T_11b, RH_8b_T_12b, RH_10b_T_13b, RH_12b_T_14b
+};
+
+/**
+ * @brief Pushes the channel's oversampling level to the sensor configuration.
+ *
+ * The SHT21 keeps its configuration, so it is only written when the level changes.
+ *
+ * @param ch Channel whose level changed.
+ */
+static void Sampling_Apply(sampling_channel_t ch) {
+    uint8_t level = Sampling.ch[ch].oversampling;
+
+    if (ch == SAMPLING_PRESSURE) {
+        BMP280.Config.osrs_p = bmpOversampling[level]; // Sent with the next forced mode trigger
+    } else if (ch == SAMPLING_SHT) {
+        SHT21.Resolution = shtResolution[level];
+        Redundant_WriteSHT21Settings();
+    }
+}
+
+/**
+ * @brief Applies the start-up oversampling level of the sensor channels.
+ *
+ * main.c configures the sensors for their best resolution; when NoiseProfile.h caps a channel
+ * lower, the sensor is switched to the capped level before the first sample.
+ */
+void Sampling_init() {
+    Sampling_Apply(SAMPLING_PRESSURE);
+    Sampling_Apply(SAMPLING_SHT);
+}
+
+/**
+ * @brief Checks whether a channel is due for a new sample.
+ *
+ * Also closes the effective-rate window once every `SAMPLING_RATE_WINDOW` ms. ADC channels
+ * share one converter, so their accumulation is set here right before the read.
+ *
+ * @param ch Channel to check.
+ * @return 1 if the caller should acquire the channel now, 0 otherwise.
+ */
+uint8_t Sampling_Begin(sampling_channel_t ch) {
+    uint32_t now = Timer_ms();
+    SamplingChannel *c = &Sampling.ch[ch];
+
+    if (now - Sampling.windowStart >= SAMPLING_RATE_WINDOW) {
+        for (uint8_t i = 0; i < SAMPLING_CHANNELS; i++) {
+            Sampling.ch[i].rate = Sampling.ch[i].count; // Window is one minute long
+            Sampling.ch[i].count = 0;
+        }
+        Sampling.windowStart = now;
+    }
+
+    if (c->primed && (now - c->lastSample < c->interval))
+        return 0; // Not due yet
+
+    c->lastSample = now;
+    if (ch <= SAMPLING_SUN)
+        ADC0_SetAccumulation(adcAccumulation[c->oversampling]);
+    return 1;
+}
+
+/**
+ * @brief Checks whether a channel is due without starting its acquisition.
+ *
+ * @param ch Channel to check.
+ * @return 1 if the next Sampling_Begin() of the channel will return 1.
+ */
+uint8_t Sampling_Due(sampling_channel_t ch) {
+    SamplingChannel *c = &Sampling.ch[ch];
+    return !c->primed || (Timer_ms() - c->lastSample >= c->interval);
+}
+
+/**
+ * @brief Feeds a new sample to the engine and adapts the channel rate.
+ *
+ * @param ch Channel that was acquired.
+ * @param value New value in the channel's units (see SamplingVar.h).
+ */
+void Sampling_End(sampling_channel_t ch, int32_t value) {
+    SamplingChannel *c = &Sampling.ch[ch];
+    uint32_t threshold = (uint32_t)c->threshold << SAMPLING_EWMA_SHIFT;
+    uint8_t level = c->oversampling;
+
+    c->count++;
+    if (ch == Sampling.trace) { // Fixed level and interval
+        if (ch == SAMPLING_PRESSURE) { // In 0.01 Pa: the noise of the finer levels is below 1 Pa
+            uint32_t p = BMP280.CalibrationValues.p;
+            USART_printf(0, "trace %lu %lu.%02u\r\n", (unsigned long)c->lastSample, (unsigned long)(p >> 8),
+                         (uint16_t)((p & 0xFF) * 100 >> 8));
+        } else {
+            USART_printf(0, "trace %lu %ld\r\n", (unsigned long)c->lastSample, (long)value);
+        }
+        c->primed = 1;
+        c->last = value;
+        return;
+    }
+    if (!c->primed) { // First sample has nothing to compare against
+        c->primed = 1;
+        c->last = value;
+        return;
+    }
+
+    uint32_t diff = labs(value - c->last);
+    c->last = value;
+    // activity = activity * 7/8 + diff (scaled by 8, so the steady state equals 8 * mean |diff|)
+    c->activity = c->activity - (c->activity >> SAMPLING_EWMA_SHIFT) + diff;
+
+    if (c->activity > threshold) { // Changing: sample faster and finer
+        c->interval = (c->interval / 2 < c->minInterval) ? c->minInterval : c->interval / 2;
+        if (level < c->osLimit)
+            level++;
+    } else if (c->activity < threshold / SAMPLING_HYSTERESIS) { // Stable: sample slower and cheaper
+        c->interval = ((uint32_t)c->interval * 2 > c->maxInterval) ? c->maxInterval : c->interval * 2;
+        if (level > 0)
+            level--;
+    }
+
+    if (level != c->oversampling) {
+        DEBUG_LOG3("sampling ch %hhu: os %hhu, interval %u ms", (uint8_t)ch, level, c->interval);
+        c->oversampling = level;
+        Sampling_Apply(ch);
+    }
+}
+
+/**
+ * @brief Holds a channel at a fixed oversampling level and sends its samples to the console.
+ *
+ * The trace starts with the line "# trace <channel> level <level> interval <ms>", then every
+ * sample follows as "trace <time> <value>": the Sampling_Begin() time (Timer_ms()), as the main
+ * loop passes stretch the interval, and the value in the channel units (pressure in 0.01 Pa).
+ * The level may be above the NoiseProfile.h cap, which is applied again when the trace ends.
+ *
+ * @param ch Channel to trace, SAMPLING_TRACE_OFF to end the trace.
+ * @param level Oversampling level (0 ... SAMPLING_OS_LEVELS - 1).
+ */
+void Sampling_Trace(uint8_t ch, uint8_t level) {
+    SamplingChannel *c;
+
+    if (Sampling.trace < SAMPLING_CHANNELS) {
+        c = &Sampling.ch[Sampling.trace];
+        if (c->oversampling > c->osLimit) {
+            c->oversampling = c->osLimit;
+            Sampling_Apply(Sampling.trace);
+        }
+    }
+    Sampling.trace = ch;
+    if (ch >= SAMPLING_CHANNELS)
+        return;
+    c = &Sampling.ch[ch];
+    c->oversampling = level;
+    c->interval = c->minInterval;
+    Sampling_Apply(ch);
+    USART_printf(0, "# trace %u level %u interval %u\r\n", ch, level, c->interval);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file Sampling.h
+ * @brief Header file for the adaptive per-channel sampling engine.
+ *
+ * Each acquisition channel tracks how fast its value is changing (exponentially weighted
+ * mean of the absolute sample-to-sample difference) and moves its sampling interval and
+ * oversampling level between configured bounds: busy channels are read more often and with
+ * more oversampling, stable channels are read rarely and cheaply.
+ *
+ * @author Saulius
+ * @date 2025-01-06
+ */
+
+#ifndef SAMPLING_H_
+#define SAMPLING_H_
+
+/**
+ * @brief Number of oversampling levels per channel (0 = cheapest, 3 = best resolution).
+ */
+#define SAMPLING_OS_LEVELS 4
+
+/**
+ * @brief EWMA weight of the activity estimate as a shift (1/8 of every new difference).
+ */
+#define SAMPLING_EWMA_SHIFT 3
+
+/**
+ * @brief Activity below threshold / SAMPLING_HYSTERESIS slows the channel down.
+ *
+ * Activity above the threshold speeds it up; the band in between keeps the current rate.
+ */
+#define SAMPLING_HYSTERESIS 4
+
+/**
+ * @brief Length of the window over which effective rates are counted (ms).
+ */
+#define SAMPLING_RATE_WINDOW 60000UL
+
+/**
+ * @brief Sampling.trace value when no channel is traced.
+ */
+#define SAMPLING_TRACE_OFF 0xFF
+
+/**
+ * @brief Acquisition channels handled by the sampling engine.
+ */
+typedef enum {
+    SAMPLING_WIND_SPEED, /**< WindSpeed(), raw ADC counts */
+    SAMPLING_WIND_DIR,   /**< WindDirection(), direction index */
+    SAMPLING_SUN,        /**< SunLevel(), raw ADC counts */
+    SAMPLING_PRESSURE,   /**< ReadBMP280TP(), pressure in Pa */
+    SAMPLING_SHT,        /**< SHT21_Read(), temperature in 0.01 C */
+    SAMPLING_CHANNELS    /**< Number of channels */
+} sampling_channel_t;
+
+/**
+ * @brief State and configuration of one acquisition channel.
+ */
+typedef struct {
+    uint16_t minInterval;  /**< Shortest allowed interval between samples (ms) */
+    uint16_t maxInterval;  /**< Longest allowed interval between samples (ms) */
+    uint16_t threshold;    /**< Mean |difference| per sample that counts as "changing" (value units) */
+    uint16_t interval;     /**< Current interval between samples (ms) */
+    uint8_t oversampling;  /**< Current oversampling level (0 to osLimit) */
+    uint8_t osLimit;       /**< Highest oversampling level allowed (NoiseProfile.h) */
+    uint8_t primed;        /**< 1 after the first sample has been taken */
+    int32_t last;          /**< Last sampled value */
+    uint32_t activity;     /**< EWMA of |difference|, scaled by 2^SAMPLING_EWMA_SHIFT */
+    uint32_t lastSample;   /**< Timestamp of the last sample (ms) */
+    uint16_t count;        /**< Samples taken in the current rate window */
+    uint16_t rate;         /**< Effective rate over the last window (samples per minute) */
+} SamplingChannel;
+
+/**
+ * @brief Adaptive sampling engine state.
+ */
+typedef struct {
+    SamplingChannel ch[SAMPLING_CHANNELS]; /**< Per-channel state */
+    uint32_t windowStart;                  /**< Start of the current rate window (ms) */
+    uint8_t trace;                         /**< Channel held at a fixed level for a noise trace, SAMPLING_TRACE_OFF if none */
+} SamplingEngine;
+
+/**
+ * @brief Global adaptive sampling engine instance.
+ */
+extern SamplingEngine Sampling;
+
+#endif /* SAMPLING_H_ */
@@ -0,0 +1,32 @@
+/**
+ * @file SamplingVar.h
+ * @brief Variable definitions and default bounds for the adaptive sampling engine.
+ *
+ * Thresholds are in the channel's own value units: ADC counts for wind speed, direction steps
+ * for wind direction, mV for light level, Pa for pressure and 0.01 C for the SHT temperature.
+ * Every channel starts at its fastest rate and at the highest oversampling level allowed by
+ * NoiseProfile.h (generated by tools/noise_profile.py), and relaxes when stable.
+ *
+ * @author Saulius
+ * @date 2025-01-06
+ */
+
+#ifndef SAMPLINGVAR_H_
+#define SAMPLINGVAR_H_
+
+/**
+ * @brief Global adaptive sampling engine instance with per-channel bounds.
+ */
+SamplingEngine Sampling = {
+    .ch = {
+        [SAMPLING_WIND_SPEED] = { .minInterval = 50,   .maxInterval = 2000,  .threshold = 40, .interval = 50,   .oversampling = NOISE_PROFILE_OS_WIND_SPEED, .osLimit = NOISE_PROFILE_OS_WIND_SPEED },
+        [SAMPLING_WIND_DIR]   = { .minInterval = 100,  .maxInterval = 4000,  .threshold = 1,  .interval = 100,  .oversampling = NOISE_PROFILE_OS_WIND_DIR, .osLimit = NOISE_PROFILE_OS_WIND_DIR },
+        [SAMPLING_SUN]        = { .minInterval = 200,  .maxInterval = 10000, .threshold = 5,  .interval = 200,  .oversampling = NOISE_PROFILE_OS_SUN, .osLimit = NOISE_PROFILE_OS_SUN },
+        [SAMPLING_PRESSURE]   = { .minInterval = 500,  .maxInterval = 30000, .threshold = 3,  .interval = 500,  .oversampling = NOISE_PROFILE_OS_PRESSURE, .osLimit = NOISE_PROFILE_OS_PRESSURE },
+        [SAMPLING_SHT]        = { .minInterval = 1000, .maxInterval = 30000, .threshold = 5,  .interval = 1000, .oversampling = NOISE_PROFILE_OS_SHT, .osLimit = NOISE_PROFILE_OS_SHT },
+    },
+    .windowStart = 0,
+    .trace = SAMPLING_TRACE_OFF
+};
+
+#endif /* SAMPLINGVAR_H_ */
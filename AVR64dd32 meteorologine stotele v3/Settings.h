@@ -49,6 +49,8 @@
 #include <float.h>       /**< Include float.h for floating point constants like FLT_MAX */
 #include <stdbool.h>     /**< Include stdbool.h for boolean type support (true/false) */
 #include <avr/pgmspace.h>
+#include <avr/eeprom.h>  /**< Include eeprom.h for the event log ring in EEPROM */
+#include <util/atomic.h> /**< Include atomic.h for ATOMIC_BLOCK around data shared with ISRs */
 #include "i2c.h"
 #include "SHT45.h"
 #include "BMP390.h"
@@ -56,8 +58,32 @@
 #include "ElAndAzComp.h"
 #include "Communications.h"
 #include "St7567S.h"
+#include "Layouts.h"
 #include "Keypad3x4.h"
 #include "Wind.h"
+#include "Timer.h"
+#include "Redundant.h"
+#include "NoiseProfile.h"
+#include "Sampling.h"
+#include "USART.h"
+#include "Telemetry.h"
+#include "DebugLog.h"
+#include "Derived.h"
+#include "CRC.h"
+#include "Turbulence.h"
+#include "Microbaro.h"
+#include "SDI12.h"
+#include "ClearSky.h"
+#include "FixedMath.h"
+#include "Tracker.h"
+#include "PlaneOfArray.h"
+#include "History.h"
+#include "GPIO.h"
+#include "Units.h"
+#include "Pool.h"
+#include "Link.h"
+#include "Gnss.h"
+#include "EventLog.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Function Prototypes
@@ -155,6 +181,13 @@ uint8_t ReadReg(uint8_t Add, uint8_t Reg);
  */
 void WriteMulti(uint8_t addr, uint8_t reg, uint64_t data, uint8_t bytes);
 
+/**
+ * @brief Selects the downstream channels of the TCA9548A I2C multiplexer.
+ * 
+ * @param mask Channel bit mask (bit n = channel n).
+ */
+void I2C_MuxSelect(uint8_t mask);
+
 /**
  * @brief Reads multiple bytes of data from a register over I2C.
  * 
@@ -165,6 +198,22 @@ void WriteMulti(uint8_t addr, uint8_t reg, uint64_t data, uint8_t bytes);
  */
 uint64_t ReadMulti(uint8_t addr, uint8_t reg, uint8_t bytes);
 
+/**
+ * @brief Starts waiting for a conversion with ready polling, call right after the trigger.
+ * 
+ * @param p Poll of the device.
+ * @param limit Worst case conversion time of the current settings (us).
+ */
+void I2C_PollStart(I2C_Poll *p, uint32_t limit);
+
+/**
+ * @brief Probes a running conversion when its next probe is due, never waits.
+ * 
+ * @param p Poll started with I2C_PollStart().
+ * @return I2C_POLL_WAIT, I2C_POLL_READY or I2C_POLL_TIMEOUT.
+ */
+uint8_t I2C_PollReady(I2C_Poll *p);
+
 /**
  * @brief Initializes USART0 for serial communication.
  * 
@@ -173,12 +222,22 @@ uint64_t ReadMulti(uint8_t addr, uint8_t reg, uint8_t bytes);
 void USART0_init();
 
 /**
- * @brief Sends a character over USART0.
+ * @brief Queues a character for transmission over USART0.
+ * 
+ * Waits only while the transmit queue is full; the USART0 data register empty
+ * interrupt sends the queued bytes.
  * 
  * @param c Character to send.
  */
 void USART0_sendChar(char c);
 
+/**
+ * @brief Returns the free space in the USART0 transmit queue.
+ * 
+ * @return Number of characters that can be queued without waiting.
+ */
+uint8_t USART0_TxSpace();
+
 /**
  * @brief Sends a string over USART0.
  * 
@@ -186,6 +245,14 @@ void USART0_sendChar(char c);
  */
 void USART0_sendString(char *str);
 
+/**
+ * @brief Queues a pool block for transmission over USART0; the transmit interrupt frees it.
+ * 
+ * @param block Pool block holding the message.
+ * @param length Bytes to send.
+ */
+void USART0_SendBlock(uint8_t block, uint8_t length);
+
 /**
  * @brief USART0 character output function for printf.
  * 
@@ -202,6 +269,42 @@ int USART0_printChar(char c, FILE *stream);
  */
 char USART0_readChar();
 
+/**
+ * @brief Starts a new telemetry record.
+ * 
+ * @param format Record format (telemetry_format_t).
+ */
+void Telemetry_Begin(uint8_t format);
+
+/**
+ * @brief Adds one fixed-point field to the current telemetry record.
+ * 
+ * @param field Field id (telemetry_field_t).
+ * @param value Fixed-point value, `value / 10^decimals`.
+ * @param decimals Number of fractional digits.
+ */
+void Telemetry_Field(uint8_t field, int32_t value, uint8_t decimals);
+
+/**
+ * @brief Closes the current telemetry record (checksum and line end).
+ */
+void Telemetry_End();
+
+/**
+ * @brief Current fixed-point value of a telemetry field (Modbus registers, records).
+ * 
+ * @param field Field id (telemetry_field_t).
+ * @return Fixed-point value with telemetryDecimals[field] fractional digits.
+ */
+int32_t Telemetry_Value(uint8_t field);
+
+/**
+ * @brief Sends the station telemetry record.
+ * 
+ * @param format Record format (telemetry_format_t).
+ */
+void Telemetry_SendStation(uint8_t format);
+
 /**
  * @brief Initializes USART1 for serial communication.
  * 
@@ -243,9 +346,14 @@ char USART1_readChar();
  * @brief Sends formatted data over USART.
  * 
  * @param usart_number USART port (0 or 1).
- * @param format Format string for the data.
+ * @param format Format string for the data, in flash.
  */
-void USART_printf(uint8_t usart_number, const char *format, ...);
+void USART_printf_P(uint8_t usart_number, PGM_P format, ...);
+
+/**
+ * @brief USART_printf_P() with a literal format string, which PSTR() keeps out of RAM.
+ */
+#define USART_printf(usart_number, format, ...) USART_printf_P(usart_number, PSTR(format), ##__VA_ARGS__)
 
 /**
  * @brief Initializes the ADC0 (Analog-to-Digital Converter).
@@ -276,6 +384,13 @@ void ADC0_SetupSLS();
  */
 uint16_t ADC0_read();
 
+/**
+ * @brief Sets the number of accumulated samples per ADC0 conversion.
+ *
+ * @param sampnum Accumulation setting (ADC_SAMPNUM_ACC1_gc to ADC_SAMPNUM_ACC128_gc).
+ */
+void ADC0_SetAccumulation(uint8_t sampnum);
+
 /**
  * @brief Computes CRC-8 checksum for MAXIM/Dallas devices.
  * 
@@ -287,6 +402,36 @@ uint16_t ADC0_read();
  */
 uint16_t CRC8MAXIM(uint32_t data);
 
+/**
+ * @brief Updates a CRC-8/Sensirion (polynomial 0x31) with a block of bytes.
+ *
+ * @param crc CRC so far (CRC8_SHT21_INIT or CRC8_SENSIRION_INIT for a new stream).
+ * @param data Bytes to add.
+ * @param length Number of bytes.
+ * @return Updated CRC.
+ */
+uint8_t CRC8_Update(uint8_t crc, const void *data, uint16_t length);
+
+/**
+ * @brief Updates a CRC-16/CCITT (polynomial 0x1021, MSB first) with a block of bytes.
+ *
+ * @param crc CRC so far (CRC16_CCITT_INIT for a new stream).
+ * @param data Bytes to add.
+ * @param length Number of bytes.
+ * @return Updated CRC.
+ */
+uint16_t CRC16_CCITT_Update(uint16_t crc, const void *data, uint16_t length);
+
+/**
+ * @brief Updates a CRC-16/Modbus (reflected polynomial 0xA001) with a block of bytes.
+ *
+ * @param crc CRC so far (CRC16_MODBUS_INIT for a new stream).
+ * @param data Bytes to add.
+ * @param length Number of bytes.
+ * @return Updated CRC, sent low byte first.
+ */
+uint16_t CRC16_Modbus_Update(uint16_t crc, const void *data, uint16_t length);
+
 /**
  * @brief Separates a 32-bit data value into individual components.
  * 
@@ -325,12 +470,44 @@ void SHT21_Reset(uint8_t save);
  * @brief Reads raw data (temperature or humidity) from the SHT21 sensor.
  * 
  * This function reads the raw data from the SHT21 sensor, including CRC checking.
+ * A no hold master read does not wait for the conversion: call it again with the same mode
+ * on the next main loop pass while it returns SHT21_PENDING.
  * 
  * @param mode The mode specifying whether to read temperature or humidity.
- * @return The 32-bit raw data read from the sensor, including CRC.
+ * @return The 32-bit raw data read from the sensor, including CRC; SHT21_PENDING while converting.
  */
 uint32_t SHT21_Read(uint8_t mode);
 
+/**
+ * @brief Starts an SHT21 no hold master measurement without waiting for it.
+ * 
+ * @param mode NO_HOLD_MASTER_T_MES or NO_HOLD_MASTER_RH_MES.
+ * @return 0 on success, I2C error code otherwise.
+ */
+uint8_t SHT21_Trigger(uint8_t mode);
+
+/**
+ * @brief Reads the result of an SHT21 no hold master measurement.
+ * 
+ * @return The raw sensor data, 0 if the read failed or the conversion is still running.
+ */
+uint32_t SHT21_Fetch();
+
+/**
+ * @brief Reads the SHT21 result bytes after its read header was acknowledged (I2C_POLL_READY).
+ * 
+ * @return The raw sensor data, 0 if the read failed.
+ */
+uint32_t SHT21_Receive();
+
+/**
+ * @brief Worst case SHT21 no hold master conversion time at the current resolution.
+ * 
+ * @param mode NO_HOLD_MASTER_T_MES or NO_HOLD_MASTER_RH_MES.
+ * @return Conversion time (us).
+ */
+uint32_t SHT21_ConversionTime(uint8_t mode);
+
 /**
  * @brief Reads the unique ID of the BMP280 sensor.
  * 
@@ -367,12 +544,23 @@ void WriteBMP280Config();
  */
 void ReadBMP280Status();
 
+/**
+ * @brief Worst case BMP280 forced mode conversion time at the current oversampling.
+ * 
+ * @return Conversion time (us).
+ */
+uint32_t BMP280_ConversionTime();
+
 /**
  * @brief Reads the temperature and pressure data from the BMP280 sensor.
  * 
- * This function reads the temperature and pressure data from the BMP280 sensor.
+ * This function reads the temperature and pressure data from the BMP280 sensor once its
+ * conversion has finished, without waiting for it: call it again on the next main loop pass
+ * while it returns I2C_POLL_WAIT.
+ * 
+ * @return I2C_POLL_WAIT, I2C_POLL_READY or I2C_POLL_TIMEOUT (results read at the limit).
  */
-void ReadBMP280TP();
+uint8_t ReadBMP280TP();
 
 /**
  * @brief Resets the BMP280 sensor.
@@ -400,11 +588,32 @@ int16_t CalcTrueTemp();
 uint32_t CalcTruePres();
 
 /**
- * @brief Computes the average altitude.
+ * @brief Calculates the vapor pressure from the SHT21 temperature and humidity.
  * 
- * This function calculates the average altitude from the available sensor data or computations.
+ * @return Vapor pressure in hPa.
  */
-void AltitudeAverage();
+double vapor_pressure();
+
+/**
+ * @brief Calculates the dew point from the SHT21 temperature and humidity.
+ * 
+ * @return Dew point in degrees Celsius.
+ */
+double dew_point();
+
+/**
+ * @brief Calculates the altitude from pressure alone.
+ * 
+ * @return Uncompensated altitude in meters.
+ */
+double calculate_uncompensated_elevation();
+
+/**
+ * @brief Calculates the altitude from pressure, temperature and vapor pressure.
+ * 
+ * @return Compensated altitude in meters.
+ */
+double calculate_adjusted_elevation();
 
 /**
  * @brief Computes the wind speed.
@@ -440,8 +649,18 @@ const char * WindDirNames();
  * @brief Reads and processes clock and data from the system.
  * 
  * This function reads and processes the system time and other data, possibly for logging or synchronization purposes.
+ * 
+ * @return 1 if a valid frame was read, 0 on a timeout, noise or a frame with values out of range.
  */
-void ClockAndDataReader();
+uint8_t ClockAndDataReader();
+
+/**
+ * @brief Checks if a year is a leap year.
+ * 
+ * @param year Year to check.
+ * @return 1 if the year is a leap year, otherwise 0.
+ */
+uint8_t isLeapYear(uint16_t year);
 
 /**
  * @brief Validates the provided date and time.
@@ -498,6 +717,13 @@ uint8_t isValidLatitude(double latitude);
  */
 uint8_t isValidLongitude(double longitude);
 
+/**
+ * @brief Calculates the refraction correction of the solar elevation.
+ * 
+ * @return Refraction in minutes of arc, 0 below the horizon.
+ */
+double calculate_refraction();
+
 /**
  * @brief Corrects the solar angles.
  * 
@@ -506,6 +732,19 @@ uint8_t isValidLongitude(double longitude);
  */
 void correct_solar_angles();
 
+/**
+ * @brief Computes SUN.azimuth and SUN.elevation from the UTC time and the station position.
+ *
+ * Used while the GNSS receiver, which sends no sun angles, is the time source.
+ *
+ * @param days UTC date, days since 2000-01-01 (up to 2099).
+ * @param seconds UTC seconds of the day.
+ * @param latitude Station latitude, north positive.
+ * @param longitude Station longitude, east positive.
+ */
+void calculate_solar_position(uint16_t days, uint32_t seconds, UNIT_T(DEGREE_10000) latitude,
+                              UNIT_T(DEGREE_10000) longitude);
+
 /**
  * @brief Initializes the screen.
  * 
@@ -518,7 +757,7 @@ void screen_init();
  * @brief Sends a command to the screen.
  * 
  * This function sends a specific command byte to the screen to control its behavior (e.g., to reset, 
- * adjust settings, or switch modes).
+ * adjust settings, or switch modes). Page and column address commands move the frame buffer cursor.
  * 
  * @param cmd The command byte to send to the screen.
  */
@@ -527,7 +766,7 @@ void screen_command(uint8_t cmd);
 /**
  * @brief Sends data to the screen.
  * 
- * This function sends a data byte to the screen, typically to be displayed or used for rendering.
+ * This function writes a data byte to the frame buffer at the cursor; screen_flush() sends it to the screen.
  * 
  * @param cmd The data byte to send to the screen.
  */
@@ -609,12 +848,58 @@ void screen_write_text_aligned(char *text, uint8_t line, alignment_t alignment);
  * This function writes formatted text to the screen, aligning it according to the specified alignment mode
  * (e.g., left, center, right). It supports variable arguments, allowing formatted text similar to printf.
  * 
- * @param format The format string for the text to display.
+ * @param format The format string for the text to display, in flash.
  * @param line The line number where the text should be written.
  * @param alignment The alignment mode to use (e.g., left, center, right).
  * @param ... The variable arguments for the format string.
  */
-void screen_write_formatted_text(const char *format, uint8_t line, alignment_t alignment, ...);
+void screen_write_formatted_text_P(PGM_P format, uint8_t line, alignment_t alignment, ...);
+
+/**
+ * @brief screen_write_formatted_text_P() with a literal format string, which PSTR() keeps out of RAM.
+ */
+#define screen_write_formatted_text(format, ...) screen_write_formatted_text_P(PSTR(format), __VA_ARGS__)
+
+/**
+ * @brief Blits a PROGMEM column bitmap to one display page of the frame buffer.
+ * 
+ * @param bitmap Pointer to the column bitmap in program memory.
+ * @param length Number of columns to send.
+ * @param line The line (page) to draw on.
+ * @param start_pixel The starting pixel column.
+ */
+void screen_blit(const uint8_t *bitmap, uint8_t length, uint8_t line, uint8_t start_pixel);
+
+/**
+ * @brief Draws a pre-rendered label from program memory.
+ * 
+ * @param label Label id (LABEL_x from Layouts.h).
+ * @param line The line (page) to draw on.
+ * @param start_pixel The starting pixel column.
+ */
+void screen_draw_label(uint8_t label, uint8_t line, uint8_t start_pixel);
+
+/**
+ * @brief Draws all labels of a pre-rendered layout.
+ * 
+ * @param layout Layout id (LAYOUT_x from Layouts.h).
+ */
+void screen_draw_layout(uint8_t layout);
+
+/**
+ * @brief Checks whether a window has to draw its static content.
+ * 
+ * @param tag Tag of the static content (window and scroll position).
+ * @return 1 if the static content must be drawn now, 0 if it is already on screen.
+ */
+uint8_t screen_static_begin(uint8_t tag);
+
+/**
+ * @brief Sends the next slice (at most SCREEN_FLUSH_BUDGET bytes) of the changed frame buffer to the display.
+ * 
+ * Yields the bus while a sensor transaction is pending. Call once per main loop pass.
+ */
+void screen_flush();
 
 /**
  * @brief Retransmits data.
@@ -658,5 +943,392 @@ void get_key_state();
  */
 void keypad();
 
+/**
+ * @brief Initializes TCB0 as the 1 ms system tick.
+ */
+void TCB0_init();
+
+/**
+ * @brief Returns the number of milliseconds since TCB0_init().
+ *
+ * @return Millisecond tick, read atomically.
+ */
+uint32_t Timer_ms();
+
+/**
+ * @brief Returns the number of microseconds since TCB0_init().
+ *
+ * @return Microsecond time, wraps after ~71 minutes.
+ */
+uint32_t Timer_us();
+
+/**
+ * @brief Stores a debug log record (message id and raw argument bytes) in the RAM ring buffer.
+ *
+ * Use the DEBUG_LOG0 ... DEBUG_LOG4 macros instead of calling it directly.
+ *
+ * @param message Message id.
+ * @param args Raw argument bytes.
+ * @param size Number of argument bytes.
+ */
+void DebugLog_Write(uint16_t message, const void *args, uint8_t size);
+
+/**
+ * @brief Sends buffered debug log records over USART0 without waiting.
+ */
+void DebugLog_Drain();
+
+/**
+ * @brief Marks the derived values whose inputs changed, call once per main loop pass.
+ */
+void Derived_Update();
+
+/**
+ * @brief Recomputes the requested derived values if they are dirty.
+ *
+ * @param nodes Mask of DERIVED_BIT() values the caller is about to read.
+ */
+void Derived_Refresh(uint16_t nodes);
+
+/**
+ * @brief Configures every BMP280 and SHT21 instance and reads the BMP280 calibration values.
+ */
+void Redundant_init();
+
+/**
+ * @brief Writes the SHT21 settings to every SHT21 instance.
+ */
+void Redundant_WriteSHT21Settings();
+
+/**
+ * @brief Writes `BMP280.Config` (IIR filter, standby time, sleep mode) to every BMP280 instance.
+ *
+ * The calibration values must be loaded again (Redundant_LoadBMP280()) before the next compensation.
+ */
+void Redundant_WriteBMP280Config();
+
+/**
+ * @brief Runs the parallel BMP280 and SHT21 acquisitions and their median voting.
+ *
+ * Call from the main loop; never waits for a conversion.
+ */
+void Redundant_Task();
+
+/**
+ * @brief Checks whether a BMP280 or SHT21 transaction is due now or within REDUNDANT_PENDING_US.
+ *
+ * @return 1 if lower priority bus traffic should wait.
+ */
+uint8_t Redundant_Pending();
+
+/**
+ * @brief Connects one BMP280 instance and loads its address and calibration values into `BMP280`.
+ *
+ * @param i Instance (index in `Redundant.bmp[]`).
+ */
+void Redundant_LoadBMP280(uint8_t i);
+
+/**
+ * @brief Samples the wind speed at a fixed rate and runs one slice of the spectrum and turbulence analysis.
+ *
+ * Call from the main loop; every call does a bounded amount of work.
+ */
+void Turbulence_Task();
+
+/**
+ * @brief One bin of the analysed block's spectrum, split out of the packed FFT result.
+ *
+ * @param k Bin, 0 ... TURBULENCE_N / 2.
+ * @param re Real part (Q15, scaled by 1 / TURBULENCE_N like a full length FFT with 1/2 per stage).
+ * @param im Imaginary part.
+ */
+void Turbulence_Bin(uint8_t k, int16_t *re, int16_t *im);
+
+/**
+ * @brief Requests the high-rate microbarometer mode; it starts when the BMP280 is free.
+ */
+void Microbaro_Start();
+
+/**
+ * @brief Ends the microbarometer mode and returns the BMP280 to forced mode acquisitions.
+ */
+void Microbaro_Stop();
+
+/**
+ * @brief Checks whether the next microbarometer sample is closer than MICROBARO_GUARD_MS.
+ *
+ * @return 1 if the rest of the main loop pass should be skipped.
+ */
+uint8_t Microbaro_Busy();
+
+/**
+ * @brief Starts the microbarometer mode and takes its samples when due, call from the main loop.
+ */
+void Microbaro_Task();
+
+/**
+ * @brief Configures the SDI-12 sensor interface (pin, break detector, bit timer).
+ *
+ * Commands are answered from interrupts once global interrupts are enabled.
+ */
+void SDI12_init();
+
+/**
+ * @brief Refreshes the SDI-12 measurement snapshot every SDI12_SNAPSHOT_MS, call from the main loop.
+ */
+void SDI12_Task();
+
+/**
+ * @brief Enables the USART0 receive interrupt that classifies the console, Modbus, binary and
+ *        bootloader traffic.
+ *
+ * Call after USART0_init().
+ */
+void Link_init();
+
+/**
+ * @brief Handles the message received on USART0, if any, and sends its reply; call from the main loop.
+ */
+void Link_Task();
+
+/**
+ * @brief Selects the time source and applies the GNSS sentences; called by Retransmitt().
+ *
+ * Switches USART1 to the GNSS receiver when Date_Clock.error latches, turns the RMC, GGA and ZDA
+ * sentences into Date_Clock and the sun angles, and goes back to the clock device when a probe
+ * every GNSS_PROBE_MS finds it answering.
+ */
+void Gnss_Task();
+
+/**
+ * @brief Finds the newest record of the EEPROM ring and logs the reset with its RSTCTRL.RSTFR flags.
+ *
+ * Call first thing after the clock is set up, so the reset is the first record of the run.
+ */
+void EventLog_init();
+
+/**
+ * @brief Queues an event record for the EEPROM; returns at once.
+ *
+ * Repeats of an I2C failure, clock link loss or source switch with the same argument within
+ * EVENT_LOG_REPEAT_MS are only counted.
+ *
+ * @param code event_code_t.
+ * @param argument Event argument.
+ * @return 1 if queued, 0 if a repeat or the queue is full.
+ */
+uint8_t EventLog_Add(uint8_t code, uint16_t argument);
+
+/**
+ * @brief Logs clock link and time source changes and writes one queued byte to the EEPROM when
+ *        it is not busy; call from the main loop.
+ */
+void EventLog_Task();
+
+/**
+ * @brief Reads a logged record.
+ *
+ * @param index 0 for the oldest record.
+ * @param record Receives the record.
+ * @return 1 if read, 0 if there are not that many records.
+ */
+uint8_t EventLog_Read(uint8_t index, EventRecord *record);
+
+/**
+ * @brief Formats a record as text: date, time, event name and argument in hex.
+ *
+ * @param text At least 40 characters with `full`, 22 without.
+ * @param record Record to format.
+ * @param full 1 for the console (sequence number, year and seconds), 0 for a display line.
+ */
+void EventLog_Text(char *text, const EventRecord *record, uint8_t full);
+
+/**
+ * @brief Takes a clear-sky index sample every CLEARSKY_SAMPLE_MS and updates the window statistics.
+ *
+ * Call from the main loop; each sample costs O(1).
+ */
+void ClearSky_Task();
+
+/**
+ * @brief Fixed-point sine.
+ *
+ * @param angle Angle (0.01 deg).
+ * @return sin(angle), Q15.
+ */
+int16_t FixedMath_Sin(int32_t angle);
+
+/**
+ * @brief Fixed-point cosine.
+ *
+ * @param angle Angle (0.01 deg).
+ * @return cos(angle), Q15.
+ */
+int16_t FixedMath_Cos(int32_t angle);
+
+/**
+ * @brief Fixed-point four quadrant arc tangent.
+ *
+ * @param y Y component (any scale common with x).
+ * @param x X component.
+ * @return atan2(y, x), -18000 ... 18000 (0.01 deg).
+ */
+int16_t FixedMath_Atan2(int32_t y, int32_t x);
+
+/**
+ * @brief Fixed-point arc cosine.
+ *
+ * @param x Cosine (Q15).
+ * @return acos(x), 0 ... 18000 (0.01 deg).
+ */
+int16_t FixedMath_Acos(int16_t x);
+
+/**
+ * @brief Integer square root.
+ *
+ * @param x Radicand.
+ * @return floor(sqrt(x)).
+ */
+uint16_t FixedMath_Sqrt(uint32_t x);
+
+/**
+ * @brief Computes the single-axis tracker rotation and backtracking from the adjusted solar angles.
+ *
+ * Called by Derived_Refresh() for DERIVED_TRACKER.
+ */
+void Tracker_Compute();
+
+/**
+ * @brief Sets the panel plane orientation and precomputes its normal.
+ *
+ * @param mode PLANE_FIXED or PLANE_TRACKER.
+ * @param tilt Fixed plane tilt from horizontal (0.01 deg).
+ * @param azimuth Direction the fixed plane faces (0.01 deg from North).
+ */
+void PlaneOfArray_Configure(uint8_t mode, int16_t tilt, uint16_t azimuth);
+
+/**
+ * @brief Updates the angle of incidence and the plane-of-array irradiance from the light level.
+ *
+ * Call after every light sample (SunLevel()).
+ */
+void PlaneOfArray_Update();
+
+/**
+ * @brief Reduces the channel inputs of every pass to minute values and appends them to the history.
+ *
+ * Call from the main loop after Derived_Update(); an append is O(1).
+ */
+void History_Task();
+
+/**
+ * @brief Appends one minute of stored channel values to the history.
+ *
+ * @param value Stored value of every channel (HistoryVar.h quantisation).
+ */
+void History_Append(const uint16_t *value);
+
+/**
+ * @brief Positions a history reader at a minute.
+ *
+ * @param r Reader.
+ * @param ch history_channel_t.
+ * @param minute Minute after start-up of the first value History_Next() returns.
+ * @return 1 if the minute is in the store.
+ */
+uint8_t History_Seek(HistoryReader *r, uint8_t ch, uint32_t minute);
+
+/**
+ * @brief Sequential decode: returns the value of the reader's minute and moves to the next one.
+ *
+ * @param r Reader positioned with History_Seek().
+ * @param value Receives the stored value.
+ * @return 1 if a value was returned, 0 if the minute is not (or no longer) in the store.
+ */
+uint8_t History_Next(HistoryReader *r, uint16_t *value);
+
+/**
+ * @brief Random access to one history value.
+ *
+ * @param ch history_channel_t.
+ * @param minute Minute after start-up.
+ * @param value Receives the stored value.
+ * @return 1 if the minute is in the store.
+ */
+uint8_t History_Read(uint8_t ch, uint32_t minute, uint16_t *value);
+
+/**
+ * @brief Allocates a pool block; may be called from interrupts.
+ * 
+ * @param owner pool_owner_t of the new block.
+ * @return Block number, or POOL_NONE when every block is in use.
+ */
+uint8_t Pool_Alloc(uint8_t owner);
+
+/**
+ * @brief Allocates a pool block, waiting while blocks are being transmitted.
+ * 
+ * @param owner pool_owner_t of the new block.
+ * @return Block number, or POOL_NONE when every block is held and none is in transmission, or
+ *         interrupts are disabled.
+ */
+uint8_t Pool_Take(uint8_t owner);
+
+/**
+ * @brief Hands a pool block over to a new owner.
+ * 
+ * @param block Block number.
+ * @param owner pool_owner_t of the new owner.
+ */
+void Pool_Give(uint8_t block, uint8_t owner);
+
+/**
+ * @brief Returns a pool block; may be called from interrupts.
+ * 
+ * @param block Block number.
+ */
+void Pool_Free(uint8_t block);
+
+/**
+ * @brief Applies the start-up oversampling levels (NoiseProfile.h) to the BMP280 and SHT21.
+ *
+ * Call after the sensors have been configured.
+ */
+void Sampling_init();
+
+/**
+ * @brief Checks whether an adaptive sampling channel is due and prepares its sensor.
+ *
+ * @param ch Channel to check.
+ * @return 1 if the channel should be acquired now, 0 otherwise.
+ */
+uint8_t Sampling_Begin(sampling_channel_t ch);
+
+/**
+ * @brief Checks whether an adaptive sampling channel is due, without side effects.
+ *
+ * @param ch Channel to check.
+ * @return 1 if the channel will be acquired on its next Sampling_Begin().
+ */
+uint8_t Sampling_Due(sampling_channel_t ch);
+
+/**
+ * @brief Feeds a new sample to the adaptive sampling engine.
+ *
+ * The channel interval and oversampling level are adjusted from the recent rate of change.
+ *
+ * @param ch Channel that was acquired.
+ * @param value New value in the channel's units.
+ */
+void Sampling_End(sampling_channel_t ch, int32_t value);
+
+/**
+ * @brief Holds a channel at a fixed oversampling level and sends its samples to the console.
+ *
+ * @param ch Channel to trace, SAMPLING_TRACE_OFF to end the trace.
+ * @param level Oversampling level (0 ... SAMPLING_OS_LEVELS - 1).
+ */
+void Sampling_Trace(uint8_t ch, uint8_t level);
+
 
 #endif /* SETTINGS_H_ */
\ No newline at end of file
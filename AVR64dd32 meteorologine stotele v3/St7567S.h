@@ -44,4 +44,62 @@ typedef enum {
     ALIGN_RIGHT  /**< Right alignment. */
 } alignment_t;
 
+/** @brief Static content tag meaning "nothing static on the screen" (set by screen_clear()). */
+#define SCREEN_STATIC_NONE 0xFF
+
+/**
+ * @brief Data bytes sent to the display per screen_flush() call (one main loop pass).
+ *
+ * At 1.2 MHz a 32-byte slice holds TWI0 for about 0.3 ms, so a sensor read that falls due
+ * during a flush waits at most one slice. 0 sends every changed byte at once and never yields
+ * (for comparing the sensor read delays with and without slicing).
+ */
+#define SCREEN_FLUSH_BUDGET 32
+
+/** @brief `dirtyFirst` value of a page whose frame buffer matches the glass. */
+#define SCREEN_CLEAN 0xFF
+
+/**
+ * @brief Position of one pre-rendered label inside the PROGMEM label bitmap.
+ */
+typedef struct {
+    uint16_t offset; /**< First column of the label in `label_bitmap` */
+    uint8_t length;  /**< Width of the label in columns */
+} LabelBitmap;
+
+/**
+ * @brief Placement of one label in a pre-rendered layout.
+ */
+typedef struct {
+    uint8_t label;  /**< Label id (LABEL_x from Layouts.h) */
+    uint8_t page;   /**< Display page (line 0-7) */
+    uint8_t column; /**< Start pixel column */
+} LayoutSpan;
+
+/**
+ * @brief Display state shared by the windows.
+ *
+ * `staticTag` identifies the static chrome (labels, separators) currently drawn on the glass,
+ * so windows only blit it when they are entered or after the screen was cleared.
+ *
+ * Drawing functions write into `frame` at the cursor set by the page and column address
+ * commands; only bytes that change are marked dirty. screen_flush() sends the dirty column
+ * ranges to the glass in bounded slices from the main loop.
+ */
+typedef struct {
+    uint8_t staticTag;  /**< Tag of the static content on screen, SCREEN_STATIC_NONE if none */
+    uint8_t page;       /**< Page of the write cursor */
+    uint8_t column;     /**< Column of the write cursor */
+    uint8_t commandArg; /**< 1 when the next command byte is the argument of a two-byte command */
+    uint8_t flushPage;  /**< Page the next flush slice starts with */
+    uint8_t dirtyFirst[ST7567S_PAGE_COUNT]; /**< First changed column of every page, SCREEN_CLEAN if none */
+    uint8_t dirtyLast[ST7567S_PAGE_COUNT];  /**< Last changed column of every page */
+    uint8_t frame[ST7567S_PAGE_COUNT][ST7567S_SCREEN_WIDTH]; /**< Frame buffer, one byte per page column */
+    uint16_t busMax;    /**< Longest bus time of one screen_flush() call (us) */
+    uint16_t yields;    /**< Flushes cut short for a pending sensor transaction */
+} ScreenState;
+
+/** @brief Global display state. */
+extern ScreenState Screen;
+
 #endif /* ST7567S_H_ */
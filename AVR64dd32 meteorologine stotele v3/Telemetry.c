@@ -0,0 +1,195 @@
+/*
+ * Telemetry.c
+ *
+ * Created: 2025-01-09
+ * Author: Saulius
+ *
+ * @brief This file contains the streaming telemetry serializer. A record is opened with
+ *        Telemetry_Begin(), filled with Telemetry_Field() and closed with Telemetry_End(). Every byte
+ *        goes directly into the USART0 transmit queue; numbers are fixed-point integers converted to
+ *        decimal by repeated subtraction, without printf and without an intermediate buffer.
+ */
+
+#include "Settings.h"
+#include "TelemetryVar.h"
+
+/**
+ * @brief Queues one record byte and adds it to the running checksum.
+ * 
+ * @param c The byte to send.
+ */
+static void Telemetry_Put(char c) {
+	Telemetry.checksum ^= c;
+	USART0_sendChar(c);
+}
+
+/**
+ * @brief Queues the checksum as two upper case hex digits (not included in the checksum).
+ */
+static void Telemetry_PutChecksum() {
+	static const char hex[] = "0123456789ABCDEF";
+	USART0_sendChar(hex[Telemetry.checksum >> 4]);
+	USART0_sendChar(hex[Telemetry.checksum & 0x0F]);
+}
+
+/**
+ * @brief Writes a fixed-point number in decimal.
+ * 
+ * The value is `value / 10^decimals`, e.g. value -1234 with 2 decimals is written as "-12.34".
+ * Digits are produced from the most significant one by subtracting powers of ten, so no
+ * digit buffer and no 32-bit division is needed.
+ * 
+ * @param value Fixed-point value.
+ * @param decimals Number of fractional digits (0-9).
+ */
+static void Telemetry_PutNumber(int32_t value, uint8_t decimals) {
+	uint32_t v = (uint32_t)value;
+	uint8_t started = 0;
+
+	if (value < 0) {
+		Telemetry_Put('-');
+		v = -v;
+	}
+	for (int8_t i = 9; i >= 0; i--) {
+		uint32_t power = pgm_read_dword(&telemetryPowers[i]);
+		char digit = '0';
+		while (v >= power) {
+			v -= power;
+			digit++;
+		}
+		if (digit != '0' || started || i <= decimals) { // Skip leading zeros, keep "0." before fractions
+			if (decimals && i == decimals - 1)
+				Telemetry_Put('.');
+			Telemetry_Put(digit);
+			started = 1;
+		}
+	}
+}
+
+/**
+ * @brief Starts a new record.
+ * 
+ * @param format Record format (telemetry_format_t).
+ */
+void Telemetry_Begin(uint8_t format) {
+	Telemetry.format = format;
+	Telemetry.fields = 0;
+	Telemetry.checksum = 0;
+	if (format == TELEMETRY_ROTATION)
+		Telemetry_Put('[');
+	else if (format != TELEMETRY_CSV)
+		Telemetry_Put('{');
+}
+
+/**
+ * @brief Adds one field to the current record.
+ * 
+ * @param field Field id (telemetry_field_t), used for the JSON name.
+ * @param value Fixed-point value.
+ * @param decimals Number of fractional digits of `value`.
+ */
+void Telemetry_Field(uint8_t field, int32_t value, uint8_t decimals) {
+	if (Telemetry.fields++)
+		Telemetry_Put(Telemetry.format >= TELEMETRY_TRACKER ? '|' : ',');
+
+	if (Telemetry.format == TELEMETRY_JSON) {
+		Telemetry_Put('"');
+		for (uint8_t i = 0; i < 4; i++) {
+			char c = pgm_read_byte(&telemetryNames[field][i]);
+			if (c == 0)
+				break;
+			Telemetry_Put(c);
+		}
+		Telemetry_Put('"');
+		Telemetry_Put(':');
+	}
+	Telemetry_PutNumber(value, decimals);
+}
+
+/**
+ * @brief Closes the current record, appending the checksum for CSV, JSON and rotation frames.
+ */
+void Telemetry_End() {
+	switch (Telemetry.format) {
+		case TELEMETRY_CSV:
+			USART0_sendChar('*');
+			Telemetry_PutChecksum();
+			break;
+		case TELEMETRY_JSON:
+			USART0_sendString(",\"ck\":\"");
+			Telemetry_PutChecksum();
+			USART0_sendString("\"}");
+			break;
+		case TELEMETRY_ROTATION:
+			USART0_sendChar('*');
+			Telemetry_PutChecksum();
+			USART0_sendChar(']');
+			break;
+		default:
+			USART0_sendChar('}');
+			break;
+	}
+	USART0_sendString("\r\n");
+}
+
+/**
+ * @brief Sends the tracker rotation frame `[ideal|angle|backtracking*HH]`.
+ */
+static void Telemetry_SendRotation() {
+	Telemetry_Begin(TELEMETRY_ROTATION);
+	Telemetry_Field(TM_TRACKER_IDEAL, Tracker.ideal, 2);
+	Telemetry_Field(TM_TRACKER_ANGLE, Tracker.angle, 2);
+	Telemetry_Field(TM_BACKTRACKING, Tracker.backtracking, 0);
+	Telemetry_End();
+}
+
+/**
+ * @brief Current fixed-point value of a field, with telemetryDecimals[field] fractional digits.
+ *
+ * The caller refreshes the derived values first (Derived_Refresh()).
+ * 
+ * @param field Field id (telemetry_field_t).
+ * @return Fixed-point value, 0 for an unknown field.
+ */
+int32_t Telemetry_Value(uint8_t field) {
+	switch (field) {
+		case TM_AZIMUTH:          return lround(SUN.adjazimuth * 100);
+		case TM_ELEVATION:        return lround(SUN.adjelevation * 100);
+		case TM_WIND_SPEED:       return Wind.speed;
+		case TM_WIND_DIR:         return Wind.direction;
+		case TM_SUN_LEVEL:        return SUN.sunlevel;
+		case TM_TEMPERATURE:      return lround(SHT21.T * 100);
+		case TM_HUMIDITY:         return lround(SHT21.RH * 100);
+		case TM_PRESSURE:         return UNIT_RAW(UNIT_CONVERT(PASCAL_Q8, HPA_100, UNIT(PASCAL_Q8, BMP280.CalibrationValues.p)));
+		case TM_DEW_POINT:        return lround(SHT21.Td * 100);
+		case TM_TURBULENCE:       return Turbulence.intensity;
+		case TM_GUST_FACTOR:      return Turbulence.gustFactor;
+		case TM_GUST_PERIOD:      return Turbulence.gustPeriod;
+		case TM_CLEAR_SKY_INDEX:  return ClearSky.index;
+		case TM_SKY_VARIABILITY:  return ClearSky.deviation;
+		case TM_TRACKER_IDEAL:    return Tracker.ideal;
+		case TM_TRACKER_ANGLE:    return Tracker.angle;
+		case TM_BACKTRACKING:     return Tracker.backtracking;
+		case TM_INCIDENCE:        return PlaneOfArray.aoi;
+		case TM_PLANE_IRRADIANCE: return PlaneOfArray.poa;
+		default:                  return 0;
+	}
+}
+
+/**
+ * @brief Sends the station record (solar angles, wind and light; plus T, RH, p and dew point for CSV and JSON).
+ *
+ * The legacy tracker frame is followed by the rotation frame; CSV and JSON carry the rotation as fields.
+ * 
+ * @param format Record format (telemetry_format_t).
+ */
+void Telemetry_SendStation(uint8_t format) {
+	Derived_Refresh(DERIVED_BIT(DERIVED_TRACKER) | (format != TELEMETRY_TRACKER ? DERIVED_BIT(DERIVED_DEW_POINT) : 0));
+	Telemetry_Begin(format);
+	uint8_t last = format == TELEMETRY_TRACKER ? TM_SUN_LEVEL : TELEMETRY_FIELDS - 1;
+	for (uint8_t field = 0; field <= last; field++)
+		Telemetry_Field(field, Telemetry_Value(field), pgm_read_byte(&telemetryDecimals[field]));
+	Telemetry_End();
+	if (format == TELEMETRY_TRACKER)
+		Telemetry_SendRotation();
+}
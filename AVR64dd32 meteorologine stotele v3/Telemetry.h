@@ -0,0 +1,78 @@
+/*
+ * Telemetry.h
+ *
+ * Created: 2025-01-09
+ * Author: Saulius
+ *
+ * @brief This header file defines the record formats, field ids and state of the streaming telemetry
+ *        serializer. Records are written byte by byte straight into the USART0 transmit queue, so their
+ *        length is not limited by any buffer and stack usage does not depend on the record.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+/**
+ * @brief Record formats.
+ *
+ * - CSV:     `v1,v2,...*HH\r\n`, HH = XOR of all bytes before '*'.
+ * - JSON:    `{"az":v1,"el":v2,...,"ck":"HH"}\r\n`, HH = XOR of all bytes before `,"ck"`.
+ * - TRACKER: `{v1|v2|...}\r\n`, the legacy tracker frame (no checksum).
+ * - ROTATION: `[v1|v2|...*HH]\r\n`, tracker rotation frame, HH = XOR of all bytes before '*'.
+ *   Legacy trackers wait for '{' and skip it.
+ */
+typedef enum {
+	TELEMETRY_CSV,     ///< Comma separated values with checksum
+	TELEMETRY_JSON,    ///< Compact JSON object with checksum field
+	TELEMETRY_TRACKER, ///< Legacy `{a|b|c}` tracker frame
+	TELEMETRY_ROTATION ///< `[a|b|c*HH]` tracker rotation frame
+} telemetry_format_t;
+
+/**
+ * @brief Format of the record sent every main loop pass.
+ *
+ * Trackers on the RS-485 line parse the legacy frame, so it stays the default.
+ */
+#define TELEMETRY_FORMAT TELEMETRY_TRACKER
+
+/**
+ * @brief Field ids. The JSON names are kept in program memory (TelemetryVar.h).
+ */
+typedef enum {
+	TM_AZIMUTH,      ///< Adjusted solar azimuth, degrees
+	TM_ELEVATION,    ///< Adjusted solar elevation, degrees
+	TM_WIND_SPEED,   ///< Wind speed, m/s
+	TM_WIND_DIR,     ///< Wind direction index (0 = North ... 7 = Northwest)
+	TM_SUN_LEVEL,    ///< Light level, mV
+	TM_TEMPERATURE,  ///< SHT21 temperature, C
+	TM_HUMIDITY,     ///< SHT21 relative humidity, %
+	TM_PRESSURE,     ///< BMP280 pressure, hPa
+	TM_DEW_POINT,    ///< Dew point, C
+	TM_TURBULENCE,   ///< Turbulence intensity, %
+	TM_GUST_FACTOR,  ///< Gust factor (3 s gust / mean)
+	TM_GUST_PERIOD,  ///< Dominant gust period, s
+	TM_CLEAR_SKY_INDEX, ///< Clear-sky index (measured / clear-sky irradiance)
+	TM_SKY_VARIABILITY, ///< Standard deviation of the clear-sky index over the rolling window
+	TM_TRACKER_IDEAL, ///< True-tracking rotation of the tracker rows, degrees
+	TM_TRACKER_ANGLE, ///< Backtracked and limited rotation of the tracker rows, degrees
+	TM_BACKTRACKING, ///< 1 while backtracking
+	TM_INCIDENCE,    ///< Angle of incidence on the panel plane, degrees
+	TM_PLANE_IRRADIANCE, ///< Plane-of-array irradiance, W/m2
+	TELEMETRY_FIELDS ///< Number of field ids
+} telemetry_field_t;
+
+/**
+ * @brief State of the record being written.
+ */
+typedef struct {
+	uint8_t format;   ///< Format of the current record (telemetry_format_t)
+	uint8_t fields;   ///< Number of fields written so far
+	uint8_t checksum; ///< Running XOR of the record bytes
+} TelemetryRecord;
+
+/**
+ * @brief External variable holding the serializer state.
+ */
+extern TelemetryRecord Telemetry;
+
+#endif /* TELEMETRY_H_ */
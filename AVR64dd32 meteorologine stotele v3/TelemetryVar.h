@@ -0,0 +1,80 @@
+/*
+ * TelemetryVar.h
+ *
+ * Created: 2025-01-09
+ * Author: Saulius
+ *
+ * @brief This header file contains the serializer state, the JSON field names and the decimals
+ *        of every field, which are stored in program memory and indexed by field id.
+ */
+
+#ifndef TELEMETRYVAR_H_
+#define TELEMETRYVAR_H_
+
+/**
+ * @brief Serializer state, no record open at start-up.
+ */
+TelemetryRecord Telemetry = {
+	.format = TELEMETRY_FORMAT,
+	.fields = 0,
+	.checksum = 0
+};
+
+/**
+ * @brief JSON field names (at most 3 characters, zero padded).
+ */
+const char telemetryNames[TELEMETRY_FIELDS][4] PROGMEM = {
+	[TM_AZIMUTH]     = "az",
+	[TM_ELEVATION]   = "el",
+	[TM_WIND_SPEED]  = "ws",
+	[TM_WIND_DIR]    = "wd",
+	[TM_SUN_LEVEL]   = "ll",
+	[TM_TEMPERATURE] = "t",
+	[TM_HUMIDITY]    = "rh",
+	[TM_PRESSURE]    = "p",
+	[TM_DEW_POINT]   = "td",
+	[TM_TURBULENCE]  = "ti",
+	[TM_GUST_FACTOR] = "gf",
+	[TM_GUST_PERIOD] = "gp",
+	[TM_CLEAR_SKY_INDEX] = "ci",
+	[TM_SKY_VARIABILITY] = "sv",
+	[TM_TRACKER_IDEAL] = "ri",
+	[TM_TRACKER_ANGLE] = "ra",
+	[TM_BACKTRACKING] = "bt",
+	[TM_INCIDENCE] = "ai",
+	[TM_PLANE_IRRADIANCE] = "pa"
+};
+
+/**
+ * @brief Fractional digits of every field (the value is `value / 10^decimals`).
+ */
+const uint8_t telemetryDecimals[TELEMETRY_FIELDS] PROGMEM = {
+	[TM_AZIMUTH]     = 2,
+	[TM_ELEVATION]   = 2,
+	[TM_WIND_SPEED]  = 0,
+	[TM_WIND_DIR]    = 0,
+	[TM_SUN_LEVEL]   = 0,
+	[TM_TEMPERATURE] = 2,
+	[TM_HUMIDITY]    = 2,
+	[TM_PRESSURE]    = 2,
+	[TM_DEW_POINT]   = 2,
+	[TM_TURBULENCE]  = 1,
+	[TM_GUST_FACTOR] = 2,
+	[TM_GUST_PERIOD] = 1,
+	[TM_CLEAR_SKY_INDEX] = 3,
+	[TM_SKY_VARIABILITY] = 3,
+	[TM_TRACKER_IDEAL] = 2,
+	[TM_TRACKER_ANGLE] = 2,
+	[TM_BACKTRACKING] = 0,
+	[TM_INCIDENCE] = 2,
+	[TM_PLANE_IRRADIANCE] = 1
+};
+
+/**
+ * @brief Powers of ten for the subtraction based decimal conversion.
+ */
+const uint32_t telemetryPowers[10] PROGMEM = {
+	1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+#endif /* TELEMETRYVAR_H_ */
@@ -0,0 +1,72 @@
+/**
+ * @file Timer.c
+ * @brief System millisecond tick based on TCB0.
+ *
+ * TCB0 runs in periodic interrupt mode and increments `Timer.ms` every millisecond.
+ * Modules that need to schedule work (e.g. adaptive sampling) use `Timer_ms()` as a time base
+ * instead of counting main-loop passes.
+ *
+ * @author Saulius
+ * @date 2025-01-06
+ */
+
+#include "Settings.h"
+#include "TimerVar.h"
+
+/**
+ * @brief Initializes TCB0 as a 1 kHz periodic interrupt source.
+ *
+ * TCB0 is clocked from CLK_PER / 2 (12 MHz) and compares against `TIMER_TCB0_CCMP`.
+ * Global interrupts must be enabled with `sei()` for the tick to run.
+ */
+void TCB0_init() {
+    TCB0.CCMP = TIMER_TCB0_CCMP; // 1 ms period
+    TCB0.CTRLB = TCB_CNTMODE_INT_gc; // Periodic interrupt mode
+    TCB0.INTCTRL = TCB_CAPT_bm; // Enable capture/compare interrupt
+    TCB0.CTRLA = TCB_CLKSEL_DIV2_gc | TCB_ENABLE_bm; // CLK_PER / 2 and enable
+}
+
+/**
+ * @brief Returns the current millisecond tick.
+ *
+ * The 32-bit counter is read with interrupts disabled so that the ISR cannot
+ * update it half way through the read.
+ *
+ * @return Milliseconds since `TCB0_init()`.
+ */
+uint32_t Timer_ms() {
+    uint32_t now;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        now = Timer.ms;
+    }
+    return now;
+}
+
+/**
+ * @brief Returns the current time with microsecond resolution.
+ *
+ * Combines the millisecond tick with the TCB0 count. If the compare interrupt is pending
+ * (the counter has just wrapped and the ISR has not run yet) the tick is one millisecond behind.
+ * The result wraps after ~71 minutes, so only intervals may be measured with it.
+ *
+ * @return Microseconds since `TCB0_init()`.
+ */
+uint32_t Timer_us() {
+    uint32_t ms;
+    uint16_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = Timer.ms;
+        count = TCB0.CNT;
+        if ((TCB0.INTFLAGS & TCB_CAPT_bm) && count < TIMER_TCB0_CCMP / 2)
+            ms++; // Wrapped after the tick was read
+    }
+    return ms * 1000 + count / TIMER_TCB0_PER_US;
+}
+
+/**
+ * @brief TCB0 compare interrupt: advances the millisecond tick.
+ */
+ISR(TCB0_INT_vect) {
+    TCB0.INTFLAGS = TCB_CAPT_bm; // Clear interrupt flag
+    Timer.ms++;
+}
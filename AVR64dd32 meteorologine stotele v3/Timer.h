@@ -0,0 +1,45 @@
+/**
+ * @file Timer.h
+ * @brief Header file for the system millisecond tick.
+ *
+ * This file defines the tick period and the structure holding the free-running
+ * millisecond counter driven by the TCB0 periodic interrupt.
+ *
+ * @author Saulius
+ * @date 2025-01-06
+ */
+
+#ifndef TIMER_H_
+#define TIMER_H_
+
+/**
+ * @brief Tick frequency of the system timer in Hz (1 ms period).
+ */
+#define TIMER_TICK_HZ 1000
+
+/**
+ * @brief TCB0 compare value for the tick period (TCB0 clocked from CLK_PER / 2).
+ */
+#define TIMER_TCB0_CCMP ((F_CPU / 2 / TIMER_TICK_HZ) - 1)
+
+/**
+ * @brief TCB0 counts per microsecond.
+ */
+#define TIMER_TCB0_PER_US (F_CPU / 2 / 1000000UL)
+
+/**
+ * @brief System tick structure.
+ *
+ * Holds the number of milliseconds elapsed since `TCB0_init()` was called.
+ * The counter wraps after ~49.7 days, so interval checks must use unsigned subtraction.
+ */
+typedef struct {
+    volatile uint32_t ms; /**< Milliseconds since start-up */
+} SystemTimer;
+
+/**
+ * @brief Global system tick instance.
+ */
+extern SystemTimer Timer;
+
+#endif /* TIMER_H_ */
@@ -0,0 +1,19 @@
+/**
+ * @file TimerVar.h
+ * @brief Variable definitions for the system millisecond tick.
+ *
+ * @author Saulius
+ * @date 2025-01-06
+ */
+
+#ifndef TIMERVAR_H_
+#define TIMERVAR_H_
+
+/**
+ * @brief Global system tick instance, starting from 0 ms at power-up.
+ */
+SystemTimer Timer = {
+    .ms = 0 /**< No time elapsed yet */
+};
+
+#endif /* TIMERVAR_H_ */
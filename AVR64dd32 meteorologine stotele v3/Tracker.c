@@ -0,0 +1,61 @@
+/**
+ * @file Tracker.c
+ * @brief Fixed-point single-axis tracker rotation with backtracking.
+ *
+ * @author Saulius
+ * @date 2025-01-19
+ */
+
+#include "Settings.h"
+#include "TrackerVar.h"
+
+/**
+ * @brief Computes the ideal and the backtracked rotation from the adjusted solar angles.
+ *
+ * Called by the derived value graph (DERIVED_TRACKER) after SUN.adjelevation/adjazimuth are up
+ * to date. Changing the configuration at run time needs `Derived.dirty |= DERIVED_BIT(DERIVED_TRACKER)`.
+ */
+void Tracker_Compute() {
+    int32_t h = UNIT_RAW(UNIT_FROM_FLOAT(DEGREE_100, SUN.adjelevation));
+    int32_t az = UNIT_RAW(UNIT_FROM_FLOAT(DEGREE_100, SUN.adjazimuth));
+
+    if (h <= 0) { // Night: rows flat
+        Tracker.ideal = 0;
+        Tracker.angle = 0;
+        Tracker.backtracking = 0;
+        Tracker.stow = 1;
+        return;
+    }
+    Tracker.stow = 0;
+
+    // Sun vector (Q15): east, north, up
+    int16_t ch = FixedMath_Cos(h);
+    int32_t se = ((int32_t)ch * FixedMath_Sin(az)) >> 15;
+    int32_t sn = ((int32_t)ch * FixedMath_Cos(az)) >> 15;
+    int32_t su = FixedMath_Sin(h);
+
+    // Into the tracker frame: x' across the axis, z' normal to the flat rows
+    int16_t sa = FixedMath_Sin(Tracker.axisAzimuth), ca = FixedMath_Cos(Tracker.axisAzimuth);
+    int16_t sb = FixedMath_Sin(Tracker.axisTilt), cb = FixedMath_Cos(Tracker.axisTilt);
+    int32_t x = (se * ca - sn * sa) >> 15;
+    int32_t along = (se * sa + sn * ca) >> 15;
+    int32_t z = (along * sb + su * cb) >> 15;
+    Tracker.sunX = x;
+    Tracker.sunZ = z;
+    int16_t theta = FixedMath_Atan2(x, z);
+    Tracker.ideal = theta;
+
+    // Backtracking while cos(theta) / GCR < 1
+    int32_t shade = ((int32_t)FixedMath_Cos(theta) << 15) / Tracker.gcr;
+    int16_t angle = theta;
+    Tracker.backtracking = (shade < FIXEDMATH_ONE);
+    if (Tracker.backtracking) {
+        int16_t wc = FixedMath_Acos(shade < INT16_MIN ? INT16_MIN : shade);
+        angle = (theta >= 0) ? theta - wc : theta + wc;
+    }
+    if (angle > Tracker.maxAngle)
+        angle = Tracker.maxAngle;
+    else if (angle < -Tracker.maxAngle)
+        angle = -Tracker.maxAngle;
+    Tracker.angle = angle;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file Tracker.h
+ * @brief Header file for the single-axis tracker rotation and backtracking.
+ *
+ * The station computes the rotation of a single-axis tracker row once for the whole site and
+ * broadcasts it, instead of every tracker computing it from the solar angles. With the sun
+ * vector s (east, north, up) from SUN.adjelevation/adjazimuth, an axis pointing to azimuth a
+ * and tilted up by b (NREL single-axis tracking, Marion & Dobos 2013):
+ *
+ *   x' = s_e cos a - s_n sin a
+ *   z' = (s_e sin a + s_n cos a) sin b + s_u cos b
+ *   ideal rotation  theta = atan2(x', z')
+ *
+ * Backtracking (Anderson & Mikofski 2020, flat ground across the rows) turns the rows back
+ * towards flat while their shadows would reach the next row:
+ *
+ *   if cos(theta) / GCR < 1:  angle = theta - sign(theta) acos(cos(theta) / GCR)
+ *
+ * and the result is limited to +-maxAngle. Rotation is positive towards the right of the axis
+ * direction: west for an axis pointing south, i.e. negative in the morning. Everything is fixed
+ * point (FixedMath.c); the value is a node of the derived value graph, so it is recomputed only
+ * when the solar angles change. tools/tracker_accuracy.py compares it with double precision.
+ *
+ * @author Saulius
+ * @date 2025-01-19
+ */
+
+#ifndef TRACKER_H_
+#define TRACKER_H_
+
+/** @name Site configuration */
+///@{
+#define TRACKER_AXIS_AZIMUTH 18000   /**< Direction the axis points to (0.01 deg from North): north-south rows */
+#define TRACKER_AXIS_TILT 0          /**< Axis tilt above horizontal (0.01 deg) */
+#define TRACKER_GCR_Q15 13107        /**< Ground coverage ratio, collector width / row pitch: 0.4 (Q15) */
+#define TRACKER_MAX_ANGLE 6000       /**< Rotation limit (0.01 deg) */
+///@}
+
+/**
+ * @brief Tracker configuration and the computed rotation.
+ */
+typedef struct {
+    uint16_t axisAzimuth; /**< Direction the axis points to (0.01 deg from North, clockwise) */
+    int16_t axisTilt;     /**< Axis tilt above horizontal (0.01 deg) */
+    uint16_t gcr;         /**< Ground coverage ratio (Q15) */
+    int16_t maxAngle;     /**< Rotation limit (0.01 deg) */
+
+    int16_t sunX;         /**< Sun vector across the axis (Q15), x' above */
+    int16_t sunZ;         /**< Sun vector normal to the flat rows (Q15), z' above */
+    int16_t ideal;        /**< True-tracking rotation, not limited (0.01 deg) */
+    int16_t angle;        /**< Rotation to apply: backtracked and limited (0.01 deg) */
+    uint8_t backtracking; /**< 1 while the rotation is reduced to avoid row to row shading */
+    uint8_t stow;         /**< 1 while the sun is below the horizon (angle 0) */
+} TrackerState;
+
+/**
+ * @brief Global tracker state.
+ */
+extern TrackerState Tracker;
+
+#endif /* TRACKER_H_ */
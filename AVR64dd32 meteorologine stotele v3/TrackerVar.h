@@ -0,0 +1,23 @@
+/**
+ * @file TrackerVar.h
+ * @brief Variable definition of the single-axis tracker rotation.
+ *
+ * @author Saulius
+ * @date 2025-01-19
+ */
+
+#ifndef TRACKERVAR_H_
+#define TRACKERVAR_H_
+
+/**
+ * @brief Site configuration from Tracker.h, rows flat until the first computation.
+ */
+TrackerState Tracker = {
+    .axisAzimuth = TRACKER_AXIS_AZIMUTH,
+    .axisTilt = TRACKER_AXIS_TILT,
+    .gcr = TRACKER_GCR_Q15,
+    .maxAngle = TRACKER_MAX_ANGLE,
+    .stow = 1
+};
+
+#endif /* TRACKERVAR_H_ */
@@ -0,0 +1,289 @@
+/**
+ * @file Turbulence.c
+ * @brief Wind spectrum (Q15 FFT) and turbulence metrics computed in background slices.
+ *
+ * Turbulence_Task() samples the wind speed every TURBULENCE_SAMPLE_MS and, while a full block is
+ * being analysed, does one slice of the analysis per call. The analysis works in place in the
+ * block buffer, so the samples taken while it runs (about 30 passes) wait in a small staging buffer
+ * and move into the next block when it is done: sampling never stops and blocks are contiguous.
+ * The window phase turns the samples into N/2 complex values (even samples real, odd samples
+ * imaginary, interleaved as they are) and moves them to their bit reversed positions, so the
+ * butterflies of the N/2 point FFT can start right after it.
+ *
+ * @author Saulius
+ * @date 2025-01-15
+ */
+
+#include "Settings.h"
+#include "TurbulenceVar.h"
+
+/**
+ * @brief Reverses the TURBULENCE_LOG2N - 1 low bits of an index of the packed N/2 point FFT.
+ */
+static uint8_t Turbulence_Reverse(uint8_t n) {
+    uint8_t r = 0;
+    for (uint8_t i = 0; i < TURBULENCE_LOG2N - 1; i++) {
+        r = (r << 1) | (n & 1);
+        n >>= 1;
+    }
+    return r;
+}
+
+/**
+ * @brief The block buffer as the packed FFT buffer: x[2m] real and x[2m + 1] imaginary part (Q15).
+ */
+#define TURBULENCE_FFT_BUFFER ((int16_t *)Turbulence.samples)
+
+/**
+ * @brief One radix-2 decimation in time butterfly of the N/2 point FFT, scaled by 1/2 so no stage
+ * can overflow.
+ *
+ * @param b Butterfly number over all stages (0 ... (TURBULENCE_LOG2N - 1) * N/4 - 1).
+ */
+static void Turbulence_Butterfly(uint16_t b) {
+    uint8_t stage = b / (TURBULENCE_N / 4);
+    uint8_t k = b % (TURBULENCE_N / 4);
+    uint8_t pos = k & ((1 << stage) - 1);               // Position within the group
+    uint8_t i = ((k >> stage) << (stage + 1)) | pos;    // Upper input
+    uint8_t j = i + (1 << stage);                       // Lower input
+    uint8_t t = pos << (TURBULENCE_LOG2N - 1 - stage);  // Twiddle index: W(N/2)^m is W(N)^2m
+    int16_t wr = pgm_read_word(&turbulenceCos[t]);
+    int16_t wi = pgm_read_word(&turbulenceCos[t + TURBULENCE_N / 4]);
+    int16_t *u = &TURBULENCE_FFT_BUFFER[2 * i], *v = &TURBULENCE_FFT_BUFFER[2 * j];
+
+    int16_t tr = ((int32_t)wr * v[0] - (int32_t)wi * v[1] + 0x4000) >> 15;
+    int16_t ti = ((int32_t)wr * v[1] + (int32_t)wi * v[0] + 0x4000) >> 15;
+    int16_t ur = u[0], ui = u[1];
+
+    u[0] = (ur + tr) >> 1;
+    u[1] = (ui + ti) >> 1;
+    v[0] = (ur - tr) >> 1;
+    v[1] = (ui - ti) >> 1;
+}
+
+/**
+ * @brief One bin of the analysed block's spectrum, split out of the packed FFT result.
+ *
+ * With Z the packed N/2 point FFT, the spectra of the even and odd samples are
+ * E = (Z[k] + conj(Z[N/2-k])) / 2 and O = -i (Z[k] - conj(Z[N/2-k])) / 2, and bin k of the block
+ * is E + W^k O. Z has one stage less of the 1/2 scaling, so the result is halved once more.
+ *
+ * @param k Bin, 0 ... TURBULENCE_N / 2.
+ * @param re Real part (Q15, scaled by 1 / TURBULENCE_N).
+ * @param im Imaginary part.
+ */
+void Turbulence_Bin(uint8_t k, int16_t *re, int16_t *im) {
+    const int16_t *a = &TURBULENCE_FFT_BUFFER[2 * (k & (TURBULENCE_N / 2 - 1))];
+    const int16_t *b = &TURBULENCE_FFT_BUFFER[2 * ((TURBULENCE_N / 2 - k) & (TURBULENCE_N / 2 - 1))];
+    int16_t wr = -32767, wi = 0; // W^(N/2) = -1, past the end of the table
+    if (k < TURBULENCE_N / 2) {
+        wr = pgm_read_word(&turbulenceCos[k]);
+        wi = pgm_read_word(&turbulenceCos[k + TURBULENCE_N / 4]);
+    }
+
+    int32_t sr = (int32_t)a[0] + b[0], si = (int32_t)a[1] - b[1];
+    int32_t dr = (int32_t)a[0] - b[0], di = (int32_t)a[1] + b[1];
+    int32_t tr = (wr * di + wi * dr + 0x4000) >> 15; // -i W^k (dr + i di)
+    int32_t ti = (wi * di - wr * dr + 0x4000) >> 15;
+
+    *re = (sr + tr + 2) >> 2;
+    *im = (si + ti + 2) >> 2;
+}
+
+/**
+ * @brief Mean removed, scaled and Hann windowed sample of the analysed block.
+ *
+ * @param n Sample, 0 ... TURBULENCE_N - 1.
+ */
+static int16_t Turbulence_Window(uint16_t n) {
+    int16_t d = (Turbulence.samples[n] - Turbulence.mean) << Turbulence.shift;
+    int16_t w = pgm_read_word(&turbulenceHann[n <= TURBULENCE_N / 2 ? n : TURBULENCE_N - n]);
+
+    return ((int32_t)d * w + 0x4000) >> 15;
+}
+
+/**
+ * @brief Empties the block being sampled.
+ */
+static void Turbulence_Clear() {
+    Turbulence.count = 0;
+    Turbulence.staged = 0;
+    Turbulence.sum = 0;
+    Turbulence.gustSum = 0;
+    Turbulence.gustMax = 0;
+}
+
+/**
+ * @brief Appends a sample to the block being sampled and closes the block when it is full.
+ *
+ * @param x Wind speed (ADC counts).
+ */
+static void Turbulence_Store(uint16_t x) {
+    uint16_t n = Turbulence.count;
+    Turbulence.samples[n] = x;
+    Turbulence.sum += x;
+    Turbulence.gustSum += x;
+    if (n >= TURBULENCE_GUST_SAMPLES)
+        Turbulence.gustSum -= Turbulence.samples[n - TURBULENCE_GUST_SAMPLES];
+    if (n >= TURBULENCE_GUST_SAMPLES - 1 && Turbulence.gustSum > Turbulence.gustMax)
+        Turbulence.gustMax = Turbulence.gustSum;
+
+    if (++n < TURBULENCE_N) {
+        Turbulence.count = n;
+        return;
+    }
+    Turbulence.mean = (Turbulence.sum + TURBULENCE_N / 2) / TURBULENCE_N;
+    Turbulence.blockGust = Turbulence.gustMax;
+    Turbulence.variance = 0;
+    Turbulence.maxDeviation = 0;
+    Turbulence.phase = TURBULENCE_SCAN;
+    Turbulence.step = 0;
+    Turbulence_Clear();
+}
+
+/**
+ * @brief Takes one wind speed sample if it is due.
+ *
+ * While a block is analysed the block buffer is busy, so the sample goes to the staging buffer;
+ * the analysis moves the staged samples into the next block when it is done.
+ */
+static void Turbulence_Sample() {
+    uint32_t now = Timer_ms();
+    int32_t late = (int32_t)(now - Turbulence.nextSample);
+
+    if (late < 0)
+        return;
+    if (late >= TURBULENCE_SAMPLE_MS) {
+        if (Turbulence.count || Turbulence.staged)
+            Turbulence.gaps++; // Not evenly sampled any more, start the block again
+        Turbulence_Clear();
+        Turbulence.nextSample = now;
+    }
+    Turbulence.nextSample += TURBULENCE_SAMPLE_MS;
+
+    ADC0_SetAccumulation(ADC_SAMPNUM_ACC16_gc);
+    ADC0_SetupWS();
+    uint16_t x = ADC0_read();
+
+    if (Turbulence.phase == TURBULENCE_IDLE) {
+        Turbulence_Store(x);
+    } else if (Turbulence.staged < TURBULENCE_STAGING) {
+        Turbulence.staging[Turbulence.staged++] = x;
+    } else {
+        Turbulence.overruns++; // The analysis took too long, start the block again
+        Turbulence_Clear();
+    }
+}
+
+/**
+ * @brief Converts the accumulated results of a block into the published metrics.
+ */
+static void Turbulence_Publish() {
+    uint16_t mean = Turbulence.mean;
+
+    Turbulence.meanSpeed = lround(mean * TURBULENCE_CMS_PER_COUNT);
+    if (mean >= TURBULENCE_MIN_MEAN) {
+        float sigma = sqrtf((float)Turbulence.variance / TURBULENCE_N);
+        Turbulence.intensity = lround(1000 * sigma / mean);
+        Turbulence.gustFactor = lround(100.0f * Turbulence.blockGust / TURBULENCE_GUST_SAMPLES / mean);
+    } else {
+        Turbulence.intensity = 0; // Calm: ratios to the mean are meaningless
+        Turbulence.gustFactor = 0;
+    }
+    Turbulence.gustPeriod = Turbulence.peakBin ? (uint32_t)TURBULENCE_N * TURBULENCE_SAMPLE_MS / 100 / Turbulence.peakBin : 0;
+
+    // One-sided band power of the windowed, scaled block -> variance of the wind speed:
+    // Hann window mean square 3/8, input scaled by 2^shift
+    float scale = (8.0f / 3) * TURBULENCE_CMS_PER_COUNT * TURBULENCE_CMS_PER_COUNT / ((uint32_t)1 << (2 * Turbulence.shift));
+    for (uint8_t b = 0; b < TURBULENCE_BANDS; b++)
+        Turbulence.band[b] = lround(Turbulence.power[b] * scale);
+    Turbulence.blocks++;
+}
+
+/**
+ * @brief Samples the wind speed and runs one slice of the block analysis, call from the main loop.
+ */
+void Turbulence_Task() {
+    Turbulence_Sample();
+
+    uint16_t n = Turbulence.step;
+    switch (Turbulence.phase) {
+        case TURBULENCE_SCAN: // Unwindowed variance (exact) and the largest deviation
+            for (uint8_t i = 0; i < TURBULENCE_SLICE_SAMPLES; i++, n++) {
+                int16_t d = Turbulence.samples[n] - Turbulence.mean;
+                uint16_t a = d < 0 ? -d : d;
+                Turbulence.variance += (uint32_t)a * a;
+                if (a > Turbulence.maxDeviation)
+                    Turbulence.maxDeviation = a;
+            }
+            if (n == TURBULENCE_N) {
+                Turbulence.shift = 0; // Block floating point: largest deviation up to 2^14
+                while (Turbulence.maxDeviation && (Turbulence.maxDeviation << Turbulence.shift) < 0x2000)
+                    Turbulence.shift++;
+                Turbulence.phase = TURBULENCE_WINDOW;
+                n = 0;
+            }
+            break;
+
+        case TURBULENCE_WINDOW: // Sample pairs are the complex values; pair n swaps with pair r
+            for (uint8_t i = 0; i < TURBULENCE_SLICE_SAMPLES / 2; i++, n++) {
+                uint8_t r = Turbulence_Reverse(n);
+                if (r < n)
+                    continue; // Done with pair r
+                int16_t *x = TURBULENCE_FFT_BUFFER;
+                int16_t re = Turbulence_Window(2 * n), im = Turbulence_Window(2 * n + 1);
+                x[2 * n] = Turbulence_Window(2 * r);
+                x[2 * n + 1] = Turbulence_Window(2 * r + 1);
+                x[2 * r] = re;
+                x[2 * r + 1] = im;
+            }
+            if (n == TURBULENCE_N / 2) {
+                Turbulence.phase = TURBULENCE_FFT;
+                n = 0;
+            }
+            break;
+
+        case TURBULENCE_FFT:
+            for (uint8_t i = 0; i < TURBULENCE_SLICE_BUTTERFLIES; i++, n++)
+                Turbulence_Butterfly(n);
+            if (n == (TURBULENCE_LOG2N - 1) * (TURBULENCE_N / 4)) {
+                for (uint8_t b = 0; b < TURBULENCE_BANDS; b++)
+                    Turbulence.power[b] = 0;
+                Turbulence.peakPower = 0;
+                Turbulence.peakBin = 0;
+                Turbulence.phase = TURBULENCE_SPECTRUM;
+                n = 1; // Bin 0 is the (removed) mean
+            }
+            break;
+
+        case TURBULENCE_SPECTRUM:
+            for (uint8_t i = 0; i < TURBULENCE_SLICE_BINS && n <= TURBULENCE_N / 2; i++, n++) {
+                int16_t re, im;
+                Turbulence_Bin(n, &re, &im);
+                uint32_t p = (uint32_t)((int32_t)re * re) + (uint32_t)((int32_t)im * im);
+                if (p > Turbulence.peakPower) {
+                    Turbulence.peakPower = p;
+                    Turbulence.peakBin = n;
+                }
+                if (n < TURBULENCE_N / 2)
+                    p <<= 1; // Negative frequency twin, except for the Nyquist bin
+                uint8_t b = 0;
+                for (uint16_t m = n >> 1; m && b < TURBULENCE_BANDS - 1; m >>= 1)
+                    b++; // Octave band: floor(log2(n)), Nyquist bin in the last band
+                Turbulence.power[b] += p;
+            }
+            if (n > TURBULENCE_N / 2) {
+                Turbulence_Publish();
+                Turbulence.phase = TURBULENCE_IDLE;
+                uint8_t staged = Turbulence.staged;
+                Turbulence.staged = 0;
+                for (uint8_t i = 0; i < staged; i++)
+                    Turbulence_Store(Turbulence.staging[i]); // Fewer than TURBULENCE_N: no block closes
+            }
+            break;
+
+        default:
+            return;
+    }
+    Turbulence.step = n;
+}
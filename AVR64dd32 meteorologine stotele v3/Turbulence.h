@@ -0,0 +1,108 @@
+/**
+ * @file Turbulence.h
+ * @brief Header file for the wind spectrum and turbulence metrics.
+ *
+ * Wind speed is sampled at a fixed rate into blocks of TURBULENCE_N samples, independently of the
+ * adaptive sampling engine. Every full block is analysed in the background: mean, standard
+ * deviation and the highest 3 s gust give the turbulence intensity and gust factor, and a Q15
+ * radix-2 FFT (in place, twiddles in PROGMEM) of the Hann windowed block gives the wind speed
+ * variance per octave band and the dominant gust period.
+ *
+ * The block is real, so it is taken as a complex sequence of half the length (even samples real,
+ * odd samples imaginary) and transformed with an N/2 point FFT; the spectrum phase splits each
+ * bin out of two conjugate bins of the packed result (Turbulence_Bin()). The transform runs in
+ * place in the sample buffer and needs no RAM beyond the 2 * N byte block and the staging buffer
+ * that keeps sampling going during the ~30 passes of the analysis.
+ *
+ * The analysis runs in slices from Turbulence_Task(), one slice per main loop pass, so it never
+ * holds the loop longer than one slice. Estimated AVR cost (avr-gcc -Os, 24 MHz; one butterfly is
+ * four 16x16->32 bit multiplies, two PROGMEM twiddle reads and eight 16-bit loads/stores,
+ * about 220 cycles):
+ *
+ *  phase     work per block                   slices   cycles/slice   total
+ *  scan      256 samples                      4        ~3 k           ~12 k
+ *  window    256 multiplies, pairs swapped    4        ~5 k           ~20 k
+ *  fft       448 butterflies                  14       ~7 k           ~99 k
+ *  spectrum  128 bin splits                   4        ~6 k           ~26 k
+ *
+ * i.e. at most ~0.3 ms per pass and ~7 ms of CPU time per 128 s block (< 0.01 % load).
+ * tools/fft_accuracy.py checks the results against a double precision FFT on the host.
+ *
+ * @author Saulius
+ * @date 2025-01-15
+ */
+
+#ifndef TURBULENCE_H_
+#define TURBULENCE_H_
+
+#define TURBULENCE_LOG2N 8                       /**< log2 of the block length */
+#define TURBULENCE_N (1 << TURBULENCE_LOG2N)     /**< Samples per block (and FFT length) */
+#define TURBULENCE_SAMPLE_MS 500                 /**< Sample period: 2 Hz, 128 s blocks */
+#define TURBULENCE_GUST_SAMPLES (3000 / TURBULENCE_SAMPLE_MS) /**< 3 s gust averaging (WMO) */
+#define TURBULENCE_BANDS 7                       /**< Octave bands: bins 1, 2-3, 4-7, ... 64-128 */
+#define TURBULENCE_MIN_MEAN 68                   /**< Lowest mean (ADC counts, 0.5 m/s) with meaningful TI and gust factor */
+#define TURBULENCE_STAGING 16                    /**< Samples taken while a block is analysed: 8 s, ~30 passes of up to 250 ms */
+
+/** @name Work per Turbulence_Task() call */
+///@{
+#define TURBULENCE_SLICE_SAMPLES 64     /**< Samples per scan/window slice */
+#define TURBULENCE_SLICE_BUTTERFLIES 32 /**< Butterflies per FFT slice */
+#define TURBULENCE_SLICE_BINS 32        /**< Bins per spectrum slice */
+///@}
+
+/**
+ * @brief Wind speed per ADC count, in cm/s (30 m/s full scale, see WindSpeed()).
+ */
+#define TURBULENCE_CMS_PER_COUNT (3000.0 / 4096)
+
+/**
+ * @brief Analysis phases of a full block.
+ */
+typedef enum {
+    TURBULENCE_IDLE,     /**< Waiting for a full block */
+    TURBULENCE_SCAN,     /**< Variance and largest deviation from the mean */
+    TURBULENCE_WINDOW,   /**< Mean removal, scaling and Hann window in place, bit reversed */
+    TURBULENCE_FFT,      /**< Butterflies, all stages */
+    TURBULENCE_SPECTRUM  /**< Power per bin into octave bands */
+} turbulence_phase_t;
+
+/**
+ * @brief Sampling, analysis state and results.
+ */
+typedef struct {
+    uint16_t samples[TURBULENCE_N]; /**< Block being sampled (ADC counts), then the packed FFT buffer (Q15) */
+    uint16_t count;       /**< Samples in the block being sampled */
+    uint16_t staging[TURBULENCE_STAGING]; /**< First samples of the next block, taken during the analysis */
+    uint8_t staged;       /**< Samples in staging */
+    uint32_t nextSample;  /**< Time of the next sample (Timer_ms()) */
+    uint32_t sum;         /**< Sum of the samples in the block being sampled */
+    uint16_t gustSum;     /**< Sum of the last TURBULENCE_GUST_SAMPLES samples */
+    uint16_t gustMax;     /**< Highest gustSum in the block being sampled */
+
+    uint8_t phase;        /**< Analysis phase (turbulence_phase_t) */
+    uint16_t step;        /**< Progress within the phase */
+    uint16_t mean;        /**< Mean of the analysed block (ADC counts) */
+    uint16_t blockGust;   /**< Highest 3 s sum of the analysed block */
+    uint16_t maxDeviation; /**< Largest |sample - mean| of the analysed block */
+    uint8_t shift;        /**< Block floating point scaling of the FFT input (left shift) */
+    uint32_t variance;    /**< Sum of squared deviations of the analysed block */
+    uint32_t power[TURBULENCE_BANDS]; /**< Band power accumulators (Q15 units squared) */
+    uint32_t peakPower;   /**< Highest bin power so far */
+    uint8_t peakBin;      /**< Bin of peakPower */
+
+    uint16_t meanSpeed;   /**< Mean wind speed of the last block (0.01 m/s) */
+    uint16_t intensity;   /**< Turbulence intensity, standard deviation / mean (0.1 %) */
+    uint16_t gustFactor;  /**< Highest 3 s mean / mean (0.01) */
+    uint16_t gustPeriod;  /**< Period of the strongest spectral peak (0.1 s) */
+    uint32_t band[TURBULENCE_BANDS]; /**< Wind speed variance per octave band ((cm/s)^2) */
+    uint16_t blocks;      /**< Blocks analysed since start-up */
+    uint16_t overruns;    /**< Blocks restarted because the staging buffer filled up during an analysis */
+    uint16_t gaps;        /**< Blocks restarted because a sample was late by more than one period */
+} TurbulenceState;
+
+/**
+ * @brief Global wind spectrum and turbulence state.
+ */
+extern TurbulenceState Turbulence;
+
+#endif /* TURBULENCE_H_ */
@@ -0,0 +1,62 @@
+/**
+ * @file TurbulenceVar.h
+ * @brief Variable definitions and PROGMEM tables of the wind spectrum analysis.
+ *
+ * @author Saulius
+ * @date 2025-01-15
+ */
+
+#ifndef TURBULENCEVAR_H_
+#define TURBULENCEVAR_H_
+
+/**
+ * @brief Wind spectrum and turbulence state, nothing sampled yet.
+ */
+TurbulenceState Turbulence = {
+    .count = 0,
+    .phase = TURBULENCE_IDLE
+};
+
+/**
+ * @brief cos(2 pi k / TURBULENCE_N) in Q15, k = 0 ... 3N/4 - 1.
+ *
+ * The FFT twiddle factor W^k = cos(2 pi k / N) - j sin(2 pi k / N) uses entry k for the real part
+ * and entry k + N/4 (= -sin) for the imaginary part.
+ */
+const int16_t turbulenceCos[3 * TURBULENCE_N / 4] PROGMEM = {
+    32767, 32758, 32729, 32679, 32610, 32522, 32413, 32286, 32138, 31972, 31786, 31581,
+    31357, 31114, 30853, 30572, 30274, 29957, 29622, 29269, 28899, 28511, 28106, 27684,
+    27246, 26791, 26320, 25833, 25330, 24812, 24279, 23732, 23170, 22595, 22006, 21403,
+    20788, 20160, 19520, 18868, 18205, 17531, 16846, 16151, 15447, 14733, 14010, 13279,
+    12540, 11793, 11039, 10279, 9512, 8740, 7962, 7180, 6393, 5602, 4808, 4011,
+    3212, 2411, 1608, 804, 0, -804, -1608, -2411, -3212, -4011, -4808, -5602,
+    -6393, -7180, -7962, -8740, -9512, -10279, -11039, -11793, -12540, -13279, -14010, -14733,
+    -15447, -16151, -16846, -17531, -18205, -18868, -19520, -20160, -20788, -21403, -22006, -22595,
+    -23170, -23732, -24279, -24812, -25330, -25833, -26320, -26791, -27246, -27684, -28106, -28511,
+    -28899, -29269, -29622, -29957, -30274, -30572, -30853, -31114, -31357, -31581, -31786, -31972,
+    -32138, -32286, -32413, -32522, -32610, -32679, -32729, -32758, -32768, -32758, -32729, -32679,
+    -32610, -32522, -32413, -32286, -32138, -31972, -31786, -31581, -31357, -31114, -30853, -30572,
+    -30274, -29957, -29622, -29269, -28899, -28511, -28106, -27684, -27246, -26791, -26320, -25833,
+    -25330, -24812, -24279, -23732, -23170, -22595, -22006, -21403, -20788, -20160, -19520, -18868,
+    -18205, -17531, -16846, -16151, -15447, -14733, -14010, -13279, -12540, -11793, -11039, -10279,
+    -9512, -8740, -7962, -7180, -6393, -5602, -4808, -4011, -3212, -2411, -1608, -804
+};
+
+/**
+ * @brief Periodic Hann window 0.5 - 0.5 cos(2 pi n / N) in Q15, n = 0 ... N/2 (symmetric around N/2).
+ */
+const int16_t turbulenceHann[TURBULENCE_N / 2 + 1] PROGMEM = {
+    0, 5, 20, 44, 79, 123, 177, 241, 315, 398, 491, 593,
+    705, 827, 958, 1098, 1247, 1406, 1573, 1749, 1935, 2128, 2331, 2542,
+    2761, 2989, 3224, 3468, 3719, 3978, 4244, 4518, 4799, 5087, 5381, 5682,
+    5990, 6304, 6624, 6950, 7282, 7619, 7961, 8308, 8661, 9018, 9379, 9745,
+    10114, 10487, 10864, 11245, 11628, 12014, 12403, 12794, 13188, 13583, 13980, 14378,
+    14778, 15179, 15580, 15982, 16384, 16786, 17188, 17589, 17990, 18390, 18788, 19185,
+    19580, 19974, 20365, 20754, 21140, 21523, 21904, 22281, 22654, 23023, 23389, 23750,
+    24107, 24460, 24807, 25149, 25486, 25818, 26144, 26464, 26778, 27086, 27387, 27681,
+    27969, 28250, 28524, 28790, 29049, 29300, 29544, 29779, 30007, 30226, 30437, 30640,
+    30833, 31019, 31195, 31362, 31521, 31670, 31810, 31941, 32063, 32175, 32277, 32370,
+    32453, 32527, 32591, 32645, 32689, 32724, 32748, 32763, 32767
+};
+
+#endif /* TURBULENCEVAR_H_ */
@@ -10,6 +10,7 @@
  */
 
 #include "Settings.h"
+#include "USARTVar.h"
 
 /**
  * @brief Initializes USART0 with a baud rate of 2500000.
@@ -24,15 +25,90 @@ void USART0_init() {
 }
 
 /**
- * @brief Sends a single character via USART0.
+ * @brief Transmits the next queued character, from the data register empty interrupt or by polling.
  * 
- * This function waits until the USART0 data register is empty and then transmits a character.
+ * A queued block is sent once the ring has caught up with its mark, ring characters queued
+ * after it wait. The interrupt is disabled when the queue is empty.
+ */
+static void USART0_TxNext() {
+	uint8_t slot = USART0_TX.blockTail;
+	if (slot != USART0_TX.blockHead && USART0_TX.tail == USART0_TX.mark[slot]) {
+		uint8_t block = USART0_TX.block[slot];
+		USART0.TXDATAL = Pool.data[block][USART0_TX.sent++];
+		if (USART0_TX.sent == USART0_TX.length[slot]) { // Block done, back to the pool
+			USART0_TX.sent = 0;
+			USART0_TX.blockTail = (slot + 1) & USART0_TX_BLOCK_MASK;
+			Pool_Free(block);
+		}
+	} else if (USART0_TX.head != USART0_TX.tail) {
+		USART0.TXDATAL = USART0_TX.data[USART0_TX.tail]; // Send next character
+		USART0_TX.tail = (USART0_TX.tail + 1) & USART0_TX_BUFFER_MASK;
+	} else {
+		USART0.CTRLA &= ~USART_DREIE_bm; // Nothing left to send
+	}
+}
+
+/**
+ * @brief Queues a single character for transmission via USART0.
+ * 
+ * The character is placed in the transmit ring buffer and sent by the data register empty
+ * interrupt. The function only waits when the buffer is full. With global interrupts disabled
+ * (before sei(), inside an atomic block) the interrupt cannot run, so the queue is then emptied
+ * by polling the data register instead of waiting for it forever.
  * 
  * @param c The character to send.
  */
 void USART0_sendChar(char c) {
-	while (!(USART0.STATUS & USART_DREIF_bm)); // Wait for data register to be empty
-	USART0.TXDATAL = c; // Send character
+	uint8_t next = (USART0_TX.head + 1) & USART0_TX_BUFFER_MASK;
+	if (SREG & CPU_I_bm)
+		while (next == USART0_TX.tail); // Wait for free space in the queue
+	else
+		while (next == USART0_TX.tail) { // Nobody else empties the queue
+			while (!(USART0.STATUS & USART_DREIF_bm));
+			USART0_TxNext();
+		}
+	USART0_TX.data[USART0_TX.head] = c; // Queue character
+	USART0_TX.head = next;
+	USART0.CTRLA |= USART_DREIE_bm; // Start (or keep) the transmit interrupt running
+}
+
+/**
+ * @brief Returns the free space in the USART0 transmit queue.
+ * 
+ * @return Number of characters that can be queued without waiting.
+ */
+uint8_t USART0_TxSpace() {
+	return (USART0_TX.tail - USART0_TX.head - 1) & USART0_TX_BUFFER_MASK;
+}
+
+/**
+ * @brief Queues a pool block for transmission via USART0 and gives it to the transmitter.
+ * 
+ * The block is sent after the characters already queued and freed by the interrupt after its
+ * last byte; the caller must not touch it any more.
+ * 
+ * @param block Pool block holding the message.
+ * @param length Bytes to send (at most POOL_BLOCK_SIZE).
+ */
+void USART0_SendBlock(uint8_t block, uint8_t length) {
+	if (!length) {
+		Pool_Free(block);
+		return;
+	}
+	uint8_t slot = USART0_TX.blockHead;
+	Pool_Give(block, POOL_USART0_TX);
+	USART0_TX.block[slot] = block;
+	USART0_TX.length[slot] = length;
+	USART0_TX.mark[slot] = USART0_TX.head;
+	USART0_TX.blockHead = (slot + 1) & USART0_TX_BLOCK_MASK; // Never full: each block is queued once
+	USART0.CTRLA |= USART_DREIE_bm;
+}
+
+/**
+ * @brief USART0 data register empty interrupt: transmits the next queued character.
+ */
+ISR(USART0_DRE_vect) {
+	USART0_TxNext();
 }
 
 /**
@@ -149,25 +225,37 @@ char USART1_readChar() {
 /**
  * @brief Sends a formatted string via the selected USART.
  * 
- * This function formats the input string with the provided arguments and sends it via the specified USART (either USART0 or USART1).
+ * This function formats the input string with the provided arguments into a pool block and sends it via the
+ * specified USART (either USART0 or USART1). USART0 takes the block over and its interrupt frees it, USART1
+ * sends it at once. Messages are cut at POOL_BLOCK_SIZE - 1 characters (counted in Pool.truncations); without
+ * a free block nothing is sent (counted in Pool.failures).
  * 
  * @param usart_number The USART number (0 or 1).
- * @param format The format string.
+ * @param format The format string, in flash.
  * @param ... The arguments to be formatted into the string.
  */
-void USART_printf(uint8_t usart_number, const char *format, ...) {
-	char buffer[128]; // Temporary buffer for formatted message
+void USART_printf_P(uint8_t usart_number, PGM_P format, ...) {
+	uint8_t block = Pool_Take(POOL_PRINTF);
+	if (block == POOL_NONE)
+		return; // Counted in Pool.failures
 	va_list args;
 	va_start(args, format);
-	vsnprintf(buffer, sizeof(buffer), format, args); // Format the message into the buffer
+	int length = vsnprintf_P(Pool.data[block], POOL_BLOCK_SIZE, format, args); // Format the message into the block
 	va_end(args);
+	if (length < 0)
+		length = 0;
+	else if (length > POOL_BLOCK_SIZE - 1) {
+		length = POOL_BLOCK_SIZE - 1;
+		Pool.truncations++;
+	}
 
 	// Select the USART channel for sending the formatted string
 	if (usart_number == 0) {
-		USART0_sendString(buffer); // Use USART0 for sending
-	} else if (usart_number == 1) {
-		USART1_sendString(buffer); // Use USART1 for sending
-	} else {
-		// Handle invalid USART number  add error management if needed
+		USART0_SendBlock(block, length); // Use USART0 for sending, the block goes with the message
+		return;
+	}
+	if (usart_number == 1) {
+		USART1_sendString(Pool.data[block]); // Use USART1 for sending
 	}
+	Pool_Free(block);
 }
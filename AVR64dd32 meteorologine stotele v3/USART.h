@@ -0,0 +1,61 @@
+/*
+ * USART.h
+ *
+ * Created: 2025-01-09
+ * Author: Saulius
+ *
+ * @brief This header file defines the interrupt driven transmit queue of USART0. Everything written
+ *        with USART0_sendChar() is placed in a ring buffer and shifted out by the data register
+ *        empty interrupt, so the main loop only blocks when the queue is full. Whole messages built
+ *        in pool blocks (Pool.h) are queued by reference with USART0_SendBlock(); the interrupt
+ *        sends them in order with the ring bytes and frees each block after its last byte.
+ */
+
+#ifndef USART_H_
+#define USART_H_
+
+/**
+ * @brief Size of the USART0 transmit ring buffer (must be a power of two).
+ */
+#define USART0_TX_BUFFER_SIZE 64
+
+/**
+ * @brief Index mask for the USART0 transmit ring buffer.
+ */
+#define USART0_TX_BUFFER_MASK (USART0_TX_BUFFER_SIZE - 1)
+
+/**
+ * @brief Size of the USART0 block queue (a power of two, more than POOL_BLOCKS).
+ */
+#define USART0_TX_BLOCKS 8
+
+/**
+ * @brief Index mask for the USART0 block queue.
+ */
+#define USART0_TX_BLOCK_MASK (USART0_TX_BLOCKS - 1)
+
+/**
+ * @brief Transmit ring buffer and block queue.
+ *
+ * `head` and `blockHead` are written by the producer (main loop), `tail`, `blockTail` and `sent`
+ * by the data register empty interrupt. One slot is always left free to tell a full buffer from
+ * an empty one. A block goes out when the ring bytes queued before it (up to its `mark`) are sent.
+ */
+typedef struct {
+	uint8_t data[USART0_TX_BUFFER_SIZE]; ///< Queued bytes
+	volatile uint8_t head;               ///< Next free slot
+	volatile uint8_t tail;               ///< Next byte to transmit
+	uint8_t block[USART0_TX_BLOCKS];     ///< Queued pool blocks
+	uint8_t length[USART0_TX_BLOCKS];    ///< Bytes to send from each block
+	uint8_t mark[USART0_TX_BLOCKS];      ///< Ring head when each block was queued
+	volatile uint8_t blockHead;          ///< Next free block slot
+	volatile uint8_t blockTail;          ///< Block being transmitted
+	uint8_t sent;                        ///< Bytes of that block sent
+} USARTTxQueue;
+
+/**
+ * @brief External variable holding the USART0 transmit queue.
+ */
+extern USARTTxQueue USART0_TX;
+
+#endif /* USART_H_ */
@@ -0,0 +1,24 @@
+/*
+ * USARTVar.h
+ *
+ * Created: 2025-01-09
+ * Author: Saulius
+ *
+ * @brief This header file contains the initialization of the USART0 transmit queue (empty at start-up).
+ */
+
+#ifndef USARTVAR_H_
+#define USARTVAR_H_
+
+/**
+ * @brief USART0 transmit queue, empty at start-up.
+ */
+USARTTxQueue USART0_TX = {
+	.head = 0,
+	.tail = 0,
+	.blockHead = 0,
+	.blockTail = 0,
+	.sent = 0
+};
+
+#endif /* USARTVAR_H_ */
@@ -0,0 +1,153 @@
+/**
+ * @file Units.h
+ * @brief Fixed-point quantities tagged with their unit and scale.
+ *
+ * Every unit is a one-member struct (UNIT_T(HPA_100) is 0.01 hPa in an int32_t), so values of
+ * different units cannot be assigned, passed or added to each other by mistake; on the AVR the
+ * struct is passed and returned in registers like the bare integer. The unit table below gives
+ * the storage type, the quantity and the size of one LSB as a fraction of the base unit, and
+ * UNIT_CONVERT() turns the ratio of two units into a constant multiply or a rounding divide
+ * (a shift for the powers of two) when the firmware is compiled: converting 0.01 hPa to Pa is a
+ * copy, the BMP280 Q24.8 Pa to 0.01 hPa is (p + 128) >> 8. Converting between different
+ * quantities or passing a value of the wrong unit stops the build.
+ *
+ *     UNIT_T(PASCAL_Q8) p = UNIT(PASCAL_Q8, BMP280.CalibrationValues.p);
+ *     int32_t hPa100 = UNIT_RAW(UNIT_CONVERT(PASCAL_Q8, HPA_100, p));
+ *
+ * Code moves over one value at a time: UNIT() wraps an integer already in a unit, UNIT_RAW()
+ * unwraps it, UNIT_FROM_FLOAT() replaces the lround(x * 100) of the float sensor values.
+ *
+ * Host builds define UNITS_CHECKED and provide Units_Check(): every result and every intermediate
+ * product is then computed in 64 bits and checked against the range the AVR code computes it in
+ * (tools/loop_benchmark.py runs the whole firmware so, tools/units_check.py sweeps the sensor
+ * ranges and checks that mixing units does not compile).
+ *
+ * @author Saulius
+ * @date 2025-01-22
+ */
+
+#ifndef UNITS_H_
+#define UNITS_H_
+
+/**
+ * @brief Quantities; values of different quantities are never converted into each other.
+ */
+typedef enum {
+    UNIT_DIM_TEMPERATURE, /**< Base unit C */
+    UNIT_DIM_PRESSURE,    /**< Base unit Pa */
+    UNIT_DIM_HUMIDITY,    /**< Base unit % relative humidity */
+    UNIT_DIM_ANGLE,       /**< Base unit degree */
+    UNIT_DIM_LENGTH,      /**< Base unit m */
+    UNIT_DIM_SPEED        /**< Base unit m/s */
+} unit_dimension_t;
+
+/** @name Units: storage, quantity, one LSB = num / den base units */
+///@{
+#define UNIT_CELSIUS_100   int16_t,  TEMPERATURE, 1, 100   /**< 0.01 C: BMP280 and SHT21 temperature */
+#define UNIT_CELSIUS_10    int16_t,  TEMPERATURE, 1, 10    /**< 0.1 C: history */
+#define UNIT_PASCAL        int32_t,  PRESSURE,    1, 1     /**< Pa: sampling engine */
+#define UNIT_PASCAL_Q8     uint32_t, PRESSURE,    1, 256   /**< Pa / 256: BMP280 compensation output */
+#define UNIT_HPA_100       int32_t,  PRESSURE,    1, 1     /**< 0.01 hPa: dependency graph, telemetry */
+#define UNIT_HPA_10        int16_t,  PRESSURE,    10, 1    /**< 0.1 hPa: history */
+#define UNIT_RH_100        int16_t,  HUMIDITY,    1, 100   /**< 0.01 %: telemetry */
+#define UNIT_RH_10         int16_t,  HUMIDITY,    1, 10    /**< 0.1 %: dependency graph */
+#define UNIT_DEGREE_100    int32_t,  ANGLE,       1, 100   /**< 0.01 degree: FixedMath, tracker */
+#define UNIT_DEGREE_1000   int32_t,  ANGLE,       1, 1000  /**< 0.001 degree: dependency graph */
+#define UNIT_DEGREE_10000  int32_t,  ANGLE,       1, 10000 /**< 0.0001 degree: latitude and longitude */
+#define UNIT_METRE         int16_t,  LENGTH,      1, 1     /**< m: site altitude */
+#define UNIT_CENTIMETRE    int32_t,  LENGTH,      1, 100   /**< 0.01 m */
+#define UNIT_MPS_100       int16_t,  SPEED,       1, 100   /**< 0.01 m/s: wind */
+///@}
+
+/**
+ * @brief Every unit of the table, X(name).
+ */
+#define UNITS(X) \
+    X(CELSIUS_100) X(CELSIUS_10) \
+    X(PASCAL) X(PASCAL_Q8) X(HPA_100) X(HPA_10) \
+    X(RH_100) X(RH_10) \
+    X(DEGREE_100) X(DEGREE_1000) X(DEGREE_10000) \
+    X(METRE) X(CENTIMETRE) \
+    X(MPS_100)
+
+/** @name Unit table fields */
+///@{
+#define UNIT_APPLY(macro, ...) macro(__VA_ARGS__)
+#define UNIT_STORAGE_(type, dim, num, den) type
+#define UNIT_DIM_(type, dim, num, den) UNIT_DIM_##dim
+#define UNIT_NUM_(type, dim, num, den) (num##L)
+#define UNIT_DEN_(type, dim, num, den) (den##L)
+#define UNIT_STORAGE(u) UNIT_APPLY(UNIT_STORAGE_, UNIT_##u) /**< Storage type */
+#define UNIT_DIM(u) UNIT_APPLY(UNIT_DIM_, UNIT_##u)         /**< unit_dimension_t */
+#define UNIT_NUM(u) UNIT_APPLY(UNIT_NUM_, UNIT_##u)         /**< LSB numerator */
+#define UNIT_DEN(u) UNIT_APPLY(UNIT_DEN_, UNIT_##u)         /**< LSB denominator */
+///@}
+
+/**
+ * @brief Type of a value in unit u.
+ */
+#define UNIT_T(u) unit_##u##_t
+
+#define UNIT_TYPEDEF(u) typedef struct { UNIT_STORAGE(u) v; } UNIT_T(u);
+UNITS(UNIT_TYPEDEF)
+
+/** @name Range checks: 64-bit arithmetic and Units_Check() in host builds, none on the AVR */
+///@{
+#ifdef UNITS_CHECKED
+#define UNIT_WIDE int64_t
+#define UNIT_MAX_OF(type) ((type)-1 < 0 ? (int64_t)((1ULL << (sizeof(type) * 8 - 1)) - 1) \
+                                          : (int64_t)((1ULL << (sizeof(type) * 8)) - 1))
+#define UNIT_MIN_OF(type) ((type)-1 < 0 ? -UNIT_MAX_OF(type) - 1 : 0)
+#define UNIT_FIT(type, value) \
+    ((type)Units_Check((value), UNIT_MIN_OF(type), UNIT_MAX_OF(type), __FILE__, __LINE__))
+
+/**
+ * @brief Reports a value outside [min, max] (host builds only).
+ *
+ * @return value.
+ */
+int64_t Units_Check(int64_t value, int64_t min, int64_t max, const char *file, int line);
+#else
+#define UNIT_WIDE int32_t
+#define UNIT_FIT(type, value) ((type)(value))
+#endif
+///@}
+
+/** @name Construction and access */
+///@{
+#define UNIT(u, raw) ((UNIT_T(u)){ UNIT_FIT(UNIT_STORAGE(u), (raw)) }) /**< Value from an integer in unit u */
+#define UNIT_RAW(x) ((x).v)                                             /**< Integer of a value */
+#define UNIT_FROM_FLOAT(u, f) UNIT(u, lround((f) * UNIT_DEN(u) / UNIT_NUM(u))) /**< From a float in base units */
+#define UNIT_IS(u, x) _Static_assert(__builtin_types_compatible_p(__typeof__(x), UNIT_T(u)), \
+                                     "value is not in unit " #u)
+///@}
+
+/** @name Scaling by constants, the cases are resolved by the compiler */
+///@{
+#define UNIT_MUL32(x, k) UNIT_FIT(__typeof__(x), (UNIT_WIDE)(x) * (k))
+#define UNIT_ROUND_DIV(x, d) ((x) >= 0 ? ((x) + (d) / 2) / (d) : ((x) - (d) / 2) / (d))
+#define UNIT_SCALE(x, mul, div) \
+    ((mul) % (div) == 0 ? UNIT_MUL32(x, (mul) / (div)) \
+     : (div) % (mul) == 0 ? UNIT_ROUND_DIV(x, (div) / (mul)) \
+     : UNIT_ROUND_DIV(UNIT_MUL32(x, mul), div))
+///@}
+
+/**
+ * @brief Value x in unit from converted to unit to of the same quantity, rounded to nearest.
+ */
+#define UNIT_CONVERT(from, to, x) ({ \
+    UNIT_IS(from, x); \
+    _Static_assert(UNIT_DIM(from) == UNIT_DIM(to), #from " and " #to " are different quantities"); \
+    __typeof__(UNIT_RAW(x) + (int32_t)0) unit_raw_ = UNIT_RAW(x); \
+    UNIT(to, UNIT_SCALE(unit_raw_, UNIT_NUM(from) * UNIT_DEN(to), UNIT_DEN(from) * UNIT_NUM(to))); \
+})
+
+/** @name Arithmetic within one unit */
+///@{
+#define UNIT_ADD(u, a, b) ({ UNIT_IS(u, a); UNIT_IS(u, b); UNIT(u, (UNIT_WIDE)UNIT_RAW(a) + UNIT_RAW(b)); })
+#define UNIT_SUB(u, a, b) ({ UNIT_IS(u, a); UNIT_IS(u, b); UNIT(u, (UNIT_WIDE)UNIT_RAW(a) - UNIT_RAW(b)); })
+#define UNIT_MUL(u, a, k) ({ UNIT_IS(u, a); UNIT(u, (UNIT_WIDE)UNIT_RAW(a) * (k)); }) /**< By an integer */
+#define UNIT_DIV(u, a, k) ({ UNIT_IS(u, a); UNIT_WIDE unit_raw_ = UNIT_RAW(a); UNIT(u, UNIT_ROUND_DIV(unit_raw_, (k))); }) /**< By an integer, rounded */
+///@}
+
+#endif /* UNITS_H_ */
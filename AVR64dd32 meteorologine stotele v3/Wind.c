@@ -21,7 +21,8 @@
  */
 void WindSpeed(){
 	ADC0_SetupWS();
-	Wind.speed = (ADC0_read()* 0.00732421875); // same as *30m/s /4096 = 0.00732421875 //and rounding to lower side
+	Wind.raw = ADC0_read();
+	Wind.speed = (Wind.raw * 0.00732421875); // same as *30m/s /4096 = 0.00732421875 //and rounding to lower side
 }
 
 /**
@@ -19,13 +19,15 @@
 /**
  * @brief Structure for storing wind parameters.
  * 
- * This structure holds two values:
+ * This structure holds three values:
  * - `speed`: The wind speed, in m/s.
  * - `direction`: The wind direction, represented as an integer code (e.g., 0 for North, 1 for Northeast, etc.).
+ * - `raw`: The last raw 12-bit ADC reading of the wind speed sensor.
  */
 typedef struct {
 	uint8_t speed;      ///< Wind speed in m/s
 	uint8_t direction;  ///< Wind direction (0 = North, 1 = Northeast, 2 = East, etc.)
+	uint16_t raw;       ///< Raw wind speed ADC value (0-4095), used for change detection
 } WindParam;
 
 /**
@@ -11,7 +11,8 @@
 
 WindParam Wind= {
 .speed = 0,
-.direction = 0
+.direction = 0,
+.raw = 0
 };
 
 
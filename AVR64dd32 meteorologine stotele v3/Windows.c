@@ -10,6 +10,18 @@
 
 #include "Settings.h"
 
+/** @brief Static content tag of the main window (see screen_static_begin()). */
+#define STATIC_MAIN 0x00
+
+/** @brief Static content tag of the parameter view; the scroll position is added to it. */
+#define STATIC_PARAMETERS 0x10
+
+/** @brief Added to STATIC_PARAMETERS while Date_Clock.error is set: the labels differ. */
+#define STATIC_CLOCK_ERROR 0x20
+
+/** @brief Static content tag of the event log window; the scroll position is added to it. */
+#define STATIC_EVENTS 0x40
+
 /**
  * @brief Displays the current date, time, timezone, altitude, latitude, and longitude on the screen.
  * 
@@ -290,7 +302,12 @@ void ValidateNewData(uint8_t * newTimeAndPlace, uint8_t *step)
         lastAction = 0; // all good, go to main window
         //screen_write_formatted_text("Isaugota :D", 3, ALIGN_CENTER); // Lithuanian // display success message
         screen_write_formatted_text("Saved :D", 3, ALIGN_CENTER); // English
-        PORTF.OUTCLR = PIN2_bm; // Ready to set time and location
+        EventLog_Add(EVENT_SETTINGS, EVENT_SETTINGS_TIME | // the date and time are always sent, the rest is compared
+            (newTimeZone != Date_Clock.timezone ? EVENT_SETTINGS_TIMEZONE : 0) |
+            (newAltitude != Date_Clock.altitude ? EVENT_SETTINGS_ALTITUDE : 0) |
+            (fabs(newLatitude - Date_Clock.latitude) >= 0.00005 ? EVENT_SETTINGS_LATITUDE : 0) |
+            (fabs(newLongitude - Date_Clock.longitude) >= 0.00005 ? EVENT_SETTINGS_LONGITUDE : 0));
+        GPIO_LOW(CLOCK_SET); // Ready to set time and location
         _delay_ms(10); // wait some for clock device to end current action
         USART_printf(1, "<%d%d%d%d%d%d%d%d%d%d%d%d%d%d0|%d|%3.4f|%3.4f>\r\n", // sending new data to clock device
         newTimeAndPlace[0], newTimeAndPlace[1], newTimeAndPlace[2], newTimeAndPlace[3],
@@ -302,7 +319,7 @@ void ValidateNewData(uint8_t * newTimeAndPlace, uint8_t *step)
         newLongitude // longitude
         );
         Date_Clock.altitude = newAltitude; // and save to this device altitude
-        PORTF.OUTSET = PIN2_bm; // Time and location is set, continue normal clock work
+        GPIO_HIGH(CLOCK_SET); // Time and location is set, continue normal clock work
     }
     _delay_ms(1000); // show any message for 1 second
     Keypad3x4.key_held = lastAction; // going to main window if success, and stay if data is wrong
@@ -313,10 +330,11 @@ void ValidateNewData(uint8_t * newTimeAndPlace, uint8_t *step)
  * 
  * This function shows parameters such as date, time, azimuth, elevation, and location data when there are no errors.
  * @param upDown The current step to determine which parameters to display.
+ * @param redraw 1 if the static labels must be drawn (window entered, scrolled or cleared).
  */
-void parametersWOerror(uint8_t upDown) { 
+void parametersWOerror(uint8_t upDown, uint8_t redraw) { 
     if(upDown < 1){
-        screen_write_formatted_text("t:", upDown, ALIGN_LEFT);
+        if (redraw) screen_draw_label(LABEL_TIME, upDown, 0);
         screen_write_formatted_text("%4d%02d%02d%02d%02d%02d%d", upDown, ALIGN_RIGHT,
         Date_Clock.year,
         Date_Clock.month,
@@ -328,36 +346,36 @@ void parametersWOerror(uint8_t upDown) {
         );
     }
     if (upDown < 2){
-        screen_write_formatted_text("az:", 1-upDown, ALIGN_LEFT);
-        screen_write_formatted_text("%3.4f",1-upDown, ALIGN_RIGHT, SUN.azimuth);
+        if (redraw) screen_draw_label(LABEL_AZIMUTH, 1-upDown, 0);
+        screen_write_formatted_text("%9.4f", 1-upDown, ALIGN_RIGHT, SUN.azimuth);
     }
     if(upDown < 3){
-        screen_write_formatted_text("el.:", 2-upDown, ALIGN_LEFT);
-        screen_write_formatted_text("%3.4f", 2-upDown, ALIGN_RIGHT, SUN.elevation);
+        if (redraw) screen_draw_label(LABEL_ELEVATION, 2-upDown, 0);
+        screen_write_formatted_text("%9.4f", 2-upDown, ALIGN_RIGHT, SUN.elevation);
     }
     if (upDown < 4)
     {
         //screen_write_formatted_text("kor. el.:", 3-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("adj. el.:", 3-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%3.4f", 3-upDown, ALIGN_RIGHT, SUN.adjelevation);
+        if (redraw) screen_draw_label(LABEL_ADJ_ELEVATION, 3-upDown, 0); // English
+        screen_write_formatted_text("%9.4f", 3-upDown, ALIGN_RIGHT, SUN.adjelevation);
     }
     if (upDown > 4)
     {
         //screen_write_formatted_text("laik. z:", 12-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("t.z:", 12-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%d", 12-upDown, ALIGN_RIGHT, Date_Clock.timezone);
+        if (redraw) screen_draw_label(LABEL_TIMEZONE, 12-upDown, 0); // English
+        screen_write_formatted_text("%3d", 12-upDown, ALIGN_RIGHT, Date_Clock.timezone);
     }
     if (upDown > 5)
     {
         //screen_write_formatted_text("plat. :", 13-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("lat. :", 13-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%2.4f", 13-upDown, ALIGN_RIGHT, Date_Clock.latitude);
+        if (redraw) screen_draw_label(LABEL_LATITUDE, 13-upDown, 0); // English
+        screen_write_formatted_text("%8.4f", 13-upDown, ALIGN_RIGHT, Date_Clock.latitude);
     }
     if (upDown > 6)
     {
         //screen_write_formatted_text("ilg. :", 14-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("long. :", 14-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%3.4f", 14-upDown, ALIGN_RIGHT, Date_Clock.longitude);
+        if (redraw) screen_draw_label(LABEL_LONGITUDE, 14-upDown, 0); // English
+        screen_write_formatted_text("%9.4f", 14-upDown, ALIGN_RIGHT, Date_Clock.longitude);
     }
 }
 
@@ -366,69 +384,70 @@ void parametersWOerror(uint8_t upDown) {
  * 
  * This function shows parameters related to sensor readings and altitude when there are errors.
  * @param upDown The current step to determine which parameters to display.
+ * @param redraw 1 if the static labels must be drawn (window entered, scrolled or cleared).
  */
-void parametersWerror(uint8_t upDown){ 
+void parametersWerror(uint8_t upDown, uint8_t redraw){ 
     if (upDown < 5)
     {
-        screen_write_formatted_text("bmp T C:", 4-upDown, ALIGN_LEFT);
-        screen_write_formatted_text("%3.2f", 4-upDown, ALIGN_RIGHT, BMP280.Temperature);
+        if (redraw) screen_draw_label(LABEL_BMP_T, 4-upDown, 0);
+        screen_write_formatted_text("%7.2f", 4-upDown, ALIGN_RIGHT, BMP280.Temperature);
     }
     if (upDown < 6)
     {
-        screen_write_formatted_text("sht T C:", 5-upDown, ALIGN_LEFT);
-        screen_write_formatted_text("%3.2f", 5-upDown, ALIGN_RIGHT, SHT21.T);
+        if (redraw) screen_draw_label(LABEL_SHT_T, 5-upDown, 0);
+        screen_write_formatted_text("%7.2f", 5-upDown, ALIGN_RIGHT, SHT21.T);
     }
     if (upDown < 7)
     {
-        screen_write_formatted_text("p hPa:", 6-upDown, ALIGN_LEFT);
-        screen_write_formatted_text("%3.4f", 6-upDown, ALIGN_RIGHT, BMP280.Pressure);
+        if (redraw) screen_draw_label(LABEL_P, 6-upDown, 0);
+        screen_write_formatted_text("%9.4f", 6-upDown, ALIGN_RIGHT, BMP280.Pressure);
     }
     if (upDown < 8)
     {
-        screen_write_formatted_text("rh %%:", 7-upDown, ALIGN_LEFT);
-        screen_write_formatted_text("%3.2f", 7-upDown, ALIGN_RIGHT, SHT21.RH);
+        if (redraw) screen_draw_label(LABEL_RH, 7-upDown, 0);
+        screen_write_formatted_text("%6.2f", 7-upDown, ALIGN_RIGHT, SHT21.RH);
     }
     if (upDown > 0 && upDown <= 8)
     {
         //screen_write_formatted_text("nk.aukt. m:", 8-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("not adj.alt. m:", 8-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%4.1f", 8-upDown, ALIGN_RIGHT, Altitude.UNCOMP);
+        if (redraw) screen_draw_label(LABEL_UNCOMP_ALT, 8-upDown, 0); // English
+        screen_write_formatted_text("%6.1f", 8-upDown, ALIGN_RIGHT, Altitude.UNCOMP);
     }
     if (upDown > 1 && upDown <= 9)
     {
         //screen_write_formatted_text("k.aukt. m:", 9-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("adj.alt. m:", 9-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%4.1f", 9-upDown, ALIGN_RIGHT, Altitude.COMP);
+        if (redraw) screen_draw_label(LABEL_COMP_ALT, 9-upDown, 0); // English
+        screen_write_formatted_text("%6.1f", 9-upDown, ALIGN_RIGHT, Altitude.COMP);
     }
     if (upDown > 2 && upDown <= 10)
     {
         //screen_write_formatted_text("vid.aukt. m:", 10-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("avg.alt. m:", 10-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%4.1f", 10-upDown, ALIGN_RIGHT, Altitude.AVRG);
+        if (redraw) screen_draw_label(LABEL_AVRG_ALT, 10-upDown, 0); // English
+        screen_write_formatted_text("%6.1f", 10-upDown, ALIGN_RIGHT, Altitude.AVRG);
     }
     if (upDown > 3 && upDown <= 11)
     {
         //screen_write_formatted_text("real.aukt. m:", 11-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("rl.alt. m:", 11-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%d", 11-upDown, ALIGN_RIGHT, Date_Clock.altitude);
+        if (redraw) screen_draw_label(LABEL_REAL_ALT, 11-upDown, 0); // English
+        screen_write_formatted_text("%5d", 11-upDown, ALIGN_RIGHT, Date_Clock.altitude);
     }
     if (upDown > 7 && upDown <= 12)
     {
         //screen_write_formatted_text("v.g. m/s:", 15-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("w.s. m/s:", 15-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%d", 15-upDown, ALIGN_RIGHT, Wind.speed);
+        if (redraw) screen_draw_label(LABEL_WIND_SPEED, 15-upDown, 0); // English
+        screen_write_formatted_text("%3d", 15-upDown, ALIGN_RIGHT, Wind.speed);
     }
     if (upDown > 8 && upDown <= 13)
     {
         //screen_write_formatted_text("v.k.nr:", 16-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("w.d.no:", 16-upDown, ALIGN_LEFT); // English
+        if (redraw) screen_draw_label(LABEL_WIND_DIR, 16-upDown, 0); // English
         screen_write_formatted_text("%d", 16-upDown, ALIGN_RIGHT, Wind.direction);
     }
     if (upDown > 9 && upDown <= 14)
     {
         //screen_write_formatted_text("a.l. mV:", 17-upDown, ALIGN_LEFT); // Lithuanian
-        screen_write_formatted_text("l.l. mV:", 17-upDown, ALIGN_LEFT); // English
-        screen_write_formatted_text("%d", 17-upDown, ALIGN_RIGHT, SUN.sunlevel);
+        if (redraw) screen_draw_label(LABEL_LIGHT_LEVEL, 17-upDown, 0); // English
+        screen_write_formatted_text("%4d", 17-upDown, ALIGN_RIGHT, SUN.sunlevel);
     }
 }
 
@@ -469,7 +488,7 @@ void DateAndLocationChangeWindow()
 				   step = 0;          // Step of changed data
 	static char arrow[38];            // For selection visualization of changed data
 	displayDateTimeAndLocation(newTimeAndPlace, arrow, &step);
-	if (Date_Clock.error == 1) 
+	if (Date_Clock.error == 1 || Gnss.source != GNSS_SOURCE_CLOCK) // New settings go to the clock device only
 		ClockError(3);
 	else { // If clock is working correctly
 		if ((Keypad3x4.key != 10) && (Keypad3x4.key != 12)) { //if 0-9 are pressed
@@ -513,6 +532,11 @@ void ParameterViewWindow()
 				upDown += (Keypad3x4.key == 8) ? 1 : -1;
 				screen_clear();
 			}
+			uint8_t tag = STATIC_PARAMETERS + upDown + (Date_Clock.error ? STATIC_CLOCK_ERROR : 0);
+			if (Screen.staticTag != tag && Screen.staticTag != SCREEN_STATIC_NONE)
+				screen_clear(); // Clock error set or cleared: the labels of the other state must go
+			uint8_t redraw = screen_static_begin(tag); // labels move with every scroll step
+			Derived_Refresh(DERIVED_ALTITUDES | DERIVED_BIT(DERIVED_ADJ_ANGLES)); // Recomputed only if their inputs changed
 			if (Date_Clock.error == 1) {
 				int8_t place = 0;
 				if(upDown >= 5 && upDown < 8)
@@ -523,8 +547,8 @@ void ParameterViewWindow()
 				ClockError(place);	//also scrolling error message if present
 			} 
 			else 
-				parametersWOerror(upDown); //showing those parameters only if the clock device is working normally without errors
-		parametersWerror(upDown); //showing these parameters all the time if error is present
+				parametersWOerror(upDown, redraw); //showing those parameters only if the clock device is working normally without errors
+		parametersWerror(upDown, redraw); //showing these parameters all the time if error is present
 		backButton(); // Going back to the main window
 }
 
@@ -532,32 +556,38 @@ void ParameterViewWindow()
  * @brief Displays the main window with important parameters
  * 
  * This function displays the most important parameters like temperature, pressure, humidity, wind speed, etc.
+ * The labels come from the pre-rendered LAYOUT_MAIN and are only drawn on window entry; the values use
+ * fixed field widths so they fully overwrite the previous value.
  * 
  */
 void MainWindow()
 {
+	if (screen_static_begin(STATIC_MAIN)) // Labels and separator are blitted from flash only on window entry
+		screen_draw_layout(LAYOUT_MAIN);
+	Derived_Refresh(DERIVED_BIT(DERIVED_ADJ_ANGLES)); // Recomputed only if the solar angles, p, T or altitude changed
+
 	//screen_write_formatted_text("Temperatra:", 0, ALIGN_LEFT);//Lithuanian
-	screen_write_formatted_text("Temperature:", 0, ALIGN_LEFT); //English
-	screen_write_formatted_text("%2.02fC", 0, ALIGN_RIGHT, SHT21.T);
+	// "Temperature:" //English
+	screen_write_formatted_text("%6.2fC", 0, ALIGN_RIGHT, SHT21.T);
 
 	//screen_write_formatted_text("Slgis:", 1, ALIGN_LEFT);//Lithuanian
-	screen_write_formatted_text("Pressure:", 1, ALIGN_LEFT);//English
-	screen_write_formatted_text("%4.02fhPa", 1, ALIGN_RIGHT, BMP280.Pressure);
+	// "Pressure:" //English
+	screen_write_formatted_text("%7.2fhPa", 1, ALIGN_RIGHT, BMP280.Pressure);
 
 	//screen_write_formatted_text("Drgm:", 2, ALIGN_LEFT);//Lithuanian
-	screen_write_formatted_text("Humidity:", 2, ALIGN_LEFT);//English
-	screen_write_formatted_text("%3.02f%%", 2, ALIGN_RIGHT, SHT21.RH);
+	// "Humidity:" //English
+	screen_write_formatted_text("%6.2f%%", 2, ALIGN_RIGHT, SHT21.RH);
 
 	//screen_write_formatted_text("Vjas:    ", 3, ALIGN_LEFT);//Lithuanian
-	screen_write_formatted_text("Wind:    ", 3, ALIGN_LEFT);//English
+	// "Wind:" //English
 	screen_write_formatted_text("%s", 3, ALIGN_CENTER, WindDirNames());
 	screen_write_formatted_text("%2dm/s", 3, ALIGN_RIGHT, Wind.speed);
 
 	//screen_write_formatted_text("Ap.lygis:", 4, ALIGN_LEFT);//Lithuanian
-	screen_write_formatted_text("Light level:", 4, ALIGN_LEFT);//English
+	// "Light level:" //English
 	screen_write_formatted_text("%4dmV", 4, ALIGN_RIGHT, SUN.sunlevel);
 
-	screen_write_formatted_text("---------------------", 5, ALIGN_LEFT);
+	// "---------------------" separator on line 5
 
 	if(Date_Clock.error == 1)
 		ClockError(6);
@@ -569,6 +599,89 @@ void MainWindow()
 	}
 }
 
+/**
+ * @brief Displays the adaptive sampling diagnostics
+ *
+ * One line per channel: effective rate over the last minute (samples per minute), current
+ * interval in milliseconds and current oversampling level (0 = cheapest).
+ */
+void SamplingWindow()
+{
+	static const char *names[SAMPLING_CHANNELS] = { "w.s.", "w.d.", "l.l.", "p", "sht" };
+
+	screen_write_formatted_text("ch    /min     ms os", 0, ALIGN_LEFT);
+	for (uint8_t i = 0; i < SAMPLING_CHANNELS; i++) {
+		screen_write_formatted_text("%-5s%5u%7u%3u", i + 1, ALIGN_LEFT,
+			names[i], Sampling.ch[i].rate, Sampling.ch[i].interval, Sampling.ch[i].oversampling);
+	}
+	// Longest display flush and longest sensor probe delay, in us
+	uint16_t late = BMP280.Poll.lateMax > SHT21.Poll.lateMax ? BMP280.Poll.lateMax : SHT21.Poll.lateMax;
+	screen_write_formatted_text("bus%5u late%5u us", 6, ALIGN_LEFT, Screen.busMax, late);
+	backButton(); // Going back to the main window
+}
+
+/**
+ * @brief Displays the high-rate microbarometer mode
+ *
+ * '#' starts and stops the mode. Shows the last fluctuation and the largest one of the last
+ * frame in Pa, the frames queued and dropped, failed reads and skipped sample slots.
+ */
+void MicrobaroWindow()
+{
+	static const char *modes[] = { "off", "starting", "running" };
+	static uint8_t lastKey = 0;
+
+	if (Keypad3x4.key == 12 && lastKey != 12) { // Once per press, the key repeats while held
+		if (Microbaro.mode == MICROBARO_OFF)
+			Microbaro_Start();
+		else
+			Microbaro_Stop();
+	}
+	lastKey = Keypad3x4.key;
+
+	screen_write_formatted_text("Microbarometer %2uHz", 0, ALIGN_LEFT, 1000 / MICROBARO_PERIOD_MS);
+	screen_write_formatted_text("%-8s   # on/off", 1, ALIGN_LEFT, modes[Microbaro.mode]);
+	screen_write_formatted_text("dp%8.2f Pa", 2, ALIGN_LEFT, Microbaro.fluctuation / 100.0);
+	screen_write_formatted_text("pk%8.2f Pa", 3, ALIGN_LEFT, Microbaro.peak / 100.0);
+	screen_write_formatted_text("frames%7u", 4, ALIGN_LEFT, Microbaro.frames);
+	screen_write_formatted_text("dropped%6u", 5, ALIGN_LEFT, Microbaro.dropped);
+	screen_write_formatted_text("err%5u gaps%5u", 6, ALIGN_LEFT, Microbaro.errors, Microbaro.gaps);
+	backButton(); // Going back to the main window, the mode keeps running
+}
+
+/**
+ * @brief Displays the EEPROM event log
+ *
+ * Line 0 shows the records in the ring and the events not logged (queue full or repeated).
+ * The other lines show the records newest first, 8 and 2 scroll to older and newer ones. The
+ * records are only read from the EEPROM when the window is entered or scrolled, or when a
+ * record has been written.
+ */
+void EventLogWindow()
+{
+	static uint8_t scroll = 0;
+	static uint16_t shown = 0;
+	char text[24];
+
+	if ((Keypad3x4.key == 8 && scroll + 7 < EventLog.count) || (Keypad3x4.key == 2 && scroll > 0)) {
+		while (scan_keypad() != 0); // Wait until the key is released
+		scroll += (Keypad3x4.key == 8) ? 1 : -1;
+		screen_clear();
+	}
+	screen_write_formatted_text("Events %2u  skip%5u", 0, ALIGN_LEFT, EventLog.count, EventLog.dropped + EventLog.repeats);
+	if (screen_static_begin(STATIC_EVENTS + scroll) || shown != EventLog.written) {
+		shown = EventLog.written;
+		for (uint8_t i = 0; i < 7 && scroll + i < EventLog.count; i++) {
+			EventRecord record;
+			if (EventLog_Read(EventLog.count - 1 - scroll - i, &record)) {
+				EventLog_Text(text, &record, 0);
+				screen_write_formatted_text("%s", i + 1, ALIGN_LEFT, text);
+			}
+		}
+	}
+	backButton(); // Going back to the main window
+}
+
 /**
  * @brief Main function to handle window switching based on keypress
  * 
@@ -579,6 +692,12 @@ void windows() {
 		DateAndLocationChangeWindow();
 	else if(Keypad3x4.key_held == 22) //long press 2 menu- all parameters view window
 		ParameterViewWindow();		
+	else if(Keypad3x4.key_held == 23) //long press 3 menu- adaptive sampling diagnostics window
+		SamplingWindow();
+	else if(Keypad3x4.key_held == 24) //long press 4 menu- high-rate microbarometer window
+		MicrobaroWindow();
+	else if(Keypad3x4.key_held == 25) //long press 5 menu- EEPROM event log window
+		EventLogWindow();
 	else //if long press any other button in any window, go to mainWindow
 		MainWindow(); // All roads lead to MainWindow, not to Rome :D //Main window shows most important data: pressure, temperature, humidity, adjusted altitude and elevation, wind speed and direction, light level
 };
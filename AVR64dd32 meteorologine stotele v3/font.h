@@ -29,8 +29,9 @@
  * Each character is represented by an array of 5 bytes. 
  * Each byte corresponds to a row of pixels for a given character.
  * The ASCII characters start from 32 (space) and extend to special characters.
+ * The table is in flash (PROGMEM): read it with pgm_read_byte().
  */
-uint8_t font[161][5] = {
+const uint8_t font[161][5] PROGMEM = {
 	// Pirmasis simbolis ' ' (tarpas)
 	//............................
 	{0x00, 0x00, 0x00, 0x00, 0x00}, // 32
@@ -33,6 +33,17 @@ void I2C_init(void) {
     TWI0.MSTATUS = TWI_BUSSTATE_IDLE_gc;
 }
 
+/**
+ * @brief Stores the error code of a transfer; bus errors and timeouts go to the event log.
+ *
+ * A NACK is a missing or busy device, not a bus failure, and is left to the sensor health scores.
+ */
+static void I2C_Error(uint8_t error) {
+    I2C.error = error;
+    if (error == Error_Bus || error == Error_Timout)
+        EventLog_Add(EVENT_I2C, ((uint16_t)I2C.address << 8) | error);
+}
+
 /**
  * @brief Transmits the I2C address with read/write flag.
  * 
@@ -47,6 +58,7 @@ uint8_t TransmitAdd(uint8_t addr, uint8_t read) {
     uint8_t error = 0;
 
     // Set the address and read/write flag
+    I2C.address = addr;
     TWI0.MADDR = (addr << 1) | read;
     uint32_t timeout_counter = TIMEOUT_COUNTER;
 
@@ -65,7 +77,7 @@ uint8_t TransmitAdd(uint8_t addr, uint8_t read) {
 
     if (error != 0) TWI0.MCTRLB = TWI_MCMD_STOP_gc; // Send STOP signal on error
 
-    I2C.error = error;
+    I2C_Error(error);
     return error;
 }
 
@@ -104,7 +116,7 @@ uint8_t TransmitByte(uint8_t data) {
         }
     }
 
-    I2C.error = error;
+    I2C_Error(error);
     return error;
 }
 
@@ -123,7 +135,7 @@ void ReadByteInf(uint8_t ack, uint8_t* data) {
     // Wait for the read interrupt flag or clock hold flag
     while (!(TWI0.MSTATUS & (TWI_CLKHOLD_bm | TWI_RIF_bm))) {
         if (--timeout_counter == 0) { // Timeout condition
-            I2C.error = Error_Timout;
+            I2C_Error(Error_Timout);
             break;
         }
     }
@@ -238,6 +250,95 @@ void WriteMulti(uint8_t addr, uint8_t reg, uint64_t data, uint8_t bytes) {
     TWI0.MCTRLB |= TWI_MCMD_STOP_gc; // Send STOP signal
 }
 
+/**
+ * @brief Selects the downstream channels of the TCA9548A multiplexer.
+ * 
+ * @param mask Channel bit mask (bit n = channel n, 0 disconnects all channels).
+ * 
+ * Several channels may be selected at once: a write is then received by every device with the
+ * addressed I2C address on those channels, which starts their conversions at the same time.
+ * Devices on the main bus are not affected by the multiplexer.
+ */
+void I2C_MuxSelect(uint8_t mask) {
+    if (!TransmitAdd(TCA9548A_ADD, WRITE)) // Transmit multiplexer address
+        TransmitByte(mask); // Control register: enabled channels
+
+    TWI0.MCTRLB |= TWI_MCMD_STOP_gc; // Send STOP signal
+}
+
+/**
+ * @brief Starts waiting for a conversion, call right after the trigger.
+ * 
+ * @param p Poll of the device.
+ * @param limit Worst case conversion time of the current settings (us).
+ * 
+ * The first probe is one interval before the learned typical time, so a conversion that got
+ * faster is noticed and the typical time can follow it down as well as up.
+ */
+void I2C_PollStart(I2C_Poll *p, uint32_t limit) {
+    uint32_t typical = (limit * p->ratio) >> 8;
+
+    p->start = Timer_us();
+    p->limit = limit;
+    p->next = p->start + (typical > p->interval ? typical - p->interval : 0);
+    p->probes = 0;
+}
+
+/**
+ * @brief Probes a running conversion when its next probe is due.
+ * 
+ * @param p Poll started with I2C_PollStart().
+ * @return I2C_POLL_WAIT, I2C_POLL_READY or I2C_POLL_TIMEOUT.
+ * 
+ * Returns at once without bus traffic before the next probe time. A probe is the read header
+ * (I2C_POLL_ACK, a NACK means busy) or one status register read (any busy bit set means busy);
+ * a bus error counts as busy until the limit. The conversion time is taken at the due time of
+ * the probe that found the data ready, not at the pass that ran it: the data became ready after
+ * the previous busy probe and at most one interval before that due time, while a late pass would
+ * add its latency and ratchet the typical time up to the limit. It moves the typical time by a
+ * quarter of the difference.
+ */
+uint8_t I2C_PollReady(I2C_Poll *p) {
+    uint32_t now = Timer_us();
+    int32_t late = (int32_t)(now - p->next);
+
+    if (late < 0)
+        return I2C_POLL_WAIT;
+    if (late > p->lateMax)
+        p->lateMax = (late > UINT16_MAX) ? UINT16_MAX : late;
+
+    uint8_t busy;
+    p->probes++;
+    if (p->reg == I2C_POLL_ACK)
+        busy = TransmitAdd(p->address, READ) != 0; // Stops the bus on a NACK
+    else
+        busy = (ReadReg(p->address, p->reg) & p->busy) || I2C.error;
+
+    uint32_t elapsed = now - p->start;
+    if (!busy) {
+        uint32_t ready = p->next - p->start; // Probe due time, without the pass latency
+
+        p->last = ready;
+        if (ready > p->longest)
+            p->longest = ready;
+        if (p->ratio) {
+            uint32_t r = (ready << 8) / p->limit;
+            p->ratio += ((int16_t)(r > 255 ? 255 : r) - p->ratio) / 4;
+            if (p->ratio == 0)
+                p->ratio = 1;
+        }
+        return I2C_POLL_READY;
+    }
+    if (elapsed >= p->limit) {
+        p->timeouts++;
+        return I2C_POLL_TIMEOUT;
+    }
+    p->next = now + p->interval;
+    if ((int32_t)(p->next - (p->start + p->limit)) > 0)
+        p->next = p->start + p->limit; // Last probe at the limit
+    return I2C_POLL_WAIT;
+}
+
 /**
  * @brief Quickly writes a block of data to the I2C bus.
  * 
@@ -82,6 +82,61 @@
  */
 #define Error_Bus 2 ///< Bus error code
 
+/**
+ * @brief TCA9548A I2C Multiplexer Address
+ * 
+ * Address of the optional 8-channel multiplexer (A0-A2 connected to GND) used for redundant
+ * sensors that share one I2C address.
+ */
+#define TCA9548A_ADD 0x70 ///< TCA9548A address
+
+/**
+ * @brief Ready Poll Probe by Address
+ * 
+ * I2C_Poll register value of devices that do not acknowledge their read header while converting
+ * (SHT21 no hold master): the probe is the read header itself.
+ */
+#define I2C_POLL_ACK 0xFF ///< Probe the address instead of a status register
+
+/** @name I2C_PollReady() results */
+///@{
+#define I2C_POLL_WAIT    0 ///< Still converting, or the next probe is not due yet
+#define I2C_POLL_READY   1 ///< Data ready; after an I2C_POLL_ACK probe the read header is acknowledged and the data bytes follow
+#define I2C_POLL_TIMEOUT 2 ///< Still converting (or not answering) at the conversion limit
+///@}
+
+/**
+ * @brief Conversion Ready Poll
+ * 
+ * Waits for a conversion without a fixed delay: I2C_PollStart() at the trigger schedules the
+ * first probe a little before the typical conversion time, I2C_PollReady() probes every interval
+ * from then on and reports the data ready as soon as the device says so. The typical time is
+ * learned as a fraction of the worst case of the current settings, so it follows resolution and
+ * oversampling changes; the worst case remains the limit.
+ */
+typedef struct {
+    uint8_t address;    ///< Device address
+    uint8_t reg;        ///< Status register, or I2C_POLL_ACK
+    uint8_t busy;       ///< Status register bits set while converting
+    uint8_t ratio;      ///< Typical conversion time, 1/256 of the limit; 0 = probe from the start, do not learn
+    uint16_t interval;  ///< Time between probes (us)
+    uint8_t probes;     ///< Probes of the current conversion
+    uint16_t lateMax;   ///< Longest delay of a probe past its time (us)
+    uint16_t timeouts;  ///< Conversions that reached the limit
+    uint32_t limit;     ///< Worst case conversion time of the current conversion (us)
+    uint32_t start;     ///< Trigger time (Timer_us())
+    uint32_t next;      ///< Next probe (Timer_us())
+    uint32_t last;      ///< Time of the last completed conversion, to the due time of the probe that saw it ready (us)
+    uint32_t longest;   ///< Longest completed conversion time, as last (us)
+} I2C_Poll;
+
+/**
+ * @brief Poll Probe Due
+ * 
+ * True when the next probe of poll p is due now or within ahead microseconds, without bus traffic.
+ */
+#define I2C_POLL_DUE(p, ahead) ((int32_t)(Timer_us() + (ahead) - (p)->next) >= 0)
+
 /**
  * @brief I2C Status Structure
  * 
@@ -89,6 +144,7 @@
  */
 typedef struct {
     volatile uint8_t error; ///< Error code for I2C operations
+    uint8_t address;        ///< Device addressed by the last TransmitAdd()
 } I2C_Status;
 
 /**
@@ -22,6 +22,7 @@ int main(void)
 {
     // Initialize system clock, GPIO, I2C, ADC, USART, and screen
     CLOCK_XOSCHF_crystal_init();
+    EventLog_init(); // Reset cause into the EEPROM event log, before anything else can log
     GPIO_init();
     I2C_init();
     ADC0_init();
@@ -34,51 +35,74 @@ int main(void)
     SHT21.Heater = OFF; // Disable heater (adds ~0.5-1.5C)
     SHT21.OTP_DISABLE = ON; // Keep changed settings
     SHT21.Battery = OFF; // Disable battery detection
-    SHT21_Settings_Write(); // Apply the settings
 
     // Configure BMP280 sensor settings
     BMP280.Config.osrs_p = BMP280_Pressure_UHR; // Set oversampling for pressure
-    BMP280.Config.osrs_t = BMP280_Temperature_Os_x16; // Set oversampling for temperature
-    BMP280.Config.Mode = BMP280_Mode_Normal; // Set normal mode
+    BMP280.Config.osrs_t = NOISE_PROFILE_BMP280_OSRS_T; // Set oversampling for temperature (NoiseProfile.h)
+    BMP280.Config.Mode = BMP280_Mode_Sleep; // Conversions are started in forced mode by Redundant_Task()
     BMP280.Config.t_sb = BMP280_StanBy_0m5; // Set standby time
-    BMP280.Config.filter = BMP280_Filter_16; // Set filter
+    BMP280.Config.filter = NOISE_PROFILE_BMP280_FILTER; // Set filter (NoiseProfile.h)
     BMP280.Config.spi3w_en = BMP280_SPI_Mode_3w; // Set SPI mode
-    WriteBMP280Config(); // Write configuration to BMP280
-    ReadBMP280Calibration(); // Read BMP280 calibration values
+    Redundant_init(); // Apply the settings to every sensor instance and read BMP280 calibration values
+    Sampling_init(); // Apply the oversampling limits from NoiseProfile.h
 
     screen_clear(); // Clear the screen
 
+    TCB0_init(); // Start the 1 ms system tick used by the adaptive sampling engine
+    SDI12_init(); // SDI-12 sensor interface, answered from interrupts
+    Link_init(); // Console, Modbus, binary commands and bootloader handshake on USART0
+    sei(); // Enable global interrupts
+
     while (1) 
     {
-        // Read and process sensor data
-        ReadBMP280TP(); // Read temperature and pressure from BMP280
-        CalcTrueTemp(); // Calculate true temperature from BMP280
-        // BMP280.CalibrationValues.t_fine = SHT21.T * 5120.0; // Uncomment if you want to use SHT21 temperature instead of BMP280 for pressure calculations
-        CalcTruePres(); // Calculate true pressure
+        // High-rate microbarometer mode: while it runs, a pass is only started when the next
+        // fast pressure sample is far enough away, so the other tasks continue at a reduced rate
+        Microbaro_Task();
+        if (Microbaro_Busy())
+            continue;
 
-        // Read humidity and temperature from SHT21
-        Separator(SHT21_Read(HOLD_MASTER_RH_MES)); // Read humidity from SHT21
-        Separator(SHT21_Read(HOLD_MASTER_T_MES)); // Read temperature from SHT21
+        // Read and process sensor data. Every channel is acquired only when the adaptive
+        // sampling engine decides it is due, based on how fast that channel has been changing.
+        // BMP280 and SHT21 sets: conversions run in parallel on every instance, the results are
+        // read in later passes and fused by median voting
+        Redundant_Task();
 
-        // Retransmit data from the clock device via USART1
+        // Retransmit data from the clock device via USART1; also marks the derived values whose
+        // inputs (sensors, solar angles) changed (Derived_Update())
         Retransmitt();
 
         // Read and process additional environmental parameters
-        WindSpeed(); // Calculate wind speed
-        WindDirection(); // Calculate wind direction
-        SunLevel(); // Calculate sun level
-        AltitudeAverage(); // Calculate altitude based on pressure
+        if (Sampling_Begin(SAMPLING_WIND_SPEED)) {
+            WindSpeed(); // Calculate wind speed
+            Sampling_End(SAMPLING_WIND_SPEED, Wind.raw);
+        }
+        if (Sampling_Begin(SAMPLING_WIND_DIR)) {
+            WindDirection(); // Calculate wind direction
+            Sampling_End(SAMPLING_WIND_DIR, Wind.direction);
+        }
+        if (Sampling_Begin(SAMPLING_SUN)) {
+            SunLevel(); // Calculate sun level
+            PlaneOfArray_Update(); // Angle of incidence and plane-of-array irradiance
+            Sampling_End(SAMPLING_SUN, SUN.sunlevel);
+        }
+        Turbulence_Task(); // Evenly spaced wind speed samples, spectrum and turbulence in background slices
+        History_Task(); // Minute values of every channel into the compressed 24 h history
+        ClearSky_Task(); // Clear-sky model, clear-sky index and sky variability
+        SDI12_Task(); // Fresh values for the next SDI-12 measurement command
+        Link_Task(); // Answer the console line, Modbus or binary frame received on USART0
+        EventLog_Task(); // Clock link and source changes; one byte of a queued record into the EEPROM
 
         // Handle keypad input
         keypad();
 
         // Display data on screen based on selected window
         windows();
+        screen_flush(); // Changed parts of the frame go to the glass in short slices, sensors first
 
         // Send data over USART (e.g., sun azimuth, wind speed, etc.)
-        USART_printf(0, "{%.2f|%.2f|%d|%d|%d}\r\n", 
-                     SUN.adjazimuth, SUN.adjelevation, 
-                     Wind.speed, Wind.direction, 
-                     SUN.sunlevel); // Send formatted data
+        Telemetry_SendStation(TELEMETRY_FORMAT); // Streamed into the USART0 transmit queue
+#if DEBUG_LOG_ENABLE
+        DebugLog_Drain(); // Queue buffered debug records while the transmit queue has room
+#endif
     }
 }
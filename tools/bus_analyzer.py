@@ -0,0 +1,508 @@
+#!/usr/bin/env python3
+"""
+bus_analyzer.py - decodes I2C and UART traffic and attributes the bus time to firmware functions.
+
+Reads either a logic analyzer export or the bus log of the host simulation:
+
+  - capture: CSV with the time in seconds in the first column and one column per channel, one
+    row per change (Saleae Logic 2 "digital.csv", sigrok-cli -O csv). TWI0 is decoded from the
+    SDA/SCL channels, USART0 (telemetry) and USART1 (clock device) as 8N1 at --baud0/--baud1,
+  - simulation: the log written by `tools/loop_benchmark.py --bus-log`, which also carries the
+    firmware call chain behind every byte.
+
+I2C bytes are grouped into transactions (start ... stop, repeated starts included) and labelled
+with the register and command meaning of the station's parts (BMP280, SHT21, TCA9548A,
+ST7567S); UART bytes are grouped into records (clock frames, CSV/JSON/tracker/rotation
+telemetry, microbarometer frames, debug records). The report gives the utilisation of every
+bus with a timeline, the bus time per device operation and per firmware function (inferred
+from the operation for captures), and findings: transactions dominated by addressing overhead,
+sensor polling, repeated identical writes, bus holds and gaps inside UART records.
+
+  python3 tools/bus_analyzer.py --sim bus.log
+  python3 tools/bus_analyzer.py digital.csv --sda 0 --scl 1 --uart0 2 --uart1 3
+  python3 tools/bus_analyzer.py digital.csv --sda SDA --scl SCL --bin 50 --transactions 40
+"""
+
+import argparse
+import bisect
+import collections
+import csv
+import os
+import re
+import sys
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+DRIVERS = ('i2c.c', 'USART.c')  # Their functions only move bytes: time goes to their callers
+LEVELS = ' .:-=+*#%@'
+
+MICROBARO_SYNC = 0xA7  # Microbaro.h
+DEBUG_LOG_SYNC = 0xA6  # DebugLog.h
+DEVICES = {0x76: 'BMP280', 0x77: 'BMP280', 0x40: 'SHT21', 0x70: 'TCA9548A', 0x3F: 'ST7567S'}
+BMP280_REGISTERS = [(0x88, 'calibration'), (0xD0, 'id'), (0xE0, 'reset'), (0xF3, 'status'), (0xF4, 'ctrl_meas'),
+                    (0xF5, 'config'), (0xF7, 'pressure/temperature'), (0xFA, 'temperature')]
+SHT21_COMMANDS = {0xE3: 'measure T (hold)', 0xE5: 'measure RH (hold)', 0xF3: 'trigger T', 0xF5: 'trigger RH',
+                  0xE6: 'write user register', 0xE7: 'read user register', 0xFE: 'soft reset'}
+
+# Firmware functions behind each operation when no call chains are available (captures)
+INFERRED = [('BMP280', 'Redundant_Task'), ('SHT21', 'Redundant_Task'), ('TCA9548A', 'Redundant_Task'),
+            ('ST7567S burst', 'screen_flush'), ('ST7567S', 'screen_command')]
+
+
+class Transaction:
+    def __init__(self, start):
+        self.start = self.end = start
+        self.segments = []   # [address byte, ACK, [data bytes]]
+        self.active = 0.0    # Time spent clocking bytes
+        self.origin = '-'
+
+    @property
+    def address(self):
+        return self.segments[0][0] >> 1 if self.segments else None
+
+
+def driver_functions():
+    names = set()
+    for name in DRIVERS:
+        path = os.path.join(PROJECT, name)
+        if os.path.exists(path):
+            text = open(path, encoding='latin-1').read()
+            names.update(re.findall(r'^[A-Za-z_][\w \*]*?\b(\w+)\s*\([^;]*\)\s*\{', text, re.M))
+    return names
+
+
+def function(origin, drivers):
+    """Innermost firmware function of a call chain `inner<outer<...` that is not a bus driver."""
+    for name in origin.split('<'):
+        if name not in drivers and name not in ('Timer_us', 'Timer_ms', '-'):
+            return name
+    return origin.split('<')[-1]
+
+
+# ------------------------------------------------------------------------------------------------
+# Input
+
+def read_simulation(path):
+    """Events of a simulation bus log: ('i2c', start, end, kind, value, ack, origin), ('uartN', start, end, kind, value, origin)."""
+    clock, events = 24e6, []
+    for line in open(path):
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == '#':
+            if words[1] == 'clock':
+                clock = float(words[2])
+            continue
+        start, end = int(words[1]) / clock, int(words[2]) / clock
+        if words[0] == 'i2c':
+            events.append(('i2c', start, end, words[3], int(words[4], 16), words[5], words[6]))
+        else:
+            events.append((words[0], start, end, words[3], int(words[4], 16), words[5]))
+    return events
+
+
+def read_capture(path):
+    """(channel names, [(time, [levels])]) of a logic analyzer CSV export."""
+    rows, names = [], None
+    with open(path, newline='') as source:
+        for row in csv.reader(source):
+            if not row or row[0].startswith((';', '#')):
+                continue
+            try:
+                rows.append((float(row[0]), [int(float(v)) for v in row[1:]]))
+            except ValueError:
+                names = [n.strip() for n in row[1:]]
+    return names or ['%d' % i for i in range(len(rows[0][1]) if rows else 0)], rows
+
+
+def channel(names, spec):
+    if spec is None:
+        return None
+    for i, name in enumerate(names):
+        if name.lower() == spec.lower() or re.sub(r'\D', '', name) == spec:
+            return i
+    if spec.isdigit() and int(spec) < len(names):
+        return int(spec)
+    sys.exit('no channel %s in %s' % (spec, ', '.join(names)))
+
+
+def decode_i2c(rows, sda, scl):
+    events, bits, first, reading, byte_start = [], [], False, False, None
+    previous = None
+    for t, levels in rows:
+        d, c = levels[sda], levels[scl]
+        if previous is not None:
+            pd, pc = previous
+            if c and pc and pd != d:
+                if not d:  # START or repeated START
+                    bits, first, byte_start = [], True, t
+                else:      # STOP
+                    events.append(('i2c', t, t, 'P', 0, '-', '-'))
+                    bits = []
+            elif c and not pc and byte_start is not None:
+                bits.append(d)
+                if len(bits) == 9:
+                    value = sum(b << (7 - i) for i, b in enumerate(bits[:8]))
+                    kind = 'A' if first else ('R' if reading else 'W')
+                    if first:
+                        reading = bool(value & 1)
+                    events.append(('i2c', byte_start, t, kind, value, 'N' if bits[8] else 'A', '-'))
+                    first, bits, byte_start = False, [], t
+        previous = (d, c)
+    return events
+
+
+def decode_uart(rows, line, baud, name, kind):
+    times = [t for t, _ in rows]
+    levels = [v[line] for _, v in rows]
+    bit = 1.0 / baud
+
+    def level(t):
+        return levels[max(bisect.bisect_right(times, t) - 1, 0)]
+
+    events, i = [], 1
+    while i < len(rows):
+        if levels[i - 1] and not levels[i]:  # Start bit
+            start = times[i]
+            value = sum(level(start + (b + 1.5) * bit) << b for b in range(8))
+            if level(start + 9.5 * bit):     # Stop bit, framing errors are dropped
+                events.append((name, start, start + 10 * bit, kind, value, '-'))
+            i = bisect.bisect_left(times, start + 9.5 * bit, i + 1)
+        else:
+            i += 1
+    return events
+
+
+# ------------------------------------------------------------------------------------------------
+# I2C transactions and their meaning
+
+def transactions(events):
+    found, current = [], None
+    for e in events:
+        if e[0] != 'i2c':
+            continue
+        _, start, end, kind, value, ack, origin = e
+        if kind == 'A':
+            if current is None:
+                current = Transaction(start)
+                current.origin = origin
+            current.segments.append([value, ack == 'A', []])
+        elif kind in 'WR' and current is not None and current.segments:
+            current.segments[-1][2].append(value)
+        if current is not None:
+            current.active += end - start
+            current.end = end
+            if kind == 'P':
+                found.append(current)
+                current = None
+    return found
+
+
+def bmp280_register(r):
+    return max((base, name) for base, name in BMP280_REGISTERS if base <= r)[1] if r >= 0x88 else '0x%02X' % r
+
+
+def describe(t):
+    """(device, operation, payload bytes, overhead bytes) of a transaction."""
+    device = DEVICES.get(t.address, '0x%02X' % t.address)
+    addressing = len(t.segments)  # Address bytes
+    if not t.segments[0][1]:
+        return device, 'not acknowledged', 0, addressing
+    writes = [s[2] for s in t.segments if not s[0] & 1]
+    reads = [s[2] for s in t.segments if s[0] & 1]
+    payload = sum(len(s[2]) for s in t.segments)
+    if device == 'BMP280':
+        if writes and writes[0]:
+            name = bmp280_register(writes[0][0])
+            return device, ('read %s' % name if reads else 'write %s' % name), payload - 1, addressing + 1
+        return device, 'read', payload, addressing
+    if device == 'SHT21':
+        if writes and writes[0]:
+            command = SHT21_COMMANDS.get(writes[0][0], 'command 0x%02X' % writes[0][0])
+            return device, command, payload, addressing
+        if len(t.segments) == 1 and reads:
+            return device, 'read result', payload, addressing
+    if device == 'TCA9548A':
+        return device, 'select channels' if writes else 'read channels', payload, addressing
+    if device == 'ST7567S' and writes and writes[0]:
+        controls = sum(1 for s in writes if s and s[0] in (0x00, 0x40, 0x80, 0xC0))
+        if len(writes) > 1 and writes[-1] and writes[-1][0] == 0x40:
+            return 'ST7567S burst', 'address + data', payload - controls, addressing + controls
+        kind = 'data' if writes[0][0] == 0x40 else 'command'
+        return device, kind, payload - controls, addressing + controls
+    return device, 'read' if reads else 'write', payload, addressing
+
+
+# ------------------------------------------------------------------------------------------------
+# UART records
+
+def crc8(data, crc=0xFF):
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x31) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def records(events, name):
+    """[(kind, first byte index, last byte index)] of a UART byte stream."""
+    data = [e[4] for e in events]
+    found, i = [], 0
+    while i < len(data):
+        b = data[i]
+        if name == 'uart1':
+            if b == 0x3C:  # '<' ... '>' clock frame
+                j = i + 1
+                while j < len(data) and data[j] != 0x3E and data[j] != 0x3C and j - i < 80:
+                    j += 1
+                if j < len(data) and data[j] == 0x3E:
+                    found.append(('clock frame', i, j))
+                    i = j + 1
+                    continue
+            found.append(('damaged clock frame', i, i))
+            i += 1
+            continue
+        if b == MICROBARO_SYNC and i + 3 < len(data):
+            n = data[i + 3]
+            end = i + 4 + 2 * n
+            if 1 <= n <= 10 and end < len(data) and crc8(data[i + 1:end]) == data[end]:
+                found.append(('microbaro frame', i, end))
+                i = end + 1
+                continue
+        if b == DEBUG_LOG_SYNC and i + 1 < len(data):
+            size = data[i + 1]
+            end = i + 6 + size
+            if size <= 32 and end < len(data):
+                x = 0
+                for c in data[i + 1:end]:
+                    x ^= c
+                if x == data[end]:
+                    found.append(('debug record', i, end))
+                    i = end + 1
+                    continue
+        j = i
+        while j < len(data) and data[j] != 0x0A and data[j] not in (MICROBARO_SYNC, DEBUG_LOG_SYNC):
+            j += 1
+        j = min(j, len(data) - 1)
+        first = data[i]
+        kind = ('telemetry JSON' if first == 0x7B and i + 1 < len(data) and data[i + 1] == 0x22 else
+                'tracker frame' if first == 0x7B else 'rotation frame' if first == 0x5B else
+                'telemetry CSV' if 0x20 <= first < 0x7F else 'unknown bytes')
+        found.append((kind, i, j))
+        i = j + 1
+    return found
+
+
+# ------------------------------------------------------------------------------------------------
+# Report
+
+def timeline(spans, begin, end, bins):
+    """Busy fraction per bin of [(start, end)] spans."""
+    width = (end - begin) / bins
+    busy = [0.0] * bins
+    for s, e in spans:
+        s, e = max(s, begin), min(e, end)
+        k = int((s - begin) / width)
+        while s < e and k < bins:
+            edge = begin + (k + 1) * width
+            busy[k] += min(e, edge) - s
+            s, k = edge, k + 1
+    return [b / width for b in busy]
+
+
+def ms(t):
+    return '%9.3f' % (t * 1e3)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('capture', nargs='?', help='logic analyzer CSV export')
+    parser.add_argument('--sim', metavar='LOG', help='bus log of tools/loop_benchmark.py --bus-log instead of a capture')
+    parser.add_argument('--sda', help='SDA channel (name or number)')
+    parser.add_argument('--scl', help='SCL channel')
+    parser.add_argument('--uart0', help='USART0 TX channel (telemetry)')
+    parser.add_argument('--uart1', help='USART1 RX channel (clock device)')
+    parser.add_argument('--baud0', type=float, default=2.5e6, help='USART0 bit rate')
+    parser.add_argument('--baud1', type=float, default=2.5e6, help='USART1 bit rate')
+    parser.add_argument('--bin', type=float, default=0, help='timeline bin in ms (default: 60 bins)')
+    parser.add_argument('--timeline-csv', metavar='FILE', help='write the timeline per bin')
+    parser.add_argument('--transactions', type=int, default=0, metavar='N', help='list the first N I2C transactions')
+    args = parser.parse_args()
+
+    if args.sim:
+        events = read_simulation(args.sim)
+        inferred = False
+    elif args.capture:
+        names, rows = read_capture(args.capture)
+        events = []
+        if args.sda is not None and args.scl is not None:
+            events += decode_i2c(rows, channel(names, args.sda), channel(names, args.scl))
+        if args.uart0 is not None:
+            events += decode_uart(rows, channel(names, args.uart0), args.baud0, 'uart0', 'tx')
+        if args.uart1 is not None:
+            events += decode_uart(rows, channel(names, args.uart1), args.baud1, 'uart1', 'rx')
+        events.sort(key=lambda e: e[1])
+        inferred = True
+    else:
+        parser.error('give a capture or --sim LOG')
+    if not events:
+        sys.exit('no bus traffic decoded')
+
+    drivers = driver_functions()
+    begin, end = min(e[1] for e in events), max(e[2] for e in events)
+    duration = max(end - begin, 1e-9)
+    found = transactions(events)
+    buses = {'i2c': [(t.start, t.end) for t in found]}
+    for name in ('uart0', 'uart1'):
+        spans = [(e[1], e[2]) for e in events if e[0] == name]
+        if spans:
+            buses[name] = spans
+
+    print('%.3f s of traffic, %d I2C transactions, %d USART0 bytes, %d USART1 bytes'
+          % (duration, len(found), len(buses.get('uart0', [])), len(buses.get('uart1', []))))
+    print()
+    print('utilisation:')
+    for name, spans in buses.items():
+        held = sum(e - s for s, e in spans)
+        line = '  %-6s %5.1f %%' % (name, 100 * held / duration)
+        if name == 'i2c':
+            line += ' held start to stop, %.1f %% clocking' % (100 * sum(t.active for t in found) / duration)
+        print(line)
+
+    bins = int(duration * 1e3 / args.bin) if args.bin else 60
+    bins = max(1, min(bins, 100000))
+    rows = {name: timeline(spans, begin, end, bins) for name, spans in buses.items()}
+    print()
+    print('timeline (%.3g ms per column, %s = 0 ... 100 %%):' % (duration * 1e3 / bins, repr(LEVELS)))
+    for name, fractions in rows.items():
+        width = min(bins, 100)
+        step = bins / width
+        line = ''.join(LEVELS[min(int(max(fractions[int(k * step):int((k + 1) * step)] or [0]) * 9.999), 9)]
+                       for k in range(width))
+        print('  %-6s|%s|' % (name, line))
+    if args.timeline_csv:
+        with open(args.timeline_csv, 'w', newline='') as out:
+            writer = csv.writer(out)
+            writer.writerow(['start_s'] + list(rows))
+            for k in range(bins):
+                writer.writerow(['%.6f' % (k * duration / bins)] + ['%.4f' % rows[n][k] for n in rows])
+
+    # I2C per operation and per function
+    operations = collections.OrderedDict()
+    functions = collections.defaultdict(lambda: [0, 0.0, 0.0])
+    labelled = []
+    for t in found:
+        device, operation, payload, overhead = describe(t)
+        if inferred:
+            owner = next(f for d, f in INFERRED + [(device, device)] if device.startswith(d)) + ' (inferred)'
+        else:
+            owner = function(t.origin, drivers)
+        labelled.append((t, device, operation, payload, overhead, owner))
+        o = operations.setdefault((device, operation), [0, 0.0, 0.0, 0, 0])
+        o[0] += 1
+        o[1] += t.end - t.start
+        o[2] += t.active
+        o[3] += payload
+        o[4] += overhead
+        f = functions[owner]
+        f[0] += 1
+        f[1] += t.end - t.start
+        f[2] += t.active
+    for name, spans in buses.items():
+        if name == 'i2c':
+            continue
+        stream = [e for e in events if e[0] == name]
+        for kind, i, j in records(stream, name):
+            owner = '%s %s' % (name.upper(), kind)
+            f = functions[owner]
+            f[0] += 1
+            f[1] += stream[j][2] - stream[i][1]
+            f[2] += sum(e[2] - e[1] for e in stream[i:j + 1])
+
+    if operations:
+        print()
+        print('I2C time per operation (ms):')
+        print('  %-14s %-24s %6s %9s %9s %8s %8s' % ('device', 'operation', 'count', 'held', 'clocking', 'payload',
+                                                     'overhead'))
+        for (device, operation), (n, held, active, payload, overhead) in sorted(operations.items(),
+                                                                               key=lambda x: -x[1][1]):
+            print('  %-14s %-24s %6d %s %s %8d %8d' % (device, operation, n, ms(held), ms(active), payload, overhead))
+
+    print()
+    print('bus time per firmware function (ms, records for the UARTs):')
+    print('  %-40s %6s %9s %9s %7s' % ('function', 'count', 'held', 'clocking', '% time'))
+    for owner, (n, held, active) in sorted(functions.items(), key=lambda x: -x[1][1]):
+        print('  %-40s %6d %s %s %6.2f %%' % (owner[:40], n, ms(held), ms(active), 100 * held / duration))
+
+    # Findings
+    notes = []
+    groups = collections.defaultdict(list)
+    for t, device, operation, payload, overhead, owner in labelled:
+        groups[(owner, device, operation)].append((t, payload, overhead))
+    for (owner, device, operation), items in groups.items():
+        n = len(items)
+        payload = sum(p for _, p, _ in items)
+        overhead = sum(o for _, _, o in items)
+        if n >= 10 and payload and overhead >= payload and payload / n <= 2:
+            # Back to back transactions (gap below one transaction time) could share one address
+            runs, saved = 0, 0.0
+            for (a, _, oa), (b, _, _) in zip(items, items[1:]):
+                if b.start - a.end < (a.end - a.start):
+                    runs += 1
+                    saved += (a.end - a.start) * oa / max(oa + max(1, len(a.segments[-1][2])), 1)
+            notes.append('%s sends %s %s one by one: %d transactions with %.1f payload bytes each, %d %% of their '
+                         '%.2f ms is addressing/control overhead; %d follow each other directly, batching them '
+                         'would save about %.2f ms'
+                         % (owner, device, operation, n, payload / n, 100 * overhead / (payload + overhead),
+                            sum(t.end - t.start for t, _, _ in items) * 1e3, runs, saved * 1e3))
+        if operation == 'not acknowledged' and n >= 2:
+            notes.append('%s: %d address NACKs from %s (polling a busy sensor), %.2f ms of bus time'
+                         % (device, n, owner, sum(t.end - t.start for t, _, _ in items) * 1e3))
+        if operation == 'read status' and n >= 10:
+            notes.append('%s: %d status polls from %s, %.2f ms of bus time'
+                         % (device, n, owner, sum(t.end - t.start for t, _, _ in items) * 1e3))
+    writes = collections.Counter()
+    for t, device, operation, payload, overhead, owner in labelled:
+        if all(not s[0] & 1 for s in t.segments) and device != 'ST7567S burst':
+            writes[(owner, device, operation, tuple(b for s in t.segments for b in s[2]))] += 1
+    for (owner, device, operation, data), n in writes.most_common():
+        if n >= 5 and not operation.startswith(('trigger', 'measure', 'command', 'data')):
+            notes.append('%s writes the same %s %s (%s) %d times' % (owner, device, operation,
+                                                                    ' '.join('%02X' % b for b in data), n))
+    holds = [(t.end - t.start - t.active, t, owner) for t, _, _, _, _, owner in labelled]
+    holds.sort(key=lambda x: -x[0])
+    if holds and holds[0][0] > 100e-6:
+        hold, t, owner = holds[0]
+        notes.append('longest bus hold: %.3f ms of %.3f ms at %.4f s by %s without clocking (CPU work between bytes '
+                     'keeps the bus)' % (hold * 1e3, (t.end - t.start) * 1e3, t.start - begin, owner))
+    for name in ('uart0', 'uart1'):
+        stream = [e for e in events if e[0] == name]
+        lost = sum(1 for e in stream if e[3] == 'lost')
+        if lost:
+            notes.append('%s: %d of %d received bytes lost (receive FIFO overrun, nobody reading)'
+                         % (name.upper(), lost, len(stream)))
+        gaps = []
+        for kind, i, j in records(stream, name):
+            byte = stream[i][2] - stream[i][1]
+            gap = max([b[1] - a[2] for a, b in zip(stream[i:j], stream[i + 1:j + 1])] or [0])
+            if gap > 2 * byte:
+                gaps.append(gap)
+        if gaps:
+            notes.append('%s: %d records with gaps inside (longest %.3f ms): the transmit queue ran empty mid-record'
+                         % (name.upper(), len(gaps), max(gaps) * 1e3))
+    print()
+    print('findings:')
+    for note in notes or ['none']:
+        print('  - ' + note)
+
+    if args.transactions:
+        print()
+        print('first %d I2C transactions:' % args.transactions)
+        for t, device, operation, payload, overhead, owner in labelled[:args.transactions]:
+            data = ' | '.join('%02X%s %s' % (s[0], '' if s[1] else '(N)', ' '.join('%02X' % b for b in s[2]))
+                              for s in t.segments)
+            print('  %10.6f %8.1f us  %-14s %-22s %-28s %s' % (t.start - begin, (t.end - t.start) * 1e6, device,
+                                                              operation, owner[:28], data))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+clearsky_accuracy.py - host check of the fixed-point clear-sky model and window statistics (ClearSky.c).
+
+Builds ClearSky.c and FixedMath.c with the host C compiler against stubbed solar angles, clock
+and timer, then
+
+  - sweeps solar elevation (CLEARSKY_MIN_ELEVATION ... 90 deg) at a few station altitudes and
+    compares the fixed-point Haurwitz irradiance with the double precision formula,
+  - feeds a synthetic day of clear, broken and overcast light readings and compares the rolling
+    window mean, standard deviation and mean step of the clear-sky index, which the firmware
+    updates incrementally, with a direct computation over the same window.
+
+  python3 tools/clearsky_accuracy.py
+  python3 tools/clearsky_accuracy.py --samples 2000 --seed 3
+"""
+
+import argparse
+import math
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+
+WINDOW = 60
+SAMPLE_MS = 10000
+MIN_ELEVATION = 5.0
+CAL = 138 / 256.0  # W/m2 per SUN.sunlevel unit (CLEARSKY_CAL_Q8)
+
+SETTINGS = '''#include <stdint.h>
+#include <math.h>
+#define PROGMEM
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define DERIVED_ADJ_ANGLES 0
+#define DERIVED_BIT(n) (1u << (n))
+typedef struct { int16_t altitude; } DateClock;
+typedef struct { float adjelevation; uint16_t sunlevel; } SunAngles;
+extern DateClock Date_Clock;
+extern SunAngles SUN;
+#include "ClearSky.h"
+#include "FixedMath.h"
+int16_t FixedMath_Sin(int32_t angle);
+uint16_t FixedMath_Sqrt(uint32_t x);
+uint32_t Timer_ms(void);
+void Derived_Refresh(uint16_t nodes);
+void ClearSky_Task(void);
+'''
+
+# Reads "altitude elevation sunlevel" lines, takes one sample per line and prints the results.
+HARNESS = '''#include <stdio.h>
+#include "Settings.h"
+
+DateClock Date_Clock;
+SunAngles SUN;
+static uint32_t now;
+
+uint32_t Timer_ms(void) { return now; }
+void Derived_Refresh(uint16_t nodes) { (void)nodes; }
+
+int main(void) {
+    int altitude;
+    float elevation;
+    unsigned level;
+    while (scanf("%d %f %u", &altitude, &elevation, &level) == 3) {
+        Date_Clock.altitude = altitude;
+        SUN.adjelevation = elevation;
+        SUN.sunlevel = level;
+        ClearSky_Task();
+        now += CLEARSKY_SAMPLE_MS;
+        printf("%u %u %u %u %u %u %u\\n", ClearSky.clearSky, ClearSky.index, ClearSky.count, ClearSky.mean,
+               ClearSky.deviation, ClearSky.variability, ClearSky.sky);
+    }
+    return 0;
+}
+'''
+
+
+def run(command, **kwargs):
+    result = subprocess.run(command, capture_output=True, text=True, **kwargs)
+    if result.returncode:
+        sys.exit('%s\n%s%s' % (' '.join(command), result.stdout, result.stderr))
+    return result.stdout
+
+
+def haurwitz(elevation, altitude):
+    """Clear-sky global horizontal irradiance, W/m2."""
+    s = math.sin(math.radians(elevation))
+    return 1098 * s * math.exp(-0.057 * math.exp(-max(altitude, 0) / 8434.5) / s)
+
+
+def day(rng, samples):
+    """Yields (elevation, sun level) of a synthetic day: clear morning, broken cloud, overcast, clear."""
+    for i in range(samples):
+        elevation = 60 * math.sin(math.pi * (i + 1) / (samples + 1))
+        part = 4 * i // samples
+        if part == 1:
+            k = rng.choice([0.3, 1.05]) if rng.random() < 0.5 else rng.uniform(0.3, 1.1)
+        elif part == 2:
+            k = rng.gauss(0.35, 0.03)
+        else:
+            k = rng.gauss(0.98, 0.01)
+        level = haurwitz(elevation, 0) * max(k, 0) / CAL
+        yield elevation, max(0, min(65535, round(level)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--cc', default='cc', help='host C compiler')
+    parser.add_argument('--samples', type=int, default=1000, help='samples of the synthetic day')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    sweep = [(a, e / 10) for a in (0, 500, 1500, 3000) for e in range(int(MIN_ELEVATION * 10), 901, 5)]
+    series = list(day(random.Random(args.seed), args.samples))
+    lines = ['%d %.2f 0' % s for s in sweep] + ['0 -5 0'] + ['0 %.2f %d' % s for s in series]
+
+    work = tempfile.mkdtemp(prefix='clearsky_accuracy')
+    try:
+        for name in ('ClearSky.c', 'ClearSky.h', 'ClearSkyVar.h', 'FixedMath.c', 'FixedMath.h', 'FixedMathVar.h'):
+            shutil.copy(os.path.join(PROJECT, name), work)
+        open(os.path.join(work, 'Settings.h'), 'w').write(SETTINGS)
+        open(os.path.join(work, 'harness.c'), 'w').write(HARNESS)
+        binary = os.path.join(work, 'harness')
+        run([args.cc, '-O2', '-std=gnu99', '-Wall', '-I', work, os.path.join(work, 'ClearSky.c'),
+             os.path.join(work, 'FixedMath.c'), os.path.join(work, 'harness.c'), '-o', binary, '-lm'])
+        output = [list(map(int, line.split())) for line in run([binary], input='\n'.join(lines) + '\n').splitlines()]
+    finally:
+        shutil.rmtree(work)
+
+    print('%-10s %12s %12s %10s' % ('altitude', 'worst W/m2', 'worst %', 'at deg'))
+    worst_rel = 0.0
+    for altitude in (0, 500, 1500, 3000):
+        errors = [(abs(r[0] / 10 - haurwitz(e, a)), e) for (a, e), r in zip(sweep, output) if a == altitude]
+        rel = max(abs(r[0] / 10 - haurwitz(e, a)) / haurwitz(e, a) for (a, e), r in zip(sweep, output) if a == altitude)
+        worst, at = max(errors)
+        worst_rel = max(worst_rel, rel)
+        print('%-10d %12.2f %12.3f %10.1f' % (altitude, worst, 100 * rel, at))
+
+    # Window statistics against a direct computation over the same indices
+    results = output[len(sweep) + 1:]
+    indices, worst = [], {'mean': 0, 'deviation': 0, 'variability': 0}
+    skies = [0] * 5
+    for r in results:
+        skies[r[6]] += 1
+        if r[6] == 0:  # Sun too low: the firmware empties the window
+            indices = []
+            continue
+        indices.append(r[1])
+        w = indices[-WINDOW:]
+        assert r[2] == len(w), 'window length %d, expected %d' % (r[2], len(w))
+        mean = sum(w) / len(w)
+        deviation = math.sqrt(sum(k * k for k in w) / len(w) - mean * mean) if len(w) > 1 else 0
+        steps = [abs(b - a) for a, b in zip(w, w[1:])]
+        variability = sum(steps) / len(steps) if steps else 0
+        worst['mean'] = max(worst['mean'], abs(r[3] - mean))
+        worst['deviation'] = max(worst['deviation'], abs(r[4] - deviation))
+        worst['variability'] = max(worst['variability'], abs(r[5] - variability))
+    print()
+    print('window (0.001 index units): worst mean %.2f, standard deviation %.2f, mean step %.2f'
+          % (worst['mean'], worst['deviation'], worst['variability']))
+    print('sky samples: low sun %d, clear %d, partly %d, variable %d, overcast %d' % tuple(skies))
+    if worst_rel > 0.01 or max(worst.values()) > 2:
+        sys.exit('accuracy check failed')
+
+
+if __name__ == '__main__':
+    main()
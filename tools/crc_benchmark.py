@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+crc_benchmark.py - throughput vs flash of the CRC implementations in CRC.c.
+
+Builds CRC.c once per CRC_IMPLEMENTATION (CRC_TABLE256, CRC_TABLE16, CRC_BITWISE), checks every
+CRC against its catalogue check value (CRC of "123456789") and, split in arbitrary pieces,
+against the one-shot result (incremental use), then measures the throughput of each CRC on the
+host over 64-byte frames.
+
+Code + table size is taken from the symbol sizes of the object file. With avr-gcc on the PATH
+(or --avr-gcc) the sizes are those of the AVR64DD32 build at -Os, which is what counts for the
+station's flash; otherwise the host object sizes are shown for comparison only. Host throughput
+is indicative of the relative cost per byte, not of the AVR speed.
+
+  python3 tools/crc_benchmark.py
+  python3 tools/crc_benchmark.py --avr-gcc /opt/avr8-gnu-toolchain/bin/avr-gcc --megabytes 64
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+
+IMPLEMENTATIONS = ['CRC_TABLE256', 'CRC_TABLE16', 'CRC_BITWISE']
+
+# (function, initial value macro, catalogue check value of "123456789")
+CRCS = [
+    ('CRC8_Update', 'CRC8_SENSIRION_INIT', 0xF7),
+    ('CRC16_CCITT_Update', 'CRC16_CCITT_INIT', 0x29B1),
+    ('CRC16_Modbus_Update', 'CRC16_MODBUS_INIT', 0x4B37),
+]
+
+# Stand-in for the firmware's Settings.h: CRC.c needs the integer types, CRC.h and the
+# <avr/pgmspace.h> accessors, which on the host read the tables directly.
+SETTINGS = '''#include <stdint.h>
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#include "CRC.h"
+uint8_t CRC8_Update(uint8_t crc, const void *data, uint16_t length);
+uint16_t CRC16_CCITT_Update(uint16_t crc, const void *data, uint16_t length);
+uint16_t CRC16_Modbus_Update(uint16_t crc, const void *data, uint16_t length);
+uint16_t CRC8MAXIM(uint32_t data);
+'''
+
+HARNESS = '''#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "Settings.h"
+
+#define FRAME 64
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+#define RUN(fn, init, check) do { \\
+    unsigned one = fn(init, "123456789", 9), parts = fn(fn(fn(init, "1", 1), "2345", 4), "6789", 4); \\
+    volatile unsigned sink = init; \\
+    double start = now(); \\
+    for (long i = 0; i < frames; i++) sink = fn(sink, buffer + (i & 63), FRAME); \\
+    double seconds = now() - start; \\
+    printf("%s %d %d %.0f\\n", #fn, one == (check), parts == one, frames * (double)FRAME / seconds); \\
+} while (0)
+
+int main(int argc, char **argv) {
+    static uint8_t buffer[FRAME + 64];
+    long frames = atol(argv[1]) / FRAME;
+    for (unsigned i = 0; i < sizeof(buffer); i++) buffer[i] = rand();
+@CALLS@
+    return 0;
+}
+'''
+
+
+def run(command):
+    result = subprocess.run(command, capture_output=True, text=True)
+    if result.returncode:
+        sys.exit('%s\n%s' % (' '.join(command), result.stderr))
+    return result.stdout
+
+
+def symbol_sizes(nm, obj):
+    """Returns {symbol: size in bytes} of the functions and tables in an object file."""
+    sizes = {}
+    for line in run([nm, '-S', '--size-sort', obj]).splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in 'TtRrDd':
+            sizes[fields[3]] = int(fields[1], 16)
+    return sizes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--cc', default='cc', help='host C compiler')
+    parser.add_argument('--avr-gcc', default=shutil.which('avr-gcc'), help='AVR compiler for the flash sizes')
+    parser.add_argument('--megabytes', type=float, default=16, help='data per CRC and implementation')
+    args = parser.parse_args()
+
+    total = str(int(args.megabytes * 1e6))
+    calls = '\n'.join('    RUN(%s, %s, 0x%X);' % crc for crc in CRCS)
+    work = tempfile.mkdtemp(prefix='crc_benchmark')
+    try:
+        for name in ('CRC.c', 'CRC.h'):
+            shutil.copy(os.path.join(PROJECT, name), work)
+        open(os.path.join(work, 'Settings.h'), 'w').write(SETTINGS)
+        open(os.path.join(work, 'bench.c'), 'w').write(HARNESS.replace('@CALLS@', calls))
+        crc_c = os.path.join(work, 'CRC.c')
+        bench_c = os.path.join(work, 'bench.c')
+
+        flash_target = 'AVR64DD32 -Os' if args.avr_gcc else 'host -O2 (no avr-gcc)'
+        print('%-13s %-20s %6s %6s %12s %8s' % ('', 'CRC', 'check', 'parts', 'host MB/s', 'bytes'))
+        failed = False
+        for implementation in IMPLEMENTATIONS:
+            define = '-DCRC_IMPLEMENTATION=' + implementation
+            binary = os.path.join(work, implementation)
+            run([args.cc, '-O2', '-std=gnu99', define, '-I', work, crc_c, bench_c, '-o', binary])
+            if args.avr_gcc:
+                obj = os.path.join(work, implementation + '.o')
+                run([args.avr_gcc, '-mmcu=avr64dd32', '-Os', '-std=gnu99', '-ffunction-sections',
+                     '-fdata-sections', define, '-I', work, '-c', crc_c, '-o', obj])
+                sizes = symbol_sizes(os.path.join(os.path.dirname(args.avr_gcc), 'avr-nm'), obj)
+            else:
+                obj = os.path.join(work, implementation + '.host.o')
+                run([args.cc, '-O2', '-std=gnu99', define, '-I', work, '-c', crc_c, '-o', obj])
+                sizes = symbol_sizes('nm', obj)
+
+            for line in run([binary, total]).splitlines():
+                function, check, parts, speed = line.split()
+                stem = function.replace('_Update', '').lower()  # crc8, crc16_ccitt, crc16_modbus
+                size = sizes.get(function, 0) + sum(s for symbol, s in sizes.items()
+                                                    if symbol.startswith(stem + '_table'))
+                failed |= check != '1' or parts != '1'
+                print('%-13s %-20s %6s %6s %12.1f %8d' % (implementation, function, 'ok' if check == '1' else 'FAIL',
+                      'ok' if parts == '1' else 'FAIL', float(speed) / 1e6, size))
+        print()
+        print('bytes: function + its table(s), %s' % flash_target)
+    finally:
+        shutil.rmtree(work)
+    if failed:
+        sys.exit('CRC check failed')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+debuglog.py - formats the station's deferred binary debug log (DebugLog.h) on the host.
+
+The station sends only a message id and the raw argument bytes of every DEBUG_LOGn() call. The
+format strings stay in the `.logstr` section of the ELF file built with DEBUG_LOG_ENABLE 1; the
+id of a message is the offset of its string in that section. This tool reads the strings from
+the ELF file, decodes the records from a USART0 capture and prints the formatted messages.
+
+Record on the wire (little endian):
+
+  0xA6 | size | id (2) | time ms (2) | arguments (size bytes) | XOR of size ... arguments
+
+Bytes outside records (the ASCII telemetry on the same line) are skipped, or printed with
+--text. Argument sizes follow the AVR ABI: %hhd/%hhu/%hhx/%c 1 byte, %d/%u/%x 2 bytes,
+%ld/%lu/%lx 4 bytes, %f/%e/%g 4 bytes (float).
+
+  python3 tools/debuglog.py "Debug/AVR64dd32 meteorologine stotele v3.elf" capture.bin
+  python3 tools/debuglog.py firmware.elf --serial /dev/ttyUSB0 --baud 2500000   (needs pyserial)
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = 0xA6
+HEADER = 5
+MAX_ARGS = 16
+DROPPED_ID = 0xFFFF
+
+CONVERSION = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l)?([diuxXocfeEgG%])')
+
+
+def read_strings(path):
+    """Returns {id: format string} from the .logstr section of an ELF file (32 or 64 bit, LE)."""
+    data = open(path, 'rb').read()
+    if data[:4] != b'\x7fELF' or data[5] != 1:
+        sys.exit('%s: not a little endian ELF file' % path)
+    if data[4] == 1:  # ELF32
+        shoff, = struct.unpack_from('<I', data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', data, 0x2E)
+        section = lambda i: struct.unpack_from('<IIIIII', data, shoff + i * shentsize)
+    else:  # ELF64
+        shoff, = struct.unpack_from('<Q', data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', data, 0x3A)
+        section = lambda i: struct.unpack_from('<IIQQQQ', data, shoff + i * shentsize)
+
+    names = section(shstrndx)
+    for i in range(shnum):
+        name, _, _, addr, offset, size = section(i)
+        start = names[4] + name
+        if data[start:data.index(b'\0', start)] == b'.logstr':
+            break
+    else:
+        sys.exit('%s: no .logstr section (built with DEBUG_LOG_ENABLE 0?)' % path)
+
+    strings = {}
+    blob = data[offset:offset + size]
+    i = 0
+    while i < len(blob):
+        if blob[i] == 0:  # Padding between strings
+            i += 1
+            continue
+        end = blob.index(b'\0', i)
+        strings[addr + i] = blob[i:end].decode('latin-1')
+        i = end + 1
+    return strings
+
+
+def argument_layout(fmt):
+    """Returns the struct format of the arguments of a format string."""
+    layout = '<'
+    for flags, width, precision, length, conv in CONVERSION.findall(fmt):
+        if conv == '%':
+            continue
+        if conv in 'feEgG':
+            layout += 'f'
+        elif conv == 'c' or length == 'hh':
+            layout += 'b' if conv in 'di' else 'B'
+        elif length in ('l', 'll'):
+            layout += 'i' if conv in 'di' else 'I'
+        else:
+            layout += 'h' if conv in 'di' else 'H'
+    return layout
+
+
+def format_message(fmt, args):
+    """printf-style formatting with the C length modifiers removed."""
+    return CONVERSION.sub(lambda m: '%' + m.group(1) + m.group(2) + ('.' + m.group(3) if m.group(3) else '')
+                          + m.group(5), fmt) % tuple(args)
+
+
+def records(stream, text):
+    """Yields (id, time, argument bytes) of every record with a valid checksum."""
+    buffer = b''
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        buffer += chunk
+        while buffer:
+            if buffer[0] != SYNC:
+                end = buffer.find(bytes([SYNC]))
+                skipped, buffer = (buffer, b'') if end < 0 else (buffer[:end], buffer[end:])
+                if text:
+                    sys.stdout.write(skipped.decode('latin-1'))
+                continue
+            if len(buffer) < 2:
+                break
+            size = buffer[1]
+            length = 1 + HEADER + size + 1
+            if size > MAX_ARGS:
+                buffer = buffer[1:]  # Not a record
+                continue
+            if len(buffer) < length:
+                break
+            body = buffer[1:length - 1]
+            checksum = 0
+            for c in body:
+                checksum ^= c
+            if checksum != buffer[length - 1]:
+                buffer = buffer[1:]  # Resynchronise on the next sync byte
+                continue
+            ident, time = struct.unpack_from('<HH', body, 1)
+            yield ident, time, body[HEADER:]
+            buffer = buffer[length:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('elf', help='firmware ELF file built with DEBUG_LOG_ENABLE 1')
+    parser.add_argument('capture', nargs='?', help='binary USART0 capture (default: stdin)')
+    parser.add_argument('--serial', help='read from a serial port instead')
+    parser.add_argument('--baud', type=int, default=2500000)
+    parser.add_argument('--text', action='store_true', help='also print the bytes between records')
+    args = parser.parse_args()
+
+    strings = read_strings(args.elf)
+    if args.serial:
+        import serial
+        stream = serial.Serial(args.serial, args.baud, timeout=1)
+    elif args.capture:
+        stream = open(args.capture, 'rb')
+    else:
+        stream = sys.stdin.buffer
+
+    epoch = 0
+    last = None
+    for ident, time, payload in records(stream, args.text):
+        if last is not None and time < last:
+            epoch += 0x10000  # 16-bit millisecond stamp wrapped
+        last = time
+        stamp = '[%10.3f]' % ((epoch + time) / 1000.0)
+        if ident == DROPPED_ID:
+            print('%s ... %d records dropped' % (stamp, struct.unpack('<H', payload)[0]))
+            continue
+        fmt = strings.get(ident)
+        if fmt is None:
+            print('%s unknown message 0x%04x: %s' % (stamp, ident, payload.hex()))
+            continue
+        layout = argument_layout(fmt)
+        if struct.calcsize(layout) != len(payload):
+            print('%s "%s": %d argument bytes, format expects %d: %s'
+                  % (stamp, fmt, len(payload), struct.calcsize(layout), payload.hex()))
+            continue
+        print('%s %s' % (stamp, format_message(fmt, struct.unpack(layout, payload))))
+
+
+if __name__ == '__main__':
+    main()
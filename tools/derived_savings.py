@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+"""
+derived_savings.py - recomputations saved by the derived value graph (Derived.c) on a trace.
+
+Replays a trace of the graph inputs through the same dirty tracking and lazy refresh as the
+firmware and compares the number of recomputations with the baseline firmware as it ran:
+
+  - AltitudeAverage() on every main loop pass: vapour pressure (inside the compensated
+    altitude), both altitudes and their mean,
+  - refraction and the adjusted angles only with the sun above the horizon
+    (correct_solar_angles() returned at once otherwise),
+  - no dew point and no tracker rotation: they are new work of the graph, counted against it.
+
+The trace holds one line per main loop pass. By default it is a TELEMETRY_CSV record stream
+(az,el,ws,wd,ll,t,rh,p,td*HH); the az/el columns there are the adjusted angles, which change
+exactly when the raw angles change above the horizon, so they serve as the angle inputs.
+Other layouts are mapped with --column. Site altitude is constant (--altitude).
+
+Without a recorded trace, --synthetic builds the passes of one day: the minute weather of
+tools/history_compression.py (calm, variable or front), the BMP280 and SHT21 read at the
+intervals the adaptive sampling engine (Sampling.c, SamplingVar.h) picks for the sensor noise
+below, and the sun angles of a clock device frame (0.01 deg) every pass, at 10 passes per second
+as in tools/loop_benchmark.py with 100 ms frames. Recomputations per hour on the synthetic
+midsummer days (21 June, Vilnius, seed 1), with the consumers of the main window (tracker and
+dew point: telemetry, retransmission, main window) and with the parameter view open as well
+(altitudes too):
+
+  day        baseline   lazy, main window    lazy, parameter view
+  calm         195108       21086  (89.2 %)       38178  (80.4 %)
+  variable     195108       19032  (90.2 %)       33994  (82.6 %)
+  front        195108       21036  (89.2 %)       38079  (80.5 %)
+
+The baseline is 4 x 36000 altitude values per hour (vapour pressure, both altitudes, their
+mean) plus refraction and the adjusted angles during the 17.0 h of daylight; the lazy figures
+include the dew point and tracker recomputations that the baseline did not do (about 7500 per
+hour, nearly all of them the tracker following the 0.01 deg angle steps).
+
+  python3 tools/derived_savings.py trace.csv --rate 5
+  python3 tools/derived_savings.py trace.csv --rate 5 --read adj_angles,altitudes,dew_point
+  python3 tools/derived_savings.py --synthetic variable
+"""
+
+import argparse
+import math
+import random
+import sys
+
+from history_compression import synthetic
+
+# Inputs in Derived.h order: (name, default CSV column, resolution multiplier).
+INPUTS = [
+    ('pressure', 7, 100),      # 0.01 hPa
+    ('temperature', 5, 100),   # 0.01 C
+    ('humidity', 6, 10),       # 0.1 %
+    ('elevation', 1, 1000),    # 0.001 deg
+    ('azimuth', 0, 1000),      # 0.001 deg
+    ('site_altitude', None, 1),
+]
+
+# Derived values in Derived.h order with their direct dependencies (names of inputs or values).
+DERIVED = [
+    ('vapor', ['temperature', 'humidity']),
+    ('dew_point', ['temperature', 'humidity']),
+    ('alt_uncomp', ['pressure']),
+    ('alt_comp', ['pressure', 'temperature', 'vapor']),
+    ('alt_avrg', ['alt_uncomp', 'alt_comp']),
+    ('refraction', ['elevation', 'pressure', 'temperature', 'site_altitude']),
+    ('adj_angles', ['elevation', 'azimuth', 'refraction']),
+    ('tracker', ['adj_angles']),
+]
+
+GROUPS = {'altitudes': ['alt_uncomp', 'alt_comp', 'alt_avrg']}
+
+NAMES = [n for n, _, _ in INPUTS] + [n for n, _ in DERIVED]
+BIT = {n: 1 << i for i, n in enumerate(NAMES)}
+DEPS = [0] * len(INPUTS) + [sum(BIT[d] for d in deps) for _, deps in DERIVED]
+DERIVED_MASK = sum(BIT[n] for n, _ in DERIVED)
+
+
+# The baseline firmware: computed on every pass, and only with the sun above the horizon
+BASELINE_EVERY_PASS = ['vapor', 'alt_uncomp', 'alt_comp', 'alt_avrg']
+BASELINE_DAYLIGHT = ['refraction', 'adj_angles']
+
+# Synthetic passes: sensor channels as in SamplingVar.h (shortest and longest interval in ms,
+# threshold in Pa or 0.01 C) with the read noise (1 sigma, same units), the RH noise (0.1 %),
+# and the site and date of the simulated clock frames (tools/loop_benchmark/sim.c).
+SENSORS = {'pressure': (500, 30000, 3, 1.3), 'sht': (1000, 30000, 5, 1.0)}
+RH_NOISE = 0.4
+EWMA_SHIFT, HYSTERESIS = 3, 4
+PASS_MS = 100
+LATITUDE, LONGITUDE, TIMEZONE, DAY = 54.6872, 25.2797, 2, 172
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('trace', nargs='?', help='one line per main loop pass')
+    parser.add_argument('--rate', type=float, help='main loop passes per second in the trace')
+    parser.add_argument('--synthetic', choices=['calm', 'variable', 'front'],
+                        help='one synthetic day instead of a trace, %d passes per second' % (1000 // PASS_MS))
+    parser.add_argument('--seed', type=int, default=1, help='random seed of the synthetic day')
+    parser.add_argument('--read', default='tracker,dew_point',
+                        help='values read by the consumers every pass (default: telemetry, retransmission '
+                             'and main window)')
+    parser.add_argument('--column', action='append', default=[], metavar='INPUT=N',
+                        help='CSV column of an input (0 based)')
+    parser.add_argument('--altitude', type=int, default=0, help='site altitude in m')
+    args = parser.parse_args()
+    if (args.trace is None) == (args.synthetic is None):
+        parser.error('give a trace or --synthetic')
+    if args.trace and args.rate is None:
+        parser.error('--rate is needed with a trace')
+    if args.synthetic:
+        args.rate = 1000.0 / PASS_MS
+    return args
+
+
+def recorded(args):
+    """Yields the inputs of every pass of a trace, in units of their resolution."""
+    columns = {name: column for name, column, _ in INPUTS}
+    for item in args.column:
+        name, _, value = item.partition('=')
+        if name not in columns:
+            sys.exit('unknown input "%s"' % name)
+        columns[name] = int(value)
+    for line in open(args.trace, encoding='latin-1'):
+        fields = line.split('*')[0].strip().split(',')
+        try:
+            yield [args.altitude if columns[name] is None else round(float(fields[columns[name]]) * scale)
+                   for name, _, scale in INPUTS]
+        except (ValueError, IndexError):
+            continue  # Not a record
+
+
+def sun_angles(hours):
+    """(azimuth, elevation) in degrees at local time `hours` on DAY (NOAA approximation)."""
+    utc = hours - TIMEZONE
+    g = 2 * math.pi / 365 * (DAY - 1 + (utc - 12) / 24)
+    decl = (0.006918 - 0.399912 * math.cos(g) + 0.070257 * math.sin(g) - 0.006758 * math.cos(2 * g)
+            + 0.000907 * math.sin(2 * g) - 0.002697 * math.cos(3 * g) + 0.00148 * math.sin(3 * g))
+    eqtime = 229.18 * (0.000075 + 0.001868 * math.cos(g) - 0.032077 * math.sin(g) - 0.014615 * math.cos(2 * g)
+                       - 0.040849 * math.sin(2 * g))
+    ha = math.radians((utc * 60 + eqtime + 4 * LONGITUDE) / 4 - 180)
+    lat = math.radians(LATITUDE)
+    elevation = math.degrees(math.asin(math.sin(lat) * math.sin(decl) + math.cos(lat) * math.cos(decl) * math.cos(ha)))
+    azimuth = math.degrees(math.atan2(math.sin(ha), math.cos(ha) * math.sin(lat) - math.tan(decl) * math.cos(lat)))
+    return (azimuth + 180) % 360, elevation
+
+
+class Channel:
+    """One sensor channel of the adaptive sampling engine (Sampling_End())."""
+
+    def __init__(self, bounds):
+        self.shortest, self.longest, self.threshold, self.noise = bounds
+        self.interval, self.activity, self.last, self.due = self.shortest, 0, None, 0
+
+    def read(self, rng, now, value):
+        """Returns the new reading if the channel is due at `now`, else None."""
+        if now < self.due:
+            return None
+        self.due = now + self.interval
+        reading = round(value + rng.gauss(0, self.noise))
+        if self.last is not None:
+            self.activity += abs(reading - self.last) - (self.activity >> EWMA_SHIFT)
+            if self.activity > self.threshold << EWMA_SHIFT:
+                self.interval = max(self.shortest, self.interval // 2)
+            elif self.activity < (self.threshold << EWMA_SHIFT) // HYSTERESIS:
+                self.interval = min(self.longest, self.interval * 2)
+        self.last = reading
+        return reading
+
+
+def generated(args):
+    """Yields the inputs of every pass of one synthetic day, in units of their resolution."""
+    rng = random.Random(args.seed)
+    rows = synthetic(rng, args.synthetic, 24 * 60 + 1)
+    pressure, sht = Channel(SENSORS['pressure']), Channel(SENSORS['sht'])
+    values = [0, 0, 0]
+    for n in range(24 * 3600 * 1000 // PASS_MS):
+        now = n * PASS_MS
+        m, f = divmod(now / 60000.0, 1)
+        a, b = rows[int(m)], rows[int(m) + 1]
+        p, t, rh = [a[i] + (b[i] - a[i]) * f for i in range(3)]
+        reading = pressure.read(rng, now, p * 100)
+        if reading is not None:
+            values[0] = reading
+        reading = sht.read(rng, now, t * 100)
+        if reading is not None:
+            values[1] = reading
+            values[2] = round(rh * 10 + rng.gauss(0, RH_NOISE))
+        azimuth, elevation = sun_angles(now / 3600000.0)
+        yield values + [round(elevation * 100) * 10, round(azimuth * 100) * 10, args.altitude]  # 0.01 deg frames
+
+
+def main():
+    args = parse_args()
+    request = 0
+    for name in args.read.split(','):
+        for node in GROUPS.get(name, [name]):
+            if node not in BIT or not BIT[node] & DERIVED_MASK:
+                sys.exit('unknown derived value "%s"' % node)
+            request |= BIT[node]
+    for i in reversed(range(len(INPUTS), len(NAMES))):  # Widen to dependencies, as Derived_Refresh()
+        if request & (1 << i):
+            request |= DEPS[i]
+
+    last = [None] * len(INPUTS)
+    dirty = DERIVED_MASK
+    computed = [0] * len(NAMES)
+    passes = daylight = 0
+    elevation = NAMES.index('elevation')
+    for values in (generated(args) if args.synthetic else recorded(args)):
+        changed = 0  # Derived_Update()
+        for i, value in enumerate(values):
+            if value != last[i]:
+                last[i] = value
+                changed |= 1 << i
+        for i in range(len(INPUTS), len(NAMES)):
+            if DEPS[i] & changed:
+                changed |= 1 << i
+        dirty |= changed & DERIVED_MASK
+
+        for i in range(len(INPUTS), len(NAMES)):  # Derived_Refresh()
+            if request & dirty & (1 << i):
+                computed[i] += 1
+                dirty &= ~(1 << i)
+        passes += 1
+        daylight += values[elevation] > 0
+
+    if not passes:
+        sys.exit('%s: no records' % args.trace)
+    hours = passes / args.rate / 3600.0
+    print('%d passes, %.2f h at %g passes/s (%.2f h daylight), consumers read: %s'
+          % (passes, hours, args.rate, daylight / args.rate / 3600.0, args.read))
+    print()
+    print('%-12s %12s %12s %12s %7s' % ('value', 'baseline/h', 'lazy/h', 'saved/h', 'saved'))
+    total_baseline = total_lazy = 0
+    for i in range(len(INPUTS), len(NAMES)):
+        baseline = passes if NAMES[i] in BASELINE_EVERY_PASS else daylight if NAMES[i] in BASELINE_DAYLIGHT else 0
+        total_baseline += baseline
+        total_lazy += computed[i]
+        print('%-12s %12.0f %12.0f %12.0f %7s' % (NAMES[i], baseline / hours, computed[i] / hours,
+              (baseline - computed[i]) / hours,
+              '%6.1f%%' % (100.0 * (baseline - computed[i]) / baseline) if baseline else 'new'))
+    print('%-12s %12.0f %12.0f %12.0f %6.1f%%' % ('total', total_baseline / hours, total_lazy / hours,
+          (total_baseline - total_lazy) / hours, 100.0 * (total_baseline - total_lazy) / total_baseline))
+
+
+if __name__ == '__main__':
+    main()
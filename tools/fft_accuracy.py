@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""
+fft_accuracy.py - host accuracy check and cycle budget of the wind spectrum analysis (Turbulence.c).
+
+Builds Turbulence.c with the host C compiler against stubbed ADC and timer functions, feeds it
+synthetic wind speed blocks (ADC counts) and compares its results with a double precision
+reference computed here from the same samples:
+
+  - spectrum: SNR of the Q15 FFT output against a double precision DFT of the same Hann
+    windowed, mean removed block (both scaled to the same units), and the dominant bin,
+  - octave band variances, turbulence intensity and gust factor: relative error.
+
+It also counts how many Turbulence_Task() calls each analysis phase takes and turns them into
+an AVR cycle budget from per-operation cycle estimates (CYCLES below, avr-gcc -Os at 24 MHz).
+
+  python3 tools/fft_accuracy.py
+  python3 tools/fft_accuracy.py --blocks 20 --seed 7
+"""
+
+import argparse
+import cmath
+import math
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+
+N = 256
+SAMPLE_S = 0.5
+GUST = 6
+BANDS = 7
+COUNTS_PER_MS = 4096 / 30.0
+CMS_PER_COUNT = 3000 / 4096.0
+PHASES = ['idle', 'scan', 'window', 'fft', 'spectrum']
+
+# Estimated AVR cycles per unit of work of each phase (see Turbulence.h)
+CYCLES = {'scan': 45, 'window': 80, 'fft': 220, 'spectrum': 200}
+UNITS = {'scan': N, 'window': N, 'fft': 7 * N // 4, 'spectrum': N // 2}
+F_CPU = 24e6
+
+SETTINGS = '''#include <stdint.h>
+#include <math.h>
+#define PROGMEM
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define ADC_SAMPNUM_ACC16_gc 4
+#include "Turbulence.h"
+uint32_t Timer_ms(void);
+void ADC0_SetAccumulation(uint8_t sampnum);
+void ADC0_SetupWS(void);
+uint16_t ADC0_read(void);
+void Turbulence_Task(void);
+void Turbulence_Bin(uint8_t k, int16_t *re, int16_t *im);
+'''
+
+# Reads the blocks from stdin as one continuous sample stream, runs Turbulence_Task() 10 times
+# per sample period and prints the results of every analysed block.
+HARNESS = '''#include <stdio.h>
+#include <stdlib.h>
+#include "Settings.h"
+
+static uint32_t now;
+static uint16_t *stream;
+static unsigned length, next;
+static unsigned calls[5];
+static int16_t bins[TURBULENCE_N / 2 + 1][2];
+
+uint32_t Timer_ms(void) { return now; }
+void ADC0_SetAccumulation(uint8_t sampnum) { (void)sampnum; }
+void ADC0_SetupWS(void) {}
+uint16_t ADC0_read(void) { return next < length ? stream[next++] : 0; }
+
+int main(void) {
+    unsigned blocks = 0;
+    stream = malloc(65536 * sizeof(uint16_t));
+    while (length < 65536 && scanf("%hu", &stream[length]) == 1)
+        length++;
+    while (blocks < length / TURBULENCE_N) {
+        /* Keep passing until the next block has been sampled and analysed */
+        for (int pass = 0; Turbulence.blocks == blocks; pass++) {
+            now += TURBULENCE_SAMPLE_MS / 10;
+            uint8_t phase = Turbulence.phase;
+            Turbulence_Task();
+            calls[phase]++;
+            if (phase == TURBULENCE_FFT && Turbulence.phase == TURBULENCE_SPECTRUM) {
+                /* The staged samples of the next block overwrite the FFT buffer afterwards */
+                for (int k = 0; k <= TURBULENCE_N / 2; k++)
+                    Turbulence_Bin(k, &bins[k][0], &bins[k][1]);
+            }
+            if (pass > 10 * 2 * TURBULENCE_N + 1000 || Turbulence.overruns || Turbulence.gaps) {
+                printf("stuck\\n");
+                return 1;
+            }
+        }
+        blocks = Turbulence.blocks;
+        printf("result %u %u %u %u %u %u\\n", Turbulence.meanSpeed, Turbulence.intensity, Turbulence.gustFactor,
+               Turbulence.gustPeriod, Turbulence.shift, Turbulence.mean);
+        printf("band");
+        for (int b = 0; b < TURBULENCE_BANDS; b++) printf(" %lu", (unsigned long)Turbulence.band[b]);
+        printf("\\nfft");
+        for (int k = 0; k <= TURBULENCE_N / 2; k++)
+            printf(" %d %d", bins[k][0], bins[k][1]);
+        printf("\\ncalls");
+        for (int p = 0; p < 5; p++) { printf(" %u", calls[p]); calls[p] = 0; }
+        printf("\\n");
+    }
+    return 0;
+}
+'''
+
+
+def run(command, **kwargs):
+    result = subprocess.run(command, capture_output=True, text=True, **kwargs)
+    if result.returncode:
+        sys.exit('%s\n%s%s' % (' '.join(command), result.stdout, result.stderr))
+    return result.stdout
+
+
+def signals(rng, blocks):
+    """Yields (name, samples in ADC counts) test blocks."""
+    t = [i * SAMPLE_S for i in range(N)]
+    kinds = [
+        ('gust 20 s, 8 m/s', lambda: [8 + 2 * math.sin(2 * math.pi * x / 20) for x in t]),
+        ('gust 64 s, 5 m/s', lambda: [5 + 1 * math.sin(2 * math.pi * x / 64 + 0.3) for x in t]),
+        ('red noise TI 15 %', lambda: red_noise(rng, 10, 1.5, 0.9)),
+        ('red noise TI 3 %', lambda: red_noise(rng, 6, 0.18, 0.8)),
+        ('white noise TI 10 %', lambda: [rng.gauss(12, 1.2) for _ in t]),
+        ('calm', lambda: [abs(rng.gauss(0.2, 0.1)) for _ in t]),
+    ]
+    for i in range(blocks):
+        name, make = kinds[i % len(kinds)]
+        yield name, [max(0, min(4095, round(v * COUNTS_PER_MS))) for v in make()]
+
+
+def red_noise(rng, mean, sigma, a):
+    x, out = 0.0, []
+    for _ in range(N):
+        x = a * x + math.sqrt(1 - a * a) * rng.gauss(0, sigma)
+        out.append(mean + x)
+    return out
+
+
+def reference(samples):
+    """Double precision results: (spectrum Y_k for k <= N/2, band variances, TI %, gust factor, peak bin)."""
+    mean = sum(samples) / N
+    window = [0.5 - 0.5 * math.cos(2 * math.pi * n / N) for n in range(N)]
+    x = [(s - mean) * w for s, w in zip(samples, window)]
+    spectrum = [sum(x[n] * cmath.exp(-2j * math.pi * k * n / N) for n in range(N)) / N for k in range(N // 2 + 1)]
+    bands = [0.0] * BANDS
+    for k in range(1, N // 2 + 1):
+        p = abs(spectrum[k]) ** 2 * (2 if k < N // 2 else 1)
+        bands[min(int(math.log2(k)), BANDS - 1)] += p * (8 / 3) * CMS_PER_COUNT ** 2
+    sigma = math.sqrt(sum((s - mean) ** 2 for s in samples) / N)
+    gust = max(sum(samples[i:i + GUST]) / GUST for i in range(N - GUST + 1))
+    peak = max(range(1, N // 2 + 1), key=lambda k: abs(spectrum[k]))
+    return spectrum, bands, 100 * sigma / mean if mean else 0, gust / mean if mean else 0, peak, mean
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--cc', default='cc', help='host C compiler')
+    parser.add_argument('--blocks', type=int, default=12, help='test blocks')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    tests = list(signals(rng, args.blocks))
+    work = tempfile.mkdtemp(prefix='fft_accuracy')
+    try:
+        for name in ('Turbulence.c', 'Turbulence.h', 'TurbulenceVar.h'):
+            shutil.copy(os.path.join(PROJECT, name), work)
+        open(os.path.join(work, 'Settings.h'), 'w').write(SETTINGS)
+        open(os.path.join(work, 'harness.c'), 'w').write(HARNESS)
+        binary = os.path.join(work, 'harness')
+        run([args.cc, '-O2', '-std=gnu99', '-Wall', '-I', work, os.path.join(work, 'Turbulence.c'),
+             os.path.join(work, 'harness.c'), '-o', binary, '-lm'])
+        output = run([binary], input='\n'.join(' '.join(map(str, s)) for _, s in tests) + '\n')
+    finally:
+        shutil.rmtree(work)
+
+    lines = output.split('\n')
+    worst = {'snr': float('inf'), 'band': 0.0, 'ti': 0.0, 'gf': 0.0}
+    calls = {}
+    print('%-20s %7s %5s %8s %8s %8s %8s %7s %7s' % ('block', 'SNR dB', 'shift', 'TI %', 'ref', 'GF', 'ref',
+                                                     'peak', 'ref'))
+    for (name, samples), i in zip(tests, range(0, len(lines), 4)):
+        result = list(map(int, lines[i].split()[1:]))
+        band = list(map(int, lines[i + 1].split()[1:]))
+        fft = list(map(int, lines[i + 2].split()[1:]))
+        for phase, count in zip(PHASES, map(int, lines[i + 3].split()[1:])):
+            calls[phase] = max(calls.get(phase, 0), count)
+        spectrum, ref_bands, ti, gf, peak, mean = reference(samples)
+        _, intensity, gust_factor, gust_period, shift, _ = result
+
+        # Q15 output back to ADC count units: divided by the block floating point scale
+        q = [complex(fft[2 * k], fft[2 * k + 1]) / (1 << shift) for k in range(N // 2 + 1)]
+        signal = sum(abs(s) ** 2 for s in spectrum[1:])
+        noise = sum(abs(a - b) ** 2 for a, b in zip(q[1:], spectrum[1:]))
+        snr = 10 * math.log10(signal / noise) if noise and signal else float('inf')
+        q_peak = round(N * SAMPLE_S * 10 / gust_period) if gust_period else 0
+        calm = mean < 68
+        print('%-20s %7.1f %5d %8.1f %8.1f %8.2f %8.2f %7d %7d'
+              % (name, snr, shift, intensity / 10, 0 if calm else ti, gust_factor / 100, 0 if calm else gf,
+                 q_peak, peak))
+        if not calm:
+            worst['snr'] = min(worst['snr'], snr)
+            worst['ti'] = max(worst['ti'], abs(intensity / 10 - ti) / ti)
+            worst['gf'] = max(worst['gf'], abs(gust_factor / 100 - gf) / gf)
+            total = sum(ref_bands)
+            for b, r in zip(band, ref_bands):
+                if r > 0.01 * total:  # Bands holding at least 1 % of the variance
+                    worst['band'] = max(worst['band'], abs(b - r) / r)
+
+    print()
+    print('worst (windy blocks): spectrum SNR %.1f dB, band variance %.2f %%, TI %.2f %%, gust factor %.2f %%'
+          % (worst['snr'], 100 * worst['band'], 100 * worst['ti'], 100 * worst['gf']))
+    print()
+    print('AVR cycle budget (estimated cycles per unit, %g MHz):' % (F_CPU / 1e6))
+    print('%-9s %6s %7s %8s %10s %9s' % ('phase', 'units', 'slices', 'cyc/unit', 'cyc/slice', 'ms/slice'))
+    total = 0
+    for phase in PHASES[1:]:
+        units, slices = UNITS[phase], calls.get(phase, 0)
+        cycles = units * CYCLES[phase]
+        total += cycles
+        print('%-9s %6d %7d %8d %10.0f %9.3f' % (phase, units, slices, CYCLES[phase], cycles / max(slices, 1),
+                                                 cycles / max(slices, 1) / F_CPU * 1e3))
+    print('total %d cycles = %.1f ms per %.0f s block (%.4f %% CPU)'
+          % (total, total / F_CPU * 1e3, N * SAMPLE_S, 100 * total / F_CPU / (N * SAMPLE_S)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""
+history_compression.py - round trip check and bytes per sample of the compressed history (History.c).
+
+Builds History.c with the host C compiler against stubbed channel inputs and timer, drives
+History_Task() through minute traces (four main loop passes per minute) and checks that
+
+  - sequential decoding (History_Seek() + History_Next()) of every retained minute, and random
+    access (History_Read()) to a few hundred minutes, give back exactly the quantised minute
+    values (quantisation as in HistoryVar.h, parsed from it),
+  - the minute reduction (mean, highest, last) matches a reference computed here.
+
+It then reports the pool bytes per sample of every channel and in total, the raw equivalent and
+the hours of history the pool holds. Traces are synthetic days (calm and clear, broken cloud
+and wind, a front passing) or a recorded CSV with one row per minute and the columns
+pressure_hPa, temperature_C, humidity_pct, wind_ms, gust_ms, direction, sun_mV.
+
+  python3 tools/history_compression.py
+  python3 tools/history_compression.py --days 3 --seed 5
+  python3 tools/history_compression.py --trace station_minutes.csv
+"""
+
+import argparse
+import csv
+import math
+import os
+import random
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+
+CHANNELS = ['PRESSURE', 'TEMPERATURE', 'HUMIDITY', 'WIND_SPEED', 'WIND_GUST', 'WIND_DIR', 'SUN']
+COLUMNS = ['pressure_hPa', 'temperature_C', 'humidity_pct', 'wind_ms', 'gust_ms', 'direction', 'sun_mV']
+PASSES = 4
+
+SETTINGS = '''#include <stdint.h>
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define DERIVED_IN_PRESSURE 0
+#define DERIVED_IN_TEMPERATURE 1
+#define DERIVED_IN_HUMIDITY 2
+typedef struct { int32_t input[3]; } DerivedGraph;
+typedef struct { uint8_t direction; uint16_t raw; } WindState;
+typedef struct { uint16_t sunlevel; } SunAngles;
+extern DerivedGraph Derived;
+extern WindState Wind;
+extern SunAngles SUN;
+uint32_t Timer_ms(void);
+#include "History.h"
+'''
+
+# Reads one line per pass ("time p t rh raw direction sun"), then "end"; prints the store, the
+# bits of every channel block and every retained value by sequential decoding and random access.
+HARNESS = '''#include <stdio.h>
+#include <stdlib.h>
+#include "History.c"
+
+DerivedGraph Derived;
+WindState Wind;
+SunAngles SUN;
+static uint32_t now;
+
+uint32_t Timer_ms(void) { return now; }
+
+int main(int argc, char **argv) {
+    long p, t, rh;
+    unsigned long time;
+    unsigned raw, direction, sun;
+    unsigned long bits[HISTORY_CHANNELS] = {0};
+    srand(atoi(argv[1]));
+    while (scanf("%lu %ld %ld %ld %u %u %u", &time, &p, &t, &rh, &raw, &direction, &sun) == 7) {
+        now = time;
+        Derived.input[0] = p;
+        Derived.input[1] = t;
+        Derived.input[2] = rh;
+        Wind.raw = raw;
+        Wind.direction = direction;
+        SUN.sunlevel = sun;
+        History_Task();
+    }
+    uint32_t oldest = HISTORY_OLDEST();
+    printf("store %lu %lu %u %u %u %lu\\n", (unsigned long)History.minutes, (unsigned long)oldest, History.groups,
+           History.used, History.count, (unsigned long)History.dropped);
+    for (uint8_t g = 0; g < History.groups; g++) {
+        uint16_t bit = History.index[(History.head + g) % HISTORY_GROUPS] * 8;
+        for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+            HistoryReader r;
+            uint16_t start = bit;
+            History_Header(&bit, ch, &r);
+            r.bit = bit;
+            for (r.left = HISTORY_BLOCK - 1; r.left; )
+                History_Code(&r);
+            bit = r.bit;
+            bits[ch] += (bit + HISTORY_POOL_BITS - start) % HISTORY_POOL_BITS;
+        }
+    }
+    printf("bits");
+    for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++)
+        printf(" %lu", bits[ch]);
+    printf("\\n");
+    for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+        HistoryReader r;
+        uint16_t v;
+        History_Seek(&r, ch, oldest);
+        printf("seq");
+        while (History_Next(&r, &v))
+            printf(" %u", v);
+        printf("\\nrandom");
+        for (int i = 0; i < 300 && History.minutes > oldest; i++) {
+            uint32_t m = oldest + rand() % (History.minutes - oldest);
+            printf(" %lu:%u", (unsigned long)m, History_Read(ch, m, &v) ? v : 65535);
+        }
+        printf("\\n");
+    }
+    return 0;
+}
+'''
+
+
+def run(command, **kwargs):
+    result = subprocess.run(command, capture_output=True, text=True, **kwargs)
+    if result.returncode:
+        sys.exit('%s\n%s%s' % (' '.join(command), result.stdout, result.stderr))
+    return result.stdout
+
+
+def quantisation():
+    """[(offset, divisor, bits, mode)] per channel, from HistoryVar.h."""
+    text = open(os.path.join(PROJECT, 'HistoryVar.h'), encoding='latin-1').read()
+    table = []
+    for name in CHANNELS:
+        m = re.search(r'\[HISTORY_%s\]\s*=\s*\{\s*\.offset = (\d+),\s*\.divisor = (\d+),\s*\.bits = (\d+),'
+                      r'\s*\.mode = HISTORY_(\w+)' % name, text)
+        table.append((int(m.group(1)), int(m.group(2)), int(m.group(3)), m.group(4)))
+    blocks = {k: int(v) for k, v in re.findall(r'#define HISTORY_(\w+) (\d+)',
+                                                open(os.path.join(PROJECT, 'History.h'), encoding='latin-1').read())}
+    return table, blocks
+
+
+def synthetic(rng, kind, minutes):
+    """Minute rows in physical units of days of one kind of weather."""
+    rows = []
+    trend = {'calm': 0.05, 'variable': -0.2, 'front': -0.5}[kind] / 60  # hPa per hour
+    wind = {'calm': 1.5, 'variable': 6.0, 'front': 9.0}[kind]
+    cloud, walk, t_noise, w_noise, prevailing = 1.0, 0.0, 0.0, 0.0, rng.randrange(8)
+    direction = prevailing
+    for m in range(minutes):
+        h = m % 1440 / 60.0
+        walk += rng.gauss(0, 0.01)
+        p = 1008 + trend * m + 0.6 * math.sin(2 * math.pi * h / 12) + walk + rng.gauss(0, 0.015)
+        if kind == 'front' and h > 14:
+            p += 3 * (1 - math.exp(-(h - 14) / 2))
+        t_noise = 0.97 * t_noise + rng.gauss(0, 0.05)
+        t = 9 + 6 * math.sin(2 * math.pi * (h - 9) / 24) + t_noise + rng.gauss(0, 0.01)
+        if kind == 'front' and h > 14:
+            t -= 5 * (1 - math.exp(-(h - 14)))
+        rh = max(15, min(100, 75 - 3 * (t - 9) + 4 * t_noise + rng.gauss(0, 0.1)))
+        w_noise = 0.9 * w_noise + rng.gauss(0, 0.35 * wind / 3)
+        speed = max(0.0, wind * (0.7 + 0.3 * math.sin(2 * math.pi * (h - 6) / 24)) + w_noise)
+        gust = speed + abs(rng.gauss(0, 0.3 * speed + 0.2)) + 0.5 * (speed > 0.5)
+        if rng.random() < (0.3 if speed < 2 else 0.08):
+            direction = (direction + rng.choice((-1, 1))) % 8
+        if rng.random() < 0.02:
+            direction = prevailing
+        elevation = math.sin(math.pi * (h - 6) / 12) if 6 < h < 18 else 0
+        if kind != 'calm' and rng.random() < {'variable': 0.15, 'front': 0.05}[kind]:
+            cloud = rng.choice((1.0, 0.7, 0.35, 0.2))
+        sun = 950 * elevation * cloud + (rng.gauss(0, 3) if elevation else 0)
+        rows.append([p, t, rh, min(speed, 29.9), min(gust, 29.9), direction, max(0, sun)])
+    return rows
+
+
+def recorded(path):
+    with open(path, newline='') as source:
+        return [[float(row[c]) for c in COLUMNS] for row in csv.DictReader(source)]
+
+
+def raw_count(speed):
+    return max(0, min(4095, int(round(speed / 30.0 * 4096))))
+
+
+def passes(rows):
+    """Main loop passes, PASSES per minute: (time, pressure, temperature, humidity, wind raw, direction,
+    sun) in History_Input() units, jittered around the minute values; the gust comes on one pass."""
+    out = []
+    for m, row in enumerate(rows):
+        p, t, rh, speed, gust, direction, sun = row
+        for k in range(PASSES):
+            j = (-1, 1, 0, 1)[k]
+            raw = raw_count(gust) if k == 1 else max(0, raw_count(speed) + 5 * j)
+            out.append((m * 60000 + k * 15000, round(p * 100) + j, round(t * 100) - j, round(rh * 10) + j, raw,
+                        int(direction), max(0, round(sun) + 2 * j)))
+    return out
+
+
+def reference(pass_list, table):
+    """Stored values per channel: the minute reduction of History_Task() on the same passes."""
+    stored = [[] for _ in CHANNELS]
+    for m in range(0, len(pass_list), PASSES):
+        minute = pass_list[m:m + PASSES]
+        for ch, (offset, divisor, bits, mode) in enumerate(table):
+            column = 4 if ch in (3, 4) else ch + 1 - (ch > 4)
+            x = [max(0, (v[column] * 3000 >> 12 if column == 4 else v[column]) + offset) for v in minute]
+            v = {'MEAN': (sum(x) + len(x) // 2) // len(x), 'MAX': max(x), 'LAST': x[-1]}[mode]
+            stored[ch].append(min((v + divisor // 2) // divisor, (1 << bits) - 1))
+    return stored
+
+
+def harness_input(pass_list):
+    lines = ['%d %d %d %d %d %d %d' % v for v in pass_list]
+    lines.append('%d 0 0 0 0 0 0' % (pass_list[-1][0] // 60000 * 60000 + 60000))  # Closes the last minute
+    return '\n'.join(lines) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--cc', default='cc', help='host C compiler')
+    parser.add_argument('--trace', help='recorded minute trace (CSV), instead of synthetic days')
+    parser.add_argument('--days', type=int, default=2, help='synthetic days per weather kind')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    table, config = quantisation()
+    if sum(bits for _, _, bits, _ in table) != config['ROW_BITS']:
+        sys.exit('History.h: HISTORY_ROW_BITS is not the sum of the channel bits in HistoryVar.h')
+    if args.trace:
+        traces = [(os.path.basename(args.trace), recorded(args.trace))]
+    else:
+        rng = random.Random(args.seed)
+        traces = [(kind, synthetic(rng, kind, args.days * 1440)) for kind in ('calm', 'variable', 'front')]
+
+    work = tempfile.mkdtemp(prefix='history_compression')
+    try:
+        for name in ('History.c', 'History.h', 'HistoryVar.h'):
+            shutil.copy(os.path.join(PROJECT, name), work)
+        open(os.path.join(work, 'Settings.h'), 'w').write(SETTINGS)
+        open(os.path.join(work, 'harness.c'), 'w').write(HARNESS)
+        binary = os.path.join(work, 'harness')
+        run([args.cc, '-O2', '-std=gnu99', '-Wall', '-funsigned-char', '-I', work, os.path.join(work, 'harness.c'),
+             '-o', binary])
+        pass_lists = [passes(rows) for _, rows in traces]
+        outputs = [run([binary, str(args.seed)], input=harness_input(p)) for p in pass_lists]
+    finally:
+        shutil.rmtree(work)
+
+    block, pool, groups = config['BLOCK'], config['POOL_SIZE'], config['GROUPS']
+    ram = pool + 2 * groups + 4 + config['ROW_BITS'] * block // 8 + 1 + 16 + 4 * len(CHANNELS) + 2
+    print('pool %d B, block %d minutes, index %d groups; store %d B of SRAM (%d B per day raw)'
+          % (pool, block, groups, ram, 2 * len(CHANNELS) * 1440))
+    print()
+    print('%-22s %8s %7s %7s %8s' % ('trace', 'minutes', 'hours', 'B/smp', 'errors') + ''.join(
+        ' %8s' % c.lower()[:8] for c in CHANNELS))
+    failed = 0
+    for (name, rows), pass_list, output in zip(traces, pass_lists, outputs):
+        lines = output.split('\n')
+        minutes, oldest, stored_groups, used, count, dropped = map(int, lines[0].split()[1:])
+        bits = list(map(int, lines[1].split()[1:]))
+        expected = reference(pass_list, table)
+        errors = 0
+        for ch in range(len(CHANNELS)):
+            seq = list(map(int, lines[2 + 2 * ch].split()[1:]))
+            errors += sum(a != b for a, b in zip(seq, expected[ch][oldest:])) + abs(len(seq) - (minutes - oldest))
+            for item in lines[3 + 2 * ch].split()[1:]:
+                m, v = map(int, item.split(':'))
+                errors += v != expected[ch][m]
+        errors += minutes != len(rows)
+        failed += errors
+        packed = stored_groups * block
+        per_channel = [b / 8.0 / packed if packed else 0 for b in bits]
+        total = used / float(packed * len(CHANNELS)) if packed else 0
+        hours = (minutes - oldest) / 60.0
+        print('%-22s %8d %7.1f %7.3f %8d' % (name[:22], minutes, hours, total, errors)
+              + ''.join(' %8.3f' % b for b in per_channel))
+    print()
+    print('B/smp: pool bytes per stored sample (raw minute values take 2 B); per channel columns count the')
+    print('channel blocks alone; hours: history held when the trace ends (the pool fills after that long)')
+    if failed:
+        sys.exit('round trip errors')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,384 @@
+#!/usr/bin/env python3
+"""
+loop_benchmark.py - end-to-end main loop benchmark with simulated buses and sensors.
+
+Builds the whole firmware with the host C compiler against the simulated AVR64DD32 peripherals
+in tools/loop_benchmark/ (TWI0 with the BMP280, SHT21, TCA9548A and ST7567S behind it, USART0,
+USART1 fed by a simulated clock device and GNSS receiver, ADC0, the TCB0 tick and the EEPROM) and runs main() for a given
+simulated time. Simulated time advances with the bus model (SCL rate, baud rates, ADC and
+sensor conversion times), with delays and interrupts, and with the host time of the firmware's
+own computation scaled by --ratio (AVR run time per host run time of the same code). The build
+defines UNITS_CHECKED: a fixed-point unit conversion or operation (Units.h) that overflows stops
+the run with its file and line.
+
+Every function the main loop calls is wrapped (ld --wrap, so Linux/GNU ld only) and its time is
+split into computation, interrupts and waiting per bus. The computation figures are an estimate
+that scales with --ratio; the waits come from the bus model and do not depend on it.
+
+  python3 tools/loop_benchmark.py
+  python3 tools/loop_benchmark.py --seconds 30 --scl 400000 --conversion max
+  python3 tools/loop_benchmark.py --clock-period-ms 100 --ratio 600
+  python3 tools/loop_benchmark.py --seconds 2 --bus-log bus.log && python3 tools/bus_analyzer.py --sim bus.log
+  python3 tools/loop_benchmark.py --seconds 1 --rx0 traffic.txt --bus-log bus.log
+  python3 tools/loop_benchmark.py --seconds 90 --clock-period-ms 100 --clock-outage 1000 80000
+  python3 tools/loop_benchmark.py --seconds 20 --clock-period-ms 100 --eeprom eeprom.bin
+  python3 tools/loop_benchmark.py --seconds 30 --clock-period-ms 100 --rx0 stat.txt --tx0 console.txt
+
+--rx0 feeds USART0 from a script, one message per line: the time in ms after the start of the
+measurement, then bytes in hex, "quoted text" with C escapes, `modbus` (appends the Modbus CRC of
+the line) and `ccitt` (appends the CRC-16/CCITT of a binary frame from its command byte on). The
+bytes of a line follow each other back to back, a line starts when the previous one has ended.
+
+  100 "stat\\r"
+  120 01 04 00 00 00 04 modbus
+  140 A5 5A 02 00 ccitt
+
+--tx0 keeps the bytes the firmware sends on USART0 during the measurement (console replies,
+records) in a file. `stat` on the console reports the firmware's own figures, among them the
+longest display flush and the longest sensor probe delay in simulated time.
+
+-D defines a macro for the firmware build, like the compiler option; with -D DEBUG_LOG_ENABLE=1
+the debug log records go out on USART0 and tools/debuglog.py formats them from the --tx0
+capture with the strings of the --elf executable:
+
+  python3 tools/loop_benchmark.py -D DEBUG_LOG_ENABLE=1 --elf loop.elf --tx0 console.bin
+  python3 tools/debuglog.py loop.elf console.bin
+
+--clock-outage silences the clock device between two times (ms after the start of the
+measurement). The GNSS receiver is heard instead of the clock device while the firmware selects
+it (PIN_GNSS_SELECT high): RMC, GGA and ZDA sentences at every whole second, for the clock
+device's place.
+
+--eeprom keeps the EEPROM (the event log) in a file, so consecutive runs see the records of the
+earlier ones like restarts of the station do; without it every run starts with an erased EEPROM.
+"""
+
+import argparse
+import bisect
+import codecs
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+PROJECT = os.path.join(TOOLS, '..', 'AVR64dd32 meteorologine stotele v3')
+SIMULATION = os.path.join(TOOLS, 'loop_benchmark')
+F_CPU = 24e6
+
+FLAGS = ['-std=gnu99', '-O2', '-w', '-funsigned-char', '-funsigned-bitfields', '-fshort-enums',
+         '-U_FORTIFY_SOURCE', '-D_FORTIFY_SOURCE=0', '-DUNITS_CHECKED']
+KEYWORDS = {'if', 'while', 'for', 'switch', 'return', 'sizeof', 'defined'}
+COLUMNS = [('compute', 'compute'), ('isr', 'ISR'), ('twi', 'TWI'), ('usart0', 'USART0'), ('usart1', 'USART1'),
+           ('adc', 'ADC'), ('delay', 'delay'), ('spin', 'other')]
+
+
+def run(command, **kwargs):
+    result = subprocess.run(command, capture_output=True, text=True, **kwargs)
+    if result.returncode:
+        sys.exit('%s\n%s%s' % (' '.join(command), result.stdout, result.stderr))
+    return result.stdout
+
+
+def strip_comments(text):
+    return re.sub(r'/\*.*?\*/|//[^\n]*', '', text, flags=re.S)
+
+
+def balanced(text, i, opening, closing):
+    """Index just past the bracket matching the one at text[i]."""
+    level = 0
+    for j in range(i, len(text)):
+        if text[j] == opening:
+            level += 1
+        elif text[j] == closing:
+            level -= 1
+            if not level:
+                return j + 1
+    raise ValueError('unbalanced %s' % opening)
+
+
+def spin_loops(text):
+    """Gives empty polling loops `while (cond);` a body so waiting on RAM flags advances simulated time."""
+    out, i = [], 0
+    for m in re.finditer(r'\bwhile\s*\(', text):
+        if m.start() < i:
+            continue
+        before = text[:m.start()].rstrip()
+        end = balanced(text, m.end() - 1, '(', ')')
+        rest = re.match(r'\s*;', text[end:])
+        if rest and not before.endswith('}'):  # Not the tail of a do-while
+            out.append(text[i:end] + ' sim_spin(__FILE__);')
+            i = end + rest.end()
+    return ''.join(out) + text[i:]
+
+
+def stages(main, settings):
+    """(name, return type, parameters) of the functions called by the main loop, in call order."""
+    main = strip_comments(main)
+    m = re.search(r'while\s*\(\s*1\s*\)\s*\{', main)
+    body = main[m.end() - 1:balanced(main, m.end() - 1, '{', '}')]
+    body = re.sub(r'#if\s+(\w+).*?#endif', '', body, flags=re.S)  # Optional (debug) code stays out
+    prototypes = {}
+    for p in re.finditer(r'^\s*([A-Za-z_][\w \*]*?)\s*\b(\w+)\s*\(([^;{}()]*)\)\s*;', strip_comments(settings), re.M):
+        prototypes.setdefault(p.group(2), (p.group(1).strip(), p.group(3).strip()))
+    found = []
+    for name in re.findall(r'\b([A-Za-z_]\w*)\s*\(', body):
+        if name not in KEYWORDS and name in prototypes and name not in [f[0] for f in found]:
+            found.append((name,) + prototypes[name])
+    return found
+
+
+def wrappers(found):
+    lines = ['#include "Settings.h"', '',
+             'int sim_stage_enter(int index);', 'void sim_stage_exit(int previous);',
+             'const int sim_stage_count = %d;' % len(found),
+             'const char *const sim_stage_names[] = { %s };' % ', '.join('"%s"' % f[0] for f in found), '']
+    for i, (name, result, parameters) in enumerate(found):
+        if parameters in ('', 'void'):
+            parameters, arguments = 'void', ''
+        else:
+            names = [re.findall(r'(\w+)\s*(?:\[\s*\w*\s*\])?$', p.strip())[0] for p in parameters.split(',')]
+            arguments = ', '.join(names)
+        call = '__real_%s(%s)' % (name, arguments)
+        lines.append('%s __real_%s(%s);' % (result, name, parameters))
+        lines.append('%s __wrap_%s(%s) {' % (result, name, parameters))
+        lines.append('    int previous = sim_stage_enter(%d);' % i)
+        if result == 'void':
+            lines += ['    %s;' % call, '    sim_stage_exit(previous);', '}', '']
+        else:
+            lines += ['    %s r = %s;' % (result, call), '    sim_stage_exit(previous);', '    return r;', '}', '']
+    return '\n'.join(lines)
+
+
+def build(cc, work, log=False, defines=()):
+    source = os.path.join(work, 'src')
+    os.mkdir(source)
+    for name in os.listdir(PROJECT):
+        if name.endswith(('.c', '.h')):
+            text = open(os.path.join(PROJECT, name), encoding='latin-1').read()
+            if name.endswith('.c'):
+                text = re.sub(r'\bUSART(\d)\.RXDATAL\b', r'sim_rxdata(\1)', spin_loops(text))
+            open(os.path.join(source, name), 'w', encoding='latin-1').write(text)
+    found = stages(open(os.path.join(source, 'main.c'), encoding='latin-1').read(),
+                   open(os.path.join(source, 'Settings.h'), encoding='latin-1').read())
+    open(os.path.join(work, 'stages.c'), 'w').write(wrappers(found))
+
+    includes = ['-I', SIMULATION, '-I', source, '-include', os.path.join(SIMULATION, 'sim.h')]
+    objects = []
+    for name in sorted(os.listdir(source)) + ['stages.c']:
+        if not name.endswith('.c'):
+            continue
+        path = os.path.join(source if name != 'stages.c' else work, name)
+        obj = os.path.join(work, name[:-2] + '.o')
+        extra = ['-D' + d for d in defines] + (['-Dmain=firmware_main'] if name == 'main.c' else [])
+        if log:
+            extra.append('-fno-inline')  # Every function shows up in the bus log call chains
+        run([cc] + FLAGS + includes + extra + ['-c', path, '-o', obj])
+        objects.append(obj)
+    sim = os.path.join(work, 'sim.o')
+    run([cc, '-std=gnu99', '-O2', '-Wall', '-I', SIMULATION, '-I', source, '-c', os.path.join(SIMULATION, 'sim.c'),
+         '-o', sim])  # GPIO.h: the pin map
+    binary = os.path.join(work, 'loop')
+    run([cc] + objects + [sim, '-o', binary, '-no-pie', '-lm'] + ['-Wl,--wrap=%s' % f[0] for f in found])
+    return binary
+
+
+def symbols(path):
+    """Sorted (address, name) of the functions in an object or executable."""
+    table = []
+    for line in run(['nm', '-n', '--defined-only', path]).splitlines():
+        words = line.split()
+        if len(words) == 3 and words[1] in 'tT':
+            table.append((int(words[0], 16), words[2]))
+    return table
+
+
+def resolve_log(binary, work, raw, path):
+    """Writes the bus log with the call chains as firmware function names, innermost first."""
+    table = symbols(binary)
+    simulation = {name for _, name in symbols(os.path.join(work, 'sim.o'))}
+    starts = [a for a, _ in table]
+    cache = {}
+
+    def name(address):
+        i = bisect.bisect_right(starts, address - 1) - 1  # Return addresses point past the call
+        return table[i][1] if i >= 0 else '?'
+
+    def chain(text):
+        if text not in cache:
+            names = []
+            for word in text.split(','):
+                if word == '-':
+                    continue
+                n = name(int(word, 16))
+                if n in simulation or n.startswith(('__wrap_', '_start', '__libc')) or n == '?':
+                    continue
+                n = n.replace('__real_', '').replace('firmware_main', 'main')
+                if n.startswith('sim_vector_'):
+                    n = 'ISR(%s_vect)' % n[len('sim_vector_'):]
+                names.append(n)
+                if n == 'main':
+                    break
+            cache[text] = '<'.join(names) or '-'
+        return cache[text]
+
+    with open(raw) as source, open(path, 'w') as out:
+        for line in source:
+            words = line.split()
+            if words[0] != '#':
+                words[-1] = chain(words[-1])
+            out.write(' '.join(words) + '\n')
+
+
+def crc16(data, polynomial, crc, reflected):
+    for byte in data:
+        if reflected:
+            crc ^= byte
+            for _ in range(8):
+                crc = (crc >> 1) ^ polynomial if crc & 1 else crc >> 1
+        else:
+            crc ^= byte << 8
+            for _ in range(8):
+                crc = ((crc << 1) ^ polynomial if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def rx_script(path):
+    """The --rx0 script as the simulation reads it: lines of "time_us hh hh ..."."""
+    lines = []
+    for number, line in enumerate(open(path, encoding='latin-1'), 1):
+        if line.lstrip().startswith('#'):
+            continue
+        items = re.findall(r'"((?:[^"\\]|\\.)*)"|(\S+)', line)
+        if not items:
+            continue
+        try:
+            ms = float(items[0][1])
+            data = []
+            for text, word in items[1:]:
+                if not word:
+                    data += codecs.decode(text, 'unicode_escape').encode('latin-1')
+                elif word == 'modbus':
+                    crc = crc16(data, 0xA001, 0xFFFF, True)
+                    data += [crc & 0xFF, crc >> 8]
+                elif word == 'ccitt':
+                    crc = crc16(data[2:], 0x1021, 0xFFFF, False)
+                    data += [crc >> 8, crc & 0xFF]
+                else:
+                    data.append(int(word, 16) & 0xFF)
+        except ValueError:
+            sys.exit('%s:%d: cannot read %r' % (path, number, line.strip()))
+        lines.append('%.0f %s\n' % (ms * 1000, ' '.join('%02x' % b for b in data)))
+    return ''.join(lines)
+
+
+def report(output):
+    stage, bus, devices = [], {}, []
+    for line in output.splitlines():
+        words = line.split()
+        if words[0] == 'config':
+            seconds, ratio, scl, baud0, baud1 = map(float, words[1:])
+        elif words[0] == 'window':
+            window, iterations = int(words[1]), int(words[2])
+        elif words[0] == 'stage':
+            stage.append((words[1], int(words[2]), list(map(int, words[3:]))))
+        elif words[0] == 'bus':
+            bus[words[1]] = (int(words[2]), int(words[3]))
+        elif words[0] == 'device':
+            devices.append((' '.join(words[1:-1]), int(words[-1])))
+        elif words[0] == 'interruptions':
+            interruptions, interrupted = int(words[1]), float(words[2])
+
+    seconds = window / F_CPU
+    print('simulated %.1f s: SCL %.0f kHz, USART0 %.0f kbit/s, USART1 %.0f kbit/s, compute ratio %g'
+          % (seconds, scl / 1e3, baud0 / 1e3, baud1 / 1e3, ratio))
+    print('%d loop passes, %.1f per second, %.3f ms per pass' % (iterations, iterations / seconds,
+                                                              1e3 * seconds / max(iterations, 1)))
+    print()
+    print('time per loop pass (us):')
+    print('%-22s %7s' % ('stage', 'calls') + ''.join('%9s' % c[1] for c in COLUMNS) + '%10s %6s' % ('total', '%'))
+    totals = [0] * len(COLUMNS)
+    passes = max(iterations, 1)
+    for name, calls, cycles in stage:
+        if name == '(start-up)':
+            continue
+        total = sum(cycles)
+        totals = [a + b for a, b in zip(totals, cycles)]
+        print('%-22s %7d' % (name, calls) + ''.join('%9.1f' % (c / F_CPU * 1e6 / passes) for c in cycles)
+              + '%10.1f %6.1f' % (total / F_CPU * 1e6 / passes, 100.0 * total / max(window, 1)))
+    print('%-22s %7s' % ('total', '') + ''.join('%9.1f' % (c / F_CPU * 1e6 / passes) for c in totals)
+          + '%10.1f %6.1f' % (sum(totals) / F_CPU * 1e6 / passes, 100.0 * sum(totals) / max(window, 1)))
+    waits = sum(totals[2:])
+    print()
+    print('bus waits %.1f %%, delays included; computation %.1f %%; interrupts %.1f %%'
+          % (100.0 * waits / max(window, 1), 100.0 * totals[0] / max(window, 1), 100.0 * totals[1] / max(window, 1)))
+    for name, (count, extra) in sorted(bus.items()):
+        if name == 'twi':
+            print('TWI0: %d bytes, bus busy %.1f %%' % (count, 100.0 * extra / max(window, 1)))
+        elif name == 'adc':
+            print('ADC0: %d conversions' % count)
+        elif name == 'eeprom':
+            print('EEPROM: %d bytes written, %.1f ms waited' % (count, extra / F_CPU * 1e3))
+        else:
+            print('%s: %d bytes, %d overruns' % (name.upper(), count, extra))
+    print('I2C transactions: ' + ', '.join('%s %d' % d for d in devices))
+    startup = [s for s in stage if s[0] == '(start-up)'][0]
+    print('start-up: %.1f ms' % (sum(startup[2]) / F_CPU * 1e3))
+    print('host interruptions: %d, %.1f ms of computation not charged' % (interruptions, interrupted / F_CPU * 1e3))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--cc', default='cc', help='host C compiler')
+    parser.add_argument('--seconds', type=float, default=10, help='simulated time measured after start-up')
+    parser.add_argument('--ratio', type=float, default=400,
+                        help='AVR run time per host run time of the same code (scales computation only)')
+    parser.add_argument('--scl', type=float, default=0, help='SCL frequency in Hz (default: from TWI0.MBAUD)')
+    parser.add_argument('--baud0', type=float, default=0, help='USART0 bit rate (default: from USART0.BAUD)')
+    parser.add_argument('--baud1', type=float, default=0, help='USART1 bit rate (default: from USART1.BAUD)')
+    parser.add_argument('--conversion', choices=['typ', 'max'], default='typ', help='sensor conversion times')
+    parser.add_argument('--clock-period-ms', type=float, default=0,
+                        help='clock device frame period (default: frames back to back)')
+    parser.add_argument('--clock-outage', type=float, nargs=2, default=[0, 0], metavar=('FROM_MS', 'TO_MS'),
+                        help='clock device silent between these times after the start of the measurement')
+    parser.add_argument('--bus-log', metavar='FILE',
+                        help='also write every bus byte with the calling functions (for tools/bus_analyzer.py)')
+    parser.add_argument('--rx0', metavar='FILE', help='bytes received on USART0 (script, see above)')
+    parser.add_argument('--tx0', metavar='FILE', help='write the bytes sent on USART0 to this file')
+    parser.add_argument('-D', dest='define', action='append', default=[], metavar='NAME[=VALUE]',
+                        help='define a macro for the firmware build (repeatable)')
+    parser.add_argument('--elf', metavar='FILE', help='keep the simulator executable (for tools/debuglog.py)')
+    parser.add_argument('--eeprom', metavar='FILE',
+                        help='EEPROM image: loaded at start if it exists (else erased), saved at the end')
+    args = parser.parse_args()
+
+    work = tempfile.mkdtemp(prefix='loop_benchmark')
+    try:
+        binary = build(args.cc, work, args.bus_log, args.define)
+        raw = os.path.join(work, 'bus.log')
+        script = os.path.join(work, 'rx0.txt')
+        if args.rx0:
+            open(script, 'w').write(rx_script(args.rx0))
+        output = run([binary, '--seconds', str(args.seconds), '--ratio', str(args.ratio), '--scl', str(args.scl),
+                      '--baud0', str(args.baud0), '--baud1', str(args.baud1),
+                      '--maximum', '1' if args.conversion == 'max' else '0',
+                      '--clock-period-us', str(args.clock_period_ms * 1000),
+                      '--outage-from-us', str(args.clock_outage[0] * 1000),
+                      '--outage-to-us', str(args.clock_outage[1] * 1000)]
+                     + (['--bus-log', raw] if args.bus_log else [])
+                     + (['--rx0', script] if args.rx0 else [])
+                     + (['--tx0', os.path.abspath(args.tx0)] if args.tx0 else [])
+                     + (['--eeprom', os.path.abspath(args.eeprom)] if args.eeprom else []))
+        if args.bus_log:
+            resolve_log(binary, work, raw, args.bus_log)
+        if args.elf:
+            shutil.copy(binary, args.elf)
+    finally:
+        shutil.rmtree(work)
+    report(output)
+
+
+if __name__ == '__main__':
+    main()
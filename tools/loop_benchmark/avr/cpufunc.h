@@ -0,0 +1,7 @@
+/* avr/cpufunc.h - configuration change protection is not simulated */
+#ifndef SIM_AVR_CPUFUNC_H
+#define SIM_AVR_CPUFUNC_H
+#include <stdint.h>
+static inline void ccp_write_io(void *address, uint8_t value) { *(volatile uint8_t *)address = value; }
+#define _NOP()
+#endif
@@ -0,0 +1,12 @@
+/* avr/eeprom.h - EEPROM of the simulation; addresses are offsets into it, writes keep it busy */
+#ifndef SIM_AVR_EEPROM_H
+#define SIM_AVR_EEPROM_H
+#include <stddef.h>
+#include <stdint.h>
+int eeprom_is_ready(void);
+uint8_t eeprom_read_byte(const uint8_t *address);
+void eeprom_read_block(void *destination, const void *source, size_t size);
+void eeprom_write_byte(uint8_t *address, uint8_t value);
+void eeprom_update_byte(uint8_t *address, uint8_t value);
+#define eeprom_busy_wait() do { } while (!eeprom_is_ready())
+#endif
@@ -0,0 +1,8 @@
+/* avr/interrupt.h - interrupt stand-in for tools/loop_benchmark.py: the simulation calls the vectors */
+#ifndef SIM_AVR_INTERRUPT_H
+#define SIM_AVR_INTERRUPT_H
+void sim_interrupts(int on);
+#define ISR(vector) void vector(void)
+#define sei() sim_interrupts(1)
+#define cli() sim_interrupts(0)
+#endif
@@ -0,0 +1,223 @@
+/*
+ * avr/io.h - AVR64DD32 register stand-in for tools/loop_benchmark.py.
+ *
+ * Peripherals the benchmark simulates (TWI0, USART0/1, ADC0, TCB0) are reached through
+ * accessor functions, so every register access lets the simulation catch up: time passes,
+ * transfers complete and interrupts are delivered. Registers the firmware writes to start
+ * something are 16 bits wide here; the simulation keeps SIM_MARK in the upper byte of the
+ * values it stores, so any firmware write (an 8-bit value) is recognised on the next access.
+ * The other peripherals are plain variables. Bit values are those of the AVR64DD32.
+ */
+
+#ifndef SIM_AVR_IO_H
+#define SIM_AVR_IO_H
+
+#include <stdint.h>
+
+typedef volatile uint8_t register8_t;
+typedef volatile uint16_t register16_t;
+
+#define SIM_MARK 0x100 /**< Set in every register value written by the simulation */
+
+typedef struct {
+    register8_t CTRLA, DUALCTRL, DBGCTRL, MCTRLA;
+    register16_t MCTRLB, MSTATUS;
+    register8_t MBAUD;
+    register16_t MADDR, MDATA;
+} TWI_t;
+
+typedef struct {
+    register8_t RXDATAL, RXDATAH;
+    register16_t TXDATAL;
+    register8_t TXDATAH;
+    register16_t STATUS;
+    register8_t CTRLA, CTRLB, CTRLC, CTRLD, DBGCTRL, EVCTRL, TXPLCTRL, RXPLCTRL;
+    register16_t BAUD;
+} USART_t;
+
+typedef struct {
+    register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLE, SAMPCTRL, MUXPOS, MUXNEG;
+    register16_t COMMAND;
+    register8_t EVCTRL, INTCTRL;
+    register16_t INTFLAGS;
+    register8_t DBGCTRL, TEMP;
+    register16_t RES, WINLT, WINHT;
+} ADC_t;
+
+typedef struct {
+    register8_t CTRLA, CTRLB, CTRLC, CTRLD, EVCTRL, INTCTRL;
+    register16_t INTFLAGS;
+    register8_t STATUS, DBGCTRL, TEMP;
+    register16_t CNT, CCMP;
+} TCB_t;
+
+typedef struct {
+    struct {
+        register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLECLR, CTRLESET, INTCTRL, INTFLAGS;
+        register16_t CNT, PER, CMP0, CMP1, CMP2;
+    } SINGLE;
+} TCA_t;
+
+typedef struct {
+    register8_t DIR, DIRSET, DIRCLR, DIRTGL, OUT, OUTSET, OUTCLR, OUTTGL, IN, INTFLAGS, PORTCTRL;
+    register8_t PINCONFIG, PINCTRLUPD, PINCTRLSET, PINCTRLCLR;
+    register8_t PIN0CTRL, PIN1CTRL, PIN2CTRL, PIN3CTRL, PIN4CTRL, PIN5CTRL, PIN6CTRL, PIN7CTRL;
+} PORT_t;
+
+typedef struct { register8_t DIR, OUT, IN, INTFLAGS; } VPORT_t;
+typedef struct { register8_t ADC0REF, DAC0REF, ACREF; } VREF_t;
+typedef struct { register8_t MCLKCTRLA, MCLKCTRLB, MCLKSTATUS, XOSCHFCTRLA, OSCHFCTRLA; } CLKCTRL_t;
+typedef struct { register8_t EVSYSROUTEA, CCLROUTEA, USARTROUTEA, SPIROUTEA, TWIROUTEA, TCAROUTEA, TCBROUTEA; } PORTMUX_t;
+typedef struct { register8_t CHANNEL0, CHANNEL1, CHANNEL2, CHANNEL3, CHANNEL4, CHANNEL5; register8_t USERTCB0CAPT, USERTCB1CAPT, USERTCB2CAPT; } EVSYS_t;
+typedef struct { register8_t CTRLA, STATUS, LVL0PRI, LVL1VEC; } CPUINT_t;
+typedef struct { register8_t CTRLA, CTRLB, STATUS, INTCTRL, INTFLAGS; register16_t DATA, ADDR; } NVMCTRL_t;
+typedef struct { register8_t RSTFR, SWRR; } RSTCTRL_t;
+
+/** @name Simulated peripherals */
+///@{
+TWI_t *sim_twi0(void);
+USART_t *sim_usart(uint8_t n);
+ADC_t *sim_adc0(void);
+TCB_t *sim_tcb0(void);
+#define TWI0 (*sim_twi0())
+#define USART0 (*sim_usart(0))
+#define USART1 (*sim_usart(1))
+#define ADC0 (*sim_adc0())
+#define TCB0 (*sim_tcb0())
+///@}
+
+/** Status register: only the global interrupt flag, as set by sei()/cli() and atomic blocks */
+uint8_t sim_sreg(void);
+#define SREG sim_sreg()
+#define CPU_I_bm 0x80
+
+extern TCB_t TCB1, TCB2;
+extern TCA_t TCA0;
+extern PORT_t PORTA, PORTC, PORTD, PORTF;
+extern VPORT_t VPORTA, VPORTC, VPORTD, VPORTF;
+extern VREF_t VREF;
+extern CLKCTRL_t CLKCTRL;
+extern PORTMUX_t PORTMUX;
+extern EVSYS_t EVSYS;
+extern CPUINT_t CPUINT;
+extern NVMCTRL_t NVMCTRL;
+extern RSTCTRL_t RSTCTRL;
+
+#define PIN0_bm 0x01
+#define PIN1_bm 0x02
+#define PIN2_bm 0x04
+#define PIN3_bm 0x08
+#define PIN4_bm 0x10
+#define PIN5_bm 0x20
+#define PIN6_bm 0x40
+#define PIN7_bm 0x80
+#define PIN0_bp 0
+#define PIN1_bp 1
+#define PIN2_bp 2
+#define PIN3_bp 3
+#define PIN4_bp 4
+#define PIN5_bp 5
+#define PIN6_bp 6
+#define PIN7_bp 7
+
+#define TWI_SDAHOLD_OFF_gc 0x00
+#define TWI_SDASETUP_4CYC_gc 0x00
+#define TWI_FMPEN_ON_gc 0x02
+#define TWI_ENABLE_bm 0x01
+#define TWI_MCMD_gm 0x03
+#define TWI_MCMD_RECVTRANS_gc 0x02
+#define TWI_MCMD_STOP_gc 0x03
+#define TWI_ACKACT_NACK_gc 0x04
+#define TWI_RIF_bm 0x80
+#define TWI_WIF_bm 0x40
+#define TWI_CLKHOLD_bm 0x20
+#define TWI_RXACK_bm 0x10
+#define TWI_ARBLOST_bm 0x08
+#define TWI_BUSERR_bm 0x04
+#define TWI_BUSSTATE_IDLE_gc 0x01
+
+#define USART_RXCIF_bm 0x80
+#define USART_TXCIF_bm 0x40
+#define USART_DREIF_bm 0x20
+#define USART_DREIE_bm 0x20
+#define USART_RXCIE_bm 0x80
+#define USART_BUFOVF_bm 0x40
+#define USART_FERR_bm 0x04
+#define USART_PERR_bm 0x02
+#define USART_RXEN_bm 0x80
+#define USART_TXEN_bm 0x40
+#define USART_RXMODE_gm 0x06
+#define USART_RXMODE_CLK2X_gc 0x02
+#define USART_CMODE_ASYNCHRONOUS_gc 0x00
+#define USART_CHSIZE_8BIT_gc 0x03
+#define USART_PMODE_DISABLED_gc 0x00
+#define USART_SBMODE_1BIT_gc 0x00
+
+#define ADC_ENABLE_bm 0x01
+#define ADC_RESSEL_12BIT_gc 0x00
+#define ADC_SAMPNUM_gm 0x0F
+#define ADC_SAMPNUM_ACC1_gc 0x00
+#define ADC_SAMPNUM_ACC4_gc 0x02
+#define ADC_SAMPNUM_ACC16_gc 0x04
+#define ADC_SAMPNUM_ACC64_gc 0x06
+#define ADC_SAMPNUM_ACC128_gc 0x07
+#define ADC_PRESC_gm 0x0F
+#define ADC_PRESC_DIV4_gc 0x01
+#define ADC_STCONV_bm 0x01
+#define ADC_RESRDY_bm 0x01
+#define ADC_MUXPOS_AIN26_gc 0x1A
+#define ADC_MUXPOS_AIN30_gc 0x1E
+#define ADC_MUXPOS_AIN31_gc 0x1F
+#define VREF_REFSEL_1V024_gc 0x00
+#define VREF_REFSEL_VDD_gc 0x05
+
+#define TCB_ENABLE_bm 0x01
+#define TCB_CLKSEL_DIV2_gc 0x02
+#define TCB_CLKSEL_TCA0_gc 0x04
+#define TCB_CNTMODE_INT_gc 0x00
+#define TCB_CNTMODE_PW_gc 0x04
+#define TCB_CAPT_bm 0x01
+#define TCB_OVF_bm 0x02
+#define TCB_CAPTEI_bm 0x01
+#define TCB_EDGE_bm 0x10
+#define TCA_SINGLE_ENABLE_bm 0x01
+#define TCA_SINGLE_CLKSEL_DIV64_gc 0x0A
+
+#define PORT_PULLUPEN_bm 0x08
+#define PORT_INVEN_bm 0x80
+#define PORT_ISC_gm 0x07
+#define PORT_ISC_INTDISABLE_gc 0x00
+#define PORT_ISC_FALLING_gc 0x03
+#define PORT_ISC_INPUT_DISABLE_gc 0x04
+#define PORTMUX_USART0_ALT1_gc 0x01
+#define PORTMUX_USART1_DEFAULT_gc 0x00
+#define PORTMUX_TWI0_DEFAULT_gc 0x00
+#define EVSYS_CHANNEL2_PORTD_PIN4_gc 0x4C
+#define EVSYS_USER_CHANNEL2_gc 0x03
+
+#define CLKCTRL_ENABLE_bm 0x01
+#define CLKCTRL_RUNSTDBY_bm 0x80
+#define CLKCTRL_CSUTHF_4K_gc 0x20
+#define CLKCTRL_FRQRANGE_24M_gc 0x08
+#define CLKCTRL_SELHF_XTAL_gc 0x00
+#define CLKCTRL_SELHF_EXTCLOCK_gc 0x02
+#define CLKCTRL_CLKSEL_EXTCLK_gc 0x03
+#define CLKCTRL_CLKOUT_bm 0x80
+#define CLKCTRL_PEN_bm 0x01
+#define CLKCTRL_PDIV_2X_gc 0x00
+#define CLKCTRL_SOSC_bm 0x01
+#define CLKCTRL_EXTS_bm 0x80
+#define RSTCTRL_SWRST_bm 0x01
+#define RSTCTRL_PORF_bm 0x01
+#define EEPROM_SIZE 256
+
+#define TCB0_INT_vect sim_vector_TCB0_INT
+#define TCB1_INT_vect sim_vector_TCB1_INT
+#define TCB2_INT_vect sim_vector_TCB2_INT
+#define TCB2_INT_vect_num 27
+#define USART0_DRE_vect sim_vector_USART0_DRE
+#define USART0_RXC_vect sim_vector_USART0_RXC
+#define USART1_RXC_vect sim_vector_USART1_RXC
+#define PORTD_PORT_vect sim_vector_PORTD_PORT
+
+#endif /* SIM_AVR_IO_H */
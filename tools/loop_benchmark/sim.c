@@ -0,0 +1,1262 @@
+/*
+ * sim.c - simulated AVR64DD32 peripherals, I2C devices and bus timing for tools/loop_benchmark.py.
+ *
+ * The firmware runs natively on the host. Simulated time (CPU cycles at F_CPU) advances in
+ * three ways:
+ *  - computation: the host time between two simulation hooks, scaled by --ratio (AVR run time
+ *    per host run time of the same C code), is charged to the running stage; stretches shorter
+ *    than SHORT_NS are charged their fastest run, as their host time is mostly noise, and so
+ *    are the rare long runs of a path that is nearly always short (the host was interrupted),
+ *  - waiting: every pass of a polling loop on a busy peripheral costs POLL_CYCLES and is charged
+ *    to that peripheral; _delay_ms/_delay_us are charged as delays,
+ *  - interrupts: vectors run when their flags are set and interrupts are enabled; their host
+ *    time plus ISR_CYCLES is charged as interrupt time of the stage they interrupted.
+ *
+ * Transfers take the time of the bus model: TWI bytes 9 SCL periods (start + address 10),
+ * USART bytes 10 bit times, ADC conversions 16 ADC clocks per accumulated sample, sensor
+ * conversions the datasheet times, EEPROM byte writes EEPROM_WRITE_US. The I2C devices answer like the real parts: the SHT21 does
+ * not acknowledge its address while converting, the BMP280 reports `measuring` in its status.
+ */
+
+#include <execinfo.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "avr/io.h"
+#include "GPIO.h"      /* Pin map of the firmware */
+
+#define F_CPU 24000000UL
+#define POLL_CYCLES 10   /**< One pass of a polling loop: load, test, timeout decrement, branch */
+#define ISR_CYCLES 30    /**< Interrupt entry, register saves and reti */
+#define STAGES_MAX 64
+#define SHORT_NS 1000    /**< Host time below which a stretch of code is timed by its fastest run */
+#define PATHS 4096
+#define INTERRUPT_RUNS 1000 /**< A path longer than SHORT_NS in fewer than 1 of this many runs was interrupted there */
+
+/** @name Time categories */
+///@{
+enum { CAT_COMPUTE, CAT_ISR, CAT_TWI, CAT_USART0, CAT_USART1, CAT_ADC, CAT_DELAY, CAT_SPIN, CATS };
+static const char *const categoryNames[CATS] = {
+    "compute", "isr", "twi", "usart0", "usart1", "adc", "delay", "spin"
+};
+///@}
+
+extern const char *const sim_stage_names[];
+extern const int sim_stage_count;
+int firmware_main(void);
+void sim_vector_TCB0_INT(void);
+void sim_vector_USART0_DRE(void);
+void sim_vector_USART0_RXC(void);
+void sim_vector_USART1_RXC(void);
+
+TCB_t TCB1, TCB2;
+TCA_t TCA0;
+PORT_t PORTA, PORTC, PORTD, PORTF;
+VPORT_t VPORTA, VPORTC, VPORTD, VPORTF;
+VREF_t VREF;
+CLKCTRL_t CLKCTRL;
+PORTMUX_t PORTMUX;
+EVSYS_t EVSYS;
+CPUINT_t CPUINT;
+NVMCTRL_t NVMCTRL;
+RSTCTRL_t RSTCTRL;
+
+static TWI_t twi0;
+static USART_t usart[2];
+static ADC_t adc0;
+static TCB_t tcb0;
+
+/* ------------------------------------------------------------------------------------------ */
+/* Configuration, time and accounting                                                           */
+
+static struct {
+    double seconds;       /**< Simulated time measured after start-up */
+    double ratio;         /**< AVR run time / host run time of the same code */
+    double scl;           /**< SCL frequency (Hz), 0: from TWI0.MBAUD */
+    double baud[2];       /**< USART bit rates, 0: from BAUD */
+    int maximum;          /**< 1: sensor conversions take the datasheet maximum, 0: typical */
+    double clockPeriodUs; /**< Clock device frame period, 0: frames back to back */
+    const char *rx0;      /**< USART0 input script, NULL: nothing is received */
+    FILE *tx0;            /**< --tx0: bytes sent on USART0 during the measurement, NULL: not kept */
+    double outageUs[2];   /**< Clock device silent from ... to (after the start of the measurement) */
+} config = { 10, 400, 0, { 0, 0 }, 0, 0, NULL, NULL, { 0, 0 } };
+
+static uint64_t now;              /**< Simulated time (CPU cycles) */
+static uint64_t start, end;       /**< Measurement window */
+static double cyclesPerNs;        /**< AVR cycles per host nanosecond of computation */
+static double overheadNs;         /**< Cost of one host clock read */
+static double hookFloorNs;        /**< Host time between two hooks with no firmware code in between */
+static double lastHost;           /**< Host time when the firmware got control back */
+static unsigned long interruptions; /**< Charged stretches of the measurement taken for host interruptions, see path_time() */
+static double interruptedNs;      /**< Host time of those stretches not charged */
+static double pendingNs;          /**< Host time the last path_time() did not charge */
+static int lastWasPoll;
+static int interruptsOn, inIsr, atomicDepth;
+static int stage, depth, started;
+static uint64_t cycles[STAGES_MAX + 2][CATS];
+static unsigned long calls[STAGES_MAX + 2];
+static unsigned long iterations;
+static jmp_buf finish;
+static uint32_t seed = 12345;
+static FILE *busLog;              /**< --bus-log: every byte on the buses, see bus_chain() */
+
+#define STAGE_MAIN (sim_stage_count)        /**< Main loop code between the stages */
+#define STAGE_STARTUP (sim_stage_count + 1) /**< Everything before the first loop pass */
+
+static double host_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static uint32_t noise(uint32_t range) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % range;
+}
+
+static uint64_t ms_cycles(double ms) {
+    return (uint64_t)(ms * (F_CPU / 1000));
+}
+
+/**
+ * Return addresses of the firmware code running now, innermost first, comma separated (the
+ * simulation's own frames are dropped later by loop_benchmark.py, which resolves the addresses).
+ */
+static void bus_chain(char *out, size_t size) {
+    void *frames[32];
+    int n = backtrace(frames, 32), length = 0;
+    out[0] = '-';
+    out[1] = 0;
+    for (int i = 1; i < n && length < (int)size - 20; i++)
+        length += snprintf(out + length, size - length, i > 1 ? ",%lx" : "%lx", (unsigned long)(uintptr_t)frames[i]);
+}
+
+/* ------------------------------------------------------------------------------------------ */
+/* I2C devices                                                                                  */
+
+typedef struct {
+    const char *name;
+    uint8_t address;
+    int (*start)(int read);  /**< (Repeated) start addressed to the device, 1 = ACK */
+    int (*write)(uint8_t b); /**< Byte written, 1 = ACK */
+    uint8_t (*read)(void);   /**< Next byte read */
+    unsigned long transactions;
+} Device;
+
+/* BMP280: datasheet example calibration and raw values (25.08 C, 1006.5 hPa) */
+static uint8_t bmp[256];
+static uint8_t bmpPointer;
+static int bmpFirst;
+static uint64_t bmpReady;
+static int32_t bmpRawP = 415148, bmpRawT = 519888;
+
+static void bmp_load(void) {
+    static const int16_t calibration[12] = { 27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000 };
+    for (int i = 0; i < 12; i++) {
+        bmp[0x88 + 2 * i] = (uint16_t)calibration[i] & 0xFF;
+        bmp[0x89 + 2 * i] = (uint16_t)calibration[i] >> 8;
+    }
+    bmp[0xF7] = bmpRawP >> 12;
+    bmp[0xF8] = bmpRawP >> 4;
+    bmp[0xF9] = (bmpRawP & 0x0F) << 4;
+    bmp[0xFA] = bmpRawT >> 12;
+    bmp[0xFB] = bmpRawT >> 4;
+    bmp[0xFC] = (bmpRawT & 0x0F) << 4;
+}
+
+static void bmp_reset(void) {
+    memset(bmp, 0, sizeof(bmp));
+    bmp[0xD0] = 0x58;
+    bmp_load();
+}
+
+static int bmp_start(int read) {
+    if (!read)
+        bmpFirst = 1;
+    return 1;
+}
+
+static int bmp_write(uint8_t b) {
+    if (bmpFirst) {
+        bmpPointer = b;
+        bmpFirst = 0;
+        return 1;
+    }
+    uint8_t r = bmpPointer++;
+    bmp[r] = b;
+    if (r == 0xE0 && b == 0xB6)
+        bmp_reset();
+    if (r == 0xF4 && ((b & 3) == 1 || (b & 3) == 2)) { // Forced mode conversion
+        static const int os[8] = { 0, 1, 2, 4, 8, 16, 16, 16 };
+        int ot = os[(b >> 5) & 7], op = os[(b >> 2) & 7];
+        double ms = config.maximum ? 1.25 + 2.3 * ot + (op ? 2.3 * op + 0.575 : 0) : 1 + 2 * ot + (op ? 2 * op + 0.5 : 0);
+        bmpReady = now + ms_cycles(ms);
+        bmp[0xF4] &= ~3; // Back to sleep when done
+        bmpRawP = 415148 + (int32_t)noise(41) - 20;
+        bmpRawT = 519888 + (int32_t)noise(21) - 10;
+        bmp_load();
+    }
+    return 1;
+}
+
+static uint8_t bmp_read(void) {
+    if (bmpPointer == 0xF3)
+        bmp[0xF3] = (now < bmpReady) ? 0x08 : 0x00;
+    return bmp[bmpPointer++];
+}
+
+/* SHT21: no-hold conversions; the address is not acknowledged until the result is ready */
+static uint8_t shtUser = 0x02, shtCommand, shtData[3];
+static int shtFirst, shtIndex, shtResult;
+static uint64_t shtReady;
+
+static uint8_t sht_crc(const uint8_t *data, int n) {
+    uint8_t crc = 0;
+    for (int i = 0; i < n; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+    }
+    return crc;
+}
+
+static void sht_convert(int humidity) {
+    static const double typT[4] = { 66, 17, 33, 9 }, maxT[4] = { 85, 22, 43, 11 };
+    static const double typRH[4] = { 22, 3, 7, 12 }, maxRH[4] = { 29, 4, 9, 15 };
+    int resolution = ((shtUser >> 6) & 2) | (shtUser & 1);
+    double ms = humidity ? (config.maximum ? maxRH : typRH)[resolution] : (config.maximum ? maxT : typT)[resolution];
+    double value = humidity ? (55.0 + 6) / 125 : (21.5 + 46.85) / 175.72;
+    uint16_t raw = ((uint16_t)(value * 65536) + noise(64)) & ~3;
+    shtData[0] = raw >> 8;
+    shtData[1] = (raw & 0xFC) | (humidity ? 2 : 0);
+    shtData[2] = sht_crc(shtData, 2);
+    shtReady = now + ms_cycles(ms);
+    shtResult = 1;
+}
+
+static int sht_start(int read) {
+    if (!read) {
+        shtFirst = 1;
+        return 1;
+    }
+    shtIndex = 0;
+    if (shtCommand == 0xE7)
+        return 1;
+    return shtResult && now >= shtReady;
+}
+
+static int sht_write(uint8_t b) {
+    if (!shtFirst) {
+        if (shtCommand == 0xE6)
+            shtUser = b;
+        return 1;
+    }
+    shtFirst = 0;
+    shtCommand = b;
+    if (b == 0xF3 || b == 0xE3)
+        sht_convert(0);
+    else if (b == 0xF5 || b == 0xE5)
+        sht_convert(1);
+    else if (b == 0xFE) {
+        shtUser = 0x02;
+        shtResult = 0;
+        shtReady = now + ms_cycles(15);
+    }
+    return 1;
+}
+
+static uint8_t sht_read(void) {
+    if (shtCommand == 0xE7)
+        return shtUser;
+    return shtIndex < 3 ? shtData[shtIndex++] : 0xFF;
+}
+
+/* TCA9548A multiplexer and ST7567S display: take whatever they are sent */
+static uint8_t muxChannels;
+static int accept_start(int read) { (void)read; return 1; }
+static int mux_write(uint8_t b) { muxChannels = b; return 1; }
+static uint8_t mux_read(void) { return muxChannels; }
+static int accept_write(uint8_t b) { (void)b; return 1; }
+static uint8_t accept_read(void) { return 0; }
+
+static Device devices[] = {
+    { "BMP280 0x76", 0x76, bmp_start, bmp_write, bmp_read, 0 },
+    { "SHT21 0x40", 0x40, sht_start, sht_write, sht_read, 0 },
+    { "TCA9548A 0x70", 0x70, accept_start, mux_write, mux_read, 0 },
+    { "ST7567S 0x3F", 0x3F, accept_start, accept_write, accept_read, 0 },
+};
+
+static Device *device_find(uint8_t address) {
+    for (unsigned i = 0; i < sizeof(devices) / sizeof(devices[0]); i++)
+        if (devices[i].address == address)
+            return &devices[i];
+    return NULL;
+}
+
+/* ------------------------------------------------------------------------------------------ */
+/* TWI0 master                                                                                  */
+
+enum { TWI_IDLE, TWI_ADDRESS, TWI_WRITE, TWI_READ };
+
+static struct {
+    int phase;             /**< Transfer in progress */
+    uint64_t done;         /**< Its end */
+    uint64_t busFree;      /**< End of the last STOP */
+    Device *device;        /**< Addressed device, NULL when nobody answered */
+    uint8_t address, data, status;
+    uint16_t storedAddress, storedData, storedStatus;
+    unsigned long bytes;   /**< Bytes on the bus, address bytes included */
+    uint64_t busy;         /**< Cycles the bus was transferring */
+    uint64_t start;        /**< Start of the transfer in progress */
+    char chain[512];       /**< Code that started it (bus log) */
+} twi;
+
+static uint64_t twi_bit(void) {
+    double scl = config.scl ? config.scl : (double)F_CPU / (10 + 2 * twi0.MBAUD);
+    return (uint64_t)(F_CPU / scl + 0.5);
+}
+
+static void twi_log(char kind, uint8_t value, char ack, uint64_t from, uint64_t to) {
+    if (busLog && started)
+        fprintf(busLog, "i2c %llu %llu %c %02x %c %s\n", (unsigned long long)from, (unsigned long long)to, kind, value,
+                ack, twi.chain);
+}
+
+static void twi_transfer(int phase, int bits, uint64_t from) {
+    twi.start = from;
+    twi.phase = phase;
+    twi.done = from + bits * twi_bit();
+    twi.busy += twi.done - from;
+    twi.bytes++;
+    twi.status &= ~(TWI_RIF_bm | TWI_WIF_bm | TWI_RXACK_bm | TWI_CLKHOLD_bm);
+}
+
+static void twi_event(void) {
+    int phase = twi.phase;
+    twi.phase = TWI_IDLE;
+    switch (phase) {
+        case TWI_ADDRESS: {
+            Device *d = device_find(twi.address >> 1);
+            twi.device = (d && d->start(twi.address & 1)) ? d : NULL;
+            twi_log('A', twi.address, twi.device ? 'A' : 'N', twi.start, now);
+            if (twi.device)
+                twi.device->transactions++;
+            if (!twi.device)
+                twi.status |= TWI_WIF_bm | TWI_RXACK_bm;
+            else if (twi.address & 1)
+                twi_transfer(TWI_READ, 9, now); // First byte follows the address
+            else
+                twi.status |= TWI_WIF_bm;
+            break;
+        }
+        case TWI_WRITE:
+            twi.status |= TWI_WIF_bm;
+            if (!twi.device || !twi.device->write(twi.data))
+                twi.status |= TWI_RXACK_bm;
+            twi_log('W', twi.data, (twi.status & TWI_RXACK_bm) ? 'N' : 'A', twi.start, now);
+            break;
+        case TWI_READ:
+            twi.data = twi.device ? twi.device->read() : 0xFF;
+            twi_log('R', twi.data, '-', twi.start, now);
+            twi0.MDATA = twi.storedData = SIM_MARK | twi.data;
+            twi.status |= TWI_RIF_bm | TWI_CLKHOLD_bm;
+            break;
+    }
+}
+
+/** Remembers the code starting a transfer for the bus log */
+static void twi_chain(void) {
+    if (busLog && started)
+        bus_chain(twi.chain, sizeof(twi.chain));
+}
+
+static void twi_sync(void) {
+    if (twi0.MADDR != twi.storedAddress) { // (Repeated) start and address
+        twi.address = twi0.MADDR;
+        twi0.MADDR = twi.storedAddress = SIM_MARK | twi.address;
+        twi_chain();
+        twi_transfer(TWI_ADDRESS, 10, now > twi.busFree ? now : twi.busFree);
+    }
+    if (twi0.MDATA != twi.storedData) {
+        twi.data = twi0.MDATA;
+        twi0.MDATA = twi.storedData = SIM_MARK | twi.data;
+        twi_chain();
+        twi_transfer(TWI_WRITE, 9, now);
+    }
+    if (twi0.MCTRLB != SIM_MARK) {
+        uint8_t command = twi0.MCTRLB & TWI_MCMD_gm;
+        twi0.MCTRLB = SIM_MARK;
+        if (command == TWI_MCMD_RECVTRANS_gc) {
+            twi_chain();
+            twi_transfer(TWI_READ, 9, now);
+        } else if (command == TWI_MCMD_STOP_gc) {
+            twi.phase = TWI_IDLE;
+            twi.device = NULL;
+            twi.busFree = now + twi_bit();
+            twi_chain();
+            twi_log('P', 0, '-', now, twi.busFree);
+            twi.status &= ~(TWI_RIF_bm | TWI_WIF_bm | TWI_CLKHOLD_bm);
+        }
+    }
+    if (twi0.MSTATUS != twi.storedStatus) // Flags are cleared by writing one
+        twi.status &= ~(twi0.MSTATUS & (TWI_RIF_bm | TWI_WIF_bm | TWI_ARBLOST_bm | TWI_BUSERR_bm));
+    twi0.MSTATUS = twi.storedStatus = SIM_MARK | twi.status | TWI_BUSSTATE_IDLE_gc;
+}
+
+/* ------------------------------------------------------------------------------------------ */
+/* USART0 (RS-485 telemetry) and USART1 (clock device, GNSS receiver)                          */
+
+static struct {
+    uint8_t status;
+    uint16_t storedTx, storedStatus;
+    int shifting, buffered;
+    uint64_t shiftDone;
+    unsigned long txBytes, rxBytes, overruns;
+    unsigned long rxLost;   /**< USART0: scripted bytes lost in a full receive FIFO */
+    uint8_t rx[2];          /**< Receive FIFO (RXDATAL shows the first byte) */
+    int rxCount;
+    uint64_t rxNext, frameStart;
+    char frame[256];
+    int framePosition, frameLength;
+    uint8_t next;           /**< Byte waiting in the data register (bus log) */
+    char chain[512];        /**< Code that wrote it (bus log) */
+} serial[2];
+
+static uint64_t usart_byte(int n) {
+    double baud = config.baud[n];
+    if (!baud && usart[n].BAUD) {
+        int clk2x = (usart[n].CTRLB & USART_RXMODE_gm) == USART_RXMODE_CLK2X_gc;
+        baud = (double)F_CPU * 64 / ((clk2x ? 8 : 16) * (double)usart[n].BAUD);
+    }
+    if (!baud)
+        baud = 2500000;
+    return (uint64_t)(10 * F_CPU / baud + 0.5);
+}
+
+/** Next clock device frame `<YYYYMMDDhhmmssc|az|el|lat|lon|tz>`, the sun moving 15 deg per hour */
+static void clock_frame(void) {
+    double t = (double)now / F_CPU;
+    long s = 12 * 3600 + (long)t;
+    serial[1].frameLength = snprintf(serial[1].frame, sizeof(serial[1].frame),
+        "<2025%02d%02d%02ld%02ld%02ld%01d|%.2f|%.2f|54.6872|25.2797|2>", 6, 21, (s / 3600) % 24, (s / 60) % 60,
+        s % 60, (int)(t * 10) % 10, 180.0 + t * 15 / 3600, 58.0 - t * 2 / 3600);
+    serial[1].framePosition = 0;
+    serial[1].frameStart = serial[1].rxNext;
+}
+
+/** Appends `$body*hh` CR LF to the frame */
+static void nmea_sentence(const char *body) {
+    uint8_t sum = 0;
+    for (const char *p = body; *p; p++)
+        sum ^= (uint8_t)*p;
+    serial[1].frameLength += snprintf(serial[1].frame + serial[1].frameLength,
+        sizeof(serial[1].frame) - serial[1].frameLength, "$%s*%02X\r\n", body, sum);
+}
+
+/** GNSS receiver burst of the current second: RMC, GGA and ZDA at the clock device's place and UTC time */
+static void gnss_frame(void) {
+    long s = 10 * 3600 + (long)(now / F_CPU);
+    char time[16], body[96];
+    snprintf(time, sizeof(time), "%02ld%02ld%02ld.00", (s / 3600) % 24, (s / 60) % 60, s % 60);
+    serial[1].frameLength = 0;
+    snprintf(body, sizeof(body), "GNRMC,%s,A,5441.23200,N,02516.78200,E,0.02,,210625,,,A", time);
+    nmea_sentence(body);
+    snprintf(body, sizeof(body), "GNGGA,%s,5441.23200,N,02516.78200,E,1,12,0.8,112.4,M,28.1,M,,", time);
+    nmea_sentence(body);
+    snprintf(body, sizeof(body), "GNZDA,%s,21,06,2025,00,00", time);
+    nmea_sentence(body);
+    serial[1].framePosition = 0;
+    serial[1].frameStart = serial[1].rxNext;
+}
+
+/**
+ * Starts the next USART1 frame. The receive line multiplexer (PIN_GNSS_SELECT, GPIO.h) connects
+ * the GNSS receiver, whose sentences come at every whole second, or the clock device with its
+ * frames (none during --outage). Returns 0 and moves rxNext to when to look again if nothing is
+ * sent now.
+ */
+static int usart1_frame(void) {
+    uint64_t at = serial[1].rxNext;
+    if (GPIO_VPORT(GNSS_SELECT).OUT & GPIO_BM(GNSS_SELECT)) {
+        static uint64_t second = UINT64_MAX;
+        if (at / F_CPU == second) {
+            serial[1].rxNext = at + F_CPU / 1000; // The rate may change meanwhile
+            return 0;
+        }
+        second = at / F_CPU;
+        gnss_frame();
+        return 1;
+    }
+    uint64_t from = start + (uint64_t)(config.outageUs[0] * (F_CPU / 1000000));
+    uint64_t to = start + (uint64_t)(config.outageUs[1] * (F_CPU / 1000000));
+    if (started && at >= from && at < to) {
+        serial[1].rxNext = at + F_CPU / 1000; // Silent
+        return 0;
+    }
+    uint64_t period = (uint64_t)(config.clockPeriodUs * (F_CPU / 1000000));
+    if (serial[1].frameStart + period > at) {
+        serial[1].rxNext = serial[1].frameStart + period;
+        return 0;
+    }
+    clock_frame();
+    return 1;
+}
+
+/** USART0 input (--rx0): bytes with their earliest time after the start of the measurement */
+static struct {
+    uint64_t at;
+    uint8_t c;
+} *script;
+static int scriptLength, scriptNext;
+
+/** Reads the script lines "time_us hh hh ...": the bytes of a line follow each other back to back */
+static int load_script(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 0;
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), f)) {
+        char *p = line, *q;
+        double us = strtod(p, &q);
+        if (q == p)
+            continue;
+        for (p = q;; p = q) {
+            long c = strtol(p, &q, 16);
+            if (q == p)
+                break;
+            script = realloc(script, (scriptLength + 1) * sizeof(*script));
+            script[scriptLength].at = (uint64_t)(us * (F_CPU / 1000000));
+            script[scriptLength++].c = (uint8_t)c;
+        }
+    }
+    fclose(f);
+    return 1;
+}
+
+/** Schedules the end of the next scripted byte, the line being free from the given time */
+static void script_schedule(uint64_t free) {
+    if (scriptNext >= scriptLength) {
+        serial[0].rxNext = UINT64_MAX;
+        return;
+    }
+    uint64_t at = start + script[scriptNext].at;
+    serial[0].rxNext = (at > free ? at : free) + usart_byte(0);
+}
+
+static void usart_log(int n, const char *kind, uint8_t c, uint64_t from, const char *chain) {
+    if (busLog && started)
+        fprintf(busLog, "uart%d %llu %llu %s %02x %s\n", n, (unsigned long long)from,
+                (unsigned long long)(from + usart_byte(n)), kind, c, chain);
+}
+
+static void usart_sync(int n) {
+    USART_t *u = &usart[n];
+    if (u->TXDATAL != serial[n].storedTx) {
+        uint8_t c = u->TXDATAL;
+        u->TXDATAL = serial[n].storedTx = SIM_MARK | c;
+        serial[n].txBytes++;
+        if (n == 0 && config.tx0 && started)
+            fputc(c, config.tx0);
+        char chain[512] = "-";
+        if (busLog && started)
+            bus_chain(chain, sizeof(chain));
+        if (!serial[n].shifting) {
+            serial[n].shifting = 1;
+            serial[n].shiftDone = now + usart_byte(n);
+            usart_log(n, "tx", c, now, chain);
+        } else if (!serial[n].buffered) {
+            serial[n].buffered = 1;
+            serial[n].next = c;
+            strcpy(serial[n].chain, chain);
+        } else {
+            serial[n].overruns++; // Written while the data register was full: lost
+        }
+        serial[n].status &= ~USART_TXCIF_bm;
+    }
+    if (u->STATUS != serial[n].storedStatus) // RXCIF is read-only: only reading RXDATAL clears it
+        serial[n].status &= ~(u->STATUS & USART_TXCIF_bm);
+    serial[n].status = (serial[n].status & ~USART_DREIF_bm) | (serial[n].buffered ? 0 : USART_DREIF_bm);
+    u->STATUS = serial[n].storedStatus = SIM_MARK | serial[n].status;
+}
+
+static void usart_event(int n) {
+    if (serial[n].shifting && now >= serial[n].shiftDone) {
+        if (serial[n].buffered) {
+            serial[n].buffered = 0;
+            usart_log(n, "tx", serial[n].next, serial[n].shiftDone, serial[n].chain);
+            serial[n].shiftDone += usart_byte(n);
+        } else {
+            serial[n].shifting = 0;
+            serial[n].status |= USART_TXCIF_bm;
+        }
+    }
+    if (n == 0 && now >= serial[0].rxNext) { // Scripted byte
+        uint8_t c = script[scriptNext++].c;
+        usart_log(0, serial[0].rxCount < 2 ? "rx" : "lost", c, serial[0].rxNext - usart_byte(0), "-");
+        if (serial[0].rxCount < 2)
+            serial[0].rx[serial[0].rxCount++] = c;
+        else
+            serial[0].rxLost++; // FIFO full: the byte is lost
+        usart[0].RXDATAL = serial[0].rx[0];
+        serial[0].status |= USART_RXCIF_bm;
+        serial[0].rxBytes++;
+        script_schedule(serial[0].rxNext);
+    }
+    if (n == 1 && now >= serial[1].rxNext) { // Clock device or GNSS receiver byte
+        if (serial[1].framePosition >= serial[1].frameLength && !usart1_frame())
+            return;
+        char c = serial[1].frame[serial[1].framePosition++];
+        usart_log(1, serial[1].rxCount < 2 ? "rx" : "lost", c, serial[1].rxNext - usart_byte(1), "-");
+        if (serial[1].rxCount < 2)
+            serial[1].rx[serial[1].rxCount++] = c;
+        else
+            serial[1].overruns++; // FIFO full: the byte is lost
+        usart[1].RXDATAL = serial[1].rx[0];
+        serial[1].status |= USART_RXCIF_bm;
+        serial[1].rxBytes++;
+        serial[1].rxNext += usart_byte(1);
+    }
+    serial[n].status = (serial[n].status & ~USART_DREIF_bm) | (serial[n].buffered ? 0 : USART_DREIF_bm);
+    usart[n].STATUS = serial[n].storedStatus = SIM_MARK | serial[n].status;
+}
+
+/* ------------------------------------------------------------------------------------------ */
+/* ADC0                                                                                         */
+
+static struct {
+    int busy;
+    uint64_t done;
+    uint8_t flags;
+    uint16_t storedFlags;
+    unsigned long conversions;
+} adc;
+
+static void adc_sync(void) {
+    if (adc0.COMMAND != SIM_MARK) {
+        if (adc0.COMMAND & ADC_STCONV_bm) {
+            static const int divider[16] = { 2, 4, 8, 12, 16, 20, 24, 28, 32, 48, 64, 96, 128, 256, 256, 256 };
+            int samples = 1 << (adc0.CTRLB & ADC_SAMPNUM_gm);
+            adc.busy = 1;
+            adc.done = now + (uint64_t)(samples * 16 + 2) * divider[adc0.CTRLC & ADC_PRESC_gm];
+            adc.flags &= ~ADC_RESRDY_bm;
+            adc.conversions++;
+        }
+        adc0.COMMAND = SIM_MARK;
+    }
+    if (adc0.INTFLAGS != adc.storedFlags)
+        adc.flags &= ~(adc0.INTFLAGS & ADC_RESRDY_bm);
+    adc0.INTFLAGS = adc.storedFlags = SIM_MARK | adc.flags;
+}
+
+static void adc_event(void) {
+    int log2n = adc0.CTRLB & ADC_SAMPNUM_gm, samples = 1 << log2n;
+    int base = adc0.MUXPOS == ADC_MUXPOS_AIN30_gc ? 400 : adc0.MUXPOS == ADC_MUXPOS_AIN31_gc ? 2048 : 2800;
+    uint32_t sum = 0;
+    for (int i = 0; i < samples; i++)
+        sum += base + noise(61) - 30;
+    adc0.RES = sum >> (log2n > 4 ? log2n - 4 : 0);
+    adc.busy = 0;
+    adc.flags |= ADC_RESRDY_bm;
+    adc0.INTFLAGS = adc.storedFlags = SIM_MARK | adc.flags;
+}
+
+/* ------------------------------------------------------------------------------------------ */
+/* TCB0 system tick                                                                             */
+
+static struct {
+    int running;
+    uint64_t lastTick, nextTick, period;
+    uint8_t flags;
+    uint16_t storedFlags;
+} tick;
+
+static void tick_sync(void) {
+    if (!tick.running && (tcb0.CTRLA & TCB_ENABLE_bm)) {
+        tick.running = 1;
+        tick.period = ((uint64_t)tcb0.CCMP + 1) * 2; // CLK_PER / 2
+        tick.lastTick = now;
+        tick.nextTick = now + tick.period;
+    }
+    if (tcb0.INTFLAGS != tick.storedFlags)
+        tick.flags &= ~(tcb0.INTFLAGS & (TCB_CAPT_bm | TCB_OVF_bm));
+    tcb0.INTFLAGS = tick.storedFlags = SIM_MARK | tick.flags;
+    if (tick.running)
+        tcb0.CNT = (now - tick.lastTick) / 2;
+}
+
+static void tick_event(void) {
+    tick.flags |= TCB_CAPT_bm;
+    tick.lastTick = tick.nextTick;
+    tick.nextTick += tick.period;
+    tcb0.INTFLAGS = tick.storedFlags = SIM_MARK | tick.flags;
+}
+
+/* ------------------------------------------------------------------------------------------ */
+/* EEPROM                                                                                       */
+
+#define EEPROM_WRITE_US 11000 /**< Erase and write of one byte */
+
+static struct {
+    uint8_t data[EEPROM_SIZE];
+    uint64_t busyUntil;
+    unsigned long writes;
+    uint64_t waited;
+    const char *path;             /**< --eeprom: image loaded at start, saved at the end */
+} eeprom;
+
+static void eeprom_load(void) {
+    memset(eeprom.data, 0xFF, sizeof(eeprom.data)); // Erased
+    FILE *f = eeprom.path ? fopen(eeprom.path, "rb") : NULL;
+    if (f) {
+        if (fread(eeprom.data, 1, sizeof(eeprom.data), f) != sizeof(eeprom.data))
+            memset(eeprom.data, 0xFF, sizeof(eeprom.data));
+        fclose(f);
+    }
+}
+
+static void eeprom_save(void) {
+    FILE *f = eeprom.path ? fopen(eeprom.path, "wb") : NULL;
+    if (f) {
+        fwrite(eeprom.data, 1, sizeof(eeprom.data), f);
+        fclose(f);
+    }
+}
+
+static uint8_t *eeprom_byte(const void *address) {
+    uintptr_t offset = (uintptr_t)address;
+    if (offset >= EEPROM_SIZE) {
+        fprintf(stderr, "EEPROM address %lu out of range\n", (unsigned long)offset);
+        exit(1);
+    }
+    return &eeprom.data[offset];
+}
+
+/* ------------------------------------------------------------------------------------------ */
+/* Event loop, interrupts and accounting                                                        */
+
+static void sync_all(void) {
+    twi_sync();
+    usart_sync(0);
+    usart_sync(1);
+    adc_sync();
+    tick_sync();
+}
+
+static uint64_t next_event(void) {
+    uint64_t t = UINT64_MAX;
+    if (twi.phase != TWI_IDLE && twi.done < t) t = twi.done;
+    for (int n = 0; n < 2; n++)
+        if (serial[n].shifting && serial[n].shiftDone < t) t = serial[n].shiftDone;
+    for (int n = 0; n < 2; n++)
+        if (serial[n].rxNext < t) t = serial[n].rxNext;
+    if (adc.busy && adc.done < t) t = adc.done;
+    if (tick.running && tick.nextTick < t) t = tick.nextTick;
+    return t;
+}
+
+static void process_events(void) {
+    if (twi.phase != TWI_IDLE && twi.done <= now) twi_event();
+    for (int n = 0; n < 2; n++) usart_event(n);
+    if (adc.busy && adc.done <= now) adc_event();
+    if (tick.running && tick.nextTick <= now) tick_event();
+}
+
+static void charge(int category, uint64_t c) {
+    cycles[stage][category] += c;
+}
+
+static double isrSimulationNs; /**< Host time spent in the simulation during the running vector */
+static double isrFloorNs;      /**< Host time of a vector doing nothing but one register access */
+
+/** Register access from an interrupt: writes take effect, the time is not charged */
+static void isr_access(void) {
+    double t = host_ns();
+    sync_all();
+    isrSimulationNs += host_ns() - t + overheadNs;
+}
+
+/**
+ * Interrupt handlers are short and do the same work on every run, but a single host run is
+ * dominated by cache misses after the simulation code; the fastest run of each vector so far is
+ * charged instead.
+ */
+static uint64_t run_isr(int index, void (*vector)(void)) {
+    static double fastest[4] = { 1e9, 1e9, 1e9, 1e9 };
+    inIsr = 1;
+    isrSimulationNs = 0;
+    double t = host_ns();
+    vector();
+    double ns = host_ns() - t - overheadNs - isrSimulationNs;
+    inIsr = 0;
+    sync_all();
+    ns -= isrFloorNs;
+    if (ns < fastest[index])
+        fastest[index] = ns > 0 ? ns : 0;
+    return ISR_CYCLES + (uint64_t)(fastest[index] * cyclesPerNs);
+}
+
+/** Runs the pending interrupts, returns the cycles they took */
+static uint64_t deliver(void) {
+    uint64_t spent = 0;
+    if (!interruptsOn || inIsr || atomicDepth)
+        return 0;
+    for (int guard = 0; guard < 64; guard++) {
+        if (tick.running && (tcb0.INTCTRL & TCB_CAPT_bm) && (tick.flags & TCB_CAPT_bm))
+            spent += run_isr(0, sim_vector_TCB0_INT);
+        else if ((usart[0].CTRLA & USART_RXCIE_bm) && (serial[0].status & USART_RXCIF_bm))
+            spent += run_isr(2, sim_vector_USART0_RXC);
+        else if ((usart[0].CTRLA & USART_DREIE_bm) && (serial[0].status & USART_DREIF_bm))
+            spent += run_isr(1, sim_vector_USART0_DRE);
+        else if ((usart[1].CTRLA & USART_RXCIE_bm) && (serial[1].status & USART_RXCIF_bm))
+            spent += run_isr(3, sim_vector_USART1_RXC);
+        else
+            break;
+    }
+    return spent;
+}
+
+/** Lets c cycles pass in the given category, with the transfers and interrupts they contain */
+static void advance(uint64_t c, int category) {
+    uint64_t target = now + c;
+    charge(category, c);
+    for (;;) {
+        uint64_t spent = deliver();
+        if (spent) {
+            charge(CAT_ISR, spent);
+            target += spent;
+        }
+        uint64_t t = next_event();
+        if (t > target)
+            break;
+        if (t > now)
+            now = t;
+        process_events();
+    }
+    now = target;
+}
+
+/**
+ * Host time to charge for a stretch between the same two hook call sites. Short stretches of code
+ * (a byte loop between two register accesses) take a few nanoseconds on the host, less than the
+ * noise of the measurement after the simulation has run; their fastest run is the best estimate.
+ * A long run of a path that is short in all but fewer than 1 of INTERRUPT_RUNS runs is the host
+ * being interrupted (a timer tick, another task): scaled by the ratio, 20 us of host time would
+ * be 8 ms of AVR time between two bytes of a display burst. It is charged the fastest run too,
+ * and hook_charge() counts it in `interruptions`. A path that takes longer now and then because
+ * the firmware does more work (a minute's end) is long more often than that and keeps its time.
+ */
+static double path_time(const void *from, const void *to, double ns) {
+    static struct { const void *from, *to; double fastest; unsigned long runs, longRuns; } paths[PATHS];
+    static unsigned used;
+    unsigned h = (unsigned)(((uintptr_t)from * 31) ^ (uintptr_t)to) % PATHS;
+    for (;; h = (h + 1) % PATHS) {
+        if (paths[h].from == from && paths[h].to == to)
+            break;
+        if (!paths[h].to) {
+            if (used == PATHS - 1)
+                return ns; // Full: measured value
+            used++;
+            paths[h].from = from;
+            paths[h].to = to;
+            paths[h].fastest = ns;
+            break;
+        }
+    }
+    paths[h].runs++;
+    if (ns < SHORT_NS) {
+        if (ns < paths[h].fastest)
+            paths[h].fastest = ns;
+        return paths[h].fastest;
+    }
+    paths[h].longRuns++;
+    if (paths[h].runs >= INTERRUPT_RUNS && paths[h].longRuns * INTERRUPT_RUNS < paths[h].runs) {
+        pendingNs = ns - paths[h].fastest;
+        return paths[h].fastest;
+    }
+    return ns;
+}
+
+/** Start of a hook called from the firmware at `site`: pending writes take effect, returns the host time since the last hook */
+static double hook_enter(const void *site) {
+    static const void *lastSite;
+    double ns = host_ns() - lastHost - overheadNs - hookFloorNs;
+    sync_all();
+    ns = path_time(lastSite, site, ns);
+    lastSite = site;
+    return ns;
+}
+
+/** Charges the computation before a hook (unless it was only the next pass of a polling loop) and the poll itself */
+static void hook_charge(double ns, int poll, int category) {
+    if (!(poll && lastWasPoll)) {
+        if (pendingNs > 0 && started) {
+            interruptions++;
+            interruptedNs += pendingNs;
+        }
+        if (ns > 0)
+            advance((uint64_t)(ns * cyclesPerNs), CAT_COMPUTE);
+    }
+    pendingNs = 0;
+    if (poll)
+        advance(POLL_CYCLES, category);
+    else
+        advance(0, CAT_COMPUTE); // Interrupts that became pending
+    lastWasPoll = poll;
+    if (started && now >= end)
+        longjmp(finish, 1);
+    if (!started && now >= ms_cycles(60000))
+        longjmp(finish, 2); // Never reached the main loop
+}
+
+static void hook_leave(void) {
+    lastHost = host_ns();
+}
+
+/* ------------------------------------------------------------------------------------------ */
+/* Hooks called from the firmware                                                               */
+
+TWI_t *sim_twi0(void) {
+    if (inIsr) {
+        isr_access();
+        return &twi0;
+    }
+    double ns = hook_enter(__builtin_return_address(0));
+    hook_charge(ns, twi.phase != TWI_IDLE, CAT_TWI);
+    hook_leave();
+    return &twi0;
+}
+
+USART_t *sim_usart(uint8_t n) {
+    if (inIsr) {
+        isr_access();
+        return &usart[n];
+    }
+    double ns = hook_enter(__builtin_return_address(0));
+    int waiting = !(serial[n].status & USART_DREIF_bm) || (n == 1 && !(serial[1].status & USART_RXCIF_bm));
+    hook_charge(ns, waiting, n ? CAT_USART1 : CAT_USART0);
+    hook_leave();
+    return &usart[n];
+}
+
+ADC_t *sim_adc0(void) {
+    if (inIsr) {
+        isr_access();
+        return &adc0;
+    }
+    double ns = hook_enter(__builtin_return_address(0));
+    hook_charge(ns, adc.busy, CAT_ADC);
+    hook_leave();
+    return &adc0;
+}
+
+TCB_t *sim_tcb0(void) {
+    if (inIsr) {
+        isr_access();
+        return &tcb0;
+    }
+    double ns = hook_enter(__builtin_return_address(0));
+    hook_charge(ns, 0, CAT_COMPUTE);
+    tick_sync();
+    hook_leave();
+    return &tcb0;
+}
+
+uint8_t sim_rxdata(uint8_t n) {
+    if (inIsr)
+        isr_access();
+    else
+        hook_charge(hook_enter(__builtin_return_address(0)), 0, CAT_COMPUTE);
+    uint8_t c = serial[n].rx[0];
+    if (serial[n].rxCount) {
+        serial[n].rx[0] = serial[n].rx[1];
+        if (--serial[n].rxCount == 0)
+            serial[n].status &= ~USART_RXCIF_bm;
+    }
+    usart[n].RXDATAL = serial[n].rx[0];
+    usart[n].STATUS = serial[n].storedStatus = SIM_MARK | serial[n].status;
+    if (!inIsr)
+        hook_leave();
+    return c;
+}
+
+/** Waits for the EEPROM write in progress, if any */
+static void eeprom_wait(void) {
+    if (now < eeprom.busyUntil) {
+        eeprom.waited += eeprom.busyUntil - now;
+        advance(eeprom.busyUntil - now, CAT_SPIN);
+    }
+}
+
+int eeprom_is_ready(void) {
+    hook_charge(hook_enter(__builtin_return_address(0)), 0, CAT_COMPUTE);
+    int ready = now >= eeprom.busyUntil;
+    hook_leave();
+    return ready;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *address) {
+    hook_charge(hook_enter(__builtin_return_address(0)), 0, CAT_COMPUTE);
+    eeprom_wait();
+    uint8_t value = *eeprom_byte(address);
+    hook_leave();
+    return value;
+}
+
+void eeprom_read_block(void *destination, const void *source, size_t size) {
+    hook_charge(hook_enter(__builtin_return_address(0)), 0, CAT_COMPUTE);
+    eeprom_wait();
+    eeprom_byte((const uint8_t *)source + size - 1);
+    memcpy(destination, eeprom_byte(source), size);
+    hook_leave();
+}
+
+void eeprom_update_byte(uint8_t *address, uint8_t value) {
+    hook_charge(hook_enter(__builtin_return_address(0)), 0, CAT_COMPUTE);
+    eeprom_wait();
+    uint8_t *p = eeprom_byte(address);
+    if (*p != value) {
+        *p = value;
+        eeprom.busyUntil = now + (uint64_t)EEPROM_WRITE_US * (F_CPU / 1000000);
+        eeprom.writes++;
+    }
+    hook_leave();
+}
+
+void eeprom_write_byte(uint8_t *address, uint8_t value) {
+    hook_charge(hook_enter(__builtin_return_address(0)), 0, CAT_COMPUTE);
+    eeprom_wait();
+    *eeprom_byte(address) = value;
+    eeprom.busyUntil = now + (uint64_t)EEPROM_WRITE_US * (F_CPU / 1000000);
+    eeprom.writes++;
+    hook_leave();
+}
+
+void sim_spin(const char *file) {
+    double ns = hook_enter(__builtin_return_address(0));
+    int category = strstr(file, "USART") ? CAT_USART0 : strstr(file, "i2c") ? CAT_TWI : strstr(file, "ADC") ? CAT_ADC : CAT_SPIN;
+    if (lastWasPoll) // The loop condition already polled a register
+        hook_charge(0, 1, category);
+    else
+        hook_charge(ns, 1, category);
+    hook_leave();
+}
+
+void sim_delay_us(double us) {
+    double ns = hook_enter(__builtin_return_address(0));
+    hook_charge(ns, 0, CAT_COMPUTE);
+    advance((uint64_t)(us * (F_CPU / 1000000)), CAT_DELAY);
+    hook_leave();
+}
+
+void sim_interrupts(int on) {
+    double ns = hook_enter(__builtin_return_address(0));
+    interruptsOn = on;
+    hook_charge(ns, 0, CAT_COMPUTE);
+    hook_leave();
+}
+
+uint8_t sim_sreg(void) {
+    return interruptsOn && !inIsr && !atomicDepth ? CPU_I_bm : 0;
+}
+
+int sim_atomic(int enter) {
+    if (inIsr) // Interrupts are off already (Pool_Free() from the USART0 transmit interrupt)
+        return enter;
+    double ns = hook_enter(__builtin_return_address(0));
+    if (!enter)
+        atomicDepth--;
+    hook_charge(ns, 0, CAT_COMPUTE);
+    if (enter)
+        atomicDepth++;
+    hook_leave();
+    return enter;
+}
+
+/** stdout is not set up on the station: avr-libc printf() finds no stream and returns at once */
+int sim_printf(const char *format, ...) {
+    (void)format;
+    return -1;
+}
+
+/** Units.h range check of the UNITS_CHECKED build: an overflow on the AVR is a bug, stop the run */
+int64_t Units_Check(int64_t value, int64_t min, int64_t max, const char *file, int line) {
+    if (value < min || value > max) {
+        fprintf(stderr, "%s:%d: unit overflow: %lld outside %lld ... %lld\n", file, line,
+                (long long)value, (long long)min, (long long)max);
+        exit(3);
+    }
+    return value;
+}
+
+/** Start of a wrapped main loop stage (generated wrappers), returns the stage to go back to */
+int sim_stage_enter(int index) {
+    double ns = hook_enter(__builtin_return_address(0));
+    hook_charge(ns, 0, CAT_COMPUTE);
+    int previous = stage;
+    if (depth++ == 0) {
+        if (index == 0) {
+            if (!started) { // First loop pass: the measurement starts
+                started = 1;
+                start = now;
+                end = now + (uint64_t)(config.seconds * F_CPU);
+                interruptions = 0;
+                interruptedNs = 0;
+                script_schedule(now);
+                stage = STAGE_MAIN;
+            }
+            iterations++;
+        }
+        if (started) {
+            stage = index;
+            calls[index]++;
+        }
+    }
+    hook_leave();
+    return previous;
+}
+
+void sim_stage_exit(int previous) {
+    double ns = hook_enter(__builtin_return_address(0));
+    hook_charge(ns, 0, CAT_COMPUTE);
+    if (--depth == 0 && started)
+        stage = previous == STAGE_STARTUP ? STAGE_MAIN : previous;
+    hook_leave();
+}
+
+/* ------------------------------------------------------------------------------------------ */
+
+static void __attribute__((noinline)) empty_vector(void) {
+    volatile uint16_t status = USART0.STATUS;
+    (void)status;
+}
+
+static TCB_t *__attribute__((noinline)) empty_hook(void) {
+    hookFloorNs = 0;
+    double ns = hook_enter(__builtin_return_address(0));
+    lastHost = ns; // Passes the measurement back instead of charging it
+    return &tcb0;
+}
+
+/** Host clock read cost and the floors of hook and interrupt measurements */
+static void calibrate(void) {
+    double floor = 1e9;
+    overheadNs = isrFloorNs = 1e9;
+    for (int i = 0; i < 10000; i++) {
+        double a = host_ns(), b = host_ns();
+        if (b - a < overheadNs)
+            overheadNs = b - a;
+    }
+    for (int i = 0; i < 10000; i++) {
+        hook_leave();
+        (void)empty_hook()->CNT;
+        if (lastHost < floor)
+            floor = lastHost;
+    }
+    hookFloorNs = floor > 0 ? floor : 0;
+    for (int i = 0; i < 10000; i++) {
+        inIsr = 1;
+        isrSimulationNs = 0;
+        double t = host_ns();
+        empty_vector();
+        double ns = host_ns() - t - overheadNs - isrSimulationNs;
+        inIsr = 0;
+        if (ns < isrFloorNs)
+            isrFloorNs = ns;
+    }
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        double v = atof(argv[i + 1]);
+        if (!strcmp(argv[i], "--seconds")) config.seconds = v;
+        else if (!strcmp(argv[i], "--ratio")) config.ratio = v;
+        else if (!strcmp(argv[i], "--scl")) config.scl = v;
+        else if (!strcmp(argv[i], "--baud0")) config.baud[0] = v;
+        else if (!strcmp(argv[i], "--baud1")) config.baud[1] = v;
+        else if (!strcmp(argv[i], "--maximum")) config.maximum = (int)v;
+        else if (!strcmp(argv[i], "--clock-period-us")) config.clockPeriodUs = v;
+        else if (!strcmp(argv[i], "--outage-from-us")) config.outageUs[0] = v;
+        else if (!strcmp(argv[i], "--outage-to-us")) config.outageUs[1] = v;
+        else if (!strcmp(argv[i], "--eeprom")) eeprom.path = argv[i + 1];
+        else if (!strcmp(argv[i], "--rx0") && !load_script(config.rx0 = argv[i + 1]))
+            return 1;
+        else if (!strcmp(argv[i], "--tx0") && !(config.tx0 = fopen(argv[i + 1], "wb"))) {
+            perror(argv[i + 1]);
+            return 1;
+        } else if (!strcmp(argv[i], "--bus-log") && !(busLog = fopen(argv[i + 1], "w"))) {
+            perror(argv[i + 1]);
+            return 1;
+        }
+    }
+    cyclesPerNs = config.ratio * F_CPU / 1e9;
+
+
+    // Reset values: pull-ups keep the keypad columns high, the crystal is running
+    PORTD.IN = PORTF.IN = PORTA.IN = PORTC.IN = 0xFF;
+    VPORTD.IN = VPORTF.IN = VPORTA.IN = VPORTC.IN = 0xFF; // GPIO.h reads the pins through the VPORTs
+    CLKCTRL.MCLKSTATUS = CLKCTRL_EXTS_bm;
+    RSTCTRL.RSTFR = RSTCTRL_PORF_bm; // Every run is a power-on
+    eeprom_load();
+    twi0.MADDR = twi.storedAddress = SIM_MARK;
+    twi0.MDATA = twi.storedData = SIM_MARK;
+    twi0.MCTRLB = SIM_MARK;
+    for (int n = 0; n < 2; n++)
+        usart[n].TXDATAL = serial[n].storedTx = SIM_MARK;
+    adc0.COMMAND = SIM_MARK;
+    bmp_reset();
+    clock_frame();
+    serial[0].rxNext = UINT64_MAX; // Scripted bytes start with the measurement
+    sync_all();
+    calibrate();
+    if (busLog)
+        fprintf(busLog, "# clock %lu\n", F_CPU);
+
+    stage = STAGE_STARTUP;
+    int result = setjmp(finish);
+    if (result == 0) {
+        lastHost = host_ns();
+        firmware_main();
+        return 1;
+    }
+    if (result == 2) {
+        printf("error start-up did not reach the main loop within 60 s of simulated time\n");
+        return 1;
+    }
+
+    printf("config %g %g %.0f %.0f %.0f\n", config.seconds, config.ratio, (double)F_CPU / twi_bit(),
+           10.0 * F_CPU / usart_byte(0), 10.0 * F_CPU / usart_byte(1));
+    printf("window %llu %lu\n", (unsigned long long)(now - start), iterations);
+    printf("categories");
+    for (int c = 0; c < CATS; c++)
+        printf(" %s", categoryNames[c]);
+    printf("\n");
+    for (int s = 0; s < sim_stage_count + 2; s++) {
+        printf("stage %s %lu", s < sim_stage_count ? sim_stage_names[s] : s == STAGE_MAIN ? "(loop)" : "(start-up)", calls[s]);
+        for (int c = 0; c < CATS; c++)
+            printf(" %llu", (unsigned long long)cycles[s][c]);
+        printf("\n");
+    }
+    printf("bus twi %lu %llu\n", twi.bytes, (unsigned long long)twi.busy);
+    printf("bus usart0 %lu %lu\n", serial[0].txBytes, serial[0].overruns);
+    if (config.rx0)
+        printf("bus usart0-rx %lu %lu\n", serial[0].rxBytes, serial[0].rxLost);
+    printf("bus usart1 %lu %lu\n", serial[1].rxBytes, serial[1].overruns);
+    printf("bus adc %lu 0\n", adc.conversions);
+    printf("bus eeprom %lu %llu\n", eeprom.writes, (unsigned long long)eeprom.waited);
+    eeprom_save();
+    for (unsigned i = 0; i < sizeof(devices) / sizeof(devices[0]); i++)
+        printf("device %s %lu\n", devices[i].name, devices[i].transactions);
+    printf("interruptions %lu %.0f\n", interruptions, interruptedNs * cyclesPerNs);
+    if (busLog)
+        fclose(busLog);
+    if (config.tx0)
+        fclose(config.tx0);
+    return 0;
+}
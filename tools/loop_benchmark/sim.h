@@ -0,0 +1,20 @@
+/*
+ * sim.h - included ahead of every firmware file by tools/loop_benchmark.py.
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdarg.h> /* avr-libc <stdio.h> brings it along */
+#include <stdint.h>
+
+/** Empty polling loops `while (c);` are rewritten to `while (c) sim_spin(__FILE__);` */
+void sim_spin(const char *file);
+
+/** Reads of USARTn.RXDATAL are rewritten to sim_rxdata(n): reading takes the byte out of the receive FIFO */
+uint8_t sim_rxdata(uint8_t n);
+
+/** printf() output goes nowhere on the station (stdout is not connected) */
+int sim_printf(const char *format, ...);
+#define printf sim_printf
+
+#endif /* SIM_H */
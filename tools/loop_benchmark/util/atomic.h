@@ -0,0 +1,8 @@
+/* util/atomic.h - atomic blocks hold back the simulated interrupts */
+#ifndef SIM_UTIL_ATOMIC_H
+#define SIM_UTIL_ATOMIC_H
+int sim_atomic(int enter);
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (int sim_atomic_ = sim_atomic(1); sim_atomic_; sim_atomic_ = sim_atomic(0))
+#endif
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+microbaro.py - decodes the binary microbarometer frames from a capture of the USART0 line.
+
+Scans the capture for frames (see Microbaro.h), checks their CRC-8, skips everything else
+(text telemetry, debug records, damaged frames) and writes one CSV line per sample slot:
+time in seconds since the first frame, sample index and pressure fluctuation in Pa (empty when
+the read failed or the slot was skipped). The summary on stderr gives the frames, CRC errors,
+skipped slots, and the RMS and peak fluctuation.
+
+  python3 tools/microbaro.py capture.bin > microbaro.csv
+  python3 tools/microbaro.py capture.bin --period 40 --quiet
+"""
+
+import argparse
+import math
+import sys
+
+SYNC = 0xA7  # MICROBARO_SYNC, Microbaro.h
+FRAME_SAMPLES = 10
+MISSING = -32768
+
+
+def crc8(data, crc=0xFF):
+    """CRC-8/Sensirion (polynomial 0x31, init 0xFF), as CRC8_Update() in CRC.c."""
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x31) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def frames(capture):
+    """Returns ([(first index, [samples in 0.01 Pa])] of the frames with a good CRC, bad CRCs)."""
+    found, bad, i = [], 0, 0
+    while i + 6 <= len(capture):
+        n = capture[i + 3]
+        length = 5 + 2 * n
+        if capture[i] != SYNC or not 1 <= n <= FRAME_SAMPLES or i + length > len(capture):
+            i += 1
+            continue
+        body = capture[i + 1:i + length - 1]
+        if crc8(body) != capture[i + length - 1]:
+            bad += 1
+            i += 1
+            continue
+        samples = [int.from_bytes(body[3 + 2 * k:5 + 2 * k], 'little', signed=True) for k in range(n)]
+        found.append((body[0] | body[1] << 8, samples))
+        i += length
+    return found, bad
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('capture', help='raw bytes received on the USART0 line')
+    parser.add_argument('--period', type=float, default=40, help='sample period, ms (MICROBARO_PERIOD_MS)')
+    parser.add_argument('--quiet', action='store_true', help='summary only')
+    args = parser.parse_args()
+
+    found, bad = frames(open(args.capture, 'rb').read())
+    slot = skipped = failed = 0
+    expected = None
+    values = []
+    if not args.quiet:
+        print('time,index,pa')
+    for index, samples in found:
+        gap = 0 if expected is None else (index - expected) & 0xFFFF  # The index wraps at 16 bits
+        if gap >= 0x8000:
+            gap = 0  # Index went back: the mode was restarted, not a gap
+        rows = [((expected + k) & 0xFFFF, '') for k in range(gap)]
+        for k, x in enumerate(samples):
+            if x == MISSING:
+                failed += 1
+                rows.append(((index + k) & 0xFFFF, ''))
+            else:
+                values.append(x / 100)
+                rows.append(((index + k) & 0xFFFF, '%.2f' % (x / 100)))
+        if not args.quiet:
+            for k, (i, pa) in enumerate(rows):
+                print('%.3f,%d,%s' % ((slot + k) * args.period / 1000, i, pa))
+        skipped += gap
+        slot += len(rows)
+        expected = (index + len(samples)) & 0xFFFF
+
+    rms = math.sqrt(sum(v * v for v in values) / len(values)) if values else 0
+    peak = max((abs(v) for v in values), default=0)
+    sys.stderr.write('%d frames, %d CRC errors, %d samples, %d failed reads, %d skipped slots, '
+                     'RMS %.2f Pa, peak %.2f Pa\n'
+                     % (len(found), bad, len(values) + failed, failed, skipped, rms, peak))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,397 @@
+#!/usr/bin/env python3
+"""
+noise_profile.py - sensor noise characterisation and oversampling recommendation.
+
+Ingests raw traces recorded from the station at each oversampling / accumulation level of a
+sampling channel (see Sampling.h), and for every trace computes, in one streaming pass whose
+memory does not grow with the trace,
+
+  - the Allan deviation at octave-spaced averaging times: overlapping up to OVERLAP_MAX samples,
+    from a ring of the last 2 * OVERLAP_MAX + 1 running sums; beyond that non-overlapping, from a
+    cascade of pairwise block averages that keeps two values per octave,
+  - a Welch noise spectrum (each segment is transformed and accumulated as soon as it is
+    complete).
+
+The noise of a single reading is the Allan deviation at the sample interval; unlike the plain
+standard deviation it is not inflated by slow drift (weather) in the trace. For every channel
+the cheapest level (conversion time, datasheet figures below) whose single-reading noise meets
+the target is recommended, and the result is written as NoiseProfile.h, which caps the
+oversampling level of the adaptive sampling engine.
+
+The pressure has two more dimensions, fixed by main.c rather than adapted: the BMP280
+temperature oversampling, which sets the resolution of the compensation (T1 ... T16), and its IIR
+filter (F0 = off ... F16), which lowers the noise of a forced mode reading at the cost of a lag: a
+step reaches 75 % after FILTER_STEP[coefficient] readings. A pressure level is written as
+osrs_p/osrs_t/filter, e.g. UHR/T16/F16 (x16/x16 with filter 16, the main.c default, also what
+a plain UHR means); a filter whose lag at the trace rate exceeds --max-lag is not recommended.
+
+Station traces come from the console "trace" command (Sampling_Trace(), Link.c): "trace 3 3 5 4"
+holds the pressure at UHR with osrs_t x16 and filter 16 and sends every reading as a
+"trace <ms> <value>" line, interleaved with whatever else the station sends; a capture of the console
+is used as it is. In a file that holds such lines only they are read. Other trace files hold one
+sample per line; comma separated lines (e.g. telemetry CSV records, with or without the *HH
+checksum) are accepted, `--column` selects the value. Lines starting with '#' and lines that do
+not parse are skipped.
+
+  python3 tools/noise_profile.py \\
+      --trace pressure:ULP:2:p_ulp.csv --trace pressure:UHR/T16/F16:auto:p_uhr.txt \\
+      --trace sun:ACC4:5:sun_4.csv ... --target pressure=2 --target sun=3
+
+Each --trace is channel:level:rate_hz:path, level is 0-3 or the level name of the channel. For
+a station trace the rate may be "auto": the mean rate from the times of the trace lines, as main
+loop passes stretch the interval of the "# trace" header line. Channels
+without traces keep the full range (level 3) and the main.c pressure settings. Without --output
+the header is written to the project directory.
+"""
+
+import argparse
+import cmath
+import math
+import os
+import sys
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+
+# ADC0: CLK_ADC = 24 MHz / 4, about 15.5 ADC clocks per 12-bit conversion (sample + conversion).
+ADC_SAMPLE_MS = 15.5 / 6000.0
+
+# Sampling channels in Sampling.h order: (name, macro, unit, level names, conversion time per level in ms,
+# active current in mA, default target noise in channel units).
+#   ADC channels: 4/16/64/128 accumulations.
+#   BMP280: t = 1 + 2 * osrs_t + 2 * osrs_p + 0.5 ms (datasheet typical), here with osrs_t = x16;
+#           conversion_ms() uses the osrs_t of the trace.
+#   SHT21: T + RH conversion time, datasheet maximum.
+CHANNELS = [
+    ('wind_speed', 'WIND_SPEED', 'ADC counts', ['ACC4', 'ACC16', 'ACC64', 'ACC128'],
+     [ADC_SAMPLE_MS * n for n in (4, 16, 64, 128)], 0.7, 4.0),
+    ('wind_dir', 'WIND_DIR', 'ADC counts', ['ACC4', 'ACC16', 'ACC64', 'ACC128'],
+     [ADC_SAMPLE_MS * n for n in (4, 16, 64, 128)], 0.7, 8.0),
+    ('sun', 'SUN', 'mV', ['ACC4', 'ACC16', 'ACC64', 'ACC128'],
+     [ADC_SAMPLE_MS * n for n in (4, 16, 64, 128)], 0.7, 1.0),
+    ('pressure', 'PRESSURE', 'Pa', ['ULP', 'SR', 'HR', 'UHR'],
+     [1 + 2 * 16 + 2 * n + 0.5 for n in (1, 4, 8, 16)], 0.72, 3.0),
+    ('sht', 'SHT', '0.01 C', ['11/11', '8/12', '10/13', '12/14'],
+     [11 + 15, 22 + 4, 43 + 9, 85 + 29], 0.3, 5.0),
+]
+
+LEVELS = 4
+SEGMENT = 256  # Welch segment length (power of two)
+OVERLAP_MAX = 4096  # Longest tau (samples) of the overlapping Allan deviation
+
+PRESSURE = 3  # Index of the pressure in CHANNELS
+# BMP280 temperature oversampling (osrs_t register code, multiplier) and IIR filter (code, coefficient),
+# names as in BMP390.h; the defaults are the main.c settings.
+OSRS_T = {'T1': (1, 1), 'T2': (2, 2), 'T4': (3, 4), 'T8': (4, 8), 'T16': (5, 16)}
+FILTERS = {'F0': (0, 1), 'F2': (1, 2), 'F4': (2, 4), 'F8': (3, 8), 'F16': (4, 16)}
+OSRS_T_MACRO = {1: 'BMP280_Temperature_Os_x1', 2: 'BMP280_Temperature_Os_x2', 3: 'BMP280_Temperature_Os_x4',
+                4: 'BMP280_Temperature_Os_x8', 5: 'BMP280_Temperature_Os_x16'}
+FILTER_MACRO = {0: 'BMP280_Filter_Off', 1: 'BMP280_Filter_2', 2: 'BMP280_Filter_4', 3: 'BMP280_Filter_8',
+                4: 'BMP280_Filter_16'}
+DEFAULT_T, DEFAULT_F = 'T16', 'F16'
+# Readings until a step reaches 75 % through the filter x += (new - x) / coefficient
+FILTER_STEP = {c: math.ceil(math.log(0.25) / math.log(1 - 1.0 / c)) if c > 1 else 1 for _, c in FILTERS.values()}
+
+
+def channel_by_name(name):
+    for i, ch in enumerate(CHANNELS):
+        if ch[0] == name:
+            return i
+    sys.exit('unknown channel "%s" (one of: %s)' % (name, ', '.join(c[0] for c in CHANNELS)))
+
+
+def parse_level(channel, text):
+    """Returns the key (level, osrs_t name, filter name) of a trace; the pressure extras are None
+    for the other channels."""
+    names = CHANNELS[channel][3]
+    parts = text.upper().split('/')
+    extras = (DEFAULT_T, DEFAULT_F) if channel == PRESSURE else (None, None)
+    if channel == PRESSURE and len(parts) == 3 and parts[1] in OSRS_T and parts[2] in FILTERS:
+        extras = (parts[1], parts[2])
+    elif len(parts) != 1:
+        sys.exit('unknown level "%s" for %s (pressure: level/T1...T16/F0...F16)' % (text, CHANNELS[channel][0]))
+    if parts[0].isdigit() and int(parts[0]) < LEVELS:
+        return (int(parts[0]),) + extras
+    for i, name in enumerate(names):
+        if name.upper() == parts[0]:
+            return (i,) + extras
+    sys.exit('unknown level "%s" for %s (0-3 or one of: %s)' % (text, CHANNELS[channel][0], ', '.join(names)))
+
+
+def level_name(channel, key):
+    name = CHANNELS[channel][3][key[0]]
+    return name if key[1] is None else '%s/%s/%s' % ((name,) + key[1:])
+
+
+def conversion_ms(channel, key):
+    """Conversion time of a level; the pressure uses the osrs_t of the key."""
+    if channel != PRESSURE:
+        return CHANNELS[channel][4][key[0]]
+    return 1 + 2 * OSRS_T[key[1]][1] + 2 * (1, 4, 8, 16)[key[0]] + 0.5
+
+
+def read_samples(path, column, clock):
+    """Yields the selected column of every parsable line, or the value of the "trace <ms> <value>"
+    lines of a station trace, whose first and last times go to clock. The file is scanned once for
+    such lines first, nothing is kept."""
+    with open(path, encoding='latin-1') as f:
+        station = any(line.startswith('trace ') for line in f)
+    with open(path, encoding='latin-1') as f:
+        for line in f:
+            if station:
+                fields = line.split()
+                if len(fields) != 3 or fields[0] != 'trace':
+                    continue
+                try:
+                    ms, value = int(fields[1]), float(fields[2])
+                except ValueError:
+                    continue
+                clock[0] = ms if clock[0] is None else clock[0]
+                clock[1] = ms
+                yield value
+                continue
+            line = line.split('*')[0].strip()
+            if not line or line.startswith('#'):
+                continue
+            fields = line.strip('{}').replace('|', ',').split(',')
+            try:
+                yield float(fields[column])
+            except (ValueError, IndexError):
+                continue
+
+
+def fft(x):
+    """Recursive radix-2 FFT of a power-of-two length list."""
+    n = len(x)
+    if n == 1:
+        return x
+    even = fft(x[0::2])
+    odd = fft(x[1::2])
+    out = [0] * n
+    for k in range(n // 2):
+        t = cmath.exp(-2j * math.pi * k / n) * odd[k]
+        out[k] = even[k] + t
+        out[k + n // 2] = even[k] - t
+    return out
+
+
+class Welch:
+    """Streaming Welch estimate (Hann window, 50 % overlap), one-sided PSD in unit^2/Hz."""
+
+    def __init__(self, rate):
+        self.rate = rate
+        self.window = [0.5 - 0.5 * math.cos(2 * math.pi * i / SEGMENT) for i in range(SEGMENT)]
+        self.power = sum(w * w for w in self.window)
+        self.buffer = []
+        self.sum = [0.0] * (SEGMENT // 2 + 1)
+        self.segments = 0
+
+    def add(self, value):
+        self.buffer.append(value)
+        if len(self.buffer) == SEGMENT:
+            mean = sum(self.buffer) / SEGMENT
+            spectrum = fft([(v - mean) * w for v, w in zip(self.buffer, self.window)])
+            for k in range(SEGMENT // 2 + 1):
+                self.sum[k] += abs(spectrum[k]) ** 2
+            self.segments += 1
+            self.buffer = self.buffer[SEGMENT // 2:]
+
+    def psd(self):
+        if not self.segments:
+            return []
+        scale = 1.0 / (self.segments * self.rate * self.power)
+        return [(k * self.rate / SEGMENT, self.sum[k] * scale * (1 if k in (0, SEGMENT // 2) else 2))
+                for k in range(SEGMENT // 2 + 1)]
+
+
+class Allan:
+    """Streaming Allan deviation at octave-spaced averaging times m = 1, 2, 4, ... samples.
+
+    Up to OVERLAP_MAX the overlapping estimator, from a ring of the last 2 * OVERLAP_MAX + 1 running
+    sums x[n] = y[0] + ... + y[n-1]:
+        avar(m) = sum((x[i+2m] - 2 x[i+m] + x[i])^2) / (2 m^2 (n - 2m + 1))
+    Above it, block averages of 2 * OVERLAP_MAX samples feed a cascade that pairs them up octave by
+    octave, keeping per octave the unpaired average and the previous one:
+        avar(m) = sum((a[j+1] - a[j])^2) / (2 (blocks - 1))
+    The sums are taken relative to the first sample, which keeps them small against their differences.
+    """
+
+    def __init__(self):
+        self.ring = [0.0] * (2 * OVERLAP_MAX + 1)
+        self.n = 0
+        self.first = None
+        self.sum = 0.0
+        self.overlap = {}  # m -> [sum of squares, terms]
+        self.block, self.blockCount = 0.0, 0
+        self.cascade = []  # per octave above OVERLAP_MAX: [unpaired, previous, sum of squares, terms]
+
+    def add(self, value):
+        if self.first is None:
+            self.first = value
+        value -= self.first
+        self.sum += value
+        self.n += 1
+        size = len(self.ring)
+        self.ring[self.n % size] = self.sum
+        m = 1
+        while m <= OVERLAP_MAX and 2 * m <= self.n:
+            d = self.sum - 2 * self.ring[(self.n - m) % size] + self.ring[(self.n - 2 * m) % size]
+            term = self.overlap.setdefault(m, [0.0, 0])
+            term[0] += d * d
+            term[1] += 1
+            m *= 2
+        self.block += value
+        self.blockCount += 1
+        if self.blockCount == 2 * OVERLAP_MAX:
+            self.push(0, self.block / self.blockCount)
+            self.block, self.blockCount = 0.0, 0
+
+    def push(self, octave, average):
+        if octave == len(self.cascade):
+            self.cascade.append([None, None, 0.0, 0])
+        level = self.cascade[octave]
+        if level[1] is not None:
+            level[2] += (average - level[1]) ** 2
+            level[3] += 1
+        level[1] = average
+        if level[0] is None:
+            level[0] = average
+        else:
+            self.push(octave + 1, (level[0] + average) / 2)
+            level[0] = None
+
+    def result(self, rate):
+        """[(tau, adev)] for the averaging times with at least n / 4 overlapping terms or 3 differences."""
+        adev = []
+        for m in sorted(self.overlap):
+            total, terms = self.overlap[m]
+            if 4 * m <= self.n:
+                adev.append((m / rate, math.sqrt(total / (2.0 * m * m * terms))))
+        for octave, (_, _, total, terms) in enumerate(self.cascade):
+            if terms >= 3:
+                adev.append((2 * OVERLAP_MAX * 2 ** octave / rate, math.sqrt(total / (2.0 * terms))))
+        return adev
+
+    def mean(self):
+        return self.first + self.sum / self.n if self.n else 0.0
+
+
+def analyse(samples, rate, clock):
+    """Returns (count, rate, mean, [(tau, adev)], psd) of one trace. Without a rate it is the one of
+    the station trace times in clock, which are known once the samples have been read."""
+    welch = Welch(rate)
+    allan = Allan()
+    for value in samples:
+        allan.add(value)
+        welch.add(value)
+    if not rate:
+        if clock[0] is None or clock[1] == clock[0]:
+            sys.exit('no rate given and no station trace times to measure it')
+        rate = welch.rate = 1000.0 * (allan.n - 1) / (clock[1] - clock[0])
+    if allan.n < 8:
+        return allan.n, rate, 0.0, [], []
+    return allan.n, rate, allan.mean(), allan.result(rate), welch.psd()
+
+
+def white_level(psd):
+    """Median PSD over the upper half of the band (white noise floor), unit/sqrt(Hz)."""
+    upper = sorted(p for f, p in psd[len(psd) // 2:])
+    return math.sqrt(upper[len(upper) // 2]) if upper else float('nan')
+
+
+def write_header(path, choices, report):
+    out = []
+    out.append('/**')
+    out.append(' * @file NoiseProfile.h')
+    out.append(' * @brief Highest oversampling level the adaptive sampling engine may use, per channel,')
+    out.append(' *        and the BMP280 temperature oversampling and IIR filter (main.c).')
+    out.append(' *')
+    out.append(' * Generated by tools/noise_profile.py from recorded noise traces - do not edit by hand.')
+    out.append(' * Each limit is the cheapest level whose single-reading noise (Allan deviation at the')
+    out.append(' * sample interval) meets the channel target.')
+    out.append(' *')
+    for line in report:
+        out.append(' * ' + line if line else ' *')
+    out.append(' */')
+    out.append('')
+    out.append('#ifndef NOISEPROFILE_H_')
+    out.append('#define NOISEPROFILE_H_')
+    out.append('')
+    for i, ch in enumerate(CHANNELS):
+        out.append('#define %-30s %d /**< %s */' % ('NOISE_PROFILE_OS_' + ch[1], choices[i][0], ch[3][choices[i][0]]))
+    osrs, coefficient = OSRS_T[choices[PRESSURE][1]], FILTERS[choices[PRESSURE][2]]
+    out.append('#define %-30s %s /**< x%d */' % ('NOISE_PROFILE_BMP280_OSRS_T', OSRS_T_MACRO[osrs[0]], osrs[1]))
+    out.append('#define %-30s %s /**< %s */' % ('NOISE_PROFILE_BMP280_FILTER', FILTER_MACRO[coefficient[0]],
+                                              'coefficient %d' % coefficient[1] if coefficient[1] > 1 else 'off'))
+    out.append('')
+    out.append('#endif /* NOISEPROFILE_H_ */')
+    open(path, 'w', encoding='latin-1', newline='\n').write('\n'.join(out) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--trace', action='append', default=[], metavar='CH:LEVEL:RATE:PATH',
+                        help='raw trace of one channel at one oversampling level')
+    parser.add_argument('--target', action='append', default=[], metavar='CH=NOISE',
+                        help='target single-reading noise in channel units')
+    parser.add_argument('--column', type=int, default=0, help='value column in comma separated traces')
+    parser.add_argument('--max-lag', type=float, default=15.0,
+                        help='longest 75 %% step response of the BMP280 IIR filter at the trace rate (s)')
+    parser.add_argument('--output', default=os.path.join(PROJECT, 'NoiseProfile.h'))
+    args = parser.parse_args()
+
+    targets = [ch[6] for ch in CHANNELS]
+    for item in args.target:
+        name, _, value = item.partition('=')
+        targets[channel_by_name(name)] = float(value)
+
+    # noise[channel][key] = (single-reading noise, filter lag in s), key = (level, osrs_t, filter)
+    noise = [{} for _ in CHANNELS]
+    for spec in args.trace:
+        parts = spec.split(':', 3)
+        if len(parts) != 4:
+            sys.exit('bad trace "%s", expected channel:level:rate_hz:path' % spec)
+        channel = channel_by_name(parts[0])
+        key = parse_level(channel, parts[1])
+        rate = 0.0 if parts[2] == 'auto' else float(parts[2])
+        clock = [None, None]
+        n, rate, mean, adev, psd = analyse(read_samples(parts[3], args.column, clock), rate, clock)
+        if not adev:
+            sys.exit('%s: too few samples (%d)' % (parts[3], n))
+        name, _, unit = CHANNELS[channel][:3]
+        floor_tau, floor = min(adev, key=lambda a: a[1])
+        lag = FILTER_STEP[FILTERS[key[2]][1]] / rate if key[2] else 0.0
+        noise[channel][key] = (adev[0][1], lag)
+        print('%s %s: %d samples at %g Hz, mean %.3f %s' % (name, level_name(channel, key), n, rate, mean, unit))
+        print('  adev(tau0) %.4f, floor %.4f at %g s, white %.4f %s/sqrt(Hz)%s'
+              % (adev[0][1], floor, floor_tau, white_level(psd), unit, ', filter lag %.1f s' % lag if lag else ''))
+        print('  ' + ' '.join('%g:%.3g' % a for a in adev))
+
+    choices = []
+    report = ['channel      level         noise       target   time ms  charge uC']
+    for i, (name, macro, unit, names, times, current, _) in enumerate(CHANNELS):
+        measured = sorted(noise[i])
+        if not measured:  # Not measured: keep the engine's full range and the main.c settings
+            choices.append((LEVELS - 1, DEFAULT_T, DEFAULT_F) if i == PRESSURE else (LEVELS - 1, None, None))
+            report.append('%-12s %-13s not measured' % (name, level_name(i, choices[-1])))
+            continue
+        usable = [k for k in measured if noise[i][k][1] <= args.max_lag] or measured
+        passing = [k for k in usable if noise[i][k][0] <= targets[i]]
+        if passing:  # Cheapest, then the shortest filter lag
+            key = min(passing, key=lambda k: (conversion_ms(i, k), noise[i][k][1]))
+        else:
+            key = min(usable, key=lambda k: noise[i][k][0])
+            print('warning: %s misses its target %.3g %s at every level, using the quietest (%s)'
+                  % (name, targets[i], unit, level_name(i, key)))
+        choices.append(key)
+        report.append('%-12s %-13s %-11.4g %-8.3g %-8.3g %.3g'
+                      % (name, level_name(i, key), noise[i][key][0], targets[i], conversion_ms(i, key),
+                         conversion_ms(i, key) * current))
+
+    print()
+    print('\n'.join(report))
+    write_header(args.output, choices, report)
+    print('written %s' % os.path.normpath(args.output))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+poa_accuracy.py - host accuracy check of the angle of incidence and plane-of-array irradiance
+(PlaneOfArray.c).
+
+Builds PlaneOfArray.c, Tracker.c and FixedMath.c with the host C compiler against stubbed SUN,
+Date_Clock and Derived_Refresh(), sweeps the sun over the sky with light readings from overcast
+to clear for fixed planes and for the tracker rows, and compares the angle of incidence, the
+diffuse part and the plane-of-array irradiance with the same Erbs decomposition and isotropic
+sky transposition in double precision (as pvlib.irradiance.erbs and get_total_irradiance with
+model='isotropic').
+
+  python3 tools/poa_accuracy.py
+  python3 tools/poa_accuracy.py --step 2
+"""
+
+import argparse
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+
+CAL_Q8 = 138  # CLEARSKY_CAL_Q8: W/m2 per sunlevel unit, Q8
+ALBEDO = 6554 / 32768
+DAY = (6, 21)  # Month, day of the sweep
+
+# (name, mode, tilt, azimuth), degrees; mode 1 = tracker rows (Tracker.h defaults)
+PLANES = [
+    ('fixed 35 S', 0, 35, 180),
+    ('fixed 90 E', 0, 90, 90),
+    ('fixed 10 SW', 0, 10, 225),
+    ('tracker', 1, 0, 0),
+]
+
+SETTINGS = '''#include <stdint.h>
+#include <math.h>
+#define PROGMEM
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#include "Units.h"
+#include "FixedMath.h"
+#include "Tracker.h"
+#include "PlaneOfArray.h"
+#define CLEARSKY_CAL_Q8 %d
+#define DERIVED_TRACKER 1
+#define DERIVED_ADJ_ANGLES 0
+#define DERIVED_BIT(node) (1U << (node))
+typedef struct { float adjelevation, adjazimuth; uint16_t sunlevel; } SunStub;
+typedef struct { int month, day; } CalendarStub;
+extern SunStub SUN;
+extern CalendarStub Date_Clock;
+void Derived_Refresh(uint16_t mask);
+int16_t FixedMath_Sin(int32_t angle);
+int16_t FixedMath_Cos(int32_t angle);
+int16_t FixedMath_Atan2(int32_t y, int32_t x);
+int16_t FixedMath_Acos(int16_t x);
+uint16_t FixedMath_Sqrt(uint32_t x);
+void Tracker_Compute(void);
+void PlaneOfArray_Configure(uint8_t mode, int16_t tilt, uint16_t azimuth);
+void PlaneOfArray_Update(void);
+''' % CAL_Q8
+
+# Reads "c mode tilt azimuth" planes and "s elevation azimuth sunlevel" samples from stdin.
+HARNESS = '''#include <stdio.h>
+#include "Settings.h"
+
+SunStub SUN;
+CalendarStub Date_Clock = { %d, %d };
+
+void Derived_Refresh(uint16_t mask) {
+    if (mask & DERIVED_BIT(DERIVED_TRACKER))
+        Tracker_Compute();
+}
+
+int main(void) {
+    char kind;
+    while (scanf(" %%c", &kind) == 1) {
+        if (kind == 'c') {
+            unsigned mode, azimuth; int tilt;
+            scanf("%%u %%d %%u", &mode, &tilt, &azimuth);
+            PlaneOfArray_Configure(mode, tilt, azimuth);
+        } else {
+            scanf("%%f %%f %%hu", &SUN.adjelevation, &SUN.adjazimuth, &SUN.sunlevel);
+            PlaneOfArray_Update();
+            printf("%%u %%u %%u %%u %%u\\n", PlaneOfArray.aoi, PlaneOfArray.dhi, PlaneOfArray.beam, PlaneOfArray.poa,
+                   PlaneOfArray.e0);
+        }
+    }
+    return 0;
+}
+''' % DAY
+
+
+def run(command, **kwargs):
+    result = subprocess.run(command, capture_output=True, text=True, **kwargs)
+    if result.returncode:
+        sys.exit('%s\n%s%s' % (' '.join(command), result.stdout, result.stderr))
+    return result.stdout
+
+
+def erbs(kt):
+    if kt <= 0.22:
+        return 1 - 0.09 * kt
+    if kt > 0.8:
+        return 0.165
+    return 0.9511 - 0.1604 * kt + 4.388 * kt ** 2 - 16.638 * kt ** 3 + 12.336 * kt ** 4
+
+
+def tracker_plane(se, sn, su):
+    """Surface normal of the tracker rows for the Tracker.h defaults (N-S axis, GCR 0.4, 60 deg)."""
+    theta = math.degrees(math.atan2(se, su))
+    shade = math.cos(math.radians(theta)) / 0.4
+    if shade < 1:
+        theta -= math.copysign(math.degrees(math.acos(shade)), theta)
+    r = math.radians(max(-60.0, min(60.0, theta)))
+    return math.sin(r), 0.0, math.cos(r)
+
+
+def reference(elevation, azimuth, sunlevel, mode, tilt, plane_azimuth):
+    """Double precision (AOI deg, DHI, beam on plane, POA in W/m2)."""
+    r = math.radians
+    se = math.cos(r(elevation)) * math.sin(r(azimuth))
+    sn = math.cos(r(elevation)) * math.cos(r(azimuth))
+    su = math.sin(r(elevation))
+    if mode:
+        normal = tracker_plane(se, sn, su)
+    else:
+        normal = (math.sin(r(tilt)) * math.sin(r(plane_azimuth)), math.sin(r(tilt)) * math.cos(r(plane_azimuth)),
+                  math.cos(r(tilt)))
+    cos_aoi = min(1.0, se * normal[0] + sn * normal[1] + su * normal[2])
+    ghi = sunlevel * CAL_Q8 / 256
+    doy = (DAY[0] - 1) * 30.44 + DAY[1]
+    e0 = 1361 * (1 + 0.033 * math.cos(2 * math.pi * doy / 365))
+    kt = min(1.0, ghi / (e0 * su))
+    dhi = ghi if elevation < 5 else ghi * erbs(kt)
+    beam = max(0.0, (ghi - dhi) * cos_aoi / su)
+    poa = beam + dhi * (1 + normal[2]) / 2 + ghi * ALBEDO * (1 - normal[2]) / 2
+    return math.degrees(math.acos(cos_aoi)), dhi, beam, poa
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--cc', default='cc', help='host C compiler')
+    parser.add_argument('--step', type=float, default=3.0, help='sun position grid step, degrees')
+    args = parser.parse_args()
+
+    cases, lines = [], []
+    for plane in PLANES:
+        _, mode, tilt, azimuth = plane
+        lines.append('c %d %d %d' % (mode, tilt * 100, azimuth * 100))
+        elevation = 1.0
+        while elevation < 90:
+            azimuth = 0.0
+            while azimuth < 360:
+                # GHI from 5 % to 100 % of a simple clear-sky value
+                clear = 1098 * math.sin(math.radians(elevation)) * math.exp(-0.057 / math.sin(math.radians(elevation)))
+                for fraction in (0.05, 0.3, 0.6, 0.8, 1.0):
+                    sunlevel = round(clear * fraction * 256 / CAL_Q8)
+                    lines.append('s %.3f %.3f %d' % (elevation, azimuth, sunlevel))
+                    cases.append((plane, elevation, azimuth, sunlevel))
+                azimuth += args.step
+            elevation += args.step
+
+    work = tempfile.mkdtemp(prefix='poa_accuracy')
+    try:
+        sources = []
+        for name in ('PlaneOfArray', 'Tracker', 'FixedMath'):
+            for suffix in ('.c', '.h', 'Var.h'):
+                shutil.copy(os.path.join(PROJECT, name + suffix), work)
+            sources.append(os.path.join(work, name + '.c'))
+        shutil.copy(os.path.join(PROJECT, 'Units.h'), work)
+        open(os.path.join(work, 'Settings.h'), 'w').write(SETTINGS)
+        open(os.path.join(work, 'harness.c'), 'w').write(HARNESS)
+        binary = os.path.join(work, 'harness')
+        run([args.cc, '-O2', '-std=gnu99', '-Wall', '-I', work] + sources +
+            [os.path.join(work, 'harness.c'), '-o', binary, '-lm'])
+        output = run([binary], input='\n'.join(lines) + '\n').split()
+    finally:
+        shutil.rmtree(work)
+
+    worst = {}
+    for i, (plane, elevation, azimuth, sunlevel) in enumerate(cases):
+        aoi, dhi, beam, poa, _ = (int(v) for v in output[5 * i:5 * i + 5])
+        ref_aoi, ref_dhi, ref_beam, ref_poa = reference(elevation, azimuth, sunlevel, *plane[1:])
+        entry = worst.setdefault(plane[0], [0.0] * 4)
+        entry[0] = max(entry[0], abs(aoi / 100 - ref_aoi))
+        entry[1] = max(entry[1], abs(dhi / 10 - ref_dhi))
+        entry[2] = max(entry[2], abs(poa / 10 - ref_poa))
+        entry[3] = max(entry[3], abs(poa / 10 - ref_poa) / max(ref_poa, 50))
+
+    print('%-12s %10s %10s %10s %10s' % ('plane', 'AOI deg', 'DHI W/m2', 'POA W/m2', 'POA %'))
+    for name, (aoi, dhi, poa, relative) in worst.items():
+        print('%-12s %10.3f %10.2f %10.2f %10.2f' % (name, aoi, dhi, poa, 100 * relative))
+    print('(worst absolute errors over %d samples per plane, %% relative to max(POA, 50 W/m2))'
+          % (len(cases) // len(PLANES)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""
+ram_usage.py - static RAM, worst case stack and free SRAM of the firmware.
+
+The AVR64DD32 has 8 KB of SRAM for .data, .bss and the stack. This tool adds up
+
+  - the static RAM: .data + .bss + .noinit of the ELF file (avr-size -A),
+  - the stack bound: the deepest call chain from main(), plus the two deepest interrupt vectors
+    (the level 1 vector, CPUINT.LVL1VEC, can interrupt any level 0 one, and level 0 vectors do not
+    nest), from the call graph avr-gcc writes with -fcallgraph-info=su: every function with its
+    frame in bytes and the functions it calls. A call costs the return address on top of the frame.
+    Library functions have no frame in the graph and get a budget instead (--budget): the printf
+    family with float conversion (vsnprintf_P of USART_printf_P), the scanf family, and a small
+    default for the rest (string and maths helpers),
+
+and prints the free SRAM, which should be positive with room to spare, and the chains that set
+the bound.
+
+  python3 tools/ram_usage.py --elf "Debug/AVR64dd32 meteorologine stotele v3.elf" --callgraph Debug
+  python3 tools/ram_usage.py --host
+  python3 tools/ram_usage.py --host --budget vsnprintf=200
+
+The AVR figures need a build with -fcallgraph-info=su added to the compiler options. Without
+avr-gcc, --host builds the sources with the host compiler in 32-bit mode (-m32, so gcc-multilib)
+with the AVR code generation flags, PROGMEM data in a section of its own and the peripherals of
+tools/loop_benchmark/: an estimate only. Pointers and int are twice as wide as on the AVR, which
+overstates structures that hold them, and x86 frames differ from AVR ones in both directions.
+"""
+
+import argparse
+import glob
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+PROJECT = os.path.join(TOOLS, '..', 'AVR64dd32 meteorologine stotele v3')
+SIMULATION = os.path.join(TOOLS, 'loop_benchmark')
+
+RAM = 8192
+STATIC = ('.data', '.bss', '.noinit')
+HOST_FLAGS = ['-m32', '-std=gnu99', '-Os', '-w', '-funsigned-char', '-fpack-struct', '-fshort-enums', '-fno-common',
+              '-fdata-sections', '-fno-jump-tables', '-fcallgraph-info=su']
+PRINTF = ('vfprintf', 'vsnprintf', 'vsnprintf_P', 'snprintf', 'snprintf_P', 'sprintf', 'sprintf_P', 'printf',
+          'printf_P', 'vsprintf')
+SCANF = ('vfscanf', 'sscanf', 'sscanf_P', '__isoc99_sscanf')
+BUDGET_PRINTF = 160  # avr-libc vfprintf with dtoa_prf and ftoa_engine (libprintf_flt); measure to refine
+BUDGET_SCANF = 128
+BUDGET_OTHER = 32
+RETURN_ADDRESS = 2  # AVR64DD32: 16-bit program counter
+HOST_PGMSPACE = '''/* PROGMEM data stays in flash on the AVR: a section of its own, not counted */
+#include_next <avr/pgmspace.h>
+#undef PROGMEM
+#undef PSTR
+#define PROGMEM __attribute__((section(".progmem.data")))
+#define PSTR(s) (__extension__({static const char __c[] PROGMEM = (s); &__c[0];}))
+'''
+
+
+def run(command, **kwargs):
+    result = subprocess.run(command, capture_output=True, text=True, **kwargs)
+    if result.returncode:
+        sys.exit('%s\n%s%s' % (' '.join(command), result.stdout, result.stderr))
+    return result.stdout
+
+
+def static_ram(size, path, sections):
+    """Bytes of the given sections (prefix match) from `size -A`, without x86 constant pools."""
+    total = 0
+    for line in run([size, '-A', path]).splitlines():
+        words = line.split()
+        if len(words) >= 2 and words[1].isdigit() and any(words[0] == s or words[0].startswith(s + '.')
+                                                          for s in sections):
+            if not words[0].startswith('.rodata.cst'):  # Float literals: immediates on the AVR
+                total += int(words[1])
+    return total
+
+
+def host_build(cc, work):
+    """Builds the sources for the host estimate, returns (relocatable object, callgraph directory)."""
+    include = os.path.join(work, 'include')
+    os.makedirs(os.path.join(include, 'avr'))
+    open(os.path.join(include, 'avr', 'pgmspace.h'), 'w').write(HOST_PGMSPACE)
+    if subprocess.run([cc, '-m32', '-E', '-x', 'c', '-', '-o', os.devnull], input='#include <stdio.h>\n',
+                      capture_output=True, text=True).returncode:
+        os.makedirs(os.path.join(include, 'gnu'))  # 32-bit glibc headers missing: only this one differs
+        open(os.path.join(include, 'gnu', 'stubs-32.h'), 'w').write('')
+    objects = []
+    for name in sorted(os.listdir(PROJECT)):
+        if name.endswith('.c'):
+            obj = os.path.join(work, name[:-2] + '.o')
+            run([cc] + HOST_FLAGS + ['-I', include, '-I', SIMULATION, '-I', PROJECT, '-idirafter',
+                                     '/usr/include/x86_64-linux-gnu', '-include', os.path.join(SIMULATION, 'sim.h'),
+                                     '-c', os.path.join(PROJECT, name), '-o', obj], cwd=work)
+            objects.append(obj)
+    whole = os.path.join(work, 'all.o')
+    run([cc, '-m32', '-r', '-o', whole] + objects)
+    return whole, work
+
+
+def callgraph(directory):
+    """Returns ({function: frame bytes or None}, {function: callees}) from the .ci files."""
+    frames, calls = {}, {}
+    for path in glob.glob(os.path.join(directory, '**', '*.ci'), recursive=True):
+        for line in open(path, encoding='latin-1'):
+            node = re.match(r'node: \{ title: "([^"]+)"(?: label: "[^"]*?\\n[^"]*?\\n(\d+) bytes)?', line)
+            if node:
+                name = node.group(1).split(':')[-1].lstrip('*')
+                if node.group(2) is not None:
+                    frames[name] = int(node.group(2))
+                else:
+                    frames.setdefault(name, None)
+                continue
+            edge = re.match(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"', line)
+            if edge:
+                source, target = (n.split(':')[-1].lstrip('*') for n in edge.groups())
+                calls.setdefault(source, set()).add(target)
+    return frames, calls
+
+
+def budget(name, budgets):
+    if name in budgets:
+        return budgets[name]
+    if name in PRINTF:
+        return budgets.get('printf', BUDGET_PRINTF)
+    if name in SCANF:
+        return budgets.get('scanf', BUDGET_SCANF)
+    return budgets.get('other', BUDGET_OTHER)
+
+
+def deepest(root, frames, calls, budgets, call_bytes, ignore, through=None):
+    """
+    Deepest stack from `root` with its chain [(function, bytes, budgeted)], or None; with `through`
+    only chains that end in one of those library functions count. Recursion is reported, not followed.
+    """
+    memo = {}
+
+    def walk(name, active):
+        if name in memo:
+            return memo[name]
+        own = frames.get(name)
+        if own is None:
+            bytes = budget(name, budgets)
+            result = (bytes, [(name, bytes, True)]) if through is None or name in through else None
+        else:
+            best = None if through else (0, [])
+            for callee in sorted(calls.get(name, ())):
+                if ignore(callee):
+                    continue
+                if callee in active:
+                    print('recursion: %s -> %s (not bounded)' % (name, callee))
+                    continue
+                below = walk(callee, active | {callee})
+                if below and (best is None or below[0] + call_bytes > best[0]):
+                    best = (below[0] + call_bytes, below[1])
+            result = (own + best[0], [(name, own, False)] + best[1]) if best else None
+        memo[name] = result
+        return result
+
+    return walk(root, {root})
+
+
+def chain_text(chain):
+    return ' > '.join('%s(%d%s)' % (name, size, ' budget' if budgeted else '') for name, size, budgeted in chain)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--elf', help='firmware ELF file (avr-size -A)')
+    parser.add_argument('--callgraph', help='directory with the .ci files of a -fcallgraph-info=su build')
+    parser.add_argument('--size', default='avr-size', help='size program for --elf')
+    parser.add_argument('--host', action='store_true', help='estimate with the host compiler (no avr-gcc)')
+    parser.add_argument('--cc', default='gcc', help='host C compiler for --host')
+    parser.add_argument('--ram', type=int, default=RAM, help='SRAM bytes')
+    parser.add_argument('--budget', action='append', default=[], metavar='FUNCTION=BYTES',
+                        help='stack of a library function, or of the groups printf, scanf and other')
+    args = parser.parse_args()
+    if not args.host and not (args.elf and args.callgraph):
+        parser.error('give --elf and --callgraph, or --host')
+    budgets = {}
+    for item in args.budget:
+        name, _, value = item.partition('=')
+        budgets[name] = int(value)
+
+    work = tempfile.mkdtemp(prefix='ram_usage')
+    try:
+        if args.host:
+            whole, directory = host_build(args.cc, work)
+            static = static_ram('size', whole, STATIC + ('.rodata',))
+            call_bytes = 0  # The x86 frames hold the return address
+            vector = re.compile(r'^sim_vector_')
+            ignore = lambda name: name.startswith('sim_') and not vector.match(name)
+        else:
+            static = static_ram(args.size, args.elf, STATIC)
+            directory = args.callgraph
+            call_bytes = RETURN_ADDRESS
+            vector = re.compile(r'^__vector_\d+$')
+            ignore = lambda name: False
+        frames, calls = callgraph(directory)
+    finally:
+        shutil.rmtree(work)
+    if 'main' not in frames:
+        sys.exit('no main() in the call graph')
+
+    stack, chain = deepest('main', frames, calls, budgets, call_bytes, ignore)
+    vectors = sorted((deepest(name, frames, calls, budgets, call_bytes, ignore) + (name,)
+                      for name in frames if vector.match(name)), key=lambda v: -v[0])
+    nested = sum(v[0] + call_bytes for v in vectors[:2])
+    printing = deepest('main', frames, calls, budgets, call_bytes, ignore, PRINTF)
+
+    print('%s: static RAM %d B (%s)' % ('host estimate' if args.host else 'avr-size', static,
+                                       ' + '.join(STATIC + (('.rodata',) if args.host else ()))))
+    print('stack: main %d B + vectors %d B = %d B' % (stack, nested, stack + nested))
+    print('  main: %s' % chain_text(chain))
+    for depth, path, name in vectors[:2]:
+        print('  vector %d B: %s' % (depth, chain_text(path)))
+    if printing:
+        print('  main to printf %d B: %s' % (printing[0], chain_text(printing[1])))
+    free = args.ram - static - stack - nested
+    print('free: %d B of %d B' % (free, args.ram))
+    return 0 if free > 0 else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
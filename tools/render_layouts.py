@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""
+render_layouts.py - pre-renders static screen labels for the ST7567S display.
+
+Reads the 5x8 font from font.h, renders every static label of the station windows into
+page-aligned column bitmaps (5 font columns + 1 spacing column per character, exactly what
+screen_draw_char() sends) and writes:
+
+  Layouts.h     label / layout ids and flash and bus cost figures
+  LayoutsVar.h  PROGMEM bitmaps and span tables (included by ST7567S.c only)
+
+Run it after changing a label or the font:
+
+  python3 tools/render_layouts.py
+
+Strings are latin-1 encoded, so '\\xb0' is the degree sign (font index 96).
+"""
+
+import os
+import re
+import sys
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+
+# Bus timing model: F_SCL from i2c.h, 9 SCL clocks per byte (8 data + ACK),
+# about 2 extra clocks for START/STOP per transaction.
+F_SCL = 1200000
+CLOCKS_PER_BYTE = 9
+CLOCKS_PER_TRANSACTION = 2
+SCREEN_COLUMNS = 128
+CHARACTER_WIDTH = 6
+
+# Static labels: (id, text). English texts, as shown by Windows.c.
+LABELS = [
+    ('LABEL_TEMPERATURE', 'Temperature:'),
+    ('LABEL_PRESSURE', 'Pressure:'),
+    ('LABEL_HUMIDITY', 'Humidity:'),
+    ('LABEL_WIND', 'Wind:'),
+    ('LABEL_LIGHT', 'Light level:'),
+    ('LABEL_SEPARATOR', '-' * 21),
+    ('LABEL_TIME', 't:'),
+    ('LABEL_AZIMUTH', 'az:\xb0'),
+    ('LABEL_ELEVATION', 'el.\xb0:'),
+    ('LABEL_ADJ_ELEVATION', 'adj. el.\xb0:'),
+    ('LABEL_TIMEZONE', 't.z:'),
+    ('LABEL_LATITUDE', 'lat. \xb0:'),
+    ('LABEL_LONGITUDE', 'long. \xb0:'),
+    ('LABEL_BMP_T', 'bmp T C\xb0:'),
+    ('LABEL_SHT_T', 'sht T C\xb0:'),
+    ('LABEL_P', 'p hPa:'),
+    ('LABEL_RH', 'rh %:'),
+    ('LABEL_UNCOMP_ALT', 'not adj.alt. m:'),
+    ('LABEL_COMP_ALT', 'adj.alt. m:'),
+    ('LABEL_AVRG_ALT', 'avg.alt. m:'),
+    ('LABEL_REAL_ALT', 'rl.alt. m:'),
+    ('LABEL_WIND_SPEED', 'w.s. m/s:'),
+    ('LABEL_WIND_DIR', 'w.d.no:'),
+    ('LABEL_LIGHT_LEVEL', 'l.l. mV:'),
+]
+
+# Fixed layouts: (id, [(label id, page, start pixel), ...]), blitted once on window entry.
+LAYOUTS = [
+    ('LAYOUT_MAIN', [
+        ('LABEL_TEMPERATURE', 0, 0),
+        ('LABEL_PRESSURE', 1, 0),
+        ('LABEL_HUMIDITY', 2, 0),
+        ('LABEL_WIND', 3, 0),
+        ('LABEL_LIGHT', 4, 0),
+        ('LABEL_SEPARATOR', 5, 0),
+    ]),
+]
+
+
+def load_font(path):
+    """Returns the font table as a list of 5-byte columns, in font.h order."""
+    text = open(path, encoding='latin-1').read()
+    body = text[text.index('font[161][5]'):]
+    rows = re.findall(r'\{\s*(0x[0-9A-Fa-f]{2})\s*,\s*(0x[0-9A-Fa-f]{2})\s*,\s*(0x[0-9A-Fa-f]{2})\s*,'
+                      r'\s*(0x[0-9A-Fa-f]{2})\s*,\s*(0x[0-9A-Fa-f]{2})\s*\}', body)
+    if len(rows) != 161:
+        sys.exit('font.h: expected 161 glyphs, found %d' % len(rows))
+    return [[int(v, 16) for v in row] for row in rows]
+
+
+def glyph_index(c):
+    """Same mapping as screen_draw_char()."""
+    c = ord(c)
+    if (c < 32 or c > 127) and c != 176 and c < 192:
+        c = 32
+    if c == 176:
+        return c - 80
+    if c > 191:
+        return c - 95
+    return c - 32
+
+
+def render(font, text):
+    columns = []
+    for c in text:
+        columns += font[glyph_index(c)]
+        columns.append(0x00)
+    return columns
+
+
+def transaction_us(data_bytes):
+    clocks = CLOCKS_PER_TRANSACTION + CLOCKS_PER_BYTE * (1 + data_bytes)  # address + payload
+    return clocks * 1e6 / F_SCL
+
+
+def runtime_label_us(text, start_pixel=0):
+    """Bus time of screen_write_formatted_text() for a left-aligned label: 3 command writes,
+    then one 2-byte transaction per column, padded with spaces to the end of the line."""
+    chars = (SCREEN_COLUMNS - start_pixel) // CHARACTER_WIDTH
+    return 3 * transaction_us(2) + chars * CHARACTER_WIDTH * transaction_us(2)
+
+
+def blit_us(length):
+    """Bus time of screen_blit(): one command burst (control + 3 commands) and one data burst."""
+    return transaction_us(4) + transaction_us(1 + length)
+
+
+def c_bytes(values, indent='    ', per_line=16):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append(indent + ', '.join('0x%02X' % v for v in values[i:i + per_line]) + ',')
+    return '\n'.join(lines)
+
+
+def main():
+    font = load_font(os.path.join(PROJECT, 'font.h'))
+    label_ids = [name for name, _ in LABELS]
+
+    bitmap = []
+    index = []
+    for name, text in LABELS:
+        columns = render(font, text)
+        if len(columns) > SCREEN_COLUMNS:
+            sys.exit('%s is wider than the screen' % name)
+        index.append((name, len(bitmap), len(columns), text))
+        bitmap += columns
+
+    spans = []
+    first = [0]
+    report = []
+    for name, layout in LAYOUTS:
+        before = after = 0.0
+        for label, page, column in layout:
+            spans.append((label, page, column))
+            length = index[label_ids.index(label)][2]
+            before += runtime_label_us(dict(LABELS)[label], column)
+            after += blit_us(length)
+        first.append(len(spans))
+        report.append((name, before, after))
+
+    flash_bitmap = len(bitmap)
+    flash_tables = 3 * len(index) + 3 * len(spans) + len(first)
+
+    header = []
+    header.append('/**')
+    header.append(' * @file Layouts.h')
+    header.append(' * @brief Ids of the pre-rendered static screen labels and layouts.')
+    header.append(' *')
+    header.append(' * Generated by tools/render_layouts.py from font.h - do not edit by hand.')
+    header.append(' *')
+    header.append(' * Flash cost: %d bytes of label bitmaps + %d bytes of tables = %d bytes.'
+                  % (flash_bitmap, flash_tables, flash_bitmap + flash_tables))
+    header.append(' * Bus time at %d kHz SCL, runtime rendering per pass -> blit per window entry:'
+                  % (F_SCL // 1000))
+    for name, before, after in report:
+        header.append(' * - %s: %.2f ms -> %.2f ms' % (name, before / 1000, after / 1000))
+    header.append(' */')
+    header.append('')
+    header.append('#ifndef LAYOUTS_H_')
+    header.append('#define LAYOUTS_H_')
+    header.append('')
+    for i, (name, offset, length, text) in enumerate(index):
+        header.append('#define %-24s %2d /**< "%s" (%d columns) */'
+                      % (name, i, text.replace('\xb0', 'deg'), length))
+    header.append('#define %-24s %2d /**< Number of labels */' % ('LABEL_COUNT', len(index)))
+    header.append('')
+    for i, (name, _) in enumerate(LAYOUTS):
+        header.append('#define %-24s %2d' % (name, i))
+    header.append('#define %-24s %2d /**< Number of layouts */' % ('LAYOUT_COUNT', len(LAYOUTS)))
+    header.append('')
+    header.append('#endif /* LAYOUTS_H_ */')
+
+    var = []
+    var.append('/**')
+    var.append(' * @file LayoutsVar.h')
+    var.append(' * @brief PROGMEM bitmaps and span tables of the pre-rendered static screen labels.')
+    var.append(' *')
+    var.append(' * Generated by tools/render_layouts.py from font.h - do not edit by hand.')
+    var.append(' * Included by ST7567S.c only.')
+    var.append(' */')
+    var.append('')
+    var.append('#ifndef LAYOUTSVAR_H_')
+    var.append('#define LAYOUTSVAR_H_')
+    var.append('')
+    var.append('/** @brief Column bitmaps of all labels, one byte per display column (bit 0 = top row). */')
+    var.append('const uint8_t label_bitmap[%d] PROGMEM = {' % len(bitmap))
+    var.append(c_bytes(bitmap))
+    var.append('};')
+    var.append('')
+    var.append('/** @brief Offset and width of every label inside `label_bitmap`. */')
+    var.append('const LabelBitmap label_index[LABEL_COUNT] PROGMEM = {')
+    for name, offset, length, _ in index:
+        var.append('    { %4d, %3d }, /**< %s */' % (offset, length, name))
+    var.append('};')
+    var.append('')
+    var.append('/** @brief Label placements of all layouts. */')
+    var.append('const LayoutSpan layout_spans[%d] PROGMEM = {' % len(spans))
+    for label, page, column in spans:
+        var.append('    { %s, %d, %d },' % (label, page, column))
+    var.append('};')
+    var.append('')
+    var.append('/** @brief First span of every layout in `layout_spans` (the last entry closes the list). */')
+    var.append('const uint8_t layout_first[LAYOUT_COUNT + 1] PROGMEM = { %s };'
+               % ', '.join(str(v) for v in first))
+    var.append('')
+    var.append('#endif /* LAYOUTSVAR_H_ */')
+
+    open(os.path.join(PROJECT, 'Layouts.h'), 'w', encoding='latin-1').write('\n'.join(header) + '\n')
+    open(os.path.join(PROJECT, 'LayoutsVar.h'), 'w', encoding='latin-1').write('\n'.join(var) + '\n')
+
+    print('labels: %d, bitmap: %d bytes, tables: %d bytes' % (len(index), flash_bitmap, flash_tables))
+    for name, before, after in report:
+        print('%s: %.2f ms per pass -> %.2f ms per window entry' % (name, before / 1000, after / 1000))
+
+
+if __name__ == '__main__':
+    main()
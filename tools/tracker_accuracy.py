@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+tracker_accuracy.py - host accuracy check of the fixed-point tracker rotation (Tracker.c).
+
+Builds Tracker.c and FixedMath.c with the host C compiler against a stubbed SUN structure, sweeps
+the sun over the sky for a few row configurations (axis azimuth, axis tilt, ground coverage ratio)
+and compares the ideal and backtracked rotation with the same single-axis tracking and
+backtracking equations in double precision (as in pvlib.tracking.singleaxis).
+
+Two kinds of sun positions are ill-conditioned in any precision and are counted apart: the sun
+(almost) along the axis, where the rotation is undefined, and the start of backtracking,
+cos(theta) / GCR within 0.2 % of 1, where acos() turns a Q15 rounding step into tenths of a degree.
+
+  python3 tools/tracker_accuracy.py
+  python3 tools/tracker_accuracy.py --step 0.5
+"""
+
+import argparse
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+
+# (axis azimuth, axis tilt, GCR, max angle), degrees
+CONFIGS = [
+    (180, 0, 0.4, 60),
+    (180, 0, 0.6, 55),
+    (0, 0, 0.35, 60),
+    (180, 10, 0.4, 60),
+    (200, 5, 0.5, 50),
+]
+
+SETTINGS = '''#include <stdint.h>
+#include <math.h>
+#define PROGMEM
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#include "Units.h"
+#include "FixedMath.h"
+#include "Tracker.h"
+typedef struct { float adjelevation, adjazimuth; } SunStub;
+extern SunStub SUN;
+int16_t FixedMath_Sin(int32_t angle);
+int16_t FixedMath_Cos(int32_t angle);
+int16_t FixedMath_Atan2(int32_t y, int32_t x);
+int16_t FixedMath_Acos(int16_t x);
+uint16_t FixedMath_Sqrt(uint32_t x);
+void Tracker_Compute(void);
+'''
+
+# Reads "axis tilt gcr max" configurations and "elevation azimuth" sun positions from stdin.
+HARNESS = '''#include <stdio.h>
+#include "Settings.h"
+
+SunStub SUN;
+
+int main(void) {
+    char kind;
+    while (scanf(" %c", &kind) == 1) {
+        if (kind == 'c') {
+            unsigned axis, gcr; int tilt, max;
+            scanf("%u %d %u %d", &axis, &tilt, &gcr, &max);
+            Tracker.axisAzimuth = axis; Tracker.axisTilt = tilt; Tracker.gcr = gcr; Tracker.maxAngle = max;
+        } else {
+            scanf("%f %f", &SUN.adjelevation, &SUN.adjazimuth);
+            Tracker_Compute();
+            printf("%d %d %d\\n", Tracker.ideal, Tracker.angle, Tracker.backtracking);
+        }
+    }
+    return 0;
+}
+'''
+
+
+def run(command, **kwargs):
+    result = subprocess.run(command, capture_output=True, text=True, **kwargs)
+    if result.returncode:
+        sys.exit('%s\n%s%s' % (' '.join(command), result.stdout, result.stderr))
+    return result.stdout
+
+
+def reference(elevation, azimuth, axis, tilt, gcr, max_angle):
+    """Double precision (ideal, angle, backtracking, well conditioned), angles in degrees."""
+    r = math.radians
+    se = math.cos(r(elevation)) * math.sin(r(azimuth))
+    sn = math.cos(r(elevation)) * math.cos(r(azimuth))
+    su = math.sin(r(elevation))
+    x = se * math.cos(r(axis)) - sn * math.sin(r(axis))
+    z = (se * math.sin(r(axis)) + sn * math.cos(r(axis))) * math.sin(r(tilt)) + su * math.cos(r(tilt))
+    theta = math.degrees(math.atan2(x, z))
+    angle, backtracking = theta, False
+    shade = math.cos(r(theta)) / gcr
+    if shade < 1:
+        angle = theta - math.copysign(math.degrees(math.acos(max(-1.0, shade))), theta)
+        backtracking = True
+    conditioned = math.hypot(x, z) > 0.01 and abs(shade - 1) > 0.002
+    return theta, max(-max_angle, min(max_angle, angle)), backtracking, conditioned
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--cc', default='cc', help='host C compiler')
+    parser.add_argument('--step', type=float, default=1.0, help='sun position grid step, degrees')
+    args = parser.parse_args()
+
+    cases, lines = [], []
+    for config in CONFIGS:
+        axis, tilt, gcr, max_angle = config
+        lines.append('c %d %d %d %d' % (axis * 100, tilt * 100, round(gcr * 32768), max_angle * 100))
+        elevation = args.step
+        while elevation < 90:
+            azimuth = 0.0
+            while azimuth < 360:
+                lines.append('s %.3f %.3f' % (elevation, azimuth))
+                cases.append((config, elevation, azimuth))
+                azimuth += args.step
+            elevation += args.step
+
+    work = tempfile.mkdtemp(prefix='tracker_accuracy')
+    try:
+        for name in ('Tracker.c', 'Tracker.h', 'TrackerVar.h', 'FixedMath.c', 'FixedMath.h', 'FixedMathVar.h',
+                     'Units.h'):
+            shutil.copy(os.path.join(PROJECT, name), work)
+        open(os.path.join(work, 'Settings.h'), 'w').write(SETTINGS)
+        open(os.path.join(work, 'harness.c'), 'w').write(HARNESS)
+        binary = os.path.join(work, 'harness')
+        run([args.cc, '-O2', '-std=gnu99', '-Wall', '-I', work, os.path.join(work, 'Tracker.c'),
+             os.path.join(work, 'FixedMath.c'), os.path.join(work, 'harness.c'), '-o', binary, '-lm'])
+        output = run([binary], input='\n'.join(lines) + '\n').split()
+    finally:
+        shutil.rmtree(work)
+
+    worst = {}
+    for i, (config, elevation, azimuth) in enumerate(cases):
+        ideal, angle, backtracking = (int(v) for v in output[3 * i:3 * i + 3])
+        theta, ref_angle, ref_backtracking, conditioned = reference(elevation, azimuth, *config)
+        entry = worst.setdefault(config, [0.0, 0.0, 0, 0])
+        if not conditioned:
+            entry[3] += 1
+            continue
+        error = abs(ideal / 100 - theta)
+        entry[0] = max(entry[0], min(error, 360 - error))  # +-180 are the same rotation
+        entry[1] = max(entry[1], abs(angle / 100 - ref_angle))
+        entry[2] += bool(backtracking) != ref_backtracking
+
+    print('%7s %5s %5s %5s %12s %12s %10s %8s' % ('axis', 'tilt', 'GCR', 'max', 'ideal err', 'angle err',
+                                                'bt flips', 'skipped'))
+    for config, (ideal, angle, flips, skipped) in worst.items():
+        print('%7d %5d %5.2f %5d %10.3f d %10.3f d %10d %8d' % (config + (ideal, angle, flips, skipped)))
+    print('(%d sun positions per configuration)' % (len(cases) // len(CONFIGS)))
+    print()
+    print('worst: ideal %.3f deg, backtracked %.3f deg' % (max(w[0] for w in worst.values()),
+                                                           max(w[1] for w in worst.values())))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+"""
+units_check.py - range sweep and type checks of the fixed-point units (Units.h).
+
+Builds Units.h with the host C compiler in its checked form (UNITS_CHECKED, every result and
+intermediate product computed in 64 bits and checked against the range the AVR computes it in)
+and checks that
+
+  - UNIT_CONVERT() between every two units of the same quantity gives the exact value rounded to
+    nearest (half away from zero) over the physical range of the station's sensors, and never
+    overflows there; the table shows what the compiler made of each conversion,
+  - the checked build catches overflow of UNIT_ADD(), UNIT_MUL() and of a conversion out of range,
+  - code that mixes units does not compile: converting between quantities, passing a value of the
+    wrong unit to UNIT_CONVERT() or UNIT_ADD(), assigning or passing one unit as another.
+
+  python3 tools/units_check.py
+  python3 tools/units_check.py --points 2000 --verbose
+"""
+
+import argparse
+import fractions
+import os
+import random
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+PROJECT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AVR64dd32 meteorologine stotele v3')
+
+# Physical range of every quantity in base units: the sensors' operating ranges, the SHT21
+# humidity formula (-6 ... 119 %), angles of either sign, the site altitude limits.
+RANGES = {
+    'TEMPERATURE': (-60, 125),
+    'PRESSURE': (30000, 110000),
+    'HUMIDITY': (-6, 119),
+    'ANGLE': (-360, 360),
+    'LENGTH': (-500, 9000),
+    'SPEED': (0, 75),
+}
+
+STORAGE = {'int16_t': (-32768, 32767), 'uint16_t': (0, 65535),
+           'int32_t': (-2 ** 31, 2 ** 31 - 1), 'uint32_t': (0, 2 ** 32 - 1)}
+
+PRELUDE = '''#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Units.h"
+
+static int overflows;
+
+int64_t Units_Check(int64_t value, int64_t min, int64_t max, const char *file, int line) {
+    (void)file;
+    (void)line;
+    if (value < min || value > max)
+        overflows++;
+    return value;
+}
+
+static inline int32_t pascals(UNIT_T(PASCAL) x) { return UNIT_RAW(x); }
+'''
+
+# Each case must fail to compile with the message given.
+MIXING = [
+    ('conversion between quantities', 'UNIT_T(CELSIUS_100) t = UNIT(CELSIUS_100, 2150); '
+     'int32_t p = UNIT_RAW(UNIT_CONVERT(CELSIUS_100, HPA_100, t));', 'different quantities'),
+    ('value of the wrong unit converted', 'UNIT_T(CELSIUS_100) t = UNIT(CELSIUS_100, 2150); '
+     'int32_t p = UNIT_RAW(UNIT_CONVERT(HPA_100, PASCAL, t));', 'not in unit HPA_100'),
+    ('same scale, other unit', 'UNIT_T(HPA_100) h = UNIT(HPA_100, 101325); '
+     'int32_t p = UNIT_RAW(UNIT_CONVERT(PASCAL, HPA_10, h));', 'not in unit PASCAL'),
+    ('sum of two units', 'UNIT_T(PASCAL) a = UNIT(PASCAL, 101325); UNIT_T(HPA_100) b = UNIT(HPA_100, 5); '
+     'int32_t p = UNIT_RAW(UNIT_ADD(PASCAL, a, b));', 'not in unit PASCAL'),
+    ('assignment of another unit', 'UNIT_T(PASCAL) a; a = UNIT(HPA_100, 101325); int32_t p = UNIT_RAW(a);',
+     'incompatible type'),
+    ('argument of another unit', 'int32_t p = pascals(UNIT(HPA_100, 101325));', 'incompatible type'),
+]
+
+CONTROL = ('UNIT_T(CELSIUS_100) t = UNIT(CELSIUS_100, 2150); '
+           'int32_t p = UNIT_RAW(UNIT_CONVERT(CELSIUS_100, CELSIUS_10, t));')
+
+
+def run(command, **kwargs):
+    result = subprocess.run(command, capture_output=True, text=True, **kwargs)
+    if result.returncode:
+        sys.exit('%s\n%s%s' % (' '.join(command), result.stdout, result.stderr))
+    return result.stdout
+
+
+def units():
+    """{name: (storage, quantity, num, den)} from the unit table of Units.h."""
+    text = open(os.path.join(PROJECT, 'Units.h'), encoding='latin-1').read()
+    table = {}
+    for m in re.finditer(r'#define UNIT_(\w+)\s+(u?int\d+_t),\s*(\w+),\s*(\d+),\s*(\d+)', text):
+        table[m.group(1)] = (m.group(2), m.group(3), int(m.group(4)), int(m.group(5)))
+    return table
+
+
+def round_half_away(x):
+    """Fraction x rounded to the nearest integer, halves away from zero."""
+    n = abs(x.numerator) * 2 + x.denominator
+    q = n // (2 * x.denominator)
+    return q if x >= 0 else -q
+
+
+def operation(mul, div):
+    """What UNIT_SCALE() compiles to for the constant ratio mul / div."""
+    if mul % div == 0:
+        k = mul // div
+        return 'copy' if k == 1 else 'x%d' % k
+    d = div // mul if div % mul == 0 else None
+    if d:
+        return ('>>%d rounded' % (d.bit_length() - 1)) if d & (d - 1) == 0 else '/%d rounded' % d
+    return 'x%d /%d rounded' % (mul, div)
+
+
+def sweep_points(rng, table, name, count):
+    """Raw values of unit name covering the physical range of its quantity."""
+    storage, quantity, num, den = table[name]
+    low, high = RANGES[quantity]
+    raw_low = int(fractions.Fraction(low * den, num))
+    raw_high = int(fractions.Fraction(high * den, num))
+    lo, hi = STORAGE[storage]
+    raw_low, raw_high = max(raw_low, lo), min(raw_high, hi)
+    points = {raw_low, raw_high, 0 if raw_low <= 0 <= raw_high else raw_low}
+    points.update(rng.randint(raw_low, raw_high) for _ in range(count))
+    return sorted(points)
+
+
+def compiles(cc, work, body):
+    """(compiled, compiler messages) of a function body using Units.h."""
+    path = os.path.join(work, 'case.c')
+    open(path, 'w').write(PRELUDE + 'int32_t check(void) {\n    %s\n    return p;\n}\n' % body)
+    result = subprocess.run([cc, '-std=gnu99', '-fsyntax-only', '-DUNITS_CHECKED', '-I', work, path],
+                            capture_output=True, text=True)
+    return result.returncode == 0, result.stderr
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--cc', default='cc', help='host C compiler')
+    parser.add_argument('--points', type=int, default=500, help='random values per conversion')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--verbose', action='store_true', help='show the first mismatches of every conversion')
+    args = parser.parse_args()
+
+    table = units()
+    rng = random.Random(args.seed)
+    pairs = [(a, b) for a in table for b in table if a != b and table[a][1] == table[b][1]]
+    inputs = {(a, b): sweep_points(rng, table, a, args.points) for a, b in pairs}
+
+    harness = [PRELUDE, 'int main(void) {', '    int pair;', '    long long raw;',
+               '    while (scanf("%d %lld", &pair, &raw) == 2) {', '        long long out = 0;',
+               '        overflows = 0;', '        switch (pair) {']
+    for i, (a, b) in enumerate(pairs):
+        harness.append('            case %d: { UNIT_T(%s) x = { (UNIT_STORAGE(%s))raw }; '
+                       'out = UNIT_RAW(UNIT_CONVERT(%s, %s, x)); break; }' % (i, a, a, a, b))
+    harness += ['        }', '        printf("%lld %d\\n", out, overflows);', '    }',
+                '    UNIT_T(CELSIUS_100) hot = UNIT(CELSIUS_100, 30000);',
+                '    overflows = 0; hot = UNIT_ADD(CELSIUS_100, hot, hot); printf("add %d\\n", overflows);',
+                '    overflows = 0; hot = UNIT_MUL(CELSIUS_100, UNIT(CELSIUS_100, 20000), 2); '
+                'printf("mul %d\\n", overflows);',
+                '    overflows = 0; UNIT_T(METRE) m = UNIT_CONVERT(CENTIMETRE, METRE, UNIT(CENTIMETRE, 4000000)); '
+                'printf("convert %d\\n", overflows);',
+                '    (void)hot; (void)m;', '    return 0;', '}', '']
+
+    work = tempfile.mkdtemp(prefix='units_check')
+    try:
+        shutil.copy(os.path.join(PROJECT, 'Units.h'), work)
+        open(os.path.join(work, 'harness.c'), 'w').write('\n'.join(harness))
+        binary = os.path.join(work, 'harness')
+        run([args.cc, '-O2', '-std=gnu99', '-Wall', '-DUNITS_CHECKED', '-I', work, os.path.join(work, 'harness.c'),
+             '-o', binary, '-lm'])
+        feed = ''.join('%d %d\n' % (i, raw) for i, pair in enumerate(pairs) for raw in inputs[pair])
+        lines = run([binary], input=feed).split('\n')
+        control, _ = compiles(args.cc, work, CONTROL)
+        mixing = [(title, expect) + compiles(args.cc, work, body) for title, body, expect in MIXING]
+    finally:
+        shutil.rmtree(work)
+
+    failed = 0
+    print('%-13s %-13s %-16s %7s %9s %9s' % ('from', 'to', 'operation', 'values', 'errors', 'overflow'))
+    line = 0
+    for a, b in pairs:
+        _, _, num_a, den_a = table[a]
+        storage_b, _, num_b, den_b = table[b]
+        mul, div = num_a * den_b, den_a * num_b
+        errors = overflow = 0
+        shown = []
+        for raw in inputs[(a, b)]:
+            out, flagged = map(int, lines[line].split())
+            line += 1
+            exact = round_half_away(fractions.Fraction(raw * mul, div))
+            lo, hi = STORAGE[storage_b]
+            if not lo <= exact <= hi:
+                overflow += 1
+                errors += not flagged
+            elif out != exact or flagged:
+                errors += 1
+                if len(shown) < 3:
+                    shown.append('%d -> %d, expected %d%s' % (raw, out, exact, ' (overflow)' if flagged else ''))
+        failed += errors
+        print('%-13s %-13s %-16s %7d %9d %9d' % (a, b, operation(mul, div), len(inputs[(a, b)]), errors, overflow))
+        if args.verbose:
+            for item in shown:
+                print('    ' + item)
+
+    print()
+    for item in lines[line:line + 3]:
+        kind, flagged = item.split()
+        ok = flagged != '0'
+        failed += not ok
+        print('%-44s %s' % ('overflow of UNIT_%s caught' % kind.upper(), 'yes' if ok else 'NO'))
+    print('%-44s %s' % ('correct use compiles', 'yes' if control else 'NO'))
+    failed += not control
+    for title, expect, built, messages in mixing:
+        ok = not built and expect in messages
+        failed += not ok
+        print('%-44s %s' % (title + ' rejected', 'yes' if ok else 'NO'))
+    print()
+    print('errors: results differing from the exact value rounded half away from zero, or a false overflow')
+    print('report; overflow: values of the physical range that the target unit cannot hold (reported)')
+    if failed:
+        sys.exit('unit checks failed')
+
+
+if __name__ == '__main__':
+    main()